@@ -14,7 +14,9 @@
  * Contracts:
  * - Hot/cold memory is stable for the lifetime of the handle generation
  * - Do not store raw pointers to hot/cold across operations that may realloc the slotmap
- * - Strings in client_cold_t may be owned by string_arena or heap depending on implementation
+ * - Strings in client_cold_t are owned by string_arena and must be replaced through
+ *   client_cold_set_string; the arena is compacted (moving every string) once replaced
+ *   strings dominate, so do not keep string pointers across a setter call
  *
  * Threading:
  * - Not thread-safe
@@ -124,7 +126,8 @@ typedef enum client_flags {
     CLIENT_FLAG_NONE = 0,
     CLIENT_FLAG_URGENT = 1u << 0,
     CLIENT_FLAG_FOCUSED = 1u << 1,
-    CLIENT_FLAG_UNDECORATED = 1u << 2
+    CLIENT_FLAG_UNDECORATED = 1u << 2,
+    CLIENT_FLAG_FRAMELESS = 1u << 3 /* not reparented: frame == xid, decided at manage time */
 } client_flags_t;
 
 /* Supported WM_PROTOCOLS */
@@ -159,7 +162,7 @@ typedef struct client_hot {
     handle_t self;
 
     xcb_window_t xid;
-    xcb_window_t frame;
+    xcb_window_t frame; /* == xid for CLIENT_FLAG_FRAMELESS clients */
 
     rect_t server;
     rect_t last_synthetic_geom;
@@ -181,12 +184,21 @@ typedef struct client_hot {
     bool saved_maximized_horz;
     bool saved_maximized_vert;
 
-    int32_t stacking_index;
-    int8_t stacking_layer;
+    /* Stacking (stack.c): intrusive per-layer order list, bottom -> top */
+    struct client_hot* stack_below;
+    struct client_hot* stack_above;
+    uint64_t stack_label;  /* increases bottom -> top within a layer */
+    int8_t stacking_layer; /* -1 = not linked into any layer */
 
     uint32_t dirty;
     uint32_t last_log_dirty;
 
+    /* Per-atom property tracking, one bit per prop_schema_table entry */
+    uint64_t prop_refetch;   /* changed since the last commit (PropertyNotify NewValue) */
+    uint64_t prop_deleted;   /* deleted since the last commit (PropertyNotify Delete) */
+    uint64_t prop_inflight;  /* GetProperty issued, not every reply seen yet (client_cold_t.prop_fetches) */
+    uint64_t title_fetch_ns; /* last DIRTY_TITLE commit (monotonic ns), see wm_flush_dirty */
+
     uint8_t state;         /* client_state_t */
     uint8_t initial_state; /* from WM_HINTS */
     uint8_t pending_replies;
@@ -220,6 +232,17 @@ typedef struct client_hot {
 
     bool show_desktop_hidden;
 
+    /* Workspace visibility */
+    bool frame_mapped;       /* frame map state as last requested from the server */
+    bool frame_parked;       /* frame moved off the root area (workspace_hide = park) */
+    bool desktop_indexed;    /* present in the desktop membership index */
+    int32_t indexed_desktop; /* index bucket: desktop, or -1 for the sticky list */
+
+    /* Placement grid: cell span the frame is filed under (empty when cx0 > cx1) */
+    bool place_indexed;
+    uint16_t place_cx0, place_cy0, place_cx1, place_cy1;
+    uint32_t place_stamp;
+
     bool motif_decorations_set;
     bool motif_undecorated;
 
@@ -274,6 +297,12 @@ typedef struct client_hot {
     bool window_opacity_valid;
     uint32_t window_opacity;
 
+    /* _NET_WM_BYPASS_COMPOSITOR: 0 no preference, 1 unredirect, 2 keep compositing */
+    uint8_t bypass_compositor; /* as set by the client */
+    uint8_t bypass_rule;       /* rule override, 0 = none */
+    uint8_t bypass_published;  /* value last mirrored onto the frame */
+    bool frame_bare;           /* fullscreen frame without a background (frame_sync_bypass) */
+
     bool fullscreen_monitors_valid;
     uint32_t fullscreen_monitors[4];
 } client_hot_t;
@@ -286,6 +315,16 @@ static inline uint8_t client_layer_from_state(const client_hot_t* hot) {
     return hot->base_layer;
 }
 
+/* True if the client window is managed in place, without a frame of our own */
+static inline bool client_is_frameless(const client_hot_t* hot) {
+    return hot && (hot->flags & CLIENT_FLAG_FRAMELESS) != 0;
+}
+
+/* UnmapNotify events for the client window that unmapping hot->frame produces
+ * (a frameless client reports its own unmap once to itself and once to the root)
+ */
+static inline uint8_t client_frame_unmap_echoes(const client_hot_t* hot) { return client_is_frameless(hot) ? 2 : 1; }
+
 /* client_cold_t: rarely accessed client state */
 typedef struct client_cold {
     /* Effective/composed strings used for UI */
@@ -303,7 +342,15 @@ typedef struct client_cold {
     xcb_window_t* colormap_windows;
     uint32_t colormap_windows_len;
 
+    /* Title rules (config.rules indices) matching at the last evaluation */
+    uint32_t* title_rules;
+    uint32_t title_rules_len;
+    uint32_t title_rules_cap;
+    uint32_t title_rules_gen; /* rule_index generation the indices refer to */
+
     arena_t string_arena;
+    uint32_t string_live; /* arena bytes referenced by the fields above */
+    uint32_t string_dead; /* arena bytes orphaned by replaced strings */
 
     bool has_net_wm_name;
     bool has_net_wm_icon_name;
@@ -317,8 +364,12 @@ typedef struct client_cold {
     strut_t strut_full;
     bool strut_partial_active;
     bool strut_full_active;
+    bool strut_registered; /* listed in s->strut_clients */
 
     uint32_t pid;
+
+    /* Outstanding GetProperty requests per prop_schema_table entry (PROP_SCHEMA_MAX) */
+    uint16_t prop_fetches[64];
 } client_cold_t;
 
 typedef struct server server_t;
@@ -327,8 +378,13 @@ typedef struct server server_t;
 void client_manage_start(server_t* s, xcb_window_t win);
 void client_finish_manage(server_t* s, handle_t h);
 void client_unmanage(server_t* s, handle_t h);
+void client_apply_title_rules(server_t* s, handle_t h);
 void client_close(server_t* s, handle_t h);
 
+/* Cold string storage */
+void client_cold_set_string(client_cold_t* cold, char** field, const char* str, size_t len);
+void client_cold_strings_destroy(client_cold_t* cold);
+
 /* Helpers */
 void client_constrain_size(const size_hints_t* hints, uint32_t flags, uint16_t* w, uint16_t* h);
 
@@ -15,6 +15,8 @@
  *   are heap-owned by config_t and freed by config_destroy
  * - small_vec_t key_bindings holds key_binding_t* (or inline structs) depending on ds.h
  * - small_vec_t rules holds app_rule_t* (or inline structs) depending on ds.h
+ * - rule_index is compiled from rules at load time and owned alongside them;
+ *   anything that edits rules afterwards bumps rules_version so the index is rebuilt
  *
  * Threading:
  * - Not thread-safe
@@ -34,6 +36,7 @@ extern "C" {
 #include <xcb/xcb_keysyms.h>
 
 #include "ds.h"
+#include "rule_index.h"
 #include "theme.h"
 
 /* Action types referenced by key bindings and menu items */
@@ -72,7 +75,19 @@ typedef struct key_binding {
 } key_binding_t;
 
 /* Initial placement policy for newly-managed windows */
-typedef enum placement_policy { PLACEMENT_DEFAULT = 0, PLACEMENT_CENTER, PLACEMENT_MOUSE } placement_policy_t;
+typedef enum placement_policy {
+    PLACEMENT_DEFAULT = 0,
+    PLACEMENT_CENTER,
+    PLACEMENT_MOUSE,
+    PLACEMENT_SMART /* least overlap with visible windows on the target desktop/monitor */
+} placement_policy_t;
+
+/* How frames on hidden workspaces are taken off screen
+ * - UNMAP: unmap the frame (clients repaint from scratch when shown again)
+ * - PARK: keep the frame mapped and move it off the root area, so clients and
+ *   compositors keep their contents
+ */
+typedef enum workspace_hide { WORKSPACE_HIDE_UNMAP = 0, WORKSPACE_HIDE_PARK } workspace_hide_t;
 
 /* Application rule:
  * Match fields:
@@ -96,6 +111,7 @@ typedef struct app_rule {
     int32_t desktop;
     int32_t layer;
     int8_t focus;
+    int8_t bypass_compositor; /* -1 keep the client's, else forced _NET_WM_BYPASS_COMPOSITOR (1 or 2) */
 
     placement_policy_t placement;
 } app_rule_t;
@@ -115,10 +131,15 @@ typedef struct config {
      */
     small_vec_t key_bindings;
     small_vec_t rules;
+    rule_index_t rule_index; /* compiled from rules (rule_index.h) */
+    uint32_t rules_version;  /* bumped on every edit to rules */
 
     /* Policy flags */
     bool focus_raise;
     bool fullscreen_use_workarea;
+    workspace_hide_t workspace_hide;
+    bool frameless_undecorated;   /* manage undecorated/CSD windows without reparenting them */
+    placement_policy_t placement; /* for windows without a rule or position hint */
 } config_t;
 
 /* Initialize config to default values (does not load from disk) */
@@ -138,6 +159,20 @@ bool theme_load(theme_t* theme, const char* path);
 /* Free all heap-owned memory inside config */
 void config_destroy(config_t* config);
 
+/* Sections of config_t that differ between two loads (config_diff) */
+enum config_change {
+    CONFIG_CHANGED_DESKTOPS = 1u << 0,    /* desktop_count, desktop_names */
+    CONFIG_CHANGED_KEYS = 1u << 1,        /* key_bindings */
+    CONFIG_CHANGED_RULES = 1u << 2,       /* rules */
+    CONFIG_CHANGED_FRAME_GEOM = 1u << 3,  /* frame extents: border_width, title_height */
+    CONFIG_CHANGED_FRAME_STYLE = 1u << 4, /* anything else frames are painted with */
+    CONFIG_CHANGED_MENU = 1u << 5,        /* menu appearance */
+    CONFIG_CHANGED_POLICY = 1u << 6,      /* policy flags */
+};
+
+/* Compare two configs section by section; returns CONFIG_CHANGED_* bits */
+uint32_t config_diff(const config_t* a, const config_t* b);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,16 @@
  *   (XCB replies are heap allocated; this is the conventional contract)
  * - err pointer (if non-NULL) is owned by XCB and must be free()'d by the handler
  *
+ * Grouped transactions:
+ * - A burst of requests issued back-to-back (e.g. the manage-time property
+ *   fetches) occupies a contiguous run of sequence numbers
+ * - cookie_jar_txn_begin/add/commit record such a burst as a single jar slot
+ *   keyed by the first sequence, with a per-request descriptor table and a
+ *   completion bitmask
+ * - The handler still sees one call per sub-reply, with a synthesized slot
+ *   carrying the sub-request's sequence, type and data plus the group txn_id
+ * - A request that breaks the run falls back to an ordinary cookie_jar_push
+ *
  * Implementation notes:
  * - COOKIE_JAR_CAP must be a power of two
  * - Sequence numbers are 32-bit in XCB, but only the low 16 bits are used on the wire
@@ -55,7 +65,21 @@ typedef enum cookie_type {
 
     COOKIE_SYNC_QUERY_COUNTER,
 
-    COOKIE_CHECK_MANAGE_MAP_REQUEST
+    COOKIE_CHECK_MANAGE_MAP_REQUEST,
+
+    /* Monitor discovery (wm_update_monitors), not tied to a client */
+    COOKIE_RANDR_GET_MONITORS,
+    COOKIE_RANDR_SCREEN_RESOURCES,
+    COOKIE_RANDR_CRTC_INFO,
+
+    /* Keymap refresh (wm_setup_keys, MappingNotify) */
+    COOKIE_GET_KEYBOARD_MAPPING,
+
+    /* Round trip that releases a pooled frame from quarantine (frame_release) */
+    COOKIE_FRAME_POOL_SYNC,
+
+    /* Grouped transaction slot (see cookie_txn_t), never seen by handlers */
+    COOKIE_TXN
 } cookie_type_t;
 
 struct server;
@@ -105,11 +129,32 @@ typedef struct cookie_slot {
 #define COOKIE_JAR_TIMEOUT_NS (5ull * 1000ull * 1000ull * 1000ull)
 #endif
 
+/* Max sub-requests per grouped transaction (width of the completion mask) */
+#define COOKIE_TXN_MAX_REQUESTS 32u
+
+typedef struct cookie_txn_req {
+    cookie_type_t type;
+    uintptr_t data;
+} cookie_txn_req_t;
+
+typedef struct cookie_txn {
+    uint32_t base_sequence; /* sequence of reqs[0]; reqs[i] is base_sequence + i */
+    uint32_t count;         /* number of sub-requests recorded */
+    uint32_t done_mask;     /* bit i set once reqs[i] has been dispatched */
+    handle_t client;
+    uint64_t txn_id;
+    cookie_handler_fn handler;
+    struct cookie_txn* next_free;
+    cookie_txn_req_t reqs[COOKIE_TXN_MAX_REQUESTS];
+} cookie_txn_t;
+
 typedef struct cookie_jar {
     cookie_slot_t* slots;
     size_t cap;
     size_t live_count;
     size_t scan_cursor;
+
+    cookie_txn_t* txn_free; /* recycled transaction records */
 } cookie_jar_t;
 
 /* Initialize/destroy */
@@ -125,6 +170,19 @@ void cookie_jar_destroy(cookie_jar_t* cj);
 bool cookie_jar_push(cookie_jar_t* cj, uint32_t sequence, cookie_type_t type, handle_t client, uintptr_t data,
                      uint64_t txn_id, cookie_handler_fn handler);
 
+/* Grouped transactions
+ *
+ * cookie_jar_txn_begin returns a transaction record owned by the jar
+ * cookie_jar_txn_add records one request; it must be called in issue order
+ * cookie_jar_txn_commit publishes the group into the jar (one slot)
+ *
+ * Requests must be issued without interleaving other requests on the
+ * connection; any gap or overflow is pushed as an individual cookie instead
+ */
+cookie_txn_t* cookie_jar_txn_begin(cookie_jar_t* cj, handle_t client, uint64_t txn_id, cookie_handler_fn handler);
+void cookie_jar_txn_add(cookie_jar_t* cj, cookie_txn_t* txn, uint32_t sequence, cookie_type_t type, uintptr_t data);
+void cookie_jar_txn_commit(cookie_jar_t* cj, cookie_txn_t* txn);
+
 /* Drain ready replies (non-blocking)
  * Polls up to max_replies ready replies and dispatches handlers
  * Also expires timed out cookies (handler called with reply=NULL)
@@ -42,9 +42,11 @@ extern "C" {
 #include "config.h"
 #include "cookie_jar.h"
 #include "ds.h"
+#include "frame.h"
 #include "handle.h"
 #include "handle_conv.h"
 #include "hxm.h"
+#include "launcher.h"
 #include "menu.h"
 #include "slotmap.h"
 
@@ -111,6 +113,9 @@ typedef struct event_buckets {
     uint16_t randr_width;
     uint16_t randr_height;
 
+    /* Keyboard mapping changes (core and XKB) coalesced into one refetch */
+    bool keymap_dirty;
+
     /* Per-tick counters */
     uint64_t ingested;
     uint64_t coalesced;
@@ -145,12 +150,113 @@ typedef enum resize_dir {
     RESIZE_RIGHT = 1u << 3
 } resize_dir_t;
 
+/* Uniform grid over managed frame rectangles (wm_desktop.c)
+ * Each cell lists the clients whose frame overlaps it, so smart placement only
+ * looks at the windows near a candidate position
+ */
+typedef struct place_grid {
+    small_vec_t* cells;     /* [cols * rows], handles via ptr */
+    uint16_t cols, rows;
+    uint16_t width, height; /* screen size the grid was built for */
+    uint32_t stamp;         /* visit mark for the current query (client_hot_t.place_stamp) */
+} place_grid_t;
+
+/* Compiled key bindings (wm_input_keys.c)
+ * A direct (keycode, cleaned modifiers) -> binding table, so a key press is a
+ * single load. Modifiers are Shift/Control/Mod1/Mod3/Mod4 packed into 5 bits
+ * (Lock, Mod2 and Mod5 are cleaned away). Rebuilt by wm_setup_keys when the
+ * bindings change and by the keymap reply when the keyboard mapping does.
+ */
+#define KEY_TABLE_KEYCODES 256
+#define KEY_TABLE_MODS 32
+
+typedef struct key_table {
+    const key_binding_t** slots;            /* [KEY_TABLE_KEYCODES * KEY_TABLE_MODS], keycode-major */
+    uint8_t escape[KEY_TABLE_KEYCODES / 8]; /* keycodes whose base keysym is Escape */
+    uint32_t grabbed[KEY_TABLE_KEYCODES];   /* columns grabbed on the root (bit per column), for diffing */
+} key_table_t;
+
+/* Coalesced key actions (wm_input_keys.c)
+ * Auto-repeat on a workspace, focus-cycle or sticky binding folds into one
+ * pending action instead of running each press; wm_key_actions_flush applies
+ * the net effect once per tick. Only one kind is pending at a time: any other
+ * action flushes it first, so effects keep their order.
+ */
+typedef enum key_action_kind {
+    KEY_ACTION_NONE = 0,
+    KEY_ACTION_WORKSPACE,
+    KEY_ACTION_FOCUS,
+    KEY_ACTION_STICKY,
+} key_action_kind_t;
+
+/* Focus presses one pending FOCUS action can hold before it is flushed */
+#define KEY_ACTION_FOCUS_MAX 32
+
+typedef struct key_action_queue {
+    key_action_kind_t kind;
+    uint32_t workspace;     /* WORKSPACE: target desktop */
+    uint32_t focus_next;    /* FOCUS: bit i set if press i was focus-next */
+    uint8_t focus_presses;  /* FOCUS: presses recorded in focus_next */
+    handle_t sticky_client; /* STICKY: client the toggles apply to */
+    bool sticky_flip;       /* STICKY: odd number of toggles */
+    uint32_t coalesced;     /* presses folded into the pending action */
+} key_action_queue_t;
+
+/* Base keysym (column 0) per keycode
+ * Filled from an async GetKeyboardMapping and refetched on MappingNotify /
+ * XkbMapNotify; replies from a superseded request (older gen) are dropped
+ */
+typedef struct keymap {
+    xcb_keysym_t base[KEY_TABLE_KEYCODES];
+    uint32_t gen;
+    bool valid;
+} keymap_t;
+
+/* Last known pointer position in root coordinates
+ * Fed by the input events the WM receives (frame motion, crossing, button, key)
+ * and QueryPointer replies. Motion inside client windows never reaches the WM,
+ * so this is a placement hint only; interactions that take motion deltas from
+ * the origin query the pointer instead
+ */
+typedef struct pointer_cache {
+    int16_t x, y;
+    bool valid;
+} pointer_cache_t;
+
 /* Monitor information */
 typedef struct monitor {
     rect_t geom;
     rect_t workarea;
 } monitor_t;
 
+/* Window list as last written to a root property */
+typedef struct published_windows {
+    xcb_window_t* items;
+    uint32_t len;
+    uint32_t cap;
+} published_windows_t;
+
+/* One stacking layer: clients linked through client_hot_t.stack_below/stack_above.
+ * All-zero is a valid empty layer.
+ */
+typedef struct stack_layer {
+    client_hot_t* bottom;
+    client_hot_t* top;
+    uint32_t length;
+} stack_layer_t;
+
+/* Frame stacking order as last committed to the X server (stack_commit) */
+typedef struct stack_entry {
+    handle_t h;
+    xcb_window_t frame;
+} stack_entry_t;
+
+typedef struct committed_stack {
+    stack_entry_t* items; /* bottom -> top across all layers */
+    uint32_t len;
+    uint32_t cap;
+} committed_stack_t;
+
 /* Main server state */
 typedef struct server {
     xcb_connection_t* conn;
@@ -167,6 +273,9 @@ typedef struct server {
     int epoll_fd;
     int signal_fd;
     int timer_fd;
+    uint64_t timer_deadline_ns; /* pending timer_fd expiry (monotonic), 0 = none */
+    launcher_t launcher; /* pre-forked exec helper (launcher.h) */
+    frame_pool_t frame_pool; /* recycled frame windows (frame.h) */
 
     /* Extension support flags */
     bool damage_supported;
@@ -176,19 +285,37 @@ typedef struct server {
     bool randr_supported;
     uint8_t randr_event_base;
 
+    bool xkb_supported;
+    uint8_t xkb_event_base;
+
     /* Root property dirty bits */
     uint32_t root_dirty;
 
     /* Monitor configuration */
     monitor_t* monitors;
     uint32_t monitor_count;
+    bool randr_monitors; /* RandR >= 1.5: discover via GetMonitors */
 
-    /* Workarea (computed minus struts/docks) */
+    /* Async monitor query (wm.c): the table being collected for generation monitor_query_gen */
+    uint32_t monitor_query_gen;
+    monitor_t* monitor_query_next;
+    uint32_t monitor_query_len;
+    uint32_t monitor_query_pending; /* CRTC replies still outstanding */
+
+    /* Workarea (computed minus struts/docks); workarea is the primary monitor's */
     rect_t workarea;
     bool workarea_dirty;
+    uint64_t workarea_dirty_monitors;   /* bit per monitor: rebuild at the next wm_compute_workarea */
+    uint64_t workarea_changed_monitors; /* bit per monitor: moved, maximized windows not yet relaid out */
+    small_vec_t strut_clients;          /* clients with a non-zero strut (handle_t via ptr) */
+    uint16_t screen_w;                  /* root size, cached from the setup and RandR notifies */
+    uint16_t screen_h;
 
     /* Key symbols mapping */
     xcb_key_symbols_t* keysyms;
+    keymap_t keymap;
+    key_table_t key_table;
+    key_action_queue_t key_actions;
 
     /* Cursor resources */
     xcb_cursor_t cursor_left_ptr;
@@ -217,6 +344,8 @@ typedef struct server {
 
     int16_t interaction_pointer_x, interaction_pointer_y;
 
+    pointer_cache_t pointer;
+
     /* Per-tick scratch arena */
     arena_t tick_arena;
 
@@ -237,9 +366,15 @@ typedef struct server {
     hash_map_t window_to_client;         /* xcb_window_t -> handle_t via ptr */
     hash_map_t frame_to_client;          /* frame XID -> handle_t via ptr */
     hash_map_t pending_unmanaged_states; /* xcb_window_t -> small_vec_t* */
+    hash_map_t prop_cache;               /* xcb_window_t -> last published WM-owned properties (wm_dirty.c) */
+
+    /* Root client lists as last published (the next publish diffs against them) */
+    published_windows_t client_list_pub;  /* _NET_CLIENT_LIST */
+    published_windows_t client_stack_pub; /* _NET_CLIENT_LIST_STACKING */
 
     /* Stacking layers (bottom -> top) */
-    small_vec_t layers[LAYER_COUNT]; /* each contains handle_t via ptr or direct value depending on ds impl */
+    stack_layer_t layers[LAYER_COUNT];
+    committed_stack_t committed_stack; /* what the next stack_commit diffs against */
 
     /* Focus */
     handle_t focused_client;
@@ -252,6 +387,16 @@ typedef struct server {
     uint32_t current_desktop;
     bool showing_desktop;
 
+    /* Desktop membership index (managed clients, handles via ptr) for O(k) workspace switches */
+    small_vec_t* desktop_members;   /* [desktop_members_cap], grown on demand */
+    uint32_t desktop_members_cap;
+    small_vec_t sticky_members;
+    small_vec_t visibility_pending; /* clients whose own desktop/sticky/state changed */
+    uint32_t visible_desktop;       /* desktop shown by the last visibility pass */
+
+    /* Spatial index for smart placement */
+    place_grid_t place_grid;
+
     /* Root menu */
     menu_t menu;
 
@@ -322,7 +467,9 @@ bool event_drain_cookies(server_t* s);
 /* Process buckets, apply updates, flush dirty changes */
 void event_process(server_t* s);
 
-/* Schedule a timerfd-based wakeup after ms milliseconds */
+/* Schedule a timerfd-based wakeup after ms milliseconds
+ * One timer serves every caller: a later deadline never pushes back an earlier pending one
+ */
 void server_schedule_timer(server_t* s, int ms);
 
 #ifdef __cplusplus
@@ -5,6 +5,7 @@
  * - Per-server frame rendering resources (fonts, surfaces, caches)
  * - Redrawing frame decorations (border/title/buttons) for a client by handle
  * - Hit-testing frame buttons
+ * - Creating and recycling frame windows (frame_acquire / frame_release)
  *
  * Design notes:
  * - All functions are expected to be called from the server's main thread
@@ -15,6 +16,7 @@
  * Contract:
  * - frame_init_resources must be called once during server startup
  * - frame_cleanup_resources must be called once during server shutdown
+ * - frame_pool_destroy must be called once during server shutdown (after clients are unmanaged)
  * - Passing HANDLE_INVALID is a no-op for functions that operate on a handle
  * - If the handle does not resolve to a live client, calls are no-ops and return safe defaults
  */
@@ -26,12 +28,16 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <xcb/xcb.h>
 
 #include "handle.h"
 #include "hxm.h"
+#include "render.h"
 
 typedef struct server server_t;
+typedef struct client_hot client_hot_t;
 
 /* Redraw flags for the decoration subparts */
 typedef enum frame_redraw_mask {
@@ -53,6 +59,54 @@ typedef enum frame_button {
 void frame_init_resources(server_t* s);
 void frame_cleanup_resources(server_t* s);
 
+/*
+ * Frame pool:
+ * Short-lived toplevels (dialogs, splashes, notifications) would otherwise
+ * create and destroy a frame window, XID and render context each. Released
+ * frames are unmapped and kept, with their render context (backing surface,
+ * Pango layout), up to FRAME_POOL_MAX; frame_pool_init pre-creates a few.
+ *
+ * A released frame is only handed out again once a round trip issued after
+ * its unmap has returned and one more tick has passed, so every event the
+ * previous client's frame generated has been ingested and processed before
+ * the XID belongs to someone else.
+ */
+#define FRAME_POOL_MAX 16u
+#define FRAME_POOL_PREFILL 4u
+
+typedef struct frame_pool_entry {
+    xcb_window_t frame;
+    render_context_t render_ctx;
+    uint32_t sync_seq;  /* quarantine round trip still in flight, 0 = none */
+    uint64_t ready_txn; /* usable once s->txn_id is past this */
+} frame_pool_entry_t;
+
+typedef struct frame_pool {
+    frame_pool_entry_t entries[FRAME_POOL_MAX];
+    uint32_t len;
+    bool enabled; /* set by frame_pool_init; otherwise frames are created and destroyed */
+} frame_pool_t;
+
+void frame_pool_init(server_t* s);
+void frame_pool_destroy(server_t* s);
+
+/* Get an unmapped frame with the standard attributes, recycled if one is ready
+ * ctx receives the pooled render context (left untouched for a new window)
+ * The geometry only applies to a newly created window; callers configure it
+ */
+xcb_window_t frame_acquire(server_t* s, render_context_t* ctx, int16_t x, int16_t y, uint16_t w, uint16_t h);
+
+/* Return hot->frame to the pool (taking hot->render_ctx) or destroy it
+ * The client must already be reparented out (or destroyed); hot->frame is left as is
+ */
+void frame_release(server_t* s, client_hot_t* hot);
+
+/* Mirror the effective _NET_WM_BYPASS_COMPOSITOR onto the frame and drop the
+ * frame background while fullscreen, so a compositor can unredirect the client
+ * Cheap when nothing changed; called on manage, hint changes and state/geometry commits
+ */
+void frame_sync_bypass(server_t* s, client_hot_t* hot);
+
 /* Redraw requested subparts of a frame
  * what is a bitmask of frame_redraw_mask_t
  */
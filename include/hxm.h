@@ -335,6 +335,7 @@ struct counters {
 
     uint64_t config_requests_applied;
     uint64_t restacks_applied;
+    uint64_t stack_relabels;
 
     uint64_t tick_duration_min;
     uint64_t tick_duration_sum;
@@ -342,6 +343,28 @@ struct counters {
     uint64_t tick_count;
 
     uint64_t x_flush_count;
+
+    uint64_t title_fetches_deferred;
+    uint64_t title_redraws_skipped;
+    uint64_t frame_redraws_deferred; /* hidden or covered frames left dirty for a later flush */
+    uint64_t prop_writes_skipped;
+
+    /* Client string arenas (current totals, not rates) */
+    uint64_t client_string_live_bytes;
+    uint64_t client_string_dead_bytes;
+    uint64_t client_string_compactions;
+
+    /* Process launches (launcher.c); latency is request -> child spawned */
+    uint64_t spawn_requests;
+    uint64_t spawn_fallbacks; /* forked from the WM (no launcher) */
+    uint64_t spawn_failures;
+    uint64_t spawn_latency_count;
+    uint64_t spawn_latency_sum;
+    uint64_t spawn_latency_max;
+
+    /* Frame windows (frame_acquire) */
+    uint64_t frames_created;
+    uint64_t frames_recycled;
 };
 
 extern struct counters counters;
@@ -0,0 +1,93 @@
+/*
+ * launcher.h - Pre-forked process launcher
+ *
+ * Starting a command with fork() from the WM copies the page tables of
+ * everything the WM has mapped (cairo, pango, fontconfig caches, pixmaps),
+ * which stalls the tick for milliseconds once the process is large. Instead
+ * a small helper is forked once at startup, before any of that is loaded,
+ * and the WM sends it exec requests over a socketpair.
+ *
+ * Protocol (SOCK_SEQPACKET, one message per request/reply):
+ * - request: launch_request_t header followed by the NUL-terminated argument
+ * - reply: launch_reply_t with the spawned pid (or errno) and both the request's
+ *   send time and the spawn completion time (CLOCK_MONOTONIC is system-wide),
+ *   so the WM records request -> spawned latency in the counters
+ *
+ * Helper:
+ * - posix_spawn()s each child in its own session with default signal
+ *   dispositions and an empty signal mask
+ * - ignores SIGCHLD so children are reaped by the kernel (no double fork)
+ * - exits when the WM end of the socket closes (exit, crash or restart exec)
+ *
+ * Fallback:
+ * - if the helper could not be started or has died, requests are run with the
+ *   old double fork from the WM process
+ *
+ * Contracts:
+ * - launcher_start must run before the X connection and libraries are set up
+ * - Not thread-safe
+ */
+
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef struct server server_t;
+
+typedef enum launch_kind {
+    LAUNCH_SHELL = 0, /* /bin/sh -c <arg> */
+    LAUNCH_EXEC,      /* execute <arg> directly (autostart script) */
+} launch_kind_t;
+
+/* Longest argument sent to the helper; longer commands use the fallback */
+#define LAUNCH_ARG_MAX 4096u
+
+typedef struct launch_request {
+    uint64_t sent_ns;
+    uint32_t kind; /* launch_kind_t */
+    /* followed by the argument, NUL-terminated */
+} launch_request_t;
+
+typedef struct launch_reply {
+    uint64_t sent_ns;
+    uint64_t spawned_ns;
+    int32_t pid; /* > 0 on success */
+    int32_t err; /* errno from posix_spawn when pid <= 0 */
+} launch_reply_t;
+
+typedef struct launcher {
+    int fd;    /* WM end of the socketpair, 0 when not running */
+    pid_t pid; /* helper process */
+    uint32_t inflight;
+} launcher_t;
+
+/* Fork the helper; on failure requests fall back to forking from the WM */
+void launcher_start(launcher_t* l);
+
+/* Close the WM end; the helper exits once it sees EOF */
+void launcher_stop(launcher_t* l);
+
+/* Run a command (LAUNCH_SHELL) */
+void launcher_spawn(server_t* s, const char* cmd);
+
+/* Run a command of the given kind */
+void launcher_run(server_t* s, launch_kind_t kind, const char* arg);
+
+/* Drain helper replies (the fd is readable) and record latency counters */
+void launcher_handle_replies(server_t* s);
+
+/* The helper hung up or errored: stop using it */
+void launcher_lost(server_t* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHER_H */
@@ -0,0 +1,137 @@
+/*
+ * prop_schema.h - Table-driven client property schema
+ *
+ * Every client property the WM reads is described once, in a compile-time
+ * table (prop_schema_table, defined next to the parsers in wm_reply.c):
+ * - which atom, requested type, expected format and max length (32-bit units)
+ * - the parser that applies a reply to client state
+ * - the dirty bits a PropertyNotify raises, and which wm_flush_dirty refetches
+ * - whether it is fetched at manage time and whether manage waits for it
+ *
+ * Users:
+ * - client_manage_start issues the manage burst from the table
+ * - wm_handle_property_notify records which entries changed or were deleted
+ *   (client_hot_t.prop_refetch / prop_deleted) and raises their dirty bits
+ * - wm_flush_dirty commits: only the recorded entries are fetched, and a
+ *   deletion is applied locally as an empty reply without a round trip
+ * - wm_handle_reply dispatches COOKIE_GET_PROPERTY replies to the parser
+ *
+ * Lookup:
+ * - prop_schema_index_build (called from atoms_init) builds an open-addressing
+ *   atom -> entry index once the atom values are known
+ * - prop_schema_lookup is a probe of that index only; a miss returns NULL, and a
+ *   hit whose atom value changed since the build is treated as a miss
+ * - code that assigns atom values itself (tests) must rebuild the index
+ *
+ * Contracts:
+ * - Not thread-safe
+ * - Table order is significant: refetches are issued in table order and the
+ *   first entry wins when atom values collide
+ */
+
+#ifndef PROP_SCHEMA_H
+#define PROP_SCHEMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <xcb/xcb.h>
+
+#include "client.h"
+#include "handle.h"
+
+typedef struct server server_t;
+
+/* Parser context (resolved once per reply by wm_handle_reply) */
+typedef struct prop_ctx {
+    server_t* s;
+    handle_t h;
+    client_hot_t* hot;
+    client_cold_t* cold;
+    xcb_atom_t atom;
+} prop_ctx_t;
+
+/* Applies a property reply to client state
+ * r is never NULL; an absent property arrives as an empty reply
+ * Returns true if the frame decorations need a restyle (DIRTY_FRAME_STYLE)
+ */
+typedef bool (*prop_parse_fn)(const prop_ctx_t* ctx, xcb_get_property_reply_t* r);
+
+enum prop_schema_flags {
+    PROP_F_MANAGE = 1u << 0,        /* fetched by client_manage_start */
+    PROP_F_CRITICAL = 1u << 1,      /* manage waits for the reply (counts in pending_replies) */
+    PROP_F_NOTIFY_FETCH = 1u << 2,  /* PropertyNotify refetches immediately, not at flush */
+    PROP_F_NOTIFY_IGNORE = 1u << 3, /* PropertyNotify is dropped (WM-owned or echoed back) */
+};
+
+typedef struct prop_schema {
+    const xcb_atom_t* atom; /* into the global atoms table */
+    const xcb_atom_t* type; /* requested type (XCB_ATOM_ANY allowed) */
+    uint8_t format;         /* expected format (diagnostics only; parsers validate) */
+    uint32_t max_len;       /* long_length in 32-bit units */
+    prop_parse_fn parse;    /* NULL for notify-only entries */
+    uint32_t dirty;         /* dirty bits raised on notify and refetched on flush */
+    uint32_t flags;         /* PROP_F_* */
+} prop_schema_t;
+
+/* Per-client bitmasks (prop_refetch etc.) are 64 bits wide */
+#define PROP_SCHEMA_MAX 64u
+_Static_assert(sizeof(((client_cold_t*)0)->prop_fetches) / sizeof(uint16_t) == PROP_SCHEMA_MAX,
+               "client_cold_t.prop_fetches must have one counter per schema entry");
+
+extern const prop_schema_t prop_schema_table[];
+extern const size_t prop_schema_count;
+
+static inline uint64_t prop_schema_bit(const prop_schema_t* ps) {
+    return 1ull << (size_t)(ps - prop_schema_table);
+}
+
+void prop_schema_index_build(void);
+const prop_schema_t* prop_schema_lookup(xcb_atom_t atom);
+
+/* Union of all entries' dirty bits (the bits wm_flush_dirty refetches via the table) */
+uint32_t prop_schema_dirty_mask(void);
+
+/* Issue a GetProperty for one entry; returns the request sequence */
+uint32_t prop_schema_request(server_t* s, xcb_window_t win, const prop_schema_t* ps);
+
+/* Issue a GetProperty for one entry and register the reply with wm_handle_reply */
+void prop_schema_fetch(server_t* s, handle_t h, client_hot_t* hot, const prop_schema_t* ps);
+
+/* Refetch every entry whose dirty bits intersect `dirty`, in table order */
+void prop_schema_refetch(server_t* s, handle_t h, client_hot_t* hot, uint32_t dirty);
+
+/* Track an issued GetProperty and its reply (or error) for one entry
+ * prop_inflight stays set until the reply to the last outstanding fetch arrives,
+ * so a delete noticed between overlapping fetches is never applied ahead of them
+ */
+void prop_schema_note_request(client_hot_t* hot, client_cold_t* cold, const prop_schema_t* ps);
+void prop_schema_note_reply(client_hot_t* hot, client_cold_t* cold, const prop_schema_t* ps);
+
+/* Record a PropertyNotify; the latest state per entry wins until the next commit */
+void prop_schema_note_change(client_hot_t* hot, const prop_schema_t* ps, bool deleted);
+
+/* Apply an entry as if the server returned an empty (deleted) property */
+void prop_schema_apply_deleted(server_t* s, handle_t h, const prop_schema_t* ps);
+
+/* Commit recorded changes for the raised `dirty` groups
+ * - deleted entries are applied locally (unless a fetch is still in flight)
+ * - changed entries are fetched individually
+ * - a group raised without any recorded entry is refetched as a whole
+ * - recorded entries outside `dirty` are kept for a later commit
+ */
+void prop_schema_commit(server_t* s, handle_t h, client_hot_t* hot, uint32_t dirty);
+
+static inline uintptr_t prop_schema_cookie_data(xcb_window_t win, xcb_atom_t atom) {
+    return (uintptr_t)(((uint64_t)win << 32) | atom);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROP_SCHEMA_H */
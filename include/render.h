@@ -49,6 +49,13 @@ typedef struct render_context {
 
     int width;
     int height;
+
+    /* Title text as last painted (bytes left visible after ellipsization) */
+    char* title_visible;
+    size_t title_visible_len;
+    int title_x;
+    int title_width;
+    bool title_valid;
 } render_context_t;
 
 /* Simple color struct for interfaces and theme conversions */
@@ -85,6 +92,13 @@ void render_frame(xcb_connection_t* conn, xcb_window_t win, xcb_visualtype_t* vi
                   bool is_test, const char* title, bool active, int width, int height, theme_t* theme,
                   cairo_surface_t* icon, const dirty_region_t* dirty);
 
+/* Returns true if painting `title` now would show exactly the text already on screen
+ * (same visible prefix after ellipsization, same text box); the caller may skip a
+ * title-only redraw
+ */
+bool render_title_unchanged(render_context_t* ctx, const char* title, int width, const theme_t* theme,
+                            cairo_surface_t* icon);
+
 /* Convenience: convert theme color (or other integer formats) to rgba_t
  * If you already store doubles, you can ignore this helper
  */
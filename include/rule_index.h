@@ -0,0 +1,100 @@
+/*
+ * rule_index.h - Compiled application rule index
+ *
+ * Turns config.rules into a candidate filter so matching a window costs the
+ * same with ten rules or a thousand:
+ * - rules that match on class are chained under a hash of the class string
+ * - rules with an instance (but no class) match are chained under the instance
+ * - every title_match pattern goes into one Aho-Corasick automaton, so a single
+ *   pass over the title finds all title rules whose substring occurs in it
+ * - rules with none of the three (type/transient only) are always candidates
+ *
+ * A query returns candidate rule indices in config order, deduplicated. The
+ * index only narrows the set: hash collisions and rules that need more than
+ * their anchor field still go through the full predicate in client.c.
+ *
+ * Lifetime:
+ * - owned by config_t; built at the end of config_load and rebuilt lazily by
+ *   rule_index_sync when config.rules_version moved since the last build
+ * - generation is unique per build (across all indices), so per-client state
+ *   that refers to rule indices (client_cold_t.title_rules) can be recognized
+ *   as stale; a reload that leaves the rules unchanged keeps the old index
+ *
+ * Contracts:
+ * - Not thread-safe
+ * - Query results live in the index scratch buffer until the next query; callers
+ *   may compact them in place
+ */
+
+#ifndef RULE_INDEX_H
+#define RULE_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ds.h"
+
+/* Trie node of the title automaton; index 0 is the root */
+typedef struct rule_ac_node {
+    uint32_t child;   /* first child node, 0 = none */
+    uint32_t sibling; /* next child of the same parent, 0 = none */
+    uint32_t fail;    /* longest proper suffix that is also a trie path */
+    uint32_t dict;    /* nearest node on the fail chain that ends a pattern, 0 = none */
+    uint32_t rules;   /* first rule (+1) whose pattern ends here, 0 = none */
+    uint8_t byte;
+} rule_ac_node_t;
+
+typedef struct rule_index {
+    bool built;
+    uint32_t rule_count;    /* config.rules.length at build time */
+    uint32_t rules_version; /* config.rules_version at build time */
+    uint32_t generation;
+
+    hash_map_t by_class;    /* string hash -> first rule (+1) */
+    hash_map_t by_instance; /* string hash -> first rule (+1) */
+    uint32_t* anchor_next;  /* [rule_count] next rule (+1) under the same class/instance hash */
+
+    uint32_t* always; /* rules without a class, instance or title match */
+    uint32_t always_len;
+
+    rule_ac_node_t* ac;
+    uint32_t ac_len;
+    uint32_t ac_cap;
+    uint32_t ac_root[256]; /* direct root transitions (node index, 0 = stay at root) */
+    uint32_t* title_next;  /* [rule_count] next rule (+1) with the same title pattern */
+
+    /* Query scratch */
+    uint32_t* seen; /* [rule_count] stamp per rule */
+    uint32_t stamp;
+    uint32_t* hits; /* [rule_count] candidates of the last query, ascending */
+    uint32_t hits_len;
+} rule_index_t;
+
+void rule_index_init(rule_index_t* idx);
+void rule_index_destroy(rule_index_t* idx);
+
+/* Compile rules (small_vec_t of app_rule_t*) at `version` into the index, replacing any previous build */
+void rule_index_build(rule_index_t* idx, const small_vec_t* rules, uint32_t version);
+
+/* Rebuild if the index is missing or was built for a different rules version */
+void rule_index_sync(rule_index_t* idx, const small_vec_t* rules, uint32_t version);
+
+/* Candidates for a window at manage time (any field may be NULL)
+ * Returns the number of hits; *out points at the indices, ascending
+ */
+uint32_t rule_index_query(rule_index_t* idx, const char* wm_class, const char* wm_instance, const char* title,
+                          uint32_t** out);
+
+/* Candidates among rules with a title_match only (title changes after manage) */
+uint32_t rule_index_query_title(rule_index_t* idx, const char* title, uint32_t** out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RULE_INDEX_H */
@@ -50,9 +50,20 @@ void wm_release(server_t* s);
 /* EWMH/desktop properties */
 void wm_publish_desktop_props(server_t* s);
 
-/* Compute current workarea in root coordinates */
+/* Compute current workarea in root coordinates (rebuilds only monitors marked dirty) */
 void wm_compute_workarea(server_t* s, rect_t* out);
 
+/* Strut registry (src/wm_desktop.c)
+ * - wm_strut_changed: call after cold->strut changed (prev = old effective strut and whether it
+ *   was a partial one); keeps the
+ *   registry current and marks the monitors either strut touches for recomputation
+ * - wm_strut_remove: drop a client at unmanage
+ * - wm_workarea_invalidate: monitor layout or screen size changed, rebuild every monitor
+ */
+void wm_strut_changed(server_t* s, handle_t h, const strut_t* prev, bool prev_partial);
+void wm_strut_remove(server_t* s, handle_t h);
+void wm_workarea_invalidate(server_t* s);
+
 /* Client state set for _NET_WM_STATE style updates */
 typedef struct client_state_set {
     bool fullscreen;
@@ -74,6 +85,12 @@ void wm_client_apply_state_set(server_t* s, handle_t h, const client_state_set_t
 /* Key grab setup from config */
 void wm_setup_keys(server_t* s);
 
+/* Refetch the keyboard mapping asynchronously (MappingNotify, XkbMapNotify) */
+void wm_refresh_keymap(server_t* s);
+
+/* Apply the key actions coalesced during this tick's key presses */
+void wm_key_actions_flush(server_t* s);
+
 /* Focus helpers */
 void wm_cycle_focus(server_t* s, bool forward);
 
@@ -106,6 +123,24 @@ void wm_switch_workspace(server_t* s, uint32_t new_desktop);
 void wm_switch_workspace_relative(server_t* s, int delta);
 
 void wm_client_move_to_workspace(server_t* s, handle_t h, uint32_t desktop, bool follow);
+
+/* Desktop membership index
+ * - wm_desktop_index_update files a managed client under its current desktop/sticky state
+ *   (call after changing hot->desktop or hot->sticky); _remove drops it at unmanage
+ * - wm_client_visibility_changed queues a client for the next visibility pass
+ */
+void wm_desktop_index_update(server_t* s, handle_t h);
+void wm_desktop_index_remove(server_t* s, handle_t h);
+const small_vec_t* wm_desktop_index_members(const server_t* s, uint32_t desktop);
+
+/* Placement grid (wm_desktop.c)
+ * - wm_place_index_update refiles a managed client after hot->server changed
+ * - the grid is sized to the screen and rebuilt when the screen size changes
+ */
+void wm_place_index_update(server_t* s, handle_t h);
+void wm_place_index_remove(server_t* s, handle_t h);
+void wm_place_index_destroy(server_t* s);
+void wm_client_visibility_changed(server_t* s, handle_t h);
 void wm_client_toggle_sticky(server_t* s, handle_t h);
 void wm_client_toggle_maximize(server_t* s, handle_t h);
 void wm_client_iconify(server_t* s, handle_t h);
@@ -121,11 +156,14 @@ void stack_place_above(server_t* s, handle_t h, handle_t sibling_h);
 void stack_place_below(server_t* s, handle_t h, handle_t sibling_h);
 void stack_remove(server_t* s, handle_t h);
 
+/* True if a is above b in the same layer (O(1) label compare) */
+bool stack_is_above(const client_hot_t* a, const client_hot_t* b);
+
 /* Move client to its configured layer (based on state/rules) */
 void stack_move_to_layer(server_t* s, handle_t h);
 
-/* Sync stacking changes to X11 for a client */
-void stack_sync_to_xcb(server_t* s, handle_t h);
+/* Commit the stacking order to X11 with the fewest restacks (flush phase only) */
+void stack_commit(server_t* s);
 
 /* Dirty flush:
  * Returns true if more work remains or if flush did work (implementation-specific)
@@ -135,6 +173,17 @@ bool wm_flush_dirty(server_t* s, uint64_t now);
 /* Async reply dispatch from cookie_jar */
 void wm_handle_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_generic_error_t* err);
 
+/* Write-through cache for WM-owned properties (client state, root desktop/focus)
+ * - wm_prop_publish/wm_prop_delete skip the request if the window already holds
+ *   the same type/format/data; return true if a request was sent
+ * - wm_prop_forget drops a window's entries (call when it stops being managed)
+ */
+bool wm_prop_publish(server_t* s, xcb_window_t win, xcb_atom_t atom, xcb_atom_t type, uint8_t format, uint32_t len,
+                     const void* data);
+bool wm_prop_delete(server_t* s, xcb_window_t win, xcb_atom_t atom);
+void wm_prop_forget(server_t* s, xcb_window_t win);
+void wm_prop_cache_destroy(server_t* s);
+
 /* State/metadata updates */
 void wm_client_update_state(server_t* s, handle_t h, uint32_t action, xcb_atom_t prop);
 void wm_send_synthetic_configure(server_t* s, handle_t h);
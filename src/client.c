@@ -22,6 +22,7 @@
 #include "event.h"
 #include "frame.h"
 #include "hxm.h"
+#include "prop_schema.h"
 #include "slotmap.h"
 #include "wm.h"
 #include "xcb_utils.h"
@@ -160,8 +161,12 @@ void client_manage_start(server_t* s, xcb_window_t win) {
     hot->saved_maximize_valid = false;
     hot->saved_maximized_horz = false;
     hot->saved_maximized_vert = false;
-    hot->stacking_index = -1;
+    hot->stack_below = NULL;
+    hot->stack_above = NULL;
+    hot->stack_label = 0;
     hot->stacking_layer = -1;
+    hot->place_indexed = false;
+    hot->place_stamp = 0;
 
     hot->last_cursor_dir = -1;
 
@@ -196,12 +201,8 @@ void client_manage_start(server_t* s, xcb_window_t win) {
     hot->gtk_extents.bottom = 0;
     hot->original_border_width = 0;
 
-    // Phase 1 cookie budget
-    // Attrs, Geom, Class, ClientMachine, ColormapWindows, Command, Hints, NormalHints, Transient, Type, Protocols,
-    // NetName, Name, NetIconName, IconName, NetState, Desktop,
-    // Strut, StrutPartial, Icon, PID, UserTime, UserTimeWindow,
-    // SyncCounter, IconGeometry, MotifHints, GtkFrameExtents, WindowOpacity
-    hot->pending_replies = 28;
+    // Phase 1 cookie budget: Attrs, Geom, plus every critical schema property (counted as issued)
+    hot->pending_replies = 2;
     hot->late_probe_ticks = 0;
     hot->late_probe_attempts = 0;
     hot->late_probe_deadline_ns = 0;
@@ -209,7 +210,10 @@ void client_manage_start(server_t* s, xcb_window_t win) {
     cold->can_focus = true;
     cold->strut_partial_active = false;
     cold->strut_full_active = false;
+    cold->strut_registered = false;
     arena_init(&cold->string_arena, 512);
+    cold->string_live = 0;
+    cold->string_dead = 0;
 
     list_init(&hot->transient_sibling);
     list_init(&hot->transients_head);
@@ -225,198 +229,204 @@ void client_manage_start(server_t* s, xcb_window_t win) {
     uint32_t early_events = XCB_EVENT_MASK_PROPERTY_CHANGE;
     xcb_change_window_attributes(s->conn, win, XCB_CW_EVENT_MASK, &early_events);
 
+    // The whole burst is issued back-to-back, so it occupies a contiguous run of
+    // sequence numbers and is tracked as a single grouped cookie-jar slot.
+    cookie_txn_t* txn = cookie_jar_txn_begin(&s->cookie_jar, h, s->txn_id, wm_handle_reply);
+
     // 1. GetWindowAttributes (override_redirect, visual)
     uint32_t c1 = xcb_get_window_attributes(s->conn, win).sequence;
-    cookie_jar_push(&s->cookie_jar, c1, COOKIE_GET_WINDOW_ATTRIBUTES, h, win, s->txn_id, wm_handle_reply);
+    cookie_jar_txn_add(&s->cookie_jar, txn, c1, COOKIE_GET_WINDOW_ATTRIBUTES, win);
 
     // 2. GetGeometry
     uint32_t c2 = xcb_get_geometry(s->conn, win).sequence;
-    cookie_jar_push(&s->cookie_jar, c2, COOKIE_GET_GEOMETRY, h, win, s->txn_id, wm_handle_reply);
-
-    // 3. WM_CLASS
-    uint32_t c3 = xcb_get_property(s->conn, 0, win, atoms.WM_CLASS, XCB_ATOM_STRING, 0, 1024).sequence;
-    cookie_jar_push(&s->cookie_jar, c3, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_CLASS, s->txn_id,
-                    wm_handle_reply);
-
-    // 4. WM_CLIENT_MACHINE
-    uint32_t c4 = xcb_get_property(s->conn, 0, win, atoms.WM_CLIENT_MACHINE, XCB_ATOM_STRING, 0, 1024).sequence;
-    cookie_jar_push(&s->cookie_jar, c4, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_CLIENT_MACHINE,
-                    s->txn_id, wm_handle_reply);
-
-    // 5. WM_COMMAND
-    uint32_t c5 = xcb_get_property(s->conn, 0, win, atoms.WM_COMMAND, XCB_ATOM_STRING, 0, 1024).sequence;
-    cookie_jar_push(&s->cookie_jar, c5, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_COMMAND, s->txn_id,
-                    wm_handle_reply);
-
-    // 6. WM_HINTS
-    uint32_t c6 = xcb_get_property(s->conn, 0, win, atoms.WM_HINTS, atoms.WM_HINTS, 0, 32).sequence;
-    cookie_jar_push(&s->cookie_jar, c6, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_HINTS, s->txn_id,
-                    wm_handle_reply);
-
-    // 7. WM_NORMAL_HINTS
-    uint32_t c7 = xcb_get_property(s->conn, 0, win, atoms.WM_NORMAL_HINTS, XCB_ATOM_WM_SIZE_HINTS, 0, 32).sequence;
-    cookie_jar_push(&s->cookie_jar, c7, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_NORMAL_HINTS,
-                    s->txn_id, wm_handle_reply);
-
-    // 8. WM_TRANSIENT_FOR
-    uint32_t c8 = xcb_get_property(s->conn, 0, win, atoms.WM_TRANSIENT_FOR, XCB_ATOM_WINDOW, 0, 1).sequence;
-    cookie_jar_push(&s->cookie_jar, c8, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_TRANSIENT_FOR,
-                    s->txn_id, wm_handle_reply);
-
-    // 9. WM_COLORMAP_WINDOWS
-    uint32_t c9 = xcb_get_property(s->conn, 0, win, atoms.WM_COLORMAP_WINDOWS, XCB_ATOM_WINDOW, 0, 64).sequence;
-    cookie_jar_push(&s->cookie_jar, c9, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_COLORMAP_WINDOWS,
-                    s->txn_id, wm_handle_reply);
-
-    // 10. _NET_WM_WINDOW_TYPE
-    uint32_t c10 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_WINDOW_TYPE, XCB_ATOM_ATOM, 0, 32).sequence;
-    cookie_jar_push(&s->cookie_jar, c10, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_WINDOW_TYPE,
-                    s->txn_id, wm_handle_reply);
-
-    // 11. WM_PROTOCOLS
-    uint32_t c11 = xcb_get_property(s->conn, 0, win, atoms.WM_PROTOCOLS, XCB_ATOM_ATOM, 0, 32).sequence;
-    cookie_jar_push(&s->cookie_jar, c11, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_PROTOCOLS, s->txn_id,
-                    wm_handle_reply);
-
-    // 12. _NET_WM_NAME (UTF8)
-    uint32_t c12 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_NAME, atoms.UTF8_STRING, 0, 1024).sequence;
-    cookie_jar_push(&s->cookie_jar, c12, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_NAME, s->txn_id,
-                    wm_handle_reply);
-
-    // 13. WM_NAME
-    uint32_t c13 = xcb_get_property(s->conn, 0, win, atoms.WM_NAME, XCB_ATOM_STRING, 0, 1024).sequence;
-    cookie_jar_push(&s->cookie_jar, c13, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_NAME, s->txn_id,
-                    wm_handle_reply);
-
-    // 14. _NET_WM_ICON_NAME (UTF8)
-    uint32_t c14 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_ICON_NAME, atoms.UTF8_STRING, 0, 1024).sequence;
-    cookie_jar_push(&s->cookie_jar, c14, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_ICON_NAME,
-                    s->txn_id, wm_handle_reply);
-
-    // 15. WM_ICON_NAME
-    uint32_t c15 = xcb_get_property(s->conn, 0, win, atoms.WM_ICON_NAME, XCB_ATOM_STRING, 0, 1024).sequence;
-    cookie_jar_push(&s->cookie_jar, c15, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms.WM_ICON_NAME, s->txn_id,
-                    wm_handle_reply);
-
-    // 16. _NET_WM_STATE
-    uint32_t c16 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_STATE, XCB_ATOM_ATOM, 0, 32).sequence;
-    cookie_jar_push(&s->cookie_jar, c16, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_STATE, s->txn_id,
-                    wm_handle_reply);
-
-    // 17. _NET_WM_DESKTOP
-    uint32_t c17 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_DESKTOP, XCB_ATOM_CARDINAL, 0, 1).sequence;
-    cookie_jar_push(&s->cookie_jar, c17, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_DESKTOP,
-                    s->txn_id, wm_handle_reply);
-
-    // 18. _NET_WM_STRUT
-    uint32_t c18 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_STRUT, XCB_ATOM_CARDINAL, 0, 4).sequence;
-    cookie_jar_push(&s->cookie_jar, c18, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_STRUT, s->txn_id,
-                    wm_handle_reply);
-
-    // 19. _NET_WM_STRUT_PARTIAL
-    uint32_t c19 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_STRUT_PARTIAL, XCB_ATOM_CARDINAL, 0, 12).sequence;
-    cookie_jar_push(&s->cookie_jar, c19, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_STRUT_PARTIAL,
-                    s->txn_id, wm_handle_reply);
-
-    // 20. _NET_WM_ICON
-    uint32_t c20 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_ICON, XCB_ATOM_CARDINAL, 0, 1048576).sequence;
-    cookie_jar_push(&s->cookie_jar, c20, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_ICON, s->txn_id,
-                    wm_handle_reply);
-
-    // 21. _NET_WM_PID
-    uint32_t c21 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_PID, XCB_ATOM_CARDINAL, 0, 1).sequence;
-    cookie_jar_push(&s->cookie_jar, c21, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_PID, s->txn_id,
-                    wm_handle_reply);
-
-    // 22. _NET_WM_USER_TIME
-    uint32_t c22 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_USER_TIME, XCB_ATOM_CARDINAL, 0, 1).sequence;
-    cookie_jar_push(&s->cookie_jar, c22, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_USER_TIME,
-                    s->txn_id, wm_handle_reply);
-
-    // 23. _NET_WM_USER_TIME_WINDOW
-    uint32_t c23 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_USER_TIME_WINDOW, XCB_ATOM_WINDOW, 0, 1).sequence;
-    cookie_jar_push(&s->cookie_jar, c23, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_USER_TIME_WINDOW,
-                    s->txn_id, wm_handle_reply);
-
-    // 24. _NET_WM_SYNC_REQUEST_COUNTER
-    uint32_t c24 =
-        xcb_get_property(s->conn, 0, win, atoms._NET_WM_SYNC_REQUEST_COUNTER, XCB_ATOM_CARDINAL, 0, 1).sequence;
-    cookie_jar_push(&s->cookie_jar, c24, COOKIE_GET_PROPERTY, h,
-                    ((uint64_t)win << 32) | atoms._NET_WM_SYNC_REQUEST_COUNTER, s->txn_id, wm_handle_reply);
-
-    // 25. _NET_WM_ICON_GEOMETRY
-    uint32_t c25 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_ICON_GEOMETRY, XCB_ATOM_CARDINAL, 0, 4).sequence;
-    cookie_jar_push(&s->cookie_jar, c25, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_ICON_GEOMETRY,
-                    s->txn_id, wm_handle_reply);
-
-    // 26. _MOTIF_WM_HINTS
-    uint32_t c26 = xcb_get_property(s->conn, 0, win, atoms._MOTIF_WM_HINTS, XCB_ATOM_ANY, 0, 5).sequence;
-    cookie_jar_push(&s->cookie_jar, c26, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._MOTIF_WM_HINTS,
-                    s->txn_id, wm_handle_reply);
-
-    // 27. _GTK_FRAME_EXTENTS
-    uint32_t c27 = xcb_get_property(s->conn, 0, win, atoms._GTK_FRAME_EXTENTS, XCB_ATOM_CARDINAL, 0, 4).sequence;
-    cookie_jar_push(&s->cookie_jar, c27, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._GTK_FRAME_EXTENTS,
-                    s->txn_id, wm_handle_reply);
-
-    // 28. _NET_WM_WINDOW_OPACITY
-    uint32_t c28 = xcb_get_property(s->conn, 0, win, atoms._NET_WM_WINDOW_OPACITY, XCB_ATOM_CARDINAL, 0, 1).sequence;
-    cookie_jar_push(&s->cookie_jar, c28, COOKIE_GET_PROPERTY, h, ((uint64_t)win << 32) | atoms._NET_WM_WINDOW_OPACITY,
-                    s->txn_id, wm_handle_reply);
+    cookie_jar_txn_add(&s->cookie_jar, txn, c2, COOKIE_GET_GEOMETRY, win);
+
+    // 3. Properties from the schema table: critical ones first so the manage gate
+    // opens as early as possible, then the rest (icons, PID, ...) trail behind
+    for (int pass = 0; pass < 2; pass++) {
+        uint32_t want = pass == 0 ? PROP_F_CRITICAL : 0;
+        for (size_t i = 0; i < prop_schema_count; i++) {
+            const prop_schema_t* ps = &prop_schema_table[i];
+            if (!(ps->flags & PROP_F_MANAGE) || (ps->flags & PROP_F_CRITICAL) != want) continue;
+            if (*ps->atom == XCB_ATOM_NONE) continue;
+
+            uint32_t c = prop_schema_request(s, win, ps);
+            cookie_jar_txn_add(&s->cookie_jar, txn, c, COOKIE_GET_PROPERTY, prop_schema_cookie_data(win, *ps->atom));
+            prop_schema_note_request(hot, cold, ps);
+            if (want) hot->pending_replies++;
+        }
+    }
+
+    cookie_jar_txn_commit(&s->cookie_jar, txn);
 
     LOG_DEBUG("Started management for window %u (handle %lx)", win, h);
     TRACE_ONLY(debug_dump_focus_history(s, "after manage_start"));
 }
 
+static bool rule_matches(const app_rule_t* r, const client_hot_t* hot, const client_cold_t* cold) {
+    if (r->class_match && (!cold->wm_class || strcmp(cold->wm_class, r->class_match) != 0)) return false;
+    if (r->instance_match && (!cold->wm_instance || strcmp(cold->wm_instance, r->instance_match) != 0)) return false;
+    if (r->title_match && (!cold->title || !strstr(cold->title, r->title_match))) return false;
+    if (r->type_match != -1 && hot->type != (uint8_t)r->type_match) return false;
+    if (r->transient_match != -1) {
+        bool is_transient = (hot->transient_for != HANDLE_INVALID);
+        if (is_transient != (bool)r->transient_match) return false;
+    }
+    return true;
+}
+
+/* Remember which title rules matched, so a title change only acts on rules that start matching */
+static void client_store_title_rules(server_t* s, client_cold_t* cold, const uint32_t* matched, uint32_t count) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const app_rule_t* r = s->config.rules.items[matched[i]];
+        if (r->title_match) n++;
+    }
+
+    if (n > cold->title_rules_cap) {
+        uint32_t* grown = realloc(cold->title_rules, (size_t)n * sizeof(*grown));
+        if (!grown) {
+            LOG_ERROR("Failed to allocate title rule set");
+            exit(1);
+        }
+        cold->title_rules = grown;
+        cold->title_rules_cap = n;
+    }
+
+    cold->title_rules_len = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const app_rule_t* r = s->config.rules.items[matched[i]];
+        if (r->title_match) cold->title_rules[cold->title_rules_len++] = matched[i];
+    }
+    cold->title_rules_gen = s->config.rule_index.generation;
+}
+
+static bool client_had_title_rule(const client_cold_t* cold, uint32_t generation, uint32_t rule) {
+    if (cold->title_rules_gen != generation) return false;
+    for (uint32_t i = 0; i < cold->title_rules_len; i++) {
+        if (cold->title_rules[i] == rule) return true;
+    }
+    return false;
+}
+
+/*
+ * client_apply_rules:
+ * Apply every matching application rule, in config order, before placement.
+ *
+ * Logic:
+ * - the compiled index (rule_index.h) narrows the rules to candidates keyed
+ *   on class, instance and title substrings
+ * - each candidate is verified with the full predicate; later rules override
+ *   earlier ones field by field, as with a plain scan
+ */
 static void client_apply_rules(server_t* s, handle_t h) {
     client_hot_t* hot = server_chot(s, h);
     client_cold_t* cold = server_ccold(s, h);
     if (!hot || !cold) return;
 
-    for (size_t i = 0; i < s->config.rules.length; i++) {
-        app_rule_t* r = s->config.rules.items[i];
-        bool matched = true;
-
-        if (r->class_match && (!cold->wm_class || strcmp(cold->wm_class, r->class_match) != 0)) matched = false;
-        if (matched && r->instance_match && (!cold->wm_instance || strcmp(cold->wm_instance, r->instance_match) != 0))
-            matched = false;
-        if (matched && r->title_match && (!cold->title || !strstr(cold->title, r->title_match))) matched = false;
-        if (matched && r->type_match != -1 && hot->type != (uint8_t)r->type_match) matched = false;
-        if (matched && r->transient_match != -1) {
-            bool is_transient = (hot->transient_for != HANDLE_INVALID);
-            if (is_transient != (bool)r->transient_match) matched = false;
-        }
+    rule_index_t* idx = &s->config.rule_index;
+    rule_index_sync(idx, &s->config.rules, s->config.rules_version);
 
-        if (matched) {
-            LOG_INFO("Rule matched for window %u", hot->xid);
+    uint32_t* candidates = NULL;
+    uint32_t count = rule_index_query(idx, cold->wm_class, cold->wm_instance, cold->title, &candidates);
 
-            if (r->desktop != -2) {
-                if (r->desktop == -1) {
-                    hot->desktop = -1;
-                    hot->sticky = true;
-                } else {
-                    hot->desktop = r->desktop;
-                    hot->sticky = false;
-                }
-            }
+    // Compact matches in place; the scratch buffer is ours until the next query
+    uint32_t* matched = candidates;
+    uint32_t matched_len = 0;
 
-            if (r->layer != -1) {
-                hot->base_layer = (uint8_t)r->layer;
-                if (hot->layer != LAYER_FULLSCREEN) {
-                    hot->layer = client_layer_from_state(hot);
-                }
+    for (uint32_t i = 0; i < count; i++) {
+        app_rule_t* r = s->config.rules.items[candidates[i]];
+        if (!r || !rule_matches(r, hot, cold)) continue;
+        matched[matched_len++] = candidates[i];
+
+        LOG_INFO("Rule matched for window %u", hot->xid);
+
+        if (r->desktop != -2) {
+            if (r->desktop == -1) {
+                hot->desktop = -1;
+                hot->sticky = true;
+            } else {
+                hot->desktop = r->desktop;
+                hot->sticky = false;
             }
+        }
 
-            if (r->focus != -1) hot->focus_override = r->focus;
-            if (r->placement != PLACEMENT_DEFAULT) hot->placement = (uint8_t)r->placement;
+        if (r->layer != -1) {
+            hot->base_layer = (uint8_t)r->layer;
+            if (hot->layer != LAYER_FULLSCREEN) {
+                hot->layer = client_layer_from_state(hot);
+            }
         }
+
+        if (r->focus != -1) hot->focus_override = r->focus;
+        if (r->bypass_compositor != -1) hot->bypass_rule = (uint8_t)r->bypass_compositor;
+        if (r->placement != PLACEMENT_DEFAULT) hot->placement = (uint8_t)r->placement;
     }
 
+    client_store_title_rules(s, cold, matched, matched_len);
+
     if (!hot->sticky && hot->desktop >= (int32_t)s->desktop_count) {
         hot->desktop = (int32_t)s->current_desktop;
     }
 }
 
+/*
+ * client_apply_title_rules:
+ * Re-evaluate title rules after the title of a managed client changed.
+ *
+ * Logic:
+ * - one automaton pass over the new title yields the title rules to verify
+ * - only rules that were not matching before are applied, so a client the
+ *   user moved is not yanked back on every title update
+ * - placement is a manage-time decision and is not re-applied
+ */
+void client_apply_title_rules(server_t* s, handle_t h) {
+    client_hot_t* hot = server_chot(s, h);
+    client_cold_t* cold = server_ccold(s, h);
+    if (!hot || !cold) return;
+    if (hot->state != STATE_MAPPED && hot->state != STATE_UNMAPPED) return;
+
+    rule_index_t* idx = &s->config.rule_index;
+    rule_index_sync(idx, &s->config.rules, s->config.rules_version);
+    if (cold->title_rules_len == 0 && !cold->title) return;
+
+    uint32_t* candidates = NULL;
+    uint32_t count = rule_index_query_title(idx, cold->title, &candidates);
+
+    uint32_t* matched = candidates;
+    uint32_t matched_len = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        app_rule_t* r = s->config.rules.items[candidates[i]];
+        if (!r || !rule_matches(r, hot, cold)) continue;
+        matched[matched_len++] = candidates[i];
+        if (client_had_title_rule(cold, idx->generation, candidates[i])) continue;
+
+        LOG_INFO("Title rule matched for window %u", hot->xid);
+
+        if (r->desktop != -2) {
+            wm_client_move_to_workspace(s, h, r->desktop == -1 ? 0xFFFFFFFF : (uint32_t)r->desktop, false);
+        }
+
+        if (r->layer != -1 && hot->base_layer != (uint8_t)r->layer) {
+            hot->base_layer = (uint8_t)r->layer;
+            if (hot->layer != LAYER_FULLSCREEN) {
+                hot->layer = client_layer_from_state(hot);
+            }
+            hot->dirty |= DIRTY_STATE | DIRTY_STACK;
+        }
+
+        if (r->focus != -1) hot->focus_override = r->focus;
+
+        if (r->bypass_compositor != -1 && hot->bypass_rule != (uint8_t)r->bypass_compositor) {
+            hot->bypass_rule = (uint8_t)r->bypass_compositor;
+            frame_sync_bypass(s, hot);
+        }
+    }
+
+    client_store_title_rules(s, cold, matched, matched_len);
+}
+
 /*
  * client_finish_manage:
  * Called when all critical initial properties have been received (or timed out).
@@ -456,26 +466,31 @@ void client_finish_manage(server_t* s, handle_t h) {
     // ---------------------------------------------------------
     rect_t geom = hot->desired;
 
-    uint32_t mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
-    uint32_t values[3];
-
-    // Set background to inactive color initially
-    values[0] = 0x333333;
-
-    values[1] = XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY | XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_POINTER_MOTION |
-                XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW;
+    // Frameless fast path: windows that draw no decorations of ours (or their own) stay
+    // children of the root and the client window stands in for the frame. The choice is
+    // fixed for the client's lifetime, so it stays undecorated whatever its hints say later
+    if (s->config.frameless_undecorated &&
+        ((hot->flags & CLIENT_FLAG_UNDECORATED) || hot->gtk_frame_extents_set)) {
+        hot->flags |= CLIENT_FLAG_FRAMELESS | CLIENT_FLAG_UNDECORATED;
+    }
+    bool frameless = client_is_frameless(hot);
+    // The attributes reply leaves 2 pending unmaps (from the reparent) for a window that was mapped
+    bool was_mapped = (hot->ignore_unmap >= 2);
 
     uint16_t bw = (hot->flags & CLIENT_FLAG_UNDECORATED) ? 0 : s->config.theme.border_width;
     uint16_t th = (hot->flags & CLIENT_FLAG_UNDECORATED) ? 0 : s->config.theme.title_height;
 
-    // Use root visual/depth for frames to avoid visual-specific artifacts in clients (e.g., video players).
-
-    hot->frame = xcb_generate_id(s->conn);
-    xcb_create_window(s->conn, s->root_depth, hot->frame, s->root, geom.x, geom.y, geom.w + 2 * bw, geom.h + th + bw, 0,
-                      XCB_WINDOW_CLASS_INPUT_OUTPUT, s->root_visual, mask, values);
+    if (frameless) {
+        hot->frame = hot->xid;
+        // No reparent, so none of the unmaps expected from it will come
+        hot->ignore_unmap = 0;
+    } else {
+        // New or recycled (frame pool); the configure below sets the final geometry either way
+        hot->frame = frame_acquire(s, &hot->render_ctx, geom.x, geom.y, geom.w + 2 * bw, geom.h + th + bw);
 
-    // Register frame mapping
-    hash_map_insert(&s->frame_to_client, hot->frame, handle_to_ptr(h));
+        // Register frame mapping
+        hash_map_insert(&s->frame_to_client, hot->frame, handle_to_ptr(h));
+    }
 
     // 2. Add to SaveSet (crash safety)
     xcb_change_save_set(s->conn, XCB_SET_MODE_INSERT, hot->xid);
@@ -491,7 +506,7 @@ void client_finish_manage(server_t* s, handle_t h) {
         ry = 0;
     }
 
-    xcb_reparent_window(s->conn, hot->xid, hot->frame, rx, ry);
+    if (!frameless) xcb_reparent_window(s->conn, hot->xid, hot->frame, rx, ry);
     if (hot->original_border_width != 0) {
         uint32_t bw_values[] = {0};
         xcb_configure_window(s->conn, hot->xid, XCB_CONFIG_WINDOW_BORDER_WIDTH, bw_values);
@@ -530,14 +545,18 @@ void client_finish_manage(server_t* s, handle_t h) {
                          XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
                          frame_values);
 
-    uint32_t client_values[4];
-    client_values[0] = (uint32_t)client_x;
-    client_values[1] = (uint32_t)client_y;
-    client_values[2] = client_w;
-    client_values[3] = client_h;
-    xcb_configure_window(s->conn, hot->xid,
-                         XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
-                         client_values);
+    // Frameless: the frame configure above already placed the client (no decorations, same size)
+    if (!frameless) {
+        uint32_t client_values[4];
+        client_values[0] = (uint32_t)client_x;
+        client_values[1] = (uint32_t)client_y;
+        client_values[2] = client_w;
+        client_values[3] = client_h;
+        xcb_configure_window(s->conn, hot->xid,
+                             XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH |
+                                 XCB_CONFIG_WINDOW_HEIGHT,
+                             client_values);
+    }
 
     hot->server.x = (int16_t)frame_x;
     hot->server.y = (int16_t)frame_y;
@@ -554,13 +573,14 @@ void client_finish_manage(server_t* s, handle_t h) {
         extents[2] = 0;
         extents[3] = 0;
     }
-    xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_FRAME_EXTENTS, XCB_ATOM_CARDINAL, 32, 4,
-                        extents);
+    wm_prop_publish(s, hot->xid, atoms._NET_FRAME_EXTENTS, XCB_ATOM_CARDINAL, 32, 4, extents);
 
-    if (hot->window_opacity_valid) {
+    // A frameless client carries its own opacity property already
+    if (hot->window_opacity_valid && !frameless) {
         xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->frame, atoms._NET_WM_WINDOW_OPACITY, XCB_ATOM_CARDINAL,
                             32, 1, &hot->window_opacity);
     }
+    frame_sync_bypass(s, hot);
 
     // Set _NET_WM_ALLOWED_ACTIONS (before mapping)
     xcb_atom_t actions[16];
@@ -584,8 +604,7 @@ void client_finish_manage(server_t* s, handle_t h) {
         actions[num_actions++] = atoms._NET_WM_ACTION_FULLSCREEN;
     }
 
-    xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_WM_ALLOWED_ACTIONS, XCB_ATOM_ATOM, 32,
-                        num_actions, actions);
+    wm_prop_publish(s, hot->xid, atoms._NET_WM_ALLOWED_ACTIONS, XCB_ATOM_ATOM, 32, num_actions, actions);
 
     // ---------------------------------------------------------
     // 4. Mapping & Visibility
@@ -598,20 +617,28 @@ void client_finish_manage(server_t* s, handle_t h) {
 
     if (visible) {
         xcb_map_window(s->conn, hot->xid);
-        xcb_map_window(s->conn, hot->frame);
+        if (!frameless) xcb_map_window(s->conn, hot->frame);
+        hot->frame_mapped = true;
         hot->state = STATE_MAPPED;
 
         uint32_t state_vals[] = {XCB_ICCCM_WM_STATE_NORMAL, XCB_NONE};
-        xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2,
-                            state_vals);
+        wm_prop_publish(s, hot->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2, state_vals);
     } else {
         hot->state = STATE_UNMAPPED;
 
+        // No unmapped frame to hide an adopted, already mapped window in
+        if (frameless && was_mapped) {
+            hot->ignore_unmap = client_frame_unmap_echoes(hot);
+            xcb_unmap_window(s->conn, hot->xid);
+        }
+
         uint32_t state_vals[] = {XCB_ICCCM_WM_STATE_ICONIC, XCB_NONE};
-        xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2,
-                            state_vals);
+        wm_prop_publish(s, hot->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2, state_vals);
     }
 
+    wm_desktop_index_update(s, h);
+    wm_place_index_update(s, h);
+
     bool hidden_by_show_desktop = false;
     if (s->showing_desktop && hot->state == STATE_MAPPED && should_hide_for_show_desktop(hot)) {
         hot->show_desktop_hidden = true;
@@ -683,8 +710,7 @@ void client_finish_manage(server_t* s, handle_t h) {
 
     // Publish initial desktop
     uint32_t desk_prop = (uint32_t)hot->desktop;
-    xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_WM_DESKTOP, XCB_ATOM_CARDINAL, 32, 1,
-                        &desk_prop);
+    wm_prop_publish(s, hot->xid, atoms._NET_WM_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &desk_prop);
 
     // Mark root properties dirty
     s->root_dirty |= ROOT_DIRTY_CLIENT_LIST;
@@ -757,6 +783,8 @@ void client_unmanage(server_t* s, handle_t h) {
     // Remove from stacking
     TRACE_LOG("unmanage stack_remove h=%lx layer=%d", h, hot->layer);
     stack_remove(s, h);
+    wm_desktop_index_remove(s, h);
+    wm_place_index_remove(s, h);
 
     // Unlink from parent
     if (hot->transient_sibling.next && hot->transient_sibling.next != &hot->transient_sibling) {
@@ -846,8 +874,11 @@ void client_unmanage(server_t* s, handle_t h) {
             root_y += (int16_t)th;
         }
 
-        TRACE_LOG("unmanage reparent xid=%u -> root (%d,%d)", hot->xid, root_x, root_y);
-        xcb_reparent_window(s->conn, hot->xid, s->root, root_x, root_y);
+        // A frameless client never left the root
+        if (!client_is_frameless(hot)) {
+            TRACE_LOG("unmanage reparent xid=%u -> root (%d,%d)", hot->xid, root_x, root_y);
+            xcb_reparent_window(s->conn, hot->xid, s->root, root_x, root_y);
+        }
     }
 
     if (hot->damage != XCB_NONE) {
@@ -856,10 +887,10 @@ void client_unmanage(server_t* s, handle_t h) {
         dirty_region_reset(&hot->damage_region);
     }
 
-    // Destroy frame
-    if (hot->frame != XCB_NONE) {
-        TRACE_LOG("unmanage destroy frame=%u", hot->frame);
-        xcb_destroy_window(s->conn, hot->frame);
+    // Destroy frame (or return it to the pool)
+    if (hot->frame != XCB_NONE && !client_is_frameless(hot)) {
+        TRACE_LOG("unmanage release frame=%u", hot->frame);
+        frame_release(s, hot);
     }
 
     if (hot->frame_colormap_owned && hot->frame_colormap != XCB_NONE) {
@@ -875,17 +906,23 @@ void client_unmanage(server_t* s, handle_t h) {
             xcb_delete_property(s->conn, hot->xid, atoms._NET_WM_DESKTOP);
             xcb_delete_property(s->conn, hot->xid, atoms._NET_WM_STATE);
         }
+        wm_prop_forget(s, hot->xid);
         hash_map_remove(&s->window_to_client, hot->xid);
     }
-    if (hot->frame != XCB_NONE) hash_map_remove(&s->frame_to_client, hot->frame);
+    if (hot->frame != XCB_NONE && !client_is_frameless(hot)) hash_map_remove(&s->frame_to_client, hot->frame);
+    wm_strut_remove(s, h);
 
     // Free cold data
-    arena_destroy(&cold->string_arena);
+    client_cold_strings_destroy(cold);
     if (cold->colormap_windows) {
         free(cold->colormap_windows);
         cold->colormap_windows = NULL;
         cold->colormap_windows_len = 0;
     }
+    free(cold->title_rules);
+    cold->title_rules = NULL;
+    cold->title_rules_len = 0;
+    cold->title_rules_cap = 0;
     render_free(&hot->render_ctx);
     if (hot->icon_surface) cairo_surface_destroy(hot->icon_surface);
 
@@ -894,7 +931,6 @@ void client_unmanage(server_t* s, handle_t h) {
     small_vec_remove_swap(&s->active_clients, handle_to_ptr(h));
 
     s->root_dirty |= ROOT_DIRTY_CLIENT_LIST;
-    s->workarea_dirty = true;
     TRACE_ONLY(debug_dump_focus_history(s, "after unmanage"));
 }
 
@@ -935,6 +971,87 @@ void client_close(server_t* s, handle_t h) {
     }
 }
 
+/*
+ * Cold string storage:
+ * Strings live in the per-client string_arena (a bump allocator). Replacing a
+ * value reuses the old slot in place when the new value fits; otherwise the old
+ * slot becomes dead and the value is appended. Once dead bytes exceed both the
+ * live bytes and CLIENT_STRING_COMPACT_MIN, the live strings are copied into a
+ * fresh arena, so a client retitling forever stays within ~2x its live strings.
+ */
+#define CLIENT_STRING_COMPACT_MIN 4096u
+
+static inline uint32_t client_string_slot(size_t len) { return (uint32_t)((len + 1u + 7u) & ~(size_t)7u); }
+
+static void client_string_account(client_cold_t* cold, int64_t live_delta, int64_t dead_delta) {
+    cold->string_live = (uint32_t)((int64_t)cold->string_live + live_delta);
+    cold->string_dead = (uint32_t)((int64_t)cold->string_dead + dead_delta);
+    counters.client_string_live_bytes = (uint64_t)((int64_t)counters.client_string_live_bytes + live_delta);
+    counters.client_string_dead_bytes = (uint64_t)((int64_t)counters.client_string_dead_bytes + dead_delta);
+}
+
+static void client_strings_compact(client_cold_t* cold) {
+    arena_t fresh;
+    arena_init(&fresh, cold->string_arena.block_size);
+
+    char** fields[] = {&cold->base_title,  &cold->base_icon_name,    &cold->wm_instance,
+                       &cold->wm_class,    &cold->wm_client_machine, &cold->wm_command};
+
+    // title normally aliases base_title; anything else is copied on its own
+    bool title_aliased = cold->title && cold->title == cold->base_title;
+    char* title = (cold->title && !title_aliased) ? arena_strdup(&fresh, cold->title) : NULL;
+
+    uint32_t live = 0;
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (!*fields[i]) continue;
+        size_t len = strlen(*fields[i]);
+        *fields[i] = arena_strndup(&fresh, *fields[i], len);
+        live += client_string_slot(len);
+    }
+    if (title) live += client_string_slot(strlen(title));
+    cold->title = title_aliased ? cold->base_title : title;
+
+    arena_destroy(&cold->string_arena);
+    cold->string_arena = fresh;
+
+    client_string_account(cold, (int64_t)live - (int64_t)cold->string_live, -(int64_t)cold->string_dead);
+    counters.client_string_compactions++;
+}
+
+void client_cold_set_string(client_cold_t* cold, char** field, const char* str, size_t len) {
+    len = strnlen(str, len);
+    char* old = *field;
+    uint32_t old_slot = old ? client_string_slot(strlen(old)) : 0;
+    uint32_t new_slot = client_string_slot(len);
+
+    if (old && new_slot <= old_slot) {
+        // Fits: overwrite in place (title aliases follow along); the tail of the slot is dead
+        memmove(old, str, len);
+        old[len] = '\0';
+        client_string_account(cold, (int64_t)new_slot - (int64_t)old_slot, (int64_t)old_slot - (int64_t)new_slot);
+        return;
+    }
+
+    *field = arena_strndup(&cold->string_arena, str, len);
+    client_string_account(cold, (int64_t)new_slot - (int64_t)old_slot, (int64_t)old_slot);
+
+    if (cold->string_dead > CLIENT_STRING_COMPACT_MIN && cold->string_dead > cold->string_live) {
+        client_strings_compact(cold);
+    }
+}
+
+void client_cold_strings_destroy(client_cold_t* cold) {
+    client_string_account(cold, -(int64_t)cold->string_live, -(int64_t)cold->string_dead);
+    arena_destroy(&cold->string_arena);
+    cold->title = NULL;
+    cold->base_title = NULL;
+    cold->base_icon_name = NULL;
+    cold->wm_instance = NULL;
+    cold->wm_class = NULL;
+    cold->wm_client_machine = NULL;
+    cold->wm_command = NULL;
+}
+
 void client_constrain_size(const size_hints_t* s, uint32_t flags, uint16_t* w, uint16_t* h) {
     // Min/Max size
     if (flags & XCB_ICCCM_SIZE_HINT_P_MIN_SIZE) {
@@ -79,9 +79,13 @@ void config_init_defaults(config_t* config) {
 
     config->focus_raise = true;
     config->fullscreen_use_workarea = false;
+    config->workspace_hide = WORKSPACE_HIDE_UNMAP;
+    config->frameless_undecorated = false;
+    config->placement = PLACEMENT_DEFAULT;
 
     small_vec_init(&config->key_bindings);
     small_vec_init(&config->rules);
+    rule_index_init(&config->rule_index);
 
     // Default bindings
     add_keybind(config, XCB_MOD_MASK_1, XK_F4, ACTION_CLOSE, NULL);
@@ -132,6 +136,105 @@ void config_destroy(config_t* config) {
         free(r);
     }
     small_vec_destroy(&config->rules);
+    rule_index_destroy(&config->rule_index);
+}
+
+static bool str_equal(const char* a, const char* b) {
+    if (!a || !b) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+static bool appearance_equal(const appearance_t* a, const appearance_t* b) {
+    return a->flags == b->flags && a->color == b->color && a->color_to == b->color_to;
+}
+
+static bool key_binding_equal(const key_binding_t* a, const key_binding_t* b) {
+    return a->modifiers == b->modifiers && a->keysym == b->keysym && a->action == b->action &&
+           str_equal(a->exec_cmd, b->exec_cmd);
+}
+
+static bool app_rule_equal(const app_rule_t* a, const app_rule_t* b) {
+    return str_equal(a->class_match, b->class_match) && str_equal(a->instance_match, b->instance_match) &&
+           str_equal(a->title_match, b->title_match) && a->type_match == b->type_match &&
+           a->transient_match == b->transient_match && a->desktop == b->desktop && a->layer == b->layer &&
+           a->focus == b->focus && a->bypass_compositor == b->bypass_compositor && a->placement == b->placement;
+}
+
+/*
+ * config_diff:
+ * Sections are compared by value, so a reload that rewrites the file with the
+ * same content reports nothing. Key bindings and rules are order-sensitive
+ * (later bindings win, rules apply in order).
+ */
+uint32_t config_diff(const config_t* a, const config_t* b) {
+    uint32_t changed = 0;
+
+    if (a->desktop_count != b->desktop_count || a->desktop_names_count != b->desktop_names_count) {
+        changed |= CONFIG_CHANGED_DESKTOPS;
+    } else {
+        for (uint32_t i = 0; i < a->desktop_names_count; i++) {
+            if (!str_equal(a->desktop_names[i], b->desktop_names[i])) {
+                changed |= CONFIG_CHANGED_DESKTOPS;
+                break;
+            }
+        }
+    }
+
+    if (a->key_bindings.length != b->key_bindings.length) {
+        changed |= CONFIG_CHANGED_KEYS;
+    } else {
+        for (size_t i = 0; i < a->key_bindings.length; i++) {
+            if (!key_binding_equal(a->key_bindings.items[i], b->key_bindings.items[i])) {
+                changed |= CONFIG_CHANGED_KEYS;
+                break;
+            }
+        }
+    }
+
+    if (a->rules.length != b->rules.length) {
+        changed |= CONFIG_CHANGED_RULES;
+    } else {
+        for (size_t i = 0; i < a->rules.length; i++) {
+            if (!app_rule_equal(a->rules.items[i], b->rules.items[i])) {
+                changed |= CONFIG_CHANGED_RULES;
+                break;
+            }
+        }
+    }
+
+    const theme_t* ta = &a->theme;
+    const theme_t* tb = &b->theme;
+    if (ta->border_width != tb->border_width || ta->title_height != tb->title_height) {
+        changed |= CONFIG_CHANGED_FRAME_GEOM;
+    }
+    if (ta->padding_width != tb->padding_width || ta->handle_height != tb->handle_height ||
+        ta->label_margin != tb->label_margin ||
+        !appearance_equal(&ta->window_active_title, &tb->window_active_title) ||
+        ta->window_active_label_text_color != tb->window_active_label_text_color ||
+        ta->window_active_border_color != tb->window_active_border_color ||
+        !appearance_equal(&ta->window_active_handle, &tb->window_active_handle) ||
+        !appearance_equal(&ta->window_active_grip, &tb->window_active_grip) ||
+        !appearance_equal(&ta->window_inactive_title, &tb->window_inactive_title) ||
+        ta->window_inactive_label_text_color != tb->window_inactive_label_text_color ||
+        ta->window_inactive_border_color != tb->window_inactive_border_color ||
+        !appearance_equal(&ta->window_inactive_handle, &tb->window_inactive_handle) ||
+        !appearance_equal(&ta->window_inactive_grip, &tb->window_inactive_grip) ||
+        !str_equal(a->font_name, b->font_name)) {
+        changed |= CONFIG_CHANGED_FRAME_STYLE;
+    }
+    if (!appearance_equal(&ta->menu_items, &tb->menu_items) || ta->menu_items_text_color != tb->menu_items_text_color ||
+        !appearance_equal(&ta->menu_items_active, &tb->menu_items_active) ||
+        ta->menu_items_active_text_color != tb->menu_items_active_text_color || !str_equal(a->font_name, b->font_name)) {
+        changed |= CONFIG_CHANGED_MENU;
+    }
+
+    if (a->focus_raise != b->focus_raise || a->fullscreen_use_workarea != b->fullscreen_use_workarea ||
+        a->workspace_hide != b->workspace_hide || a->frameless_undecorated != b->frameless_undecorated ||
+        a->placement != b->placement) {
+        changed |= CONFIG_CHANGED_POLICY;
+    }
+
+    return changed;
 }
 
 static char* trim_whitespace(char* str) {
@@ -294,6 +397,7 @@ static void parse_rule(config_t* config, const char* val) {
     r->desktop = -2;
     r->layer = -1;
     r->focus = -1;
+    r->bypass_compositor = -1;
 
     char* p = match_part;
     while (p && *p) {
@@ -369,17 +473,24 @@ static void parse_rule(config_t* config, const char* val) {
                     r->layer = LAYER_OVERLAY;
             } else if (strcasecmp(k, "focus") == 0) {
                 r->focus = (strcasecmp(v, "yes") == 0 || strcasecmp(v, "true") == 0 || strcmp(v, "1") == 0);
+            } else if (strcasecmp(k, "bypass") == 0) {
+                // true: let the compositor unredirect it, false: always composite
+                bool on = (strcasecmp(v, "yes") == 0 || strcasecmp(v, "true") == 0 || strcmp(v, "1") == 0);
+                r->bypass_compositor = on ? 1 : 2;
             } else if (strcasecmp(k, "placement") == 0) {
                 if (strcasecmp(v, "center") == 0)
                     r->placement = PLACEMENT_CENTER;
                 else if (strcasecmp(v, "mouse") == 0)
                     r->placement = PLACEMENT_MOUSE;
+                else if (strcasecmp(v, "smart") == 0)
+                    r->placement = PLACEMENT_SMART;
             }
         }
         p = comma ? comma + 1 : NULL;
     }
 
     small_vec_push(&config->rules, r);
+    config->rules_version++;
     free(copy);
 }
 
@@ -472,6 +583,28 @@ bool config_load(config_t* config, const char* path) {
             config->focus_raise = (strcasecmp(val, "true") == 0 || strcmp(val, "1") == 0);
         } else if (strcmp(key, "fullscreen_use_workarea") == 0) {
             config->fullscreen_use_workarea = (strcasecmp(val, "true") == 0 || strcmp(val, "1") == 0);
+        } else if (strcmp(key, "workspace_hide") == 0) {
+            if (strcasecmp(val, "park") == 0) {
+                config->workspace_hide = WORKSPACE_HIDE_PARK;
+            } else if (strcasecmp(val, "unmap") == 0) {
+                config->workspace_hide = WORKSPACE_HIDE_UNMAP;
+            } else {
+                LOG_WARN("%s:%d: Unknown workspace_hide mode: %s", path, line_num, val);
+            }
+        } else if (strcmp(key, "frameless_undecorated") == 0) {
+            config->frameless_undecorated = (strcasecmp(val, "true") == 0 || strcmp(val, "1") == 0);
+        } else if (strcmp(key, "placement") == 0) {
+            if (strcasecmp(val, "smart") == 0) {
+                config->placement = PLACEMENT_SMART;
+            } else if (strcasecmp(val, "center") == 0) {
+                config->placement = PLACEMENT_CENTER;
+            } else if (strcasecmp(val, "mouse") == 0) {
+                config->placement = PLACEMENT_MOUSE;
+            } else if (strcasecmp(val, "default") == 0) {
+                config->placement = PLACEMENT_DEFAULT;
+            } else {
+                LOG_WARN("%s:%d: Unknown placement policy: %s", path, line_num, val);
+            }
         } else if (strcmp(key, "keybind") == 0) {
             parse_keybind(config, val);
         } else if (strcmp(key, "rule") == 0) {
@@ -490,6 +623,7 @@ bool config_load(config_t* config, const char* path) {
 
     free(line);
     fclose(f);
+    rule_index_build(&config->rule_index, &config->rules, config->rules_version);
     LOG_INFO("Loaded config from %s", path);
     return true;
 }
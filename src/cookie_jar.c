@@ -122,9 +122,20 @@ void cookie_jar_init(cookie_jar_t* cj) {
     cj->cap = cap;
     cj->live_count = 0;
     cj->scan_cursor = 0;
+    cj->txn_free = NULL;
 }
 
 void cookie_jar_destroy(cookie_jar_t* cj) {
+    if (cj->slots) {
+        for (size_t i = 0; i < cj->cap; i++) {
+            if (cj->slots[i].live && cj->slots[i].type == COOKIE_TXN) free((void*)cj->slots[i].data);
+        }
+    }
+    while (cj->txn_free) {
+        cookie_txn_t* next = cj->txn_free->next_free;
+        free(cj->txn_free);
+        cj->txn_free = next;
+    }
     free(cj->slots);
     memset(cj, 0, sizeof(*cj));
 }
@@ -154,6 +165,108 @@ bool cookie_jar_push(cookie_jar_t* cj, uint32_t sequence, cookie_type_t type, ha
     return true;
 }
 
+static void cookie_txn_release(cookie_jar_t* cj, cookie_txn_t* txn) {
+    txn->next_free = cj->txn_free;
+    cj->txn_free = txn;
+}
+
+cookie_txn_t* cookie_jar_txn_begin(cookie_jar_t* cj, handle_t client, uint64_t txn_id, cookie_handler_fn handler) {
+    cookie_txn_t* txn = cj->txn_free;
+    if (txn) {
+        cj->txn_free = txn->next_free;
+    } else {
+        txn = cj_calloc(1, sizeof(*txn));
+        if (!txn) {
+            LOG_ERROR("cookie_jar_txn_begin failed");
+            exit(1);
+        }
+    }
+
+    txn->base_sequence = 0;
+    txn->count = 0;
+    txn->done_mask = 0;
+    txn->client = client;
+    txn->txn_id = txn_id;
+    txn->handler = handler;
+    txn->next_free = NULL;
+    return txn;
+}
+
+void cookie_jar_txn_add(cookie_jar_t* cj, cookie_txn_t* txn, uint32_t sequence, cookie_type_t type, uintptr_t data) {
+    if (txn->count == 0) {
+        txn->base_sequence = sequence;
+    } else if (txn->count >= COOKIE_TXN_MAX_REQUESTS || sequence != txn->base_sequence + txn->count) {
+        // Run broken (another request slipped in) or group full
+        cookie_jar_push(cj, sequence, type, txn->client, data, txn->txn_id, txn->handler);
+        return;
+    }
+
+    txn->reqs[txn->count].type = type;
+    txn->reqs[txn->count].data = data;
+    txn->count++;
+}
+
+void cookie_jar_txn_commit(cookie_jar_t* cj, cookie_txn_t* txn) {
+    if (txn->count == 0) {
+        cookie_txn_release(cj, txn);
+        return;
+    }
+
+    cookie_jar_push(cj, txn->base_sequence, COOKIE_TXN, txn->client, (uintptr_t)txn, txn->txn_id, txn->handler);
+}
+
+/*
+ * cookie_jar_drain_txn:
+ * Dispatch the ready prefix of a grouped transaction.
+ *
+ * Replies arrive in sequence order, so polling stops at the first sub-request
+ * that is not ready yet. Each sub-reply is handed to the handler with a
+ * synthesized slot. The group slot is removed once every bit in done_mask is set
+ * (or the group timed out, in which case remaining sub-requests see reply=NULL).
+ *
+ * Handlers may push cookies (and grow the table), so the slot is looked up again
+ * by sequence before removal instead of holding a pointer across callbacks.
+ */
+static size_t cookie_jar_drain_txn(xcb_connection_t* conn, struct server* s, cookie_txn_t* txn, uint64_t enqueued_ns,
+                                   uint64_t now, size_t budget, bool* finished) {
+    size_t processed = 0;
+    uint32_t full_mask = (txn->count >= 32u) ? 0xFFFFFFFFu : ((1u << txn->count) - 1u);
+    bool timed_out = now > enqueued_ns && now - enqueued_ns > COOKIE_JAR_TIMEOUT_NS;
+
+    for (uint32_t i = 0; i < txn->count && processed < budget; i++) {
+        if (txn->done_mask & (1u << i)) continue;
+
+        cookie_slot_t local = {
+            .sequence = txn->base_sequence + i,
+            .type = txn->reqs[i].type,
+            .client = txn->client,
+            .data = txn->reqs[i].data,
+            .timestamp_ns = enqueued_ns,
+            .txn_id = txn->txn_id,
+            .handler = txn->handler,
+            .live = false,
+        };
+
+        void* reply = NULL;
+        xcb_generic_error_t* err = NULL;
+        int ready = xcb_poll_for_reply(conn, local.sequence, &reply, &err);
+
+        if (!ready && !timed_out) break;
+        if (!ready) LOG_WARN("Cookie %u (txn %u+%u) timed out, dropping", local.sequence, txn->base_sequence, i);
+
+        txn->done_mask |= (1u << i);
+        if (local.handler) local.handler(s, &local, reply, err);
+
+        if (reply) free(reply);
+        if (err) free(err);
+
+        processed++;
+    }
+
+    *finished = (txn->done_mask == full_mask);
+    return processed;
+}
+
 /*
  * cookie_jar_drain:
  * Check for available replies or timeouts.
@@ -176,6 +289,27 @@ void cookie_jar_drain(cookie_jar_t* cj, xcb_connection_t* conn, struct server* s
     while (scanned < cj->cap && processed < max_replies && cj->live_count > 0) {
         cookie_slot_t* slot = &cj->slots[idx];
 
+        if (slot->live && slot->type == COOKIE_TXN) {
+            cookie_txn_t* txn = (cookie_txn_t*)slot->data;
+            uint32_t key = slot->sequence;
+            bool finished = false;
+
+            processed += cookie_jar_drain_txn(conn, s, txn, slot->timestamp_ns, now, max_replies - processed, &finished);
+
+            // Handlers may have grown the table
+            mask = cj->cap - 1;
+            if (finished) {
+                idx = cookie_jar_probe(cj, key);
+                if (cj->slots[idx].live) cookie_jar_remove(cj, idx);
+                cookie_txn_release(cj, txn);
+                continue;
+            }
+
+            idx = cookie_next(cookie_jar_probe(cj, key), mask);
+            scanned++;
+            continue;
+        }
+
         if (slot->live) {
             void* reply = NULL;
             xcb_generic_error_t* err = NULL;
@@ -78,7 +78,22 @@ void counters_dump(void) {
 
     printf("X flushes: %" PRIu64 "\n", counters.x_flush_count);
     printf("Config requests applied: %" PRIu64 "\n", counters.config_requests_applied);
-    printf("Restacks applied: %" PRIu64 "\n", counters.restacks_applied);
+    printf("Restacks applied: %" PRIu64 " (label rebuilds %" PRIu64 ")\n", counters.restacks_applied,
+           counters.stack_relabels);
+    printf("Title fetches deferred: %" PRIu64 "\n", counters.title_fetches_deferred);
+    printf("Title redraws skipped: %" PRIu64 "\n", counters.title_redraws_skipped);
+    printf("Frame redraws deferred: %" PRIu64 "\n", counters.frame_redraws_deferred);
+    printf("Property writes skipped: %" PRIu64 "\n", counters.prop_writes_skipped);
+    printf("Client strings: live=%" PRIu64 " dead=%" PRIu64 " compactions=%" PRIu64 "\n",
+           counters.client_string_live_bytes, counters.client_string_dead_bytes, counters.client_string_compactions);
+    printf("Spawns: %" PRIu64 " (fallbacks %" PRIu64 ", failed %" PRIu64 ")", counters.spawn_requests,
+           counters.spawn_fallbacks, counters.spawn_failures);
+    if (counters.spawn_latency_count) {
+        printf(" latency avg=%" PRIu64 " max=%" PRIu64 " ns",
+               counters.spawn_latency_sum / counters.spawn_latency_count, counters.spawn_latency_max);
+    }
+    printf("\n");
+    printf("Frames: created=%" PRIu64 " recycled=%" PRIu64 "\n", counters.frames_created, counters.frames_recycled);
 
     print_event_stats();
 }
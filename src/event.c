@@ -19,6 +19,7 @@
 #include <unistd.h>
 #include <xcb/damage.h>
 #include <xcb/randr.h>
+#include <xcb/xkb.h>
 #include <xcb/xcb_keysyms.h>
 
 #include "frame.h"
@@ -58,7 +59,7 @@
 static int make_epoll_or_die(void);
 static void epoll_add_fd_or_die(int epfd, int fd);
 static void load_config_from_home(server_t* s);
-static void run_autostart(void);
+static void run_autostart(server_t* s);
 static void apply_reload(server_t* s);
 static void buckets_reset(event_buckets_t* b);
 static void event_ingest_one(server_t* s, xcb_generic_event_t* ev);
@@ -71,6 +72,9 @@ volatile sig_atomic_t g_reload_pending = 0;
 void server_init(server_t* s) {
     memset(s, 0, sizeof(*s));
 
+    // Fork the exec helper while the process is still small (launcher.h)
+    launcher_start(&s->launcher);
+
     s->conn = xcb_connect_cached();
     if (!s->conn) {
         LOG_ERROR("Failed to connect to X server");
@@ -137,10 +141,29 @@ void server_init(server_t* s) {
             s->randr_supported = false;
             s->randr_event_base = 0;
         } else {
+            s->randr_monitors = rr->major_version > 1 || (rr->major_version == 1 && rr->minor_version >= 5);
             free(rr);
         }
     }
 
+    // XKB keymap changes (layout switches) do not always come with a core MappingNotify
+    s->xkb_supported = false;
+    s->xkb_event_base = 0;
+    const xcb_query_extension_reply_t* xkb_ext = xcb_get_extension_data(s->conn, &xcb_xkb_id);
+    if (xkb_ext && xkb_ext->present) {
+        // UseExtension must precede any other XKB request; nothing in its reply is needed
+        xcb_xkb_use_extension_cookie_t uc =
+            xcb_xkb_use_extension(s->conn, XCB_XKB_MAJOR_VERSION, XCB_XKB_MINOR_VERSION);
+        xcb_discard_reply(s->conn, uc.sequence);
+
+        uint16_t events = XCB_XKB_EVENT_TYPE_NEW_KEYBOARD_NOTIFY | XCB_XKB_EVENT_TYPE_MAP_NOTIFY;
+        uint16_t parts = XCB_XKB_MAP_PART_KEY_TYPES | XCB_XKB_MAP_PART_KEY_SYMS;
+        xcb_xkb_select_events(s->conn, XCB_XKB_ID_USE_CORE_KBD, events, 0, events, parts, parts, NULL);
+
+        s->xkb_supported = true;
+        s->xkb_event_base = xkb_ext->first_event;
+    }
+
     // Initialize configuration (defaults then optional load)
     config_init_defaults(&s->config);
     load_config_from_home(s);
@@ -185,6 +208,10 @@ void server_init(server_t* s) {
         xcb_randr_select_input(s->conn, s->root, XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE);
     }
 
+    // Seed the pointer cache; input events keep it current from here on
+    xcb_query_pointer_cookie_t qp = xcb_query_pointer(s->conn, s->root);
+    cookie_jar_push(&s->cookie_jar, qp.sequence, COOKIE_QUERY_POINTER, HANDLE_INVALID, 0, s->txn_id, wm_handle_reply);
+
     // Adopt existing windows (must happen after we are the WM)
     wm_update_monitors(s);
     wm_adopt_children(s);
@@ -192,6 +219,7 @@ void server_init(server_t* s) {
     // Create epoll instance and register X connection fd
     s->epoll_fd = make_epoll_or_die();
     epoll_add_fd_or_die(s->epoll_fd, s->xcb_fd);
+    if (s->launcher.fd > 0) epoll_add_fd_or_die(s->epoll_fd, s->launcher.fd);
 
     // Setup signalfd
     sigset_t mask;
@@ -251,11 +279,9 @@ void server_init(server_t* s) {
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
     hash_map_init(&s->pending_unmanaged_states);
+    hash_map_init(&s->prop_cache);
 
-    // Layer stacks and focus ring
-    for (int i = 0; i < LAYER_COUNT; i++) {
-        small_vec_init(&s->layers[i]);
-    }
+    // Focus ring (layer stacks start empty when zeroed)
     list_init(&s->focus_history);
     s->focused_client = HANDLE_INVALID;
 
@@ -268,9 +294,13 @@ void server_init(server_t* s) {
         abort();
     }
     small_vec_init(&s->active_clients);
+    small_vec_init(&s->sticky_members);
+    small_vec_init(&s->visibility_pending);
+    small_vec_init(&s->strut_clients);
 
     // Setup decoration resources (colors/fonts/gcs/etc)
     frame_init_resources(s);
+    frame_pool_init(s);
 
     // Root menu
     menu_init(s);
@@ -286,7 +316,7 @@ void server_init(server_t* s) {
     // Setup keys
     wm_setup_keys(s);
 
-    run_autostart();
+    run_autostart(s);
 
     LOG_INFO("Server initialized");
 }
@@ -316,7 +346,10 @@ void server_cleanup(server_t* s) {
         xcb_key_symbols_free(s->keysyms);
         s->keysyms = NULL;
     }
+    free(s->key_table.slots);
+    s->key_table.slots = NULL;
 
+    frame_pool_destroy(s);
     frame_cleanup_resources(s);
     menu_destroy(s);
     config_destroy(&s->config);
@@ -325,6 +358,8 @@ void server_cleanup(server_t* s) {
         free(s->monitors);
         s->monitors = NULL;
     }
+    free(s->monitor_query_next);
+    s->monitor_query_next = NULL;
 
     if (s->signal_fd > 0) {
         close(s->signal_fd);
@@ -334,6 +369,7 @@ void server_cleanup(server_t* s) {
         close(s->timer_fd);
         s->timer_fd = -1;
     }
+    launcher_stop(&s->launcher);
     if (s->epoll_fd > 0) {
         close(s->epoll_fd);
         s->epoll_fd = -1;
@@ -379,13 +415,24 @@ void server_cleanup(server_t* s) {
         }
     }
     hash_map_destroy(&s->pending_unmanaged_states);
+    wm_prop_cache_destroy(s);
+    free(s->client_list_pub.items);
+    free(s->client_stack_pub.items);
+    free(s->committed_stack.items);
 
     slotmap_destroy(&s->clients);
     small_vec_destroy(&s->active_clients);
 
-    for (int i = 0; i < LAYER_COUNT; i++) {
-        small_vec_destroy(&s->layers[i]);
+    for (uint32_t i = 0; i < s->desktop_members_cap; i++) {
+        small_vec_destroy(&s->desktop_members[i]);
     }
+    free(s->desktop_members);
+    s->desktop_members = NULL;
+    s->desktop_members_cap = 0;
+    small_vec_destroy(&s->sticky_members);
+    wm_place_index_destroy(s);
+    small_vec_destroy(&s->strut_clients);
+    small_vec_destroy(&s->visibility_pending);
 
     // Global library cleanup for ASan
     pango_cairo_font_map_set_default(NULL);
@@ -412,7 +459,7 @@ static void epoll_add_fd_or_die(int epfd, int fd) {
     }
 }
 
-static void run_autostart(void) {
+static void run_autostart(server_t* s) {
     char path[1024];
     const char* xdg_config_home = getenv("XDG_CONFIG_HOME");
     const char* home = getenv("HOME");
@@ -443,17 +490,7 @@ static void run_autostart(void) {
 
     if (exec_path) {
         LOG_INFO("Executing autostart script: %s", exec_path);
-        pid_t pid = fork();
-        if (pid == 0) {
-            if (setsid() < 0) {
-                LOG_WARN("setsid failed in autostart: %s", strerror(errno));
-            }
-            execl(exec_path, exec_path, NULL);
-            LOG_ERROR("Failed to exec autostart script: %s", strerror(errno));
-            exit(1);
-        } else if (pid < 0) {
-            LOG_ERROR("Failed to fork for autostart: %s", strerror(errno));
-        }
+        launcher_run(s, LAUNCH_EXEC, exec_path);
     }
 }
 
@@ -531,6 +568,8 @@ static void buckets_reset(event_buckets_t* b) {
     b->randr_width = 0;
     b->randr_height = 0;
 
+    b->keymap_dirty = false;
+
     b->ingested = 0;
     b->coalesced = 0;
 }
@@ -573,6 +612,20 @@ void event_ingest(server_t* s, bool x_ready) {
     s->buckets.ingested = count;
 }
 
+static inline void pointer_note(server_t* s, int16_t root_x, int16_t root_y) {
+    s->pointer.x = root_x;
+    s->pointer.y = root_y;
+    s->pointer.valid = true;
+}
+
+static inline void keymap_note(server_t* s, uint8_t type) {
+    if (s->buckets.keymap_dirty) {
+        counters.coalesced_drops[type]++;
+        s->buckets.coalesced++;
+    }
+    s->buckets.keymap_dirty = true;
+}
+
 static void event_ingest_one(server_t* s, xcb_generic_event_t* ev) {
     uint8_t type = ev->response_type & ~0x80;
     counters.events_seen[type]++;
@@ -610,6 +663,18 @@ static void event_ingest_one(server_t* s, xcb_generic_event_t* ev) {
         return;
     }
 
+    if (s->xkb_supported && type == s->xkb_event_base) {
+        // All XKB events share one code; the subtype is in xkbType
+        uint8_t xkb_type = ((xcb_xkb_map_notify_event_t*)ev)->xkbType;
+        if (xkb_type == XCB_XKB_MAP_NOTIFY || xkb_type == XCB_XKB_NEW_KEYBOARD_NOTIFY) {
+            keymap_note(s, type);
+            TRACE_LOG("coalesce xkb keymap notify type=%u", xkb_type);
+        }
+
+        free(ev);
+        return;
+    }
+
     switch (type) {
         case XCB_EXPOSE: {
             xcb_expose_event_t* e = (xcb_expose_event_t*)ev;
@@ -628,6 +693,9 @@ static void event_ingest_one(server_t* s, xcb_generic_event_t* ev) {
 
         case XCB_BUTTON_PRESS:
         case XCB_BUTTON_RELEASE: {
+            // Press and release share a layout
+            xcb_button_press_event_t* e = (xcb_button_press_event_t*)ev;
+            pointer_note(s, e->root_x, e->root_y);
             size_t sz =
                 (type == XCB_BUTTON_PRESS) ? sizeof(xcb_button_press_event_t) : sizeof(xcb_button_release_event_t);
             void* copy = arena_alloc(&s->tick_arena, sz);
@@ -647,6 +715,7 @@ static void event_ingest_one(server_t* s, xcb_generic_event_t* ev) {
 
         case XCB_KEY_PRESS: {
             xcb_key_press_event_t* e = (xcb_key_press_event_t*)ev;
+            pointer_note(s, e->root_x, e->root_y);
             void* copy = arena_alloc(&s->tick_arena, sizeof(*e));
             memcpy(copy, e, sizeof(*e));
             small_vec_push(&s->buckets.key_presses, copy);
@@ -774,6 +843,7 @@ static void event_ingest_one(server_t* s, xcb_generic_event_t* ev) {
 
         case XCB_MOTION_NOTIFY: {
             xcb_motion_notify_event_t* e = (xcb_motion_notify_event_t*)ev;
+            pointer_note(s, e->root_x, e->root_y);
             xcb_motion_notify_event_t* existing = hash_map_get(&s->buckets.motion_notifies, e->event);
             if (existing) {
                 counters.coalesced_drops[type]++;
@@ -789,6 +859,7 @@ static void event_ingest_one(server_t* s, xcb_generic_event_t* ev) {
 
         case XCB_ENTER_NOTIFY: {
             xcb_enter_notify_event_t* e = (xcb_enter_notify_event_t*)ev;
+            pointer_note(s, e->root_x, e->root_y);
             if (s->buckets.pointer_notify.enter_valid) {
                 counters.coalesced_drops[type]++;
                 s->buckets.coalesced++;
@@ -800,6 +871,7 @@ static void event_ingest_one(server_t* s, xcb_generic_event_t* ev) {
 
         case XCB_LEAVE_NOTIFY: {
             xcb_leave_notify_event_t* e = (xcb_leave_notify_event_t*)ev;
+            pointer_note(s, e->root_x, e->root_y);
             if (s->buckets.pointer_notify.leave_valid) {
                 counters.coalesced_drops[type]++;
                 s->buckets.coalesced++;
@@ -813,10 +885,19 @@ static void event_ingest_one(server_t* s, xcb_generic_event_t* ev) {
         case XCB_CREATE_NOTIFY:
         case XCB_FOCUS_IN:
         case XCB_FOCUS_OUT:
-        case XCB_MAPPING_NOTIFY:
             // These are noisy and we don't use them for anything right now
             break;
 
+        case XCB_MAPPING_NOTIFY: {
+            xcb_mapping_notify_event_t* e = (xcb_mapping_notify_event_t*)ev;
+            // Modifier and pointer remaps leave the keysym table alone
+            if (e->request == XCB_MAPPING_KEYBOARD) {
+                keymap_note(s, type);
+                TRACE_LOG("coalesce mapping notify first=%u count=%u", e->first_keycode, e->count);
+            }
+            break;
+        }
+
         default:
             counters.events_unhandled[type]++;
             break;
@@ -887,6 +968,7 @@ void event_process(server_t* s) {
         xcb_key_press_event_t* ev = s->buckets.key_presses.items[i];
         wm_handle_key_press(s, ev);
     }
+    wm_key_actions_flush(s);
 
     // 3. buttons (menu, focus, move/resize)
     for (size_t i = 0; i < s->buckets.button_events.length; i++) {
@@ -1034,31 +1116,39 @@ void event_process(server_t* s) {
     // 11. RandR (coalesced)
     if (s->buckets.randr_dirty) {
         TRACE_LOG("process randr dirty width=%u height=%u", s->buckets.randr_width, s->buckets.randr_height);
+        if (s->buckets.randr_width && s->buckets.randr_height) {
+            s->screen_w = s->buckets.randr_width;
+            s->screen_h = s->buckets.randr_height;
+        }
+        wm_workarea_invalidate(s);
         wm_update_monitors(s);
         uint32_t geometry[] = {s->buckets.randr_width, s->buckets.randr_height};
         xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, s->root, atoms._NET_DESKTOP_GEOMETRY, XCB_ATOM_CARDINAL, 32,
                             2, geometry);
 
+        // The monitor table is replaced when the replies land (fullscreen geometry follows then)
         rect_t wa;
         wm_compute_workarea(s, &wa);
         wm_publish_workarea(s, &wa);
+    }
 
-        if (!s->config.fullscreen_use_workarea) {
-            for (size_t i = 0; i < s->active_clients.length; i++) {
-                handle_t h = ptr_to_handle(s->active_clients.items[i]);
-                client_hot_t* hot = server_chot(s, h);
-                if (!hot || hot->layer != LAYER_FULLSCREEN) continue;
-                wm_get_monitor_geometry(s, hot, &hot->desired);
-                hot->dirty |= DIRTY_GEOM;
-            }
-        }
+    // 12. Keymap (coalesced); grabs follow when the mapping reply lands
+    if (s->buckets.keymap_dirty) {
+        TRACE_LOG("process keymap dirty");
+        wm_refresh_keymap(s);
     }
 
-    // 12. maintenance
+    // 13. maintenance
 }
 
 void server_schedule_timer(server_t* s, int ms) {
     if (s->timer_fd <= 0) return;
+
+    uint64_t now = monotonic_time_ns();
+    uint64_t deadline = now + (uint64_t)(ms > 0 ? ms : 0) * 1000000ull;
+    if (s->timer_deadline_ns > now && s->timer_deadline_ns <= deadline) return;
+    s->timer_deadline_ns = deadline;
+
     struct itimerspec its;
     its.it_interval.tv_sec = 0;
     its.it_interval.tv_nsec = 0;  // One-shot
@@ -1148,46 +1238,75 @@ static void apply_reload(server_t* s) {
         theme_load(&next_config.theme, "/etc/hxm/themerc");
     }
 
+    uint32_t changed = config_diff(&s->config, &next_config);
+    LOG_INFO("Config sections changed: 0x%x", changed);
+
+    // Unchanged sections keep their live objects: the key table points into
+    // key_bindings and clients remember rule indices of the rule index generation
+    if (!(changed & CONFIG_CHANGED_KEYS)) {
+        small_vec_t tmp = next_config.key_bindings;
+        next_config.key_bindings = s->config.key_bindings;
+        s->config.key_bindings = tmp;
+    }
+    if (!(changed & CONFIG_CHANGED_RULES)) {
+        small_vec_t tmp = next_config.rules;
+        next_config.rules = s->config.rules;
+        s->config.rules = tmp;
+        rule_index_t tmp_idx = next_config.rule_index;
+        next_config.rule_index = s->config.rule_index;
+        s->config.rule_index = tmp_idx;
+        uint32_t tmp_version = next_config.rules_version;
+        next_config.rules_version = s->config.rules_version;
+        s->config.rules_version = tmp_version;
+    }
+
     config_destroy(&s->config);
     s->config = next_config;
 
-    uint32_t desired = s->config.desktop_count ? s->config.desktop_count : s->desktop_count;
-    if (desired == 0) desired = 1;
-    if (desired != s->desktop_count) {
-        s->desktop_count = desired;
-        if (s->current_desktop >= s->desktop_count) s->current_desktop = 0;
+    if (changed & CONFIG_CHANGED_DESKTOPS) {
+        uint32_t desired = s->config.desktop_count ? s->config.desktop_count : s->desktop_count;
+        if (desired == 0) desired = 1;
+        if (desired != s->desktop_count) {
+            s->desktop_count = desired;
+            if (s->current_desktop >= s->desktop_count) s->current_desktop = 0;
 
-        for (size_t i = 0; i < s->active_clients.length; i++) {
-            handle_t h = ptr_to_handle(s->active_clients.items[i]);
-            client_hot_t* hot = server_chot(s, h);
-            if (!hot || hot->sticky) continue;
-            if (hot->desktop >= (int32_t)s->desktop_count) {
-                hot->desktop = (int32_t)s->current_desktop;
-                uint32_t prop_val = (uint32_t)hot->desktop;
-                xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_WM_DESKTOP, XCB_ATOM_CARDINAL,
-                                    32, 1, &prop_val);
+            for (size_t i = 0; i < s->active_clients.length; i++) {
+                handle_t h = ptr_to_handle(s->active_clients.items[i]);
+                client_hot_t* hot = server_chot(s, h);
+                if (!hot || hot->sticky) continue;
+                if (hot->desktop >= (int32_t)s->desktop_count) {
+                    hot->desktop = (int32_t)s->current_desktop;
+                    wm_desktop_index_update(s, h);
+                    wm_client_visibility_changed(s, h);
+                    uint32_t prop_val = (uint32_t)hot->desktop;
+                    wm_prop_publish(s, hot->xid, atoms._NET_WM_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &prop_val);
+                }
             }
         }
-    }
 
-    wm_publish_desktop_props(s);
-    s->workarea_dirty = true;
+        wm_publish_desktop_props(s);
+        s->workarea_dirty = true;
+    }
 
-    frame_cleanup_resources(s);
-    frame_init_resources(s);
+    if (changed & CONFIG_CHANGED_MENU) {
+        if (s->menu.visible) menu_hide(s);
+        menu_destroy(s);
+        menu_init(s);
+    }
 
-    menu_destroy(s);
-    menu_init(s);
+    if (changed & CONFIG_CHANGED_KEYS) wm_setup_keys(s);
 
-    wm_setup_keys(s);
-
-    for (size_t i = 0; i < s->active_clients.length; i++) {
-        handle_t h = ptr_to_handle(s->active_clients.items[i]);
-        client_hot_t* hot = server_chot(s, h);
-        if (hot) hot->dirty |= DIRTY_FRAME_STYLE | DIRTY_GEOM;
+    // Extents (and fullscreen geometry, via policy) need a reconfigure; colors only a repaint
+    uint32_t dirty = 0;
+    if (changed & (CONFIG_CHANGED_FRAME_GEOM | CONFIG_CHANGED_POLICY)) dirty |= DIRTY_FRAME_STYLE | DIRTY_GEOM;
+    if (changed & CONFIG_CHANGED_FRAME_STYLE) dirty |= DIRTY_FRAME_STYLE;
+    if (dirty) {
+        for (size_t i = 0; i < s->active_clients.length; i++) {
+            handle_t h = ptr_to_handle(s->active_clients.items[i]);
+            client_hot_t* hot = server_chot(s, h);
+            if (hot) hot->dirty |= dirty;
+        }
     }
-
-    wm_publish_desktop_props(s);
 }
 
 static void event_handle_signals(server_t* s) {
@@ -1255,6 +1374,10 @@ static bool server_wait_for_events(server_t* s, int timeout_ms) {
                         g_shutdown_pending = 1;
                         return false;
                     }
+                    if (s->launcher.fd > 0 && evs[i].data.fd == s->launcher.fd) {
+                        launcher_handle_replies(s);
+                        launcher_lost(s);
+                    }
                     continue;
                 }
 
@@ -1262,10 +1385,12 @@ static bool server_wait_for_events(server_t* s, int timeout_ms) {
                     x_ready = true;
                 } else if (evs[i].data.fd == s->signal_fd) {
                     event_handle_signals(s);
+                } else if (s->launcher.fd > 0 && evs[i].data.fd == s->launcher.fd) {
+                    launcher_handle_replies(s);
                 } else if (evs[i].data.fd == s->timer_fd) {
                     uint64_t expirations;
                     (void)read(s->timer_fd, &expirations, sizeof(expirations));
-                    // Timer logic if needed
+                    s->timer_deadline_ns = 0;
                 }
             }
 
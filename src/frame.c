@@ -13,6 +13,7 @@
 #include "event.h"
 #include "hxm.h"
 #include "render.h"
+#include "xcb_utils.h"
 
 void frame_init_resources(server_t* s) {
     // Cursors
@@ -58,6 +59,154 @@ void frame_cleanup_resources(server_t* s) {
     xcb_free_cursor(s->conn, s->cursor_resize_bottom_right);
 }
 
+#define FRAME_EVENT_MASK                                                                                   \
+    (XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY | XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_POINTER_MOTION | \
+     XCB_EVENT_MASK_ENTER_WINDOW | XCB_EVENT_MASK_LEAVE_WINDOW)
+
+// Inactive title color until the first paint
+#define FRAME_INITIAL_BACK_PIXEL 0x333333u
+
+static xcb_window_t frame_create_window(server_t* s, int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    // Root visual/depth for frames avoids visual-specific artifacts in clients (e.g., video players)
+    uint32_t values[2] = {FRAME_INITIAL_BACK_PIXEL, FRAME_EVENT_MASK};
+    xcb_window_t frame = xcb_generate_id(s->conn);
+    xcb_create_window(s->conn, s->root_depth, frame, s->root, x, y, w ? w : 1, h ? h : 1, 0,
+                      XCB_WINDOW_CLASS_INPUT_OUTPUT, s->root_visual, XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK, values);
+    return frame;
+}
+
+void frame_pool_init(server_t* s) {
+    frame_pool_t* pool = &s->frame_pool;
+    memset(pool, 0, sizeof(*pool));
+    pool->enabled = true;
+
+    for (uint32_t i = 0; i < FRAME_POOL_PREFILL; i++) {
+        frame_pool_entry_t* e = &pool->entries[pool->len++];
+        e->frame = frame_create_window(s, 0, 0, 1, 1);
+        render_init(&e->render_ctx);
+        // Never mapped and never seen by a client: usable right away
+        e->sync_seq = 0;
+        e->ready_txn = 0;
+    }
+}
+
+void frame_pool_destroy(server_t* s) {
+    frame_pool_t* pool = &s->frame_pool;
+    for (uint32_t i = 0; i < pool->len; i++) {
+        if (s->conn) xcb_destroy_window(s->conn, pool->entries[i].frame);
+        render_free(&pool->entries[i].render_ctx);
+    }
+    pool->len = 0;
+    pool->enabled = false;
+}
+
+static void frame_pool_handle_sync(server_t* s, const cookie_slot_t* slot, void* reply, xcb_generic_error_t* err) {
+    (void)reply;
+    (void)err;
+
+    // Reply or timeout: either way the unmap was processed long ago
+    frame_pool_t* pool = &s->frame_pool;
+    for (uint32_t i = 0; i < pool->len; i++) {
+        frame_pool_entry_t* e = &pool->entries[i];
+        if (e->frame == (xcb_window_t)slot->data && e->sync_seq == slot->sequence) {
+            e->sync_seq = 0;
+            // Events read alongside this reply are ingested next tick; hand out the tick after
+            e->ready_txn = s->txn_id + 1;
+            return;
+        }
+    }
+}
+
+xcb_window_t frame_acquire(server_t* s, render_context_t* ctx, int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    frame_pool_t* pool = &s->frame_pool;
+
+    for (uint32_t i = pool->len; i-- > 0;) {
+        frame_pool_entry_t* e = &pool->entries[i];
+        if (e->sync_seq != 0 || s->txn_id <= e->ready_txn) continue;
+
+        xcb_window_t frame = e->frame;
+        *ctx = e->render_ctx;
+        ctx->title_valid = false;
+        pool->entries[i] = pool->entries[--pool->len];
+
+        // Undo what the previous client may have changed; geometry is up to the caller
+        uint32_t values[2] = {FRAME_INITIAL_BACK_PIXEL, XCB_NONE};
+        xcb_change_window_attributes(s->conn, frame, XCB_CW_BACK_PIXEL | XCB_CW_CURSOR, values);
+        counters.frames_recycled++;
+        return frame;
+    }
+
+    counters.frames_created++;
+    return frame_create_window(s, x, y, w, h);
+}
+
+void frame_release(server_t* s, client_hot_t* hot) {
+    frame_pool_t* pool = &s->frame_pool;
+    if (hot->frame == XCB_NONE) return;
+
+    if (!pool->enabled || pool->len >= FRAME_POOL_MAX || hot->frame_colormap_owned) {
+        xcb_destroy_window(s->conn, hot->frame);
+        return;
+    }
+
+    xcb_unmap_window(s->conn, hot->frame);
+    if (hot->window_opacity_valid) xcb_delete_property(s->conn, hot->frame, atoms._NET_WM_WINDOW_OPACITY);
+    if (hot->bypass_published) xcb_delete_property(s->conn, hot->frame, atoms._NET_WM_BYPASS_COMPOSITOR);
+
+    frame_pool_entry_t* e = &pool->entries[pool->len++];
+    e->frame = hot->frame;
+    e->render_ctx = hot->render_ctx;
+    render_init(&hot->render_ctx);
+
+    // Any reply ordered after the unmap proves the server has sent all of the frame's earlier events
+    e->sync_seq = xcb_get_input_focus(s->conn).sequence;
+    e->ready_txn = UINT64_MAX;
+    cookie_jar_push(&s->cookie_jar, e->sync_seq, COOKIE_FRAME_POOL_SYNC, HANDLE_INVALID, e->frame, s->txn_id,
+                    frame_pool_handle_sync);
+}
+
+/*
+ * frame_sync_bypass:
+ * Keep a fullscreen client eligible for unredirection.
+ *
+ * Logic:
+ * - compositors read _NET_WM_BYPASS_COMPOSITOR from the toplevel, which is our
+ *   frame: the client's value, or a rule override, is mirrored onto it
+ * - a fullscreen frame (undecorated, exactly the client's size) has no background,
+ *   so the server never paints it over the client between a configure and the
+ *   client's next frame; the normal background returns when it leaves fullscreen
+ * - a frameless client is its own toplevel: the property is the client's and is
+ *   never written, so rule overrides do not apply to it
+ */
+void frame_sync_bypass(server_t* s, client_hot_t* hot) {
+    if (hot->frame == XCB_NONE) return;
+    bool frameless = client_is_frameless(hot);
+
+    uint8_t want = hot->bypass_rule ? hot->bypass_rule : hot->bypass_compositor;
+    if (!frameless && want != hot->bypass_published) {
+        if (want) {
+            uint32_t val = want;
+            xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->frame, atoms._NET_WM_BYPASS_COMPOSITOR,
+                                XCB_ATOM_CARDINAL, 32, 1, &val);
+        } else {
+            xcb_delete_property(s->conn, hot->frame, atoms._NET_WM_BYPASS_COMPOSITOR);
+        }
+        hot->bypass_published = want;
+    }
+
+    bool bare = (hot->layer == LAYER_FULLSCREEN) && !frameless;
+    if (bare != hot->frame_bare) {
+        if (bare) {
+            uint32_t none = XCB_BACK_PIXMAP_NONE;
+            xcb_change_window_attributes(s->conn, hot->frame, XCB_CW_BACK_PIXMAP, &none);
+        } else {
+            uint32_t pixel = FRAME_INITIAL_BACK_PIXEL;
+            xcb_change_window_attributes(s->conn, hot->frame, XCB_CW_BACK_PIXEL, &pixel);
+        }
+        hot->frame_bare = bare;
+    }
+}
+
 #define BUTTON_WIDTH 16
 #define BUTTON_HEIGHT 16
 #define BUTTON_PADDING 4
@@ -115,8 +264,10 @@ void frame_flush(server_t* s, handle_t h) {
 
     if (hot->flags & CLIENT_FLAG_UNDECORATED) return;
 
-    uint32_t f_dirty = hot->dirty & (DIRTY_FRAME_ALL | DIRTY_FRAME_TITLE | DIRTY_FRAME_BUTTONS | DIRTY_FRAME_BORDER |
-                                     DIRTY_TITLE | DIRTY_FRAME_STYLE);
+    // DIRTY_TITLE is a property refetch (it may be held back by the title governor);
+    // a title that actually changed arrives here as DIRTY_FRAME_TITLE
+    uint32_t f_dirty =
+        hot->dirty & (DIRTY_FRAME_ALL | DIRTY_FRAME_TITLE | DIRTY_FRAME_BUTTONS | DIRTY_FRAME_BORDER | DIRTY_FRAME_STYLE);
 
     if (!f_dirty && !hot->frame_damage.valid) return;
 
@@ -124,6 +275,15 @@ void frame_flush(server_t* s, handle_t h) {
 
     uint16_t frame_w = hot->server.w + 2 * s->config.theme.border_width;
     uint16_t frame_h = hot->server.h + s->config.theme.title_height + s->config.theme.border_width;
+    cairo_surface_t* icon = hot->icon_surface ? hot->icon_surface : s->default_icon;
+
+    // Title-only change whose visible (ellipsized) text is what is already on screen
+    if (f_dirty == DIRTY_FRAME_TITLE && !hot->frame_damage.valid &&
+        render_title_unchanged(&hot->render_ctx, cold->title, frame_w, &s->config.theme, icon)) {
+        hot->dirty &= ~DIRTY_FRAME_TITLE;
+        counters.title_redraws_skipped++;
+        return;
+    }
 
     // Frames are always created with the root visual/depth.
     xcb_visualtype_t* visual = s->root_visual_type;
@@ -157,8 +317,7 @@ void frame_flush(server_t* s, handle_t h) {
     }
 
     render_frame(s->conn, hot->frame, visual, &hot->render_ctx, (int)s->root_depth, s->is_test, cold ? cold->title : "",
-                 active, frame_w, frame_h, &s->config.theme, hot->icon_surface ? hot->icon_surface : s->default_icon,
-                 clip_ptr);
+                 active, frame_w, frame_h, &s->config.theme, icon, clip_ptr);
 
     hot->dirty &= ~(DIRTY_FRAME_ALL | DIRTY_FRAME_TITLE | DIRTY_FRAME_BUTTONS | DIRTY_FRAME_BORDER | DIRTY_FRAME_STYLE);
     dirty_region_reset(&hot->frame_damage);
@@ -0,0 +1,235 @@
+/* src/launcher.c
+ * Pre-forked helper that starts commands on behalf of the WM
+ */
+
+#include "launcher.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "event.h"
+#include "hxm.h"
+
+extern char** environ;
+
+static void spawn_latency_record(uint64_t dt_ns) {
+    counters.spawn_latency_count++;
+    counters.spawn_latency_sum += dt_ns;
+    if (dt_ns > counters.spawn_latency_max) counters.spawn_latency_max = dt_ns;
+}
+
+/* ---------- Helper process ---------- */
+
+static pid_t launch_child(launch_kind_t kind, const char* arg, int* err) {
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+
+    // Children must not inherit the helper's ignored SIGCHLD or any blocked signals
+    sigset_t none, dfl;
+    sigemptyset(&none);
+    sigemptyset(&dfl);
+    sigaddset(&dfl, SIGCHLD);
+    sigaddset(&dfl, SIGINT);
+    sigaddset(&dfl, SIGHUP);
+    sigaddset(&dfl, SIGPIPE);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setsigdefault(&attr, &dfl);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    char* sh_args[] = {"/bin/sh", "-c", (char*)arg, NULL};
+    char* exec_args[] = {(char*)arg, NULL};
+    bool direct = (kind == LAUNCH_EXEC);
+
+    pid_t pid = 0;
+    int rc = posix_spawn(&pid, direct ? arg : "/bin/sh", NULL, &attr, direct ? exec_args : sh_args, environ);
+    posix_spawnattr_destroy(&attr);
+
+    if (rc != 0) {
+        *err = rc;
+        return -1;
+    }
+    return pid;
+}
+
+static void launcher_main(int fd) {
+    prctl(PR_SET_NAME, "hxm-launcher", 0, 0, 0);
+
+    // Children are reaped by the kernel; terminal signals meant for the WM are not ours
+    signal(SIGCHLD, SIG_IGN);
+    signal(SIGINT, SIG_IGN);
+    signal(SIGHUP, SIG_IGN);
+    signal(SIGPIPE, SIG_IGN);
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, NULL);
+
+    char buf[sizeof(launch_request_t) + LAUNCH_ARG_MAX];
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if ((size_t)n <= sizeof(launch_request_t)) continue;
+
+        launch_request_t req;
+        memcpy(&req, buf, sizeof(req));
+        buf[n - 1] = '\0';
+
+        launch_reply_t rep = {0};
+        rep.sent_ns = req.sent_ns;
+        int err = 0;
+        rep.pid = launch_child((launch_kind_t)req.kind, buf + sizeof(req), &err);
+        rep.err = err;
+        rep.spawned_ns = monotonic_time_ns();
+        (void)send(fd, &rep, sizeof(rep), MSG_NOSIGNAL);
+    }
+    _exit(0);
+}
+
+void launcher_start(launcher_t* l) {
+    memset(l, 0, sizeof(*l));
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) < 0) {
+        LOG_WARN("launcher socketpair failed: %s (spawning from the WM)", strerror(errno));
+        return;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_WARN("launcher fork failed: %s (spawning from the WM)", strerror(errno));
+        close(sv[0]);
+        close(sv[1]);
+        return;
+    }
+    if (pid == 0) {
+        close(sv[0]);
+        launcher_main(sv[1]);
+    }
+
+    close(sv[1]);
+    int flags = fcntl(sv[0], F_GETFL, 0);
+    if (flags >= 0) (void)fcntl(sv[0], F_SETFL, flags | O_NONBLOCK);
+
+    l->fd = sv[0];
+    l->pid = pid;
+    LOG_INFO("Launcher started (pid %d)", (int)pid);
+}
+
+void launcher_stop(launcher_t* l) {
+    if (l->fd > 0) close(l->fd);
+    l->fd = 0;
+    l->inflight = 0;
+}
+
+/* ---------- WM side ---------- */
+
+/* Double fork from the WM process (no helper available) */
+static void spawn_local(launch_kind_t kind, const char* arg) {
+    uint64_t start = monotonic_time_ns();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (fork() == 0) {
+            setsid();
+            sigset_t none;
+            sigemptyset(&none);
+            sigprocmask(SIG_SETMASK, &none, NULL);
+            if (kind == LAUNCH_EXEC) {
+                execl(arg, arg, (char*)NULL);
+            } else {
+                execl("/bin/sh", "sh", "-c", arg, (char*)NULL);
+            }
+            // Use _exit to avoid flushing parent stdio buffers
+            perror("spawn exec failed");
+            _exit(127);
+        }
+        _exit(0);
+    }
+    if (pid < 0) {
+        LOG_ERROR("Failed to fork for '%s': %s", arg, strerror(errno));
+        counters.spawn_failures++;
+        return;
+    }
+    // Wait for the intermediate child
+    (void)waitpid(pid, NULL, 0);
+    spawn_latency_record(monotonic_time_ns() - start);
+}
+
+void launcher_lost(server_t* s) {
+    launcher_t* l = &s->launcher;
+    if (l->fd <= 0) return;
+
+    LOG_WARN("Launcher (pid %d) went away, spawning from the WM", (int)l->pid);
+    if (s->epoll_fd > 0) (void)epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, l->fd, NULL);
+    launcher_stop(l);
+}
+
+void launcher_run(server_t* s, launch_kind_t kind, const char* arg) {
+    if (!arg) return;
+    counters.spawn_requests++;
+
+    launcher_t* l = &s->launcher;
+    size_t len = strlen(arg) + 1;
+    if (l->fd > 0 && len <= LAUNCH_ARG_MAX) {
+        launch_request_t req = {monotonic_time_ns(), (uint32_t)kind};
+        struct iovec iov[2] = {{&req, sizeof(req)}, {(void*)arg, len}};
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+
+        ssize_t n = sendmsg(l->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n == (ssize_t)(sizeof(req) + len)) {
+            l->inflight++;
+            return;
+        }
+        LOG_WARN("Launcher request failed: %s", n < 0 ? strerror(errno) : "short write");
+        if (n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) launcher_lost(s);
+    }
+
+    counters.spawn_fallbacks++;
+    spawn_local(kind, arg);
+}
+
+void launcher_spawn(server_t* s, const char* cmd) { launcher_run(s, LAUNCH_SHELL, cmd); }
+
+void launcher_handle_replies(server_t* s) {
+    launcher_t* l = &s->launcher;
+
+    while (l->fd > 0) {
+        launch_reply_t rep;
+        ssize_t n = recv(l->fd, &rep, sizeof(rep), MSG_DONTWAIT);
+        if (n == 0) {
+            launcher_lost(s);
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) launcher_lost(s);
+            return;
+        }
+        if (n != (ssize_t)sizeof(rep)) continue;
+
+        if (l->inflight) l->inflight--;
+        if (rep.pid > 0) {
+            spawn_latency_record(rep.spawned_ns - rep.sent_ns);
+        } else {
+            counters.spawn_failures++;
+            LOG_WARN("Launcher failed to spawn: %s", strerror(rep.err));
+        }
+    }
+}
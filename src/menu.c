@@ -19,7 +19,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
-#include <sys/wait.h>
 #include <unistd.h>
 #include <xcb/xcb_icccm.h>
 
@@ -472,25 +471,6 @@ void menu_handle_pointer_motion(server_t* s, int16_t x, int16_t y) {
     }
 }
 
-static void spawn(const char* cmd) {
-    pid_t p = fork();
-    if (p < 0) return;
-
-    if (p == 0) {
-        pid_t p2 = fork();
-        if (p2 < 0) _exit(1);
-        if (p2 == 0) {
-            setsid();
-            execl("/bin/sh", "sh", "-c", cmd, (char*)NULL);
-            _exit(1);
-        }
-        _exit(0);
-    }
-
-    int status = 0;
-    (void)waitpid(p, &status, 0);
-}
-
 void menu_handle_button_press(server_t* s, xcb_button_press_event_t* ev) {
     int16_t local_x = ev->root_x - s->menu.x;
     int16_t local_y = ev->root_y - s->menu.y;
@@ -578,16 +558,16 @@ static void menu_activate_selected(server_t* s) {
 
     switch (item->action) {
         case MENU_ACTION_EXEC:
-            if (item->cmd) spawn(item->cmd);
+            if (item->cmd) launcher_spawn(s, item->cmd);
             break;
         case MENU_ACTION_EXIT:
             exit(0);
             break;
         case MENU_ACTION_RESTART:
-            spawn("hxm --restart");
+            launcher_spawn(s, "hxm --restart");
             break;
         case MENU_ACTION_RELOAD:
-            spawn("hxm --reconfigure");
+            launcher_spawn(s, "hxm --reconfigure");
             break;
         case MENU_ACTION_RESTORE:
             menu_do_restore(s, item->client);
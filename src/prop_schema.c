@@ -0,0 +1,180 @@
+/* src/prop_schema.c
+ * Atom-indexed lookup and fetch helpers for the client property schema
+ */
+
+#include "prop_schema.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cookie_jar.h"
+#include "event.h"
+#include "hxm.h"
+#include "wm.h"
+#include "xcb_utils.h"
+
+// Comfortably above 2x the table size to keep probe chains short
+#define PROP_SCHEMA_INDEX_BITS 7u
+#define PROP_SCHEMA_INDEX_CAP (1u << PROP_SCHEMA_INDEX_BITS)
+
+typedef struct prop_index_slot {
+    xcb_atom_t atom;
+    uint16_t entry; /* table index + 1, 0 = empty */
+} prop_index_slot_t;
+
+static prop_index_slot_t prop_index[PROP_SCHEMA_INDEX_CAP];
+static uint32_t prop_dirty_mask;
+
+static inline size_t prop_index_home(xcb_atom_t atom) {
+    // Fibonacci hashing; interned atoms are small consecutive integers
+    return (size_t)((uint32_t)(atom * 2654435769u) >> (32u - PROP_SCHEMA_INDEX_BITS));
+}
+
+void prop_schema_index_build(void) {
+    if (prop_schema_count > PROP_SCHEMA_MAX) {
+        LOG_ERROR("prop_schema_table has %zu entries (max %u)", prop_schema_count, PROP_SCHEMA_MAX);
+        exit(1);
+    }
+
+    memset(prop_index, 0, sizeof(prop_index));
+    prop_dirty_mask = 0;
+
+    for (size_t i = 0; i < prop_schema_count; i++) {
+        const prop_schema_t* ps = &prop_schema_table[i];
+        prop_dirty_mask |= ps->dirty;
+
+        xcb_atom_t atom = *ps->atom;
+        if (atom == XCB_ATOM_NONE) continue;
+
+        size_t idx = prop_index_home(atom);
+        size_t probes = 0;
+        while (prop_index[idx].entry && prop_index[idx].atom != atom && probes < PROP_SCHEMA_INDEX_CAP) {
+            idx = (idx + 1) & (PROP_SCHEMA_INDEX_CAP - 1);
+            probes++;
+        }
+        // First entry in table order wins
+        if (prop_index[idx].entry) continue;
+
+        prop_index[idx].atom = atom;
+        prop_index[idx].entry = (uint16_t)(i + 1);
+    }
+}
+
+const prop_schema_t* prop_schema_lookup(xcb_atom_t atom) {
+    if (atom == XCB_ATOM_NONE) return NULL;
+
+    // Most PropertyNotify atoms are not in the table: a miss ends at the first empty slot
+    size_t idx = prop_index_home(atom);
+    while (prop_index[idx].entry) {
+        if (prop_index[idx].atom == atom) {
+            const prop_schema_t* ps = &prop_schema_table[prop_index[idx].entry - 1];
+            return (*ps->atom == atom) ? ps : NULL;
+        }
+        idx = (idx + 1) & (PROP_SCHEMA_INDEX_CAP - 1);
+    }
+    return NULL;
+}
+
+uint32_t prop_schema_dirty_mask(void) {
+    // Independent of atom values: computed once even if the index has not been built yet
+    if (!prop_dirty_mask) {
+        for (size_t i = 0; i < prop_schema_count; i++) prop_dirty_mask |= prop_schema_table[i].dirty;
+    }
+    return prop_dirty_mask;
+}
+
+uint32_t prop_schema_request(server_t* s, xcb_window_t win, const prop_schema_t* ps) {
+    return xcb_get_property(s->conn, 0, win, *ps->atom, *ps->type, 0, ps->max_len).sequence;
+}
+
+void prop_schema_fetch(server_t* s, handle_t h, client_hot_t* hot, const prop_schema_t* ps) {
+    uint32_t c = prop_schema_request(s, hot->xid, ps);
+    cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h, prop_schema_cookie_data(hot->xid, *ps->atom), s->txn_id,
+                    wm_handle_reply);
+    prop_schema_note_request(hot, server_ccold(s, h), ps);
+}
+
+void prop_schema_note_request(client_hot_t* hot, client_cold_t* cold, const prop_schema_t* ps) {
+    hot->prop_inflight |= prop_schema_bit(ps);
+    if (!cold) return;
+    uint16_t* n = &cold->prop_fetches[ps - prop_schema_table];
+    if (*n < UINT16_MAX) (*n)++;
+}
+
+void prop_schema_note_reply(client_hot_t* hot, client_cold_t* cold, const prop_schema_t* ps) {
+    uint16_t* n = cold ? &cold->prop_fetches[ps - prop_schema_table] : NULL;
+    if (n && *n > 0) (*n)--;
+    // Replies arrive in request order: the last one carries the newest value
+    if (!n || *n == 0) hot->prop_inflight &= ~prop_schema_bit(ps);
+}
+
+void prop_schema_refetch(server_t* s, handle_t h, client_hot_t* hot, uint32_t dirty) {
+    for (size_t i = 0; i < prop_schema_count; i++) {
+        const prop_schema_t* ps = &prop_schema_table[i];
+        if ((ps->dirty & dirty) && *ps->atom != XCB_ATOM_NONE) prop_schema_fetch(s, h, hot, ps);
+    }
+}
+
+void prop_schema_note_change(client_hot_t* hot, const prop_schema_t* ps, bool deleted) {
+    uint64_t bit = prop_schema_bit(ps);
+    if (deleted) {
+        hot->prop_deleted |= bit;
+        hot->prop_refetch &= ~bit;
+    } else {
+        hot->prop_refetch |= bit;
+        hot->prop_deleted &= ~bit;
+    }
+}
+
+void prop_schema_apply_deleted(server_t* s, handle_t h, const prop_schema_t* ps) {
+    client_hot_t* hot = server_chot(s, h);
+    client_cold_t* cold = server_ccold(s, h);
+    if (!hot || !cold || !ps->parse) return;
+
+    // Same shape as a GetProperty reply for a missing property (type None, no data)
+    xcb_get_property_reply_t empty;
+    memset(&empty, 0, sizeof(empty));
+    empty.response_type = XCB_GET_PROPERTY;
+
+    prop_ctx_t ctx = {s, h, hot, cold, *ps->atom};
+    if (ps->parse(&ctx, &empty)) hot->dirty |= DIRTY_FRAME_STYLE;
+}
+
+void prop_schema_commit(server_t* s, handle_t h, client_hot_t* hot, uint32_t dirty) {
+    uint64_t recorded = hot->prop_refetch | hot->prop_deleted;
+    uint32_t targeted = 0;
+    for (size_t i = 0; i < prop_schema_count; i++) {
+        if (recorded & (1ull << i)) targeted |= prop_schema_table[i].dirty;
+    }
+
+    uint64_t done = 0;
+    for (size_t i = 0; i < prop_schema_count; i++) {
+        const prop_schema_t* ps = &prop_schema_table[i];
+        if (!(ps->dirty & dirty)) continue;
+
+        uint64_t bit = 1ull << i;
+        done |= bit;
+        if (*ps->atom == XCB_ATOM_NONE) continue;
+
+        if (hot->prop_deleted & bit) {
+            // An older fetch still in flight would land after us with the stale value;
+            // let a fresh request (ordered after the delete) settle it instead
+            if (hot->prop_inflight & bit) {
+                prop_schema_fetch(s, h, hot, ps);
+            } else {
+                prop_schema_apply_deleted(s, h, ps);
+            }
+        } else if (hot->prop_refetch & bit) {
+            prop_schema_fetch(s, h, hot, ps);
+        } else if (!(ps->dirty & targeted)) {
+            // Group raised directly (no PropertyNotify recorded): refetch all of it
+            prop_schema_fetch(s, h, hot, ps);
+        }
+    }
+
+    // Entries of groups not raised this time (e.g. held back by the title governor) stay recorded
+    hot->prop_refetch &= ~done;
+    hot->prop_deleted &= ~done;
+}
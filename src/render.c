@@ -114,6 +114,9 @@ void render_init(render_context_t* ctx) {
     ctx->layout = NULL;
     ctx->width = 0;
     ctx->height = 0;
+    ctx->title_visible = NULL;
+    ctx->title_visible_len = 0;
+    ctx->title_valid = false;
 }
 
 void render_free(render_context_t* ctx) {
@@ -129,6 +132,10 @@ void render_free(render_context_t* ctx) {
         cairo_surface_destroy(ctx->surface);
         ctx->surface = NULL;
     }
+    free(ctx->title_visible);
+    ctx->title_visible = NULL;
+    ctx->title_visible_len = 0;
+    ctx->title_valid = false;
     ctx->width = 0;
     ctx->height = 0;
 }
@@ -148,6 +155,100 @@ static void ensure_layout(render_context_t* ctx) {
     pango_font_description_free(desc);
 }
 
+/* Title text box: after the icon, up to the leftmost button */
+static void title_text_box(const theme_t* theme, int w, cairo_surface_t* icon, int* x_out, int* width_out) {
+    int title_h = (int)theme->title_height;
+    int border_w = (int)theme->border_width;
+    int x = border_w + 6;
+
+    if (icon) {
+        int icon_w = cairo_image_surface_get_width(icon);
+        int icon_h = cairo_image_surface_get_height(icon);
+        double target_size = title_h - 4;
+        if (target_size > 16) target_size = 16;
+        if (target_size < 8) target_size = 8;
+        double scale = target_size / ((icon_w > icon_h) ? icon_w : icon_h);
+        x += (int)(icon_w * scale) + 6;
+    }
+
+    int btn_size = 16;
+    int btn_pad = 4;
+    int total_button_width = 3 * btn_size + 4 * btn_pad;
+    int leftmost_button_x = w - border_w - total_button_width;
+    // Ensure leftmost button stays within frame
+    if (leftmost_button_x < border_w) {
+        leftmost_button_x = border_w;
+    }
+    // Available width for title text: from x to leftmost_button_x minus padding
+    int width = leftmost_button_x - x - btn_pad;
+    if (width < 0) width = 0;
+
+    *x_out = x;
+    *width_out = width;
+}
+
+static void title_layout_set(render_context_t* ctx, const char* title, int width) {
+    pango_layout_set_text(ctx->layout, title, -1);
+    pango_layout_set_width(ctx->layout, width * PANGO_SCALE);
+    pango_layout_set_ellipsize(ctx->layout, PANGO_ELLIPSIZE_END);
+}
+
+/* Bytes of the laid-out title that stay visible (the whole text unless ellipsized) */
+static size_t title_visible_len(PangoLayout* layout, size_t len) {
+    if (!pango_layout_is_ellipsized(layout)) return len;
+
+    PangoLayoutLine* line = pango_layout_get_line_readonly(layout, 0);
+    size_t end = 0;
+    for (GSList* l = line ? line->runs : NULL; l; l = l->next) {
+        const PangoGlyphItem* run = l->data;
+        if (run->item->analysis.flags & PANGO_ANALYSIS_FLAG_IS_ELLIPSIS) continue;
+        size_t run_end = (size_t)run->item->offset + (size_t)run->item->length;
+        if (run_end > end) end = run_end;
+    }
+    return end;
+}
+
+static void title_remember(render_context_t* ctx, const char* title, size_t vis_len, int x, int width) {
+    if (vis_len > ctx->title_visible_len || !ctx->title_visible) {
+        char* buf = realloc(ctx->title_visible, vis_len + 1);
+        if (!buf) {
+            ctx->title_valid = false;
+            return;
+        }
+        ctx->title_visible = buf;
+    }
+    memcpy(ctx->title_visible, title, vis_len);
+    ctx->title_visible[vis_len] = '\0';
+    ctx->title_visible_len = vis_len;
+    ctx->title_x = x;
+    ctx->title_width = width;
+    ctx->title_valid = true;
+}
+
+bool render_title_unchanged(render_context_t* ctx, const char* title, int width, const theme_t* theme,
+                            cairo_surface_t* icon) {
+    if (!ctx->title_valid) return false;
+
+    int x = 0, text_w = 0;
+    title_text_box(theme, width, icon, &x, &text_w);
+    if (x != ctx->title_x || text_w != ctx->title_width) return false;
+
+    if (!title) title = "";
+    size_t len = strlen(title);
+    size_t vis_len = 0;
+    if (len > 0) {
+        // Cheap reject before shaping: the visible prefix can't match if it differs
+        size_t cmp = len < ctx->title_visible_len ? len : ctx->title_visible_len;
+        if (memcmp(title, ctx->title_visible, cmp) != 0) return false;
+
+        ensure_layout(ctx);
+        title_layout_set(ctx, title, text_w);
+        vis_len = title_visible_len(ctx->layout, len);
+    }
+
+    return vis_len == ctx->title_visible_len && memcmp(title, ctx->title_visible, vis_len) == 0;
+}
+
 static void draw_button(cairo_t* cr, int x, int y, int w, int h, const char* type, rgba_t color) {
     cairo_set_source_rgba(cr, color.r, color.g, color.b, color.a);
     cairo_set_line_width(cr, 1.0);
@@ -284,7 +385,9 @@ void render_frame(xcb_connection_t* conn, xcb_window_t win, xcb_visualtype_t* vi
         cairo_restore(cr);
     }
 
-    int title_x_offset = border_w + 6;
+    int title_x_offset = 0;
+    int title_text_width = 0;
+    title_text_box(theme, w, icon, &title_x_offset, &title_text_width);
 
     // 2. Draw Icon
     if (icon) {
@@ -294,37 +397,22 @@ void render_frame(xcb_connection_t* conn, xcb_window_t win, xcb_visualtype_t* vi
         if (target_size > 16) target_size = 16;
         if (target_size < 8) target_size = 8;
         double scale = target_size / ((icon_w > icon_h) ? icon_w : icon_h);
-        double draw_w = icon_w * scale;
         double draw_h = icon_h * scale;
         double icon_y = (title_h - draw_h) / 2.0;
         cairo_save(cr);
-        cairo_translate(cr, title_x_offset, icon_y);
+        cairo_translate(cr, border_w + 6, icon_y);
         cairo_scale(cr, scale, scale);
         cairo_set_source_surface(cr, icon, 0, 0);
         cairo_paint(cr);
         cairo_restore(cr);
-        title_x_offset += (int)draw_w + 6;
     }
 
-    // Button dimensions (used for title text clipping)
-    int btn_size = 16;
-    int btn_pad = 4;
-    int total_button_width = 3 * btn_size + 4 * btn_pad;
-    int leftmost_button_x = w - border_w - total_button_width;
-    // Ensure leftmost button stays within frame
-    if (leftmost_button_x < border_w) {
-        leftmost_button_x = border_w;
-    }
-    // Available width for title text: from title_x_offset to leftmost_button_x minus padding
-    int title_text_width = leftmost_button_x - title_x_offset - btn_pad;
-    if (title_text_width < 0) title_text_width = 0;
-
     // 3. Draw Title Text
+    size_t title_vis_len = 0;
     if (title && title[0] != '\0') {
         cairo_set_source_rgba(cr, text.r, text.g, text.b, text.a);
-        pango_layout_set_text(ctx->layout, title, -1);
-        pango_layout_set_width(ctx->layout, title_text_width * PANGO_SCALE);
-        pango_layout_set_ellipsize(ctx->layout, PANGO_ELLIPSIZE_END);
+        title_layout_set(ctx, title, title_text_width);
+        title_vis_len = title_visible_len(ctx->layout, strlen(title));
         int text_h;
         pango_layout_get_pixel_size(ctx->layout, NULL, &text_h);
         double text_y = (title_h - text_h) / 2.0;
@@ -333,6 +421,16 @@ void render_frame(xcb_connection_t* conn, xcb_window_t win, xcb_visualtype_t* vi
         pango_cairo_show_layout(cr, ctx->layout);
     }
 
+    // Remember what the title box shows, but only if this pass repainted all of it
+    bool title_box_painted = !dirty || !dirty->valid ||
+                             (dirty->x <= title_x_offset && dirty->y <= 0 &&
+                              dirty->x + dirty->w >= title_x_offset + title_text_width && dirty->y + dirty->h >= title_h);
+    if (title_box_painted) {
+        title_remember(ctx, title ? title : "", title_vis_len, title_x_offset, title_text_width);
+    } else {
+        ctx->title_valid = false;
+    }
+
     // 4. Draw Borders
     cairo_set_source_rgba(cr, border.r, border.g, border.b, border.a);
     cairo_set_line_width(cr, (double)border_w);
@@ -353,7 +451,8 @@ void render_frame(xcb_connection_t* conn, xcb_window_t win, xcb_visualtype_t* vi
     cairo_stroke(cr);
 
     // 6. Draw Buttons
-    // btn_size and btn_pad already defined above
+    int btn_size = 16;
+    int btn_pad = 4;
     int btn_y = (title_h - btn_size) / 2;
     int btn_x = w - border_w - btn_pad - btn_size;
     // Ensure buttons stay within frame
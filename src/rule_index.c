@@ -0,0 +1,261 @@
+/* src/rule_index.c
+ * Hash and Aho-Corasick index over the application rules
+ */
+
+#include "rule_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "hxm.h"
+
+static uint32_t rule_index_generation;
+
+static void* rule_index_calloc(size_t n, size_t size) {
+    void* p = calloc(n ? n : 1, size);
+    if (!p) {
+        LOG_ERROR("rule index allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+// FNV-1a; 0 is reserved by hash_map_t
+static uint64_t rule_string_key(const char* str) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (const unsigned char* p = (const unsigned char*)str; *p; p++) {
+        h ^= *p;
+        h *= 0x100000001b3ull;
+    }
+    return h ? h : 1;
+}
+
+void rule_index_init(rule_index_t* idx) {
+    memset(idx, 0, sizeof(*idx));
+    hash_map_init(&idx->by_class);
+    hash_map_init(&idx->by_instance);
+}
+
+static void rule_index_release(rule_index_t* idx) {
+    hash_map_destroy(&idx->by_class);
+    hash_map_destroy(&idx->by_instance);
+    free(idx->anchor_next);
+    free(idx->always);
+    free(idx->ac);
+    free(idx->title_next);
+    free(idx->seen);
+    free(idx->hits);
+}
+
+void rule_index_destroy(rule_index_t* idx) {
+    rule_index_release(idx);
+    rule_index_init(idx);
+}
+
+static void rule_anchor_push(rule_index_t* idx, hash_map_t* map, const char* key, uint32_t rule) {
+    uint64_t k = rule_string_key(key);
+    idx->anchor_next[rule] = (uint32_t)(uintptr_t)hash_map_get(map, k);
+    hash_map_insert(map, k, (void*)(uintptr_t)(rule + 1));
+}
+
+static uint32_t ac_child(const rule_index_t* idx, uint32_t node, uint8_t byte) {
+    if (node == 0) return idx->ac_root[byte];
+    for (uint32_t c = idx->ac[node].child; c; c = idx->ac[c].sibling) {
+        if (idx->ac[c].byte == byte) return c;
+    }
+    return 0;
+}
+
+static uint32_t ac_insert(rule_index_t* idx, const char* pattern) {
+    uint32_t node = 0;
+    for (const unsigned char* p = (const unsigned char*)pattern; *p; p++) {
+        uint32_t next = ac_child(idx, node, *p);
+        if (!next) {
+            if (idx->ac_len == idx->ac_cap) {
+                uint32_t cap = idx->ac_cap * 2;
+                rule_ac_node_t* grown = realloc(idx->ac, (size_t)cap * sizeof(*grown));
+                if (!grown) {
+                    LOG_ERROR("rule index allocation failed");
+                    exit(1);
+                }
+                idx->ac = grown;
+                idx->ac_cap = cap;
+            }
+            next = idx->ac_len++;
+            memset(&idx->ac[next], 0, sizeof(idx->ac[next]));
+            idx->ac[next].byte = *p;
+            if (node == 0) {
+                idx->ac_root[*p] = next;
+            } else {
+                idx->ac[next].sibling = idx->ac[node].child;
+                idx->ac[node].child = next;
+            }
+        }
+        node = next;
+    }
+    return node;
+}
+
+/*
+ * ac_link:
+ * Compute fail and dictionary links breadth-first.
+ *
+ * Logic:
+ * - depth-1 nodes fail to the root
+ * - a node's fail target is found by following its parent's fail chain until
+ *   some state has a child on the same byte
+ * - dict skips fail states that end no pattern, so reporting matches at a
+ *   position only visits states that have rules
+ */
+static void ac_link(rule_index_t* idx) {
+    uint32_t* queue = rule_index_calloc(idx->ac_len, sizeof(*queue));
+    uint32_t head = 0, tail = 0;
+
+    for (uint32_t b = 0; b < 256; b++) {
+        uint32_t c = idx->ac_root[b];
+        if (!c) continue;
+        idx->ac[c].fail = 0;
+        idx->ac[c].dict = 0;
+        queue[tail++] = c;
+    }
+
+    while (head < tail) {
+        uint32_t u = queue[head++];
+        for (uint32_t v = idx->ac[u].child; v; v = idx->ac[v].sibling) {
+            uint8_t byte = idx->ac[v].byte;
+            uint32_t f = idx->ac[u].fail;
+            while (f && !ac_child(idx, f, byte)) f = idx->ac[f].fail;
+            uint32_t target = ac_child(idx, f, byte);
+            idx->ac[v].fail = (target != v) ? target : 0;
+
+            uint32_t fv = idx->ac[v].fail;
+            idx->ac[v].dict = idx->ac[fv].rules ? fv : idx->ac[fv].dict;
+            queue[tail++] = v;
+        }
+    }
+    free(queue);
+}
+
+void rule_index_build(rule_index_t* idx, const small_vec_t* rules, uint32_t version) {
+    rule_index_release(idx);
+    rule_index_init(idx);
+    // Global so an index from a reloaded config never reuses a generation clients still hold
+    if (++rule_index_generation == 0) rule_index_generation = 1;
+    idx->generation = rule_index_generation;
+
+    uint32_t n = (uint32_t)rules->length;
+    idx->rule_count = n;
+    idx->rules_version = version;
+    idx->anchor_next = rule_index_calloc(n, sizeof(*idx->anchor_next));
+    idx->title_next = rule_index_calloc(n, sizeof(*idx->title_next));
+    idx->always = rule_index_calloc(n, sizeof(*idx->always));
+    idx->seen = rule_index_calloc(n, sizeof(*idx->seen));
+    idx->hits = rule_index_calloc(n, sizeof(*idx->hits));
+
+    idx->ac_cap = 64;
+    idx->ac = rule_index_calloc(idx->ac_cap, sizeof(*idx->ac));
+    idx->ac_len = 1;
+
+    uint32_t titles = 0;
+    // Chain order is irrelevant: queries sort their hits back into config order
+    for (uint32_t i = 0; i < n; i++) {
+        const app_rule_t* r = rules->items[i];
+        if (!r) continue;
+
+        if (r->class_match) {
+            rule_anchor_push(idx, &idx->by_class, r->class_match, i);
+        } else if (r->instance_match) {
+            rule_anchor_push(idx, &idx->by_instance, r->instance_match, i);
+        } else if (!r->title_match) {
+            idx->always[idx->always_len++] = i;
+        }
+
+        if (r->title_match) {
+            uint32_t node = ac_insert(idx, r->title_match);
+            idx->title_next[i] = idx->ac[node].rules;
+            idx->ac[node].rules = i + 1;
+            titles++;
+        }
+    }
+
+    ac_link(idx);
+    idx->built = true;
+
+    LOG_DEBUG("Compiled %u rules: %zu class keys, %zu instance keys, %u title patterns (%u states), %u unanchored",
+              n, hash_map_size(&idx->by_class), hash_map_size(&idx->by_instance), titles, idx->ac_len,
+              idx->always_len);
+}
+
+void rule_index_sync(rule_index_t* idx, const small_vec_t* rules, uint32_t version) {
+    if (!idx->built || idx->rules_version != version) rule_index_build(idx, rules, version);
+}
+
+static void rule_index_begin(rule_index_t* idx) {
+    idx->hits_len = 0;
+    if (++idx->stamp == 0) {
+        // Wrapped: old stamps could alias the new one
+        memset(idx->seen, 0, (size_t)idx->rule_count * sizeof(*idx->seen));
+        idx->stamp = 1;
+    }
+}
+
+static inline void rule_index_hit(rule_index_t* idx, uint32_t rule) {
+    if (idx->seen[rule] == idx->stamp) return;
+    idx->seen[rule] = idx->stamp;
+    idx->hits[idx->hits_len++] = rule;
+}
+
+static void rule_index_hit_chain(rule_index_t* idx, uint32_t head, const uint32_t* next) {
+    for (uint32_t r = head; r; r = next[r - 1]) rule_index_hit(idx, r - 1);
+}
+
+static void rule_index_scan_title(rule_index_t* idx, const char* title) {
+    // An empty pattern ends at the root and occurs in every title
+    rule_index_hit_chain(idx, idx->ac[0].rules, idx->title_next);
+
+    uint32_t state = 0;
+    for (const unsigned char* p = (const unsigned char*)title; *p; p++) {
+        while (state && !ac_child(idx, state, *p)) state = idx->ac[state].fail;
+        state = ac_child(idx, state, *p);
+
+        uint32_t out = idx->ac[state].rules ? state : idx->ac[state].dict;
+        for (; out; out = idx->ac[out].dict) rule_index_hit_chain(idx, idx->ac[out].rules, idx->title_next);
+    }
+}
+
+static int rule_index_cmp(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t rule_index_finish(rule_index_t* idx, uint32_t** out) {
+    if (idx->hits_len > 1) qsort(idx->hits, idx->hits_len, sizeof(*idx->hits), rule_index_cmp);
+    *out = idx->hits;
+    return idx->hits_len;
+}
+
+uint32_t rule_index_query(rule_index_t* idx, const char* wm_class, const char* wm_instance, const char* title,
+                          uint32_t** out) {
+    rule_index_begin(idx);
+
+    if (wm_class) {
+        uint32_t head = (uint32_t)(uintptr_t)hash_map_get(&idx->by_class, rule_string_key(wm_class));
+        rule_index_hit_chain(idx, head, idx->anchor_next);
+    }
+    if (wm_instance) {
+        uint32_t head = (uint32_t)(uintptr_t)hash_map_get(&idx->by_instance, rule_string_key(wm_instance));
+        rule_index_hit_chain(idx, head, idx->anchor_next);
+    }
+    if (title) rule_index_scan_title(idx, title);
+    for (uint32_t i = 0; i < idx->always_len; i++) rule_index_hit(idx, idx->always[i]);
+
+    return rule_index_finish(idx, out);
+}
+
+uint32_t rule_index_query_title(rule_index_t* idx, const char* title, uint32_t** out) {
+    rule_index_begin(idx);
+    if (title) rule_index_scan_title(idx, title);
+    return rule_index_finish(idx, out);
+}
@@ -3,10 +3,15 @@
  *
  * Model:
  *  - Layered Stacking: Windows are grouped into semantic layers (Desktop, Below, Normal, Above, Fullscreen, etc).
- *  - Internal Authority: The `s->layers` vectors are the single source of truth for stacking order.
+ *  - Internal Authority: The `s->layers` lists are the single source of truth for stacking order.
+ *  - Intrusive Order List: Each layer links its clients through `stack_below`/`stack_above`, so raise,
+ *    lower and place-above/below are pointer splices with no shifting or renumbering.
+ *  - Order Labels: `stack_label` increases bottom -> top within a layer, answering "is A above B"
+ *    in O(1). New labels bisect the gap to the neighbour; an exhausted gap relabels the layer.
  *  - Deferred Synchronization: Changes to the internal list mark clients as `DIRTY_STACK`.
- *    The actual X11 `ConfigureWindow` requests are issued in `stack_sync_to_xcb` during the flush phase,
- *    preventing "fighting" with the X server and reducing round-trips.
+ *    The actual X11 `ConfigureWindow` requests are issued in `stack_commit` during the flush phase,
+ *    which diffs against the last committed order, preventing "fighting" with the X server and
+ *    restacking only the frames that moved.
  */
 #include <assert.h>
 #include <stddef.h>
@@ -17,11 +22,16 @@
 #include "event.h"
 #include "hxm.h"
 #include "wm.h"
+#include "wm_internal.h"
+
+/* Spacing of freshly assigned labels; leaves 32 bisections between neighbours */
+#define STACK_LABEL_STEP (1ull << 32)
+#define STACK_LABEL_MID (1ull << 63)
 
 /* Forward */
 static void stack_restack(server_t* s, handle_t h);
 
-static inline small_vec_t* layer_vec(server_t* s, int layer) {
+static inline stack_layer_t* layer_vec(server_t* s, int layer) {
     if (!s || layer < 0 || layer >= LAYER_COUNT) return NULL;
     return &s->layers[layer];
 }
@@ -32,60 +42,85 @@ static inline int stack_current_layer(const client_hot_t* c) {
     return (c->stacking_layer >= 0) ? (int)c->stacking_layer : (int)c->layer;
 }
 
-static int32_t stack_find_index(const small_vec_t* v, handle_t h) {
-    if (!v) return -1;
-    for (size_t i = 0; i < v->length; i++) {
-        if (ptr_to_handle(v->items[i]) == h) return (int32_t)i;
+/* Spread labels evenly around the middle of the range (amortized: only when a gap runs out) */
+static void stack_relabel(stack_layer_t* v) {
+    uint64_t label = STACK_LABEL_MID - (uint64_t)(v->length / 2) * STACK_LABEL_STEP;
+    for (client_hot_t* c = v->bottom; c; c = c->stack_above) {
+        c->stack_label = label;
+        label += STACK_LABEL_STEP;
     }
-    return -1;
+    counters.stack_relabels++;
 }
 
-static void stack_update_indices(server_t* s, const small_vec_t* v, size_t start) {
-    for (size_t i = start; i < v->length; i++) {
-        handle_t h = ptr_to_handle(v->items[i]);
-        client_hot_t* hot = server_chot(s, h);
-        if (hot) hot->stacking_index = (int32_t)i;
+/* Splice c between below and above (either may be NULL at the ends) */
+static void stack_link(stack_layer_t* v, client_hot_t* c, client_hot_t* below, client_hot_t* above) {
+    c->stack_below = below;
+    c->stack_above = above;
+    if (below) {
+        below->stack_above = c;
+    } else {
+        v->bottom = c;
     }
-}
+    if (above) {
+        above->stack_below = c;
+    } else {
+        v->top = c;
+    }
+    v->length++;
 
-static void stack_vec_insert(server_t* s, small_vec_t* v, size_t idx, handle_t h) {
-    if (!v) return;
-    if (idx > v->length) idx = v->length;
-    small_vec_push(v, NULL);
-    if (idx + 1 < v->length) {
-        memmove(&v->items[idx + 1], &v->items[idx], (v->length - 1 - idx) * sizeof(void*));
+    if (!below && !above) {
+        c->stack_label = STACK_LABEL_MID;
+    } else if (!below) {
+        if (above->stack_label > STACK_LABEL_STEP) {
+            c->stack_label = above->stack_label - STACK_LABEL_STEP;
+        } else {
+            stack_relabel(v);
+        }
+    } else if (!above) {
+        if (below->stack_label < UINT64_MAX - STACK_LABEL_STEP) {
+            c->stack_label = below->stack_label + STACK_LABEL_STEP;
+        } else {
+            stack_relabel(v);
+        }
+    } else if (above->stack_label - below->stack_label > 1) {
+        c->stack_label = below->stack_label + (above->stack_label - below->stack_label) / 2;
+    } else {
+        stack_relabel(v);
     }
-    v->items[idx] = handle_to_ptr(h);
-    stack_update_indices(s, v, idx);
 }
 
-static bool stack_vec_remove(server_t* s, small_vec_t* v, size_t idx) {
-    if (!v || idx >= v->length) return false;
-    if (idx + 1 < v->length) {
-        memmove(&v->items[idx], &v->items[idx + 1], (v->length - idx - 1) * sizeof(void*));
+static void stack_unlink(stack_layer_t* v, client_hot_t* c) {
+    if (c->stack_below) {
+        c->stack_below->stack_above = c->stack_above;
+    } else {
+        v->bottom = c->stack_above;
     }
-    v->length--;
-    if (idx < v->length) {
-        stack_update_indices(s, v, idx);
+    if (c->stack_above) {
+        c->stack_above->stack_below = c->stack_below;
+    } else {
+        v->top = c->stack_below;
     }
-    return true;
+    c->stack_below = NULL;
+    c->stack_above = NULL;
+    v->length--;
 }
 
-#include "hxm.h"
-#include "wm.h"
-#include "wm_internal.h"
+bool stack_is_above(const client_hot_t* a, const client_hot_t* b) {
+    if (!a || !b || a == b) return false;
+    if (a->stacking_layer < 0 || a->stacking_layer != b->stacking_layer) return false;
+    return a->stack_label > b->stack_label;
+}
 
 #ifdef HXM_ENABLE_DEBUG_LOGGING
 static void debug_dump_layer(const server_t* s, layer_t l, const char* tag) {
     if (!s) return;
-    const small_vec_t* v = &s->layers[l];
-    LOG_DEBUG("stack %s layer=%d count=%zu", tag, l, v->length);
-
-    for (size_t i = 0; i < v->length && i < 64; i++) {
-        handle_t h = ptr_to_handle(v->items[i]);
-        const client_hot_t* c = server_chot((server_t*)s, h);
-        if (!c) continue;
-        LOG_DEBUG("  [%zu] h=%lx xid=%u frame=%u", i, c->self, c->xid, c->frame);
+    const stack_layer_t* v = &s->layers[l];
+    LOG_DEBUG("stack %s layer=%d count=%u", tag, l, v->length);
+
+    uint32_t i = 0;
+    for (const client_hot_t* c = v->bottom; c && i < 64; c = c->stack_above, i++) {
+        LOG_DEBUG("  [%u] h=%lx xid=%u frame=%u label=%llx", i, c->self, c->xid, c->frame,
+                  (unsigned long long)c->stack_label);
     }
 
     if (v->length > 64) {
@@ -100,46 +135,41 @@ void stack_remove(server_t* s, handle_t h) {
     client_hot_t* c = server_chot(s, h);
     if (!c) return;
 
-    /* Safety check: if client thinks it is not in any layer, don't try to remove. */
-    if (c->stacking_layer < 0 && c->stacking_index < 0) return;
+    /* Safety check: if client is not linked into any layer, don't try to remove. */
+    if (c->stacking_layer < 0) return;
 
-    int layer = stack_current_layer(c);
-    small_vec_t* v = layer_vec(s, layer);
+    int layer = c->stacking_layer;
+    stack_layer_t* v = layer_vec(s, layer);
     if (!v || v->length == 0) return;
 
-    int32_t idx = c->stacking_index;
-    if (idx < 0 || (size_t)idx >= v->length || ptr_to_handle(v->items[idx]) != h) {
-        idx = stack_find_index(v, h);
-        if (idx < 0) return;
-    }
-
-    TRACE_LOG("stack_remove h=%lx layer=%d index=%d", h, layer, idx);
+    TRACE_LOG("stack_remove h=%lx layer=%d", h, layer);
     TRACE_ONLY(debug_dump_layer(s, layer, "before remove"));
 
-    stack_vec_remove(s, v, (size_t)idx);
-    c->stacking_index = -1;
+    stack_unlink(v, c);
     c->stacking_layer = -1;
 
     mark_stacking_dirty(s);
     TRACE_ONLY(debug_dump_layer(s, layer, "after remove"));
 }
 
-static void stack_insert_top(server_t* s, client_hot_t* c, int layer) {
-    small_vec_t* v = layer_vec(s, layer);
+static void stack_insert(server_t* s, client_hot_t* c, int layer, client_hot_t* below, client_hot_t* above) {
+    stack_layer_t* v = layer_vec(s, layer);
     if (!v) return;
-    stack_vec_insert(s, v, v->length, c->self);
+    stack_link(v, c, below, above);
     c->stacking_layer = (int8_t)layer;
-    c->stacking_index = (int32_t)(v->length - 1);
     mark_stacking_dirty(s);
 }
 
+static void stack_insert_top(server_t* s, client_hot_t* c, int layer) {
+    stack_layer_t* v = layer_vec(s, layer);
+    if (!v) return;
+    stack_insert(s, c, layer, v->top, NULL);
+}
+
 static void stack_insert_bottom(server_t* s, client_hot_t* c, int layer) {
-    small_vec_t* v = layer_vec(s, layer);
+    stack_layer_t* v = layer_vec(s, layer);
     if (!v) return;
-    stack_vec_insert(s, v, 0, c->self);
-    c->stacking_layer = (int8_t)layer;
-    c->stacking_index = 0;
-    mark_stacking_dirty(s);
+    stack_insert(s, c, layer, NULL, v->bottom);
 }
 
 void stack_raise(server_t* s, handle_t h) {
@@ -234,24 +264,13 @@ void stack_place_above(server_t* s, handle_t h, handle_t sibling_h) {
 
     stack_remove(s, h);
 
-    small_vec_t* v = layer_vec(s, layer);
-    if (!v) return; /* Should be covered by stack_remove or earlier logic, but for safety */
-
-    int32_t sib_idx = sib->stacking_index;
-    if (sib_idx < 0 || (size_t)sib_idx >= v->length || ptr_to_handle(v->items[sib_idx]) != sibling_h) {
-        sib_idx = stack_find_index(v, sibling_h);
-        if (sib_idx < 0) {
-            stack_raise(s, h);
-            return;
-        }
+    /* Sibling not linked (or the window itself) */
+    if (sib->stacking_layer != layer) {
+        stack_raise(s, h);
+        return;
     }
 
-    /* Insert after sibling */
-    size_t new_idx = (size_t)sib_idx + 1;
-    stack_vec_insert(s, v, new_idx, h);
-    c->stacking_layer = (int8_t)layer;
-    c->stacking_index = (int32_t)new_idx;
-    mark_stacking_dirty(s);
+    stack_insert(s, c, layer, sib, sib->stack_above);
     TRACE_ONLY(debug_dump_layer(s, layer, "after place_above"));
 
     stack_restack(s, h);
@@ -275,140 +294,151 @@ void stack_place_below(server_t* s, handle_t h, handle_t sibling_h) {
 
     stack_remove(s, h);
 
-    small_vec_t* v = layer_vec(s, layer);
-    if (!v) return;
-
-    int32_t sib_idx = sib->stacking_index;
-    if (sib_idx < 0 || (size_t)sib_idx >= v->length || ptr_to_handle(v->items[sib_idx]) != sibling_h) {
-        sib_idx = stack_find_index(v, sibling_h);
-        if (sib_idx < 0) {
-            stack_lower(s, h);
-            return;
-        }
+    if (sib->stacking_layer != layer) {
+        stack_lower(s, h);
+        return;
     }
 
-    /* Insert before sibling */
-    size_t new_idx = (size_t)sib_idx;
-    stack_vec_insert(s, v, new_idx, h);
-    c->stacking_layer = (int8_t)layer;
-    c->stacking_index = (int32_t)new_idx;
-    mark_stacking_dirty(s);
+    stack_insert(s, c, layer, sib->stack_below, sib);
     TRACE_ONLY(debug_dump_layer(s, layer, "after place_below"));
 
     stack_restack(s, h);
 }
 
-static xcb_window_t find_window_below(server_t* s, client_hot_t* c) {
-    /* Same layer: previous node is immediately below */
-    int layer = stack_current_layer(c);
-    small_vec_t* v = layer_vec(s, layer);
-    if (v) {
-        int32_t idx = c->stacking_index;
-        if (idx < 0 || (size_t)idx >= v->length || ptr_to_handle(v->items[idx]) != c->self) {
-            idx = stack_find_index(v, c->self);
-        }
-        if (idx > 0) {
-            handle_t below_h = ptr_to_handle(v->items[idx - 1]);
-            client_hot_t* below = server_chot(s, below_h);
-            if (below) return below->frame;
-        }
-    }
-
-    /* Lower layers: topmost of the nearest non-empty lower layer */
-    for (int l = layer - 1; l >= 0; l--) {
-        small_vec_t* lv = layer_vec(s, l);
-        if (lv && lv->length > 0) {
-            handle_t below_h = ptr_to_handle(lv->items[lv->length - 1]);
-            client_hot_t* below = server_chot(s, below_h);
-            if (below) return below->frame;
-        }
-    }
-
-    return XCB_NONE;
-}
-
-static xcb_window_t find_window_above(server_t* s, client_hot_t* c) {
-    /* Same layer: next node is immediately above */
-    int layer = stack_current_layer(c);
-    small_vec_t* v = layer_vec(s, layer);
-    if (v) {
-        int32_t idx = c->stacking_index;
-        if (idx < 0 || (size_t)idx >= v->length || ptr_to_handle(v->items[idx]) != c->self) {
-            idx = stack_find_index(v, c->self);
-        }
-        if (idx >= 0 && (size_t)(idx + 1) < v->length) {
-            handle_t above_h = ptr_to_handle(v->items[idx + 1]);
-            client_hot_t* above = server_chot(s, above_h);
-            if (above) return above->frame;
-        }
-    }
-
-    /* Higher layers: bottommost of the nearest non-empty higher layer */
-    for (int l = layer + 1; l < LAYER_COUNT; l++) {
-        small_vec_t* lv = layer_vec(s, l);
-        if (lv && lv->length > 0) {
-            handle_t above_h = ptr_to_handle(lv->items[0]);
-            client_hot_t* above = server_chot(s, above_h);
-            if (above) return above->frame;
+static void committed_stack_store(committed_stack_t* cs, const stack_entry_t* order, uint32_t n) {
+    if (n > cs->cap) {
+        uint32_t cap = cs->cap ? cs->cap : 16;
+        while (cap < n) cap *= 2;
+        stack_entry_t* items = realloc(cs->items, cap * sizeof(*items));
+        if (!items) {
+            LOG_ERROR("committed stack allocation failed");
+            exit(1);
         }
+        cs->items = items;
+        cs->cap = cap;
     }
-
-    return XCB_NONE;
+    if (n) memcpy(cs->items, order, n * sizeof(*order));
+    cs->len = n;
 }
 
 /*
- * stack_sync_to_xcb:
+ * stack_commit:
  *
- * Translates the internal stacking list position into a concrete XCB ConfigureWindow request.
+ * Brings the X server's frame stacking in line with `s->layers` using as few
+ * ConfigureWindow requests as possible.
  *
  * Strategy:
- *  - We prefer to stack "Above" the window immediately below us.
- *  - If we are at the bottom of a layer, we check lower layers for an anchor.
- *  - Using "Above sibling" is generally more stable than "Below sibling" for
- *    iterative insertions (building a stack from bottom up).
- *  - This function is only called during the flush phase, ensuring we batch
- *    restacks and avoid fighting the X server during complex operations.
+ *  - Build the new global order (bottom -> top across layers) and look up each
+ *    frame's position in the order committed last time (s->committed_stack).
+ *    Positions are keyed by slot and checked against handle and frame, so a
+ *    recycled slot or frame XID counts as new.
+ *  - Frames whose old positions form a longest increasing subsequence are
+ *    already in the right relative order and are left alone.
+ *  - Every other frame (moved or new) is stacked "Above" its new lower
+ *    neighbour. Walking bottom -> top means that anchor is already final.
+ *  - The bottom frame has no lower neighbour and goes "Below" the lowest kept
+ *    frame instead.
+ *
+ * Raising a parent with N transients over M windows therefore costs
+ * min(N + 1, M) requests instead of one per touched client.
  */
-void stack_sync_to_xcb(server_t* s, handle_t h) {
+void stack_commit(server_t* s) {
     if (!s) return;
     assert(s->in_commit_phase);
 
-    client_hot_t* c = server_chot(s, h);
-    if (!c) return;
+    size_t total = 0;
+    for (int l = 0; l < LAYER_COUNT; l++) total += s->layers[l].length;
+
+    stack_entry_t* order = total ? arena_alloc(&s->tick_arena, total * sizeof(*order)) : NULL;
+    uint32_t n = 0;
+    for (int l = 0; l < LAYER_COUNT; l++) {
+        for (const client_hot_t* c = s->layers[l].bottom; c; c = c->stack_above) {
+            if (c->frame == XCB_NONE) continue;
+            order[n].h = c->self;
+            order[n].frame = c->frame;
+            n++;
+        }
+    }
 
-    /* Prefer expressing "above the window below me"
-     * This keeps stable ordering when inserting into the middle
-     */
-    xcb_window_t sibling = find_window_below(s, c);
+    committed_stack_t* old = &s->committed_stack;
+    if (n == 0) {
+        old->len = 0;
+        return;
+    }
 
-    uint16_t mask = 0;
-    uint32_t values[2] = {0, 0};
+    // Old position per slot, -1 = not committed
+    uint32_t slots = s->clients.cap;
+    int32_t* old_pos = arena_alloc(&s->tick_arena, (size_t)slots * sizeof(int32_t));
+    memset(old_pos, 0xff, (size_t)slots * sizeof(int32_t));
+    for (uint32_t i = 0; i < old->len; i++) {
+        uint32_t slot = handle_index(old->items[i].h);
+        if (slot < slots) old_pos[slot] = (int32_t)i;
+    }
 
-    if (sibling != XCB_NONE) {
-        mask = XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE;
-        values[0] = sibling;
-        values[1] = XCB_STACK_MODE_ABOVE;
-    } else {
-        /* If there's no below sibling, try anchoring relative to an above sibling */
-        sibling = find_window_above(s, c);
-        if (sibling != XCB_NONE) {
-            mask = XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE;
-            values[0] = sibling;
+    int32_t* key = arena_alloc(&s->tick_arena, n * sizeof(int32_t));
+    int32_t* prev = arena_alloc(&s->tick_arena, n * sizeof(int32_t));
+    uint32_t* tail = arena_alloc(&s->tick_arena, n * sizeof(uint32_t));
+    bool* keep = arena_alloc(&s->tick_arena, n * sizeof(bool));
+    memset(keep, 0, n * sizeof(bool));
+
+    // Longest increasing subsequence of old positions (patience sorting, O(n log n))
+    uint32_t lis = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t slot = handle_index(order[i].h);
+        int32_t p = slot < slots ? old_pos[slot] : -1;
+        if (p >= 0 && (old->items[p].h != order[i].h || old->items[p].frame != order[i].frame)) p = -1;
+        key[i] = p;
+        prev[i] = -1;
+        if (p < 0) continue;
+
+        uint32_t lo = 0, hi = lis;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (key[tail[mid]] < p) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo > 0) prev[i] = (int32_t)tail[lo - 1];
+        tail[lo] = i;
+        if (lo == lis) lis++;
+    }
+    for (int32_t i = lis ? (int32_t)tail[lis - 1] : -1; i >= 0; i = prev[i]) keep[i] = true;
+
+    int32_t lowest_kept = -1;
+    for (uint32_t i = 0; i < n && lowest_kept < 0; i++) {
+        if (keep[i]) lowest_kept = (int32_t)i;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (keep[i]) continue;
+
+        uint16_t mask = XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE;
+        uint32_t values[2] = {0, 0};
+
+        if (i > 0) {
+            values[0] = order[i - 1].frame;
+            values[1] = XCB_STACK_MODE_ABOVE;
+        } else if (lowest_kept >= 0 || n > 1) {
+            /* Nothing kept means nothing below is final yet; the next frame gets stacked above us */
+            values[0] = order[lowest_kept >= 0 ? (uint32_t)lowest_kept : 1u].frame;
             values[1] = XCB_STACK_MODE_BELOW;
         } else {
             /* Only window we know about */
             mask = XCB_CONFIG_WINDOW_STACK_MODE;
             values[0] = XCB_STACK_MODE_ABOVE;
         }
-    }
 
-    TRACE_ONLY({
-        uint32_t mode = (mask & XCB_CONFIG_WINDOW_SIBLING) ? values[1] : values[0];
-        TRACE_LOG("stack_sync_to_xcb h=%lx frame=%u sibling=%u mode=%u", h, c->frame, sibling, mode);
-    });
+        TRACE_LOG("stack_commit h=%lx frame=%u old=%d sibling=%u mode=%u", order[i].h, order[i].frame, key[i],
+                  (mask & XCB_CONFIG_WINDOW_SIBLING) ? values[0] : 0,
+                  (mask & XCB_CONFIG_WINDOW_SIBLING) ? values[1] : values[0]);
+
+        xcb_configure_window(s->conn, order[i].frame, mask, values);
+        counters.restacks_applied++;
+    }
 
-    xcb_configure_window(s->conn, c->frame, mask, values);
-    counters.restacks_applied++;
+    committed_stack_store(old, order, n);
 }
 
 static void stack_restack(server_t* s, handle_t h) {
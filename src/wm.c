@@ -31,6 +31,7 @@
 #include "event.h"
 #include "frame.h"
 #include "hxm.h"
+#include "prop_schema.h"
 #include "wm_internal.h"
 
 // Small helpers
@@ -77,20 +78,10 @@ static bool should_raise_on_click(client_hot_t* c, xcb_button_t button) {
     return (button == 1 || button == 3);
 }
 
-static bool wm_is_above_in_layer(const server_t* s, const client_hot_t* a, const client_hot_t* b) {
+static bool wm_is_above_in_layer(const client_hot_t* a, const client_hot_t* b) {
     if (!a || !b) return false;
     if (a->layer != b->layer) return false;
-
-    const small_vec_t* v = &s->layers[a->layer];
-    bool seen_b = false;
-    for (size_t i = 0; i < v->length; i++) {
-        handle_t h = (handle_t)(uintptr_t)v->items[i];
-        const client_hot_t* cur = server_chot((server_t*)s, h);
-        if (!cur) continue;
-        if (cur == a) return seen_b;
-        if (cur == b) seen_b = true;
-    }
-    return false;
+    return stack_is_above(a, b);
 }
 
 void wm_set_frame_extents_for_window(server_t* s, xcb_window_t win, bool undecorated) {
@@ -101,58 +92,202 @@ void wm_set_frame_extents_for_window(server_t* s, xcb_window_t win, bool undecor
                         extents);
 }
 
+/*
+ * Monitor discovery:
+ * wm_update_monitors never waits on the server. It issues RandR 1.5 GetMonitors
+ * (one request) or, on older servers, GetScreenResourcesCurrent followed by one
+ * GetCrtcInfo per CRTC, all through the cookie jar. Replies of one query
+ * generation are collected in monitor_query_next; the live table is swapped
+ * only once the set is complete, so readers never see a half-built layout.
+ * A newer query bumps the generation and orphans replies of the old one.
+ * Cookie data packs the low 16 bits of the generation above a 16-bit CRTC
+ * index, so it fits uintptr_t on 32-bit targets too.
+ */
+static void wm_handle_monitor_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_generic_error_t* err);
+
+static inline uintptr_t monitor_cookie_data(uint32_t gen, uint32_t idx) {
+    return (uintptr_t)(((gen & 0xFFFFu) << 16) | (idx & 0xFFFFu));
+}
+
+static inline bool monitor_cookie_current(const server_t* s, uintptr_t data) {
+    return (uint16_t)(data >> 16) == (uint16_t)s->monitor_query_gen;
+}
+
+static monitor_t* monitor_table_alloc(uint32_t n) {
+    monitor_t* mons = calloc(n ? n : 1, sizeof(monitor_t));
+    if (!mons) {
+        LOG_ERROR("monitor table allocation failed");
+        exit(1);
+    }
+    return mons;
+}
+
+static void wm_monitors_commit(server_t* s, monitor_t* next, uint32_t count) {
+    free(s->monitors);
+    s->monitors = next;
+    s->monitor_count = count;
+    LOG_INFO("Monitor update: %u monitors detected", s->monitor_count);
+
+    // Workareas and monitor-sized geometry follow the new table. New entries come preset
+    // with workarea = geom, so a rebuild would not flag a strut-free monitor as moved:
+    // every monitor is marked for relayout here
+    wm_workarea_invalidate(s);
+    s->workarea_changed_monitors = ~0ull;
+    s->root_dirty |= ROOT_DIRTY_WORKAREA;
+    if (!s->config.fullscreen_use_workarea) {
+        for (size_t i = 0; i < s->active_clients.length; i++) {
+            handle_t h = ptr_to_handle(s->active_clients.items[i]);
+            client_hot_t* hot = server_chot(s, h);
+            if (!hot || hot->layer != LAYER_FULLSCREEN) continue;
+            wm_get_monitor_geometry(s, hot, &hot->desired);
+            hot->dirty |= DIRTY_GEOM;
+        }
+    }
+}
+
+static void wm_monitor_query_reset(server_t* s) {
+    free(s->monitor_query_next);
+    s->monitor_query_next = NULL;
+    s->monitor_query_len = 0;
+    s->monitor_query_pending = 0;
+}
+
+static void wm_monitor_query_crtcs(server_t* s) {
+    uint32_t seq = xcb_randr_get_screen_resources_current(s->conn, s->root).sequence;
+    cookie_jar_push(&s->cookie_jar, seq, COOKIE_RANDR_SCREEN_RESOURCES, HANDLE_INVALID,
+                    monitor_cookie_data(s->monitor_query_gen, 0), s->txn_id, wm_handle_monitor_reply);
+}
+
 void wm_update_monitors(server_t* s) {
     if (!s->conn) return;
 
-    uint32_t active_count = 0;
-    monitor_t* next_monitors = NULL;
-
     if (!s->randr_supported) {
-        active_count = 1;
-        next_monitors = calloc(1, sizeof(monitor_t));
+        monitor_t* next = monitor_table_alloc(1);
         xcb_screen_t* screen = xcb_setup_roots_iterator(xcb_get_setup(s->conn)).data;
-        next_monitors[0].geom.x = 0;
-        next_monitors[0].geom.y = 0;
-        next_monitors[0].geom.w = (uint16_t)screen->width_in_pixels;
-        next_monitors[0].geom.h = (uint16_t)screen->height_in_pixels;
-        next_monitors[0].workarea = next_monitors[0].geom;
+        next[0].geom.x = 0;
+        next[0].geom.y = 0;
+        next[0].geom.w = (uint16_t)screen->width_in_pixels;
+        next[0].geom.h = (uint16_t)screen->height_in_pixels;
+        next[0].workarea = next[0].geom;
+        wm_monitors_commit(s, next, 1);
+        return;
+    }
+
+    // Supersedes any query still in flight
+    s->monitor_query_gen++;
+    wm_monitor_query_reset(s);
+
+    if (s->randr_monitors) {
+        uint32_t seq = xcb_randr_get_monitors(s->conn, s->root, 1).sequence;
+        cookie_jar_push(&s->cookie_jar, seq, COOKIE_RANDR_GET_MONITORS, HANDLE_INVALID,
+                        monitor_cookie_data(s->monitor_query_gen, 0), s->txn_id, wm_handle_monitor_reply);
     } else {
-        xcb_randr_get_screen_resources_current_cookie_t r_c = xcb_randr_get_screen_resources_current(s->conn, s->root);
-        xcb_randr_get_screen_resources_current_reply_t* res =
-            xcb_randr_get_screen_resources_current_reply(s->conn, r_c, NULL);
-
-        if (res) {
-            xcb_randr_crtc_t* crtcs = xcb_randr_get_screen_resources_current_crtcs(res);
-            int num_crtcs = xcb_randr_get_screen_resources_current_crtcs_length(res);
-
-            next_monitors = calloc((size_t)num_crtcs, sizeof(monitor_t));
-
-            for (int i = 0; i < num_crtcs; i++) {
-                xcb_randr_get_crtc_info_cookie_t c_c =
-                    xcb_randr_get_crtc_info(s->conn, crtcs[i], res->config_timestamp);
-                xcb_randr_get_crtc_info_reply_t* crtc = xcb_randr_get_crtc_info_reply(s->conn, c_c, NULL);
-
-                if (crtc) {
-                    if (crtc->mode != XCB_NONE) {
-                        next_monitors[active_count].geom.x = crtc->x;
-                        next_monitors[active_count].geom.y = crtc->y;
-                        next_monitors[active_count].geom.w = crtc->width;
-                        next_monitors[active_count].geom.h = crtc->height;
-                        next_monitors[active_count].workarea = next_monitors[active_count].geom;
-                        active_count++;
-                    }
-                    free(crtc);
+        wm_monitor_query_crtcs(s);
+    }
+}
+
+static void wm_handle_monitor_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_generic_error_t* err) {
+    (void)err;
+    if (!monitor_cookie_current(s, slot->data)) return;
+
+    switch (slot->type) {
+        case COOKIE_RANDR_GET_MONITORS: {
+            xcb_randr_get_monitors_reply_t* r = (xcb_randr_get_monitors_reply_t*)reply;
+            int n = r ? xcb_randr_get_monitors_monitors_length(r) : 0;
+            if (n <= 0) {
+                // Error, timeout or nothing active: ask the CRTCs instead
+                wm_monitor_query_crtcs(s);
+                break;
+            }
+
+            monitor_t* next = monitor_table_alloc((uint32_t)n);
+            uint32_t count = 0;
+            for (xcb_randr_monitor_info_iterator_t it = xcb_randr_get_monitors_monitors_iterator(r); it.rem;
+                 xcb_randr_monitor_info_next(&it)) {
+                const xcb_randr_monitor_info_t* info = it.data;
+                if (info->width == 0 || info->height == 0) continue;
+
+                monitor_t* m = &next[count++];
+                m->geom.x = info->x;
+                m->geom.y = info->y;
+                m->geom.w = info->width;
+                m->geom.h = info->height;
+                m->workarea = m->geom;
+
+                // monitors[0] is the primary
+                if (info->primary && count > 1) {
+                    monitor_t tmp = next[0];
+                    next[0] = *m;
+                    *m = tmp;
                 }
             }
-            free(res);
+
+            if (count == 0) {
+                free(next);
+                wm_monitor_query_crtcs(s);
+                break;
+            }
+            wm_monitors_commit(s, next, count);
+            break;
         }
-    }
 
-    if (next_monitors) {
-        if (s->monitors) free(s->monitors);
-        s->monitors = next_monitors;
-        s->monitor_count = active_count;
-        LOG_INFO("Monitor update: %u monitors detected", s->monitor_count);
+        case COOKIE_RANDR_SCREEN_RESOURCES: {
+            xcb_randr_get_screen_resources_current_reply_t* r = (xcb_randr_get_screen_resources_current_reply_t*)reply;
+            if (!r) break;  // keep the current table
+
+            xcb_randr_crtc_t* crtcs = xcb_randr_get_screen_resources_current_crtcs(r);
+            int n = xcb_randr_get_screen_resources_current_crtcs_length(r);
+            if (n <= 0 || !crtcs) break;
+
+            wm_monitor_query_reset(s);
+            s->monitor_query_next = monitor_table_alloc((uint32_t)n);
+            s->monitor_query_len = (uint32_t)n;
+            s->monitor_query_pending = (uint32_t)n;
+            for (int i = 0; i < n; i++) {
+                uint32_t seq = xcb_randr_get_crtc_info(s->conn, crtcs[i], r->config_timestamp).sequence;
+                cookie_jar_push(&s->cookie_jar, seq, COOKIE_RANDR_CRTC_INFO, HANDLE_INVALID,
+                                monitor_cookie_data(s->monitor_query_gen, (uint32_t)i), s->txn_id,
+                                wm_handle_monitor_reply);
+            }
+            break;
+        }
+
+        case COOKIE_RANDR_CRTC_INFO: {
+            uint32_t idx = (uint32_t)(slot->data & 0xFFFFu);
+            if (!s->monitor_query_next || idx >= s->monitor_query_len || s->monitor_query_pending == 0) break;
+
+            // Slots of disabled CRTCs (or failed replies) stay zero-sized and are dropped below
+            xcb_randr_get_crtc_info_reply_t* crtc = (xcb_randr_get_crtc_info_reply_t*)reply;
+            if (crtc && crtc->mode != XCB_NONE) {
+                monitor_t* m = &s->monitor_query_next[idx];
+                m->geom.x = crtc->x;
+                m->geom.y = crtc->y;
+                m->geom.w = crtc->width;
+                m->geom.h = crtc->height;
+                m->workarea = m->geom;
+            }
+
+            if (--s->monitor_query_pending > 0) break;
+
+            monitor_t* next = s->monitor_query_next;
+            uint32_t count = 0;
+            for (uint32_t i = 0; i < s->monitor_query_len; i++) {
+                if (next[i].geom.w == 0 || next[i].geom.h == 0) continue;
+                next[count++] = next[i];
+            }
+            s->monitor_query_next = NULL;
+            wm_monitor_query_reset(s);
+
+            if (count == 0) {
+                free(next);
+                break;
+            }
+            wm_monitors_commit(s, next, count);
+            break;
+        }
+
+        default:
+            break;
     }
 }
 
@@ -170,33 +305,25 @@ void wm_get_monitor_geometry(server_t* s, client_hot_t* hot, rect_t* out_geom) {
 
     if (s->monitor_count <= 1) return;
 
-    // Use center of the window to determine which monitor it is on
-    int center_x = hot->server.x + hot->server.w / 2;
-    int center_y = hot->server.y + hot->server.h / 2;
-
-    for (uint32_t i = 0; i < s->monitor_count; i++) {
-        monitor_t* m = &s->monitors[i];
-        if (center_x >= m->geom.x && center_x < m->geom.x + (int)m->geom.w && center_y >= m->geom.y &&
-            center_y < m->geom.y + (int)m->geom.h) {
-            *out_geom = m->geom;
-            break;
-        }
-    }
+    *out_geom = s->monitors[wm_monitor_index(s, hot)].geom;
 }
 
 static void wm_client_apply_maximize(server_t* s, client_hot_t* hot) {
     uint16_t bw = (hot->flags & CLIENT_FLAG_UNDECORATED) ? 0 : s->config.theme.border_width;
     uint16_t th = (hot->flags & CLIENT_FLAG_UNDECORATED) ? 0 : s->config.theme.title_height;
 
+    rect_t wa;
+    wm_get_monitor_workarea(s, hot, &wa);
+
     if (hot->maximized_horz) {
-        int32_t w = (int32_t)s->workarea.w - 2 * (int32_t)bw;
-        hot->desired.x = s->workarea.x;
+        int32_t w = (int32_t)wa.w - 2 * (int32_t)bw;
+        hot->desired.x = wa.x;
         hot->desired.w = (uint16_t)((w > 0) ? w : 0);
     }
 
     if (hot->maximized_vert) {
-        int32_t h = (int32_t)s->workarea.h - (int32_t)th - (int32_t)bw;
-        hot->desired.y = s->workarea.y;
+        int32_t h = (int32_t)wa.h - (int32_t)th - (int32_t)bw;
+        hot->desired.y = wa.y;
         hot->desired.h = (uint16_t)((h > 0) ? h : 0);
     }
 }
@@ -337,6 +464,7 @@ void wm_become(server_t* s) {
         atoms._NET_WM_SYNC_REQUEST_COUNTER,
         atoms._NET_WM_ICON_GEOMETRY,
         atoms._NET_WM_WINDOW_OPACITY,
+        atoms._NET_WM_BYPASS_COMPOSITOR,
         atoms._NET_DESKTOP_GEOMETRY,
         atoms._NET_FRAME_EXTENTS,
         atoms._NET_REQUEST_FRAME_EXTENTS,
@@ -561,7 +689,8 @@ void wm_handle_destroy_notify(server_t* s, xcb_destroy_notify_event_t* ev) {
     client_hot_t* hot = server_chot(s, h);
     if (hot) {
         // If the destroyed window is the frame, don't unmanage the client if it's still managed.
-        if (ev->window == hot->frame) {
+        // (A frameless client's "frame" is the window itself.)
+        if (ev->window == hot->frame && !client_is_frameless(hot)) {
             if (hot->state == STATE_MAPPED) {
                 LOG_WARN("Frame %u destroyed for managed client %lx. Marking frame dead.", ev->window, h);
                 if (s->interaction_handle == h) {
@@ -621,59 +750,43 @@ void wm_handle_configure_notify(server_t* s, handle_t h, xcb_configure_notify_ev
               ev->width, ev->height, ev->border_width, ev->above_sibling);
 
     if (ev->window == hot->frame) {
+        // A parked frame's position is not the client's; a late notify from the park move is ignored too
+        if (hot->frame_parked || (ev->x == WM_FRAME_PARK_POS && ev->y == WM_FRAME_PARK_POS)) return;
         hot->server.x = ev->x;
         hot->server.y = ev->y;
         LOG_DEBUG("Client %lx frame pos updated: %d,%d", h, ev->x, ev->y);
-    } else if (ev->window == hot->xid) {
+    }
+    // Frameless: the same notify carries the size as well
+    if (ev->window == hot->xid) {
         hot->server.w = ev->width;
         hot->server.h = ev->height;
         LOG_DEBUG("Client %lx window size updated: %dx%d", h, ev->width, ev->height);
     }
+    wm_place_index_update(s, h);
 }
 
 void wm_handle_property_notify(server_t* s, handle_t h, xcb_property_notify_event_t* ev) {
-    if (ev->atom == atoms._NET_WM_ALLOWED_ACTIONS || ev->atom == atoms._NET_FRAME_EXTENTS ||
-        ev->atom == atoms.WM_STATE || ev->atom == atoms._NET_WM_VISIBLE_NAME ||
-        ev->atom == atoms._NET_WM_VISIBLE_ICON_NAME || ev->atom == atoms._NET_WM_DESKTOP) {
-        return;
-    }
+    const prop_schema_t* ps = prop_schema_lookup(ev->atom);
+    if (ps && (ps->flags & PROP_F_NOTIFY_IGNORE)) return;
+
     client_hot_t* hot = server_chot(s, h);
     if (!hot) return;
 
     TRACE_LOG("property_notify h=%lx xid=%u atom=%u (%s) state=%u", h, hot->xid, ev->atom, atom_name(ev->atom),
               ev->state);
-    if (ev->atom == atoms.WM_NAME || ev->atom == atoms._NET_WM_NAME) {
-        hot->dirty |= DIRTY_TITLE;
-    } else if (ev->atom == atoms.WM_HINTS) {
-        hot->dirty |= DIRTY_HINTS;
-    } else if (ev->atom == atoms.WM_NORMAL_HINTS) {
-        hot->dirty |= DIRTY_HINTS;
-    } else if (ev->atom == atoms.WM_COLORMAP_WINDOWS) {
-        hot->dirty |= DIRTY_HINTS;
-    } else if (ev->atom == atoms.WM_PROTOCOLS) {
-        xcb_get_property_cookie_t ck = xcb_get_property(s->conn, 0, hot->xid, atoms.WM_PROTOCOLS, XCB_ATOM_ATOM, 0, 32);
-        cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_GET_PROPERTY, h,
-                        ((uint64_t)hot->xid << 32) | atoms.WM_PROTOCOLS, s->txn_id, wm_handle_reply);
-    } else if (ev->atom == atoms._NET_WM_SYNC_REQUEST_COUNTER) {
-        xcb_get_property_cookie_t ck =
-            xcb_get_property(s->conn, 0, hot->xid, atoms._NET_WM_SYNC_REQUEST_COUNTER, XCB_ATOM_CARDINAL, 0, 1);
-        cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_GET_PROPERTY, h,
-                        ((uint64_t)hot->xid << 32) | atoms._NET_WM_SYNC_REQUEST_COUNTER, s->txn_id, wm_handle_reply);
-    } else if (ev->atom == atoms._NET_WM_STRUT || ev->atom == atoms._NET_WM_STRUT_PARTIAL) {
-        hot->dirty |= DIRTY_STRUT;
-        // Waterfall: Always request PARTIAL first. If it fails/empty, we fallback to STRUT in reply handler.
-        xcb_get_property_cookie_t ck =
-            xcb_get_property(s->conn, 0, hot->xid, atoms._NET_WM_STRUT_PARTIAL, XCB_ATOM_CARDINAL, 0, 12);
-        cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_GET_PROPERTY, h,
-                        ((uint64_t)hot->xid << 32) | (uint32_t)atoms._NET_WM_STRUT_PARTIAL, s->txn_id, wm_handle_reply);
-    } else if (ev->atom == atoms._NET_WM_WINDOW_OPACITY) {
-        hot->dirty |= DIRTY_OPACITY;
-    } else if (ev->atom == atoms._MOTIF_WM_HINTS) {
-        hot->dirty |= DIRTY_HINTS;
-    } else if (ev->atom == atoms._GTK_FRAME_EXTENTS) {
-        hot->dirty |= DIRTY_HINTS;
-    } else if (ev->atom == atoms._NET_WM_BYPASS_COMPOSITOR) {
-        LOG_INFO("Client %lx changed _NET_WM_BYPASS_COMPOSITOR", h);
+    if (ps) {
+        bool deleted = (ev->state == XCB_PROPERTY_DELETE);
+        if (ps->flags & PROP_F_NOTIFY_FETCH) {
+            if (deleted && !(hot->prop_inflight & prop_schema_bit(ps))) {
+                prop_schema_apply_deleted(s, h, ps);
+            } else {
+                prop_schema_fetch(s, h, hot, ps);
+            }
+        } else if (ps->dirty) {
+            // Only this atom is fetched (or cleared, if deleted) at commit in wm_flush_dirty
+            prop_schema_note_change(hot, ps, deleted);
+            hot->dirty |= ps->dirty;
+        }
     }
 }
 
@@ -812,7 +925,8 @@ void wm_cancel_interaction(server_t* s) {
             handle_t fh = server_get_client_by_frame(s, frame);
             hot = server_chot(s, fh);
         }
-        if (hot) {
+        // A frameless client's cursor is its own business
+        if (hot && !client_is_frameless(hot)) {
             wm_update_cursor(s, hot->frame, RESIZE_NONE);
             hot->last_cursor_dir = RESIZE_NONE;
         }
@@ -1053,8 +1167,13 @@ void wm_handle_motion_notify(server_t* s, xcb_motion_notify_event_t* ev) {
         return;
     }
 
-    handle_t h = server_get_client_by_frame(s, s->interaction_window);
+    // By handle first: a frameless client is not in frame_to_client
+    handle_t h = s->interaction_handle;
     client_hot_t* hot = server_chot(s, h);
+    if (!hot || hot->frame != s->interaction_window) {
+        h = server_get_client_by_frame(s, s->interaction_window);
+        hot = server_chot(s, h);
+    }
     if (!hot) {
         LOG_WARN("Interaction client not found h=%lx window=%u", h, s->interaction_window);
         s->interaction_mode = INTERACTION_NONE;
@@ -1385,9 +1504,10 @@ void wm_handle_client_message(server_t* s, xcb_client_message_event_t* ev) {
                 if (!hot || hot->sticky) continue;
                 if (hot->desktop >= (int32_t)s->desktop_count) {
                     hot->desktop = (int32_t)s->current_desktop;
+                    wm_desktop_index_update(s, h);
+                    wm_client_visibility_changed(s, h);
                     uint32_t prop_val = (uint32_t)hot->desktop;
-                    xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_WM_DESKTOP,
-                                        XCB_ATOM_CARDINAL, 32, 1, &prop_val);
+                    wm_prop_publish(s, hot->xid, atoms._NET_WM_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &prop_val);
                 }
             }
         }
@@ -1510,13 +1630,18 @@ void wm_handle_client_message(server_t* s, xcb_client_message_event_t* ev) {
         xcb_window_t target = ev->window;
         if (target == s->root) return;
 
-        bool undecorated = false;
         handle_t h = server_get_client_by_window(s, target);
         if (h != HANDLE_INVALID) {
             client_hot_t* hot = server_chot(s, h);
-            if (hot) undecorated = (hot->flags & CLIENT_FLAG_UNDECORATED) != 0;
-            TRACE_LOG("_NET_REQUEST_FRAME_EXTENTS win=%u undecorated=%d (managed)", target, undecorated);
-            wm_set_frame_extents_for_window(s, target, undecorated);
+            if (!hot) return;
+
+            // Same values as the flush publishes, through the same cache
+            bool bare = (hot->flags & CLIENT_FLAG_UNDECORATED) || hot->gtk_frame_extents_set;
+            uint32_t bw = bare ? 0 : s->config.theme.border_width;
+            uint32_t th = bare ? 0 : s->config.theme.title_height;
+            uint32_t extents[4] = {bw, bw, th + bw, bw};
+            TRACE_LOG("_NET_REQUEST_FRAME_EXTENTS win=%u bare=%d (managed)", target, bare);
+            wm_prop_publish(s, hot->xid, atoms._NET_FRAME_EXTENTS, XCB_ATOM_CARDINAL, 32, 4, extents);
             return;
         }
 
@@ -1560,7 +1685,7 @@ void wm_handle_client_message(server_t* s, xcb_client_message_event_t* ev) {
                 }
                 break;
             case XCB_STACK_MODE_TOP_IF:
-                if (!have_sibling || !same_layer || !wm_is_above_in_layer(s, hot, sib)) {
+                if (!have_sibling || !same_layer || !wm_is_above_in_layer(hot, sib)) {
                     if (have_sibling)
                         stack_place_above(s, h, sibling_h);
                     else
@@ -1570,13 +1695,13 @@ void wm_handle_client_message(server_t* s, xcb_client_message_event_t* ev) {
             case XCB_STACK_MODE_BOTTOM_IF:
                 if (!have_sibling || !same_layer) {
                     stack_lower(s, h);
-                } else if (wm_is_above_in_layer(s, hot, sib)) {
+                } else if (wm_is_above_in_layer(hot, sib)) {
                     stack_place_below(s, h, sibling_h);
                 }
                 break;
             case XCB_STACK_MODE_OPPOSITE:
                 if (have_sibling && same_layer) {
-                    if (wm_is_above_in_layer(s, hot, sib)) {
+                    if (wm_is_above_in_layer(hot, sib)) {
                         stack_place_below(s, h, sibling_h);
                     } else {
                         stack_place_above(s, h, sibling_h);
@@ -1745,6 +1870,7 @@ void wm_handle_client_message(server_t* s, xcb_client_message_event_t* ev) {
         TRACE_LOG("_NET_WM_MOVERESIZE h=%lx root=%d,%d use_query=%d", h, root_x, root_y, use_pointer_query);
 
         if (use_pointer_query) {
+            // Asked fresh: the pointer cache misses motion inside client windows
             bool is_keyboard =
                 (direction == NET_WM_MOVERESIZE_SIZE_KEYBOARD || direction == NET_WM_MOVERESIZE_MOVE_KEYBOARD);
             uintptr_t data = (start_move ? 0x100 : 0) | (is_keyboard ? 0x200 : 0) | (uintptr_t)resize_dir;
@@ -1784,18 +1910,24 @@ void wm_place_window(server_t* s, handle_t h) {
         return;
     }
 
+    // Rules pick the policy; otherwise the configured default applies unless the client positioned itself
+    bool has_position = (hot->hints_flags & (XCB_ICCCM_SIZE_HINT_US_POSITION | XCB_ICCCM_SIZE_HINT_P_POSITION)) != 0;
+    uint8_t policy = hot->placement;
+    if (policy == PLACEMENT_DEFAULT && !has_position && hot->transient_for == HANDLE_INVALID) {
+        policy = (uint8_t)s->config.placement;
+    }
+
     // 1. Check rules/types for explicit placement
-    if (hot->placement == PLACEMENT_CENTER) {
+    if (policy == PLACEMENT_CENTER) {
         hot->desired.x = (int16_t)(s->workarea.x + (s->workarea.w - hot->desired.w) / 2);
         hot->desired.y = (int16_t)(s->workarea.y + (s->workarea.h - hot->desired.h) / 2);
         return;
-    } else if (hot->placement == PLACEMENT_MOUSE) {
-        xcb_query_pointer_cookie_t cookie = xcb_query_pointer(s->conn, s->root);
-        xcb_query_pointer_reply_t* reply = xcb_query_pointer_reply(s->conn, cookie, NULL);
-        if (reply) {
-            hot->desired.x = (int16_t)(reply->root_x - hot->desired.w / 2);
-            hot->desired.y = (int16_t)(reply->root_y - hot->desired.h / 2);
-            free(reply);
+    } else if (policy == PLACEMENT_MOUSE) {
+        // A hint from the last input event (no round trip while managing); it lags
+        // behind motion inside client windows, which the WM never sees
+        if (s->pointer.valid) {
+            hot->desired.x = (int16_t)(s->pointer.x - hot->desired.w / 2);
+            hot->desired.y = (int16_t)(s->pointer.y - hot->desired.h / 2);
         }
     } else if (hot->transient_for != HANDLE_INVALID) {
         // Transients: center over parent
@@ -1808,11 +1940,12 @@ void wm_place_window(server_t* s, handle_t h) {
     }
 
     // Honor user/program position if specified (only if no rule applied)
-    if (hot->placement == PLACEMENT_DEFAULT &&
-        (hot->hints_flags & (XCB_ICCCM_SIZE_HINT_US_POSITION | XCB_ICCCM_SIZE_HINT_P_POSITION))) {
+    if (hot->placement == PLACEMENT_DEFAULT && has_position) {
         return;
     }
 
+    if (policy == PLACEMENT_SMART && wm_place_smart(s, hot)) return;
+
     // Clamp to workarea
     if (hot->desired.x < s->workarea.x) hot->desired.x = s->workarea.x;
     if (hot->desired.y < s->workarea.y) hot->desired.y = s->workarea.y;
@@ -1849,7 +1982,8 @@ void wm_client_refresh_title(server_t* s, handle_t h) {
         xcb_delete_property(s->conn, hot->xid, atoms._NET_WM_VISIBLE_ICON_NAME);
     }
 
-    hot->dirty |= DIRTY_TITLE | DIRTY_FRAME_STYLE;
+    hot->dirty |= DIRTY_FRAME_TITLE;
+    client_apply_title_rules(s, h);
 }
 
 void wm_client_toggle_maximize(server_t* s, handle_t h) {
@@ -1869,8 +2003,10 @@ void wm_client_iconify(server_t* s, handle_t h) {
     TRACE_LOG("iconify h=%lx xid=%u frame=%u layer=%d", h, hot->xid, hot->frame, hot->layer);
 
     hot->state = STATE_UNMAPPED;
-    if (hot->ignore_unmap < UINT8_MAX) hot->ignore_unmap++;
+    uint8_t echoes = client_frame_unmap_echoes(hot);
+    hot->ignore_unmap = (hot->ignore_unmap > UINT8_MAX - echoes) ? UINT8_MAX : (uint8_t)(hot->ignore_unmap + echoes);
     xcb_unmap_window(s->conn, hot->frame);
+    hot->frame_mapped = false;
     stack_remove(s, h);
 
     if (s->focused_client == h) {
@@ -1887,7 +2023,7 @@ void wm_client_iconify(server_t* s, handle_t h) {
 
     // Set WM_STATE to IconicState
     uint32_t state_vals[] = {XCB_ICCCM_WM_STATE_ICONIC, XCB_NONE};
-    xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2, state_vals);
+    wm_prop_publish(s, hot->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2, state_vals);
 
     hot->dirty |= DIRTY_STATE;
 }
@@ -1908,11 +2044,16 @@ void wm_client_restore(server_t* s, handle_t h) {
     TRACE_LOG("restore h=%lx xid=%u frame=%u layer=%d", h, hot->xid, hot->frame, hot->layer);
 
     hot->state = STATE_MAPPED;
+    wm_frame_set_parked(s, hot, false);
     xcb_map_window(s->conn, hot->xid);
-    xcb_map_window(s->conn, hot->frame);
+    if (!client_is_frameless(hot)) xcb_map_window(s->conn, hot->frame);
+    hot->frame_mapped = true;
+
+    // Restored onto a desktop that isn't shown: the visibility pass hides it again
+    if (!hot->sticky && hot->desktop != (int32_t)s->current_desktop) wm_client_visibility_changed(s, h);
 
     uint32_t state_vals[] = {XCB_ICCCM_WM_STATE_NORMAL, XCB_NONE};
-    xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2, state_vals);
+    wm_prop_publish(s, hot->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2, state_vals);
 
     hot->dirty |= DIRTY_STATE;
     stack_raise(s, h);
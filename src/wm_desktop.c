@@ -6,7 +6,8 @@
  * - Windows on the `current_desktop` (or sticky) are mapped.
  * - Windows on other desktops are unmapped (iconified).
  *
- * This module also handles workarea computation (subtracting struts).
+ * This module also handles workarea computation (subtracting struts) via a
+ * registry of strut-bearing clients and per-monitor workareas.
  */
 
 #include <stdio.h>
@@ -70,8 +71,7 @@ void wm_publish_desktop_props(server_t* s) {
 
     xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root, atoms._NET_NUMBER_OF_DESKTOPS, XCB_ATOM_CARDINAL, 32, 1,
                         &s->desktop_count);
-    xcb_change_property(conn, XCB_PROP_MODE_REPLACE, root, atoms._NET_CURRENT_DESKTOP, XCB_ATOM_CARDINAL, 32, 1,
-                        &s->current_desktop);
+    wm_prop_publish(s, root, atoms._NET_CURRENT_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &s->current_desktop);
 
     xcb_window_t* vroots = calloc(s->desktop_count, sizeof(*vroots));
     if (vroots) {
@@ -150,123 +150,630 @@ void wm_publish_desktop_props(server_t* s) {
     }
 }
 
+/*
+ * Strut registry:
+ * Only clients with a non-zero effective strut are listed in s->strut_clients,
+ * so workarea recomputation never walks the full client list. Each strut change
+ * marks the monitors its old and new edges touch; wm_compute_workarea rebuilds
+ * just those monitors' workareas and records which ones actually moved, and
+ * wm_publish_workarea re-lays out maximized windows on those monitors only.
+ *
+ * Monitor masks have one bit per monitor; monitors past 63 share the top bit.
+ */
+static inline uint64_t workarea_monitor_bit(uint32_t m) { return 1ull << (m < 63u ? m : 63u); }
+
+static bool strut_is_set(const strut_t* st) { return st->left || st->right || st->top || st->bottom; }
+
+static void wm_screen_size(server_t* s, int32_t* w, int32_t* h) {
+    if (!s->screen_w || !s->screen_h) {
+        xcb_screen_t* screen = xcb_setup_roots_iterator(xcb_get_setup(s->conn)).data;
+        s->screen_w = (uint16_t)screen->width_in_pixels;
+        s->screen_h = (uint16_t)screen->height_in_pixels;
+    }
+    *w = s->screen_w;
+    *h = s->screen_h;
+}
+
+/*
+ * Apply one strut to one monitor.
+ * With wa == NULL nothing is modified; the return value says whether any edge
+ * reaches into the monitor (used to find the monitors a strut change touches).
+ */
+static bool strut_apply(const strut_t* st, bool partial, int32_t screen_w, int32_t screen_h, const rect_t* geom,
+                        rect_t* wa) {
+    int32_t ml = geom->x;
+    int32_t mt = geom->y;
+    int32_t mr = geom->x + geom->w;
+    int32_t mb = geom->y + geom->h;
+    bool touched = false;
+
+    if (st->left > 0 && (int32_t)st->left > ml && (int32_t)st->left < mr) {
+        // Check if strut vertical range overlaps monitor
+        bool overlap = true;
+        if (partial) overlap = (st->left_start_y < (uint32_t)mb && st->left_end_y > (uint32_t)mt);
+        if (overlap) {
+            touched = true;
+            int32_t new_l = (int32_t)st->left;
+            if (wa && new_l > wa->x) {
+                wa->w -= (uint16_t)(new_l - wa->x);
+                wa->x = (int16_t)new_l;
+            }
+        }
+    }
+    if (st->right > 0) {
+        int32_t r_edge = screen_w - (int32_t)st->right;
+        if (r_edge < mr && r_edge > ml) {
+            bool overlap = true;
+            if (partial) overlap = (st->right_start_y < (uint32_t)mb && st->right_end_y > (uint32_t)mt);
+            if (overlap) {
+                touched = true;
+                if (wa && r_edge < (int32_t)(wa->x + wa->w)) wa->w = (uint16_t)(r_edge - wa->x);
+            }
+        }
+    }
+    if (st->top > 0 && (int32_t)st->top > mt && (int32_t)st->top < mb) {
+        bool overlap = true;
+        if (partial) overlap = (st->top_start_x < (uint32_t)mr && st->top_end_x > (uint32_t)ml);
+        if (overlap) {
+            touched = true;
+            int32_t new_t = (int32_t)st->top;
+            if (wa && new_t > wa->y) {
+                wa->h -= (uint16_t)(new_t - wa->y);
+                wa->y = (int16_t)new_t;
+            }
+        }
+    }
+    if (st->bottom > 0) {
+        int32_t b_edge = screen_h - (int32_t)st->bottom;
+        if (b_edge < mb && b_edge > mt) {
+            bool overlap = true;
+            if (partial) overlap = (st->bottom_start_x < (uint32_t)mr && st->bottom_end_x > (uint32_t)ml);
+            if (overlap) {
+                touched = true;
+                if (wa && b_edge < (int32_t)(wa->y + wa->h)) wa->h = (uint16_t)(b_edge - wa->y);
+            }
+        }
+    }
+    return touched;
+}
+
+static uint64_t strut_monitor_mask(server_t* s, const strut_t* st, bool partial) {
+    if (!strut_is_set(st)) return 0;
+    if (s->monitor_count == 0) return workarea_monitor_bit(0);
+
+    int32_t sw, sh;
+    wm_screen_size(s, &sw, &sh);
+    uint64_t mask = 0;
+    for (uint32_t m = 0; m < s->monitor_count; m++) {
+        if (strut_apply(st, partial, sw, sh, &s->monitors[m].geom, NULL)) mask |= workarea_monitor_bit(m);
+    }
+    return mask;
+}
+
+void wm_strut_changed(server_t* s, handle_t h, const strut_t* prev, bool prev_partial) {
+    client_cold_t* cold = server_ccold(s, h);
+    if (!cold) return;
+
+    uint64_t mask =
+        strut_monitor_mask(s, prev, prev_partial) | strut_monitor_mask(s, &cold->strut, cold->strut_partial_active);
+
+    bool want = strut_is_set(&cold->strut);
+    if (want && !cold->strut_registered) {
+        small_vec_push(&s->strut_clients, handle_to_ptr(h));
+        cold->strut_registered = true;
+    } else if (!want && cold->strut_registered) {
+        small_vec_remove_swap(&s->strut_clients, handle_to_ptr(h));
+        cold->strut_registered = false;
+    }
+
+    if (mask) {
+        s->workarea_dirty_monitors |= mask;
+        s->workarea_dirty = true;
+        s->root_dirty |= ROOT_DIRTY_WORKAREA;
+    }
+}
+
+void wm_strut_remove(server_t* s, handle_t h) {
+    client_cold_t* cold = server_ccold(s, h);
+    if (!cold || !cold->strut_registered) return;
+
+    small_vec_remove_swap(&s->strut_clients, handle_to_ptr(h));
+    cold->strut_registered = false;
+
+    uint64_t mask = strut_monitor_mask(s, &cold->strut, cold->strut_partial_active);
+    if (mask) {
+        s->workarea_dirty_monitors |= mask;
+        s->workarea_dirty = true;
+    }
+}
+
+void wm_workarea_invalidate(server_t* s) {
+    s->workarea_dirty_monitors = ~0ull;
+    s->workarea_dirty = true;
+}
+
+static void wm_workarea_build(server_t* s, const rect_t* geom, rect_t* wa) {
+    int32_t sw, sh;
+    wm_screen_size(s, &sw, &sh);
+
+    *wa = *geom;
+    for (size_t i = 0; i < s->strut_clients.length; i++) {
+        client_cold_t* cold = server_ccold(s, ptr_to_handle(s->strut_clients.items[i]));
+        if (!cold) continue;
+        strut_apply(&cold->strut, cold->strut_partial_active, sw, sh, geom, wa);
+    }
+}
+
 /*
  * wm_compute_workarea:
  * Calculate the usable screen geometry (minus panels/docks).
  *
  * Logic:
- * 1. Start with full monitor geometry.
- * 2. Iterate all mapped clients with _NET_WM_STRUT_PARTIAL.
- * 3. If a strut edge intersects a monitor edge, shrink the workarea.
- * 4. This is an O(N*M) operation, but N (struts) and M (monitors) are usually small.
+ * 1. Only monitors marked in workarea_dirty_monitors are rebuilt.
+ * 2. A rebuilt monitor starts from its geometry and subtracts every registered strut.
+ * 3. Monitors whose workarea moved are recorded in workarea_changed_monitors.
+ * 4. The output is the primary (first) monitor's workarea.
+ * Cost is O(struts) per dirty monitor; clients without struts are never visited.
  */
 void wm_compute_workarea(server_t* s, rect_t* out) {
     if (!s || !out) return;
 
-    uint32_t m_count = s->monitor_count;
-    monitor_t default_mon;
-    monitor_t* mons = s->monitors;
+    if (s->monitor_count == 0) {
+        int32_t sw, sh;
+        wm_screen_size(s, &sw, &sh);
+        rect_t geom = {0, 0, (uint16_t)sw, (uint16_t)sh};
+        wm_workarea_build(s, &geom, out);
+        if (memcmp(out, &s->workarea, sizeof(*out)) != 0) s->workarea_changed_monitors |= workarea_monitor_bit(0);
+        s->workarea_dirty_monitors = 0;
+        return;
+    }
 
-    if (m_count == 0) {
-        m_count = 1;
-        xcb_screen_t* screen = xcb_setup_roots_iterator(xcb_get_setup(s->conn)).data;
-        default_mon.geom.x = 0;
-        default_mon.geom.y = 0;
-        default_mon.geom.w = screen->width_in_pixels;
-        default_mon.geom.h = screen->height_in_pixels;
-        default_mon.workarea = default_mon.geom;
-        mons = &default_mon;
-    } else {
-        // 1. Initialize monitor workareas
-        for (uint32_t m = 0; m < m_count; m++) {
-            s->monitors[m].workarea = s->monitors[m].geom;
+    for (uint32_t m = 0; m < s->monitor_count; m++) {
+        uint64_t bit = workarea_monitor_bit(m);
+        if (!(s->workarea_dirty_monitors & bit)) continue;
+
+        monitor_t* mon = &s->monitors[m];
+        rect_t wa;
+        wm_workarea_build(s, &mon->geom, &wa);
+        if (memcmp(&wa, &mon->workarea, sizeof(wa)) != 0) {
+            mon->workarea = wa;
+            s->workarea_changed_monitors |= bit;
         }
     }
+    s->workarea_dirty_monitors = 0;
 
-    // 2. Iterate clients and subtract struts
-    for (size_t i = 0; i < s->active_clients.length; i++) {
-        handle_t h = ptr_to_handle(s->active_clients.items[i]);
-        client_hot_t* c = server_chot(s, h);
-        client_cold_t* cold = server_ccold(s, h);
-        if (!c || !cold) continue;
-        bool has_strut = cold->strut_partial_active || cold->strut_full_active;
-        if (c->state != STATE_MAPPED && !has_strut) continue;
-
-        // Apply strut to intersecting monitors
-        for (uint32_t m = 0; m < m_count; m++) {
-            monitor_t* mon = &mons[m];
-            int32_t ml = mon->geom.x;
-            int32_t mt = mon->geom.y;
-            int32_t mr = mon->geom.x + mon->geom.w;
-            int32_t mb = mon->geom.y + mon->geom.h;
-
-            if (cold->strut.left > 0 && (int32_t)cold->strut.left > ml && (int32_t)cold->strut.left < mr) {
-                // Check if strut vertical range overlaps monitor
-                bool overlap = true;
-                if (cold->strut_partial_active) {
-                    overlap = (cold->strut.left_start_y < (uint32_t)mb && cold->strut.left_end_y > (uint32_t)mt);
-                }
-                if (overlap) {
-                    int32_t new_l = (int32_t)cold->strut.left;
-                    if (new_l > mon->workarea.x) {
-                        mon->workarea.w -= (uint16_t)(new_l - mon->workarea.x);
-                        mon->workarea.x = (int16_t)new_l;
-                    }
-                }
-            }
-            if (cold->strut.right > 0) {
-                xcb_screen_t* screen = xcb_setup_roots_iterator(xcb_get_setup(s->conn)).data;
-                int32_t r_edge = (int32_t)screen->width_in_pixels - (int32_t)cold->strut.right;
-                if (r_edge < mr && r_edge > ml) {
-                    bool overlap = true;
-                    if (cold->strut_partial_active) {
-                        overlap = (cold->strut.right_start_y < (uint32_t)mb && cold->strut.right_end_y > (uint32_t)mt);
-                    }
-                    if (overlap) {
-                        if (r_edge < (int32_t)(mon->workarea.x + mon->workarea.w)) {
-                            mon->workarea.w = (uint16_t)(r_edge - mon->workarea.x);
-                        }
-                    }
-                }
+    *out = s->monitors[0].workarea;
+}
+
+uint32_t wm_monitor_index(server_t* s, const client_hot_t* hot) {
+    if (s->monitor_count <= 1) return 0;
+
+    // Use center of the window to determine which monitor it is on
+    int center_x = hot->server.x + hot->server.w / 2;
+    int center_y = hot->server.y + hot->server.h / 2;
+
+    for (uint32_t i = 0; i < s->monitor_count; i++) {
+        monitor_t* m = &s->monitors[i];
+        if (center_x >= m->geom.x && center_x < m->geom.x + (int)m->geom.w && center_y >= m->geom.y &&
+            center_y < m->geom.y + (int)m->geom.h) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+void wm_get_monitor_workarea(server_t* s, const client_hot_t* hot, rect_t* out) {
+    if (s->monitor_count <= 1) {
+        *out = s->workarea;
+        return;
+    }
+    *out = s->monitors[wm_monitor_index(s, hot)].workarea;
+}
+
+bool wm_client_on_monitors(server_t* s, const client_hot_t* hot, uint64_t mask) {
+    if (s->monitor_count <= 1) return (mask & workarea_monitor_bit(0)) != 0;
+    return (mask & workarea_monitor_bit(wm_monitor_index(s, hot))) != 0;
+}
+
+/*
+ * Desktop membership index:
+ * Every managed client sits in exactly one bucket, its desktop or the sticky
+ * list. A workspace switch only has to look at the old and the new desktop's
+ * buckets; clients whose own desktop/sticky/state changed are queued in
+ * visibility_pending by wm_client_visibility_changed.
+ */
+static small_vec_t* desktop_index_bucket(server_t* s, int32_t desktop) {
+    if (desktop < 0) return &s->sticky_members;
+
+    uint32_t d = (uint32_t)desktop;
+    if (d >= s->desktop_members_cap) {
+        uint32_t cap = s->desktop_members_cap ? s->desktop_members_cap : 4;
+        while (cap <= d) cap *= 2;
+
+        small_vec_t* buckets = calloc(cap, sizeof(*buckets));
+        if (!buckets) {
+            LOG_ERROR("desktop index allocation failed");
+            exit(1);
+        }
+        // small_vec_t may point at its own inline storage, so move buckets field by field
+        for (uint32_t i = 0; i < cap; i++) small_vec_init(&buckets[i]);
+        for (uint32_t i = 0; i < s->desktop_members_cap; i++) {
+            small_vec_t* from = &s->desktop_members[i];
+            small_vec_t* to = &buckets[i];
+            if (from->items == from->inline_storage) {
+                memcpy(to->inline_storage, from->inline_storage, from->length * sizeof(void*));
+            } else {
+                to->items = from->items;
+                to->capacity = from->capacity;
             }
-            if (cold->strut.top > 0 && (int32_t)cold->strut.top > mt && (int32_t)cold->strut.top < mb) {
-                bool overlap = true;
-                if (cold->strut_partial_active) {
-                    overlap = (cold->strut.top_start_x < (uint32_t)mr && cold->strut.top_end_x > (uint32_t)ml);
-                }
-                if (overlap) {
-                    int32_t new_t = (int32_t)cold->strut.top;
-                    if (new_t > mon->workarea.y) {
-                        mon->workarea.h -= (uint16_t)(new_t - mon->workarea.y);
-                        mon->workarea.y = (int16_t)new_t;
-                    }
-                }
+            to->length = from->length;
+        }
+        free(s->desktop_members);
+        s->desktop_members = buckets;
+        s->desktop_members_cap = cap;
+    }
+    return &s->desktop_members[d];
+}
+
+void wm_desktop_index_remove(server_t* s, handle_t h) {
+    client_hot_t* hot = server_chot(s, h);
+    if (!hot || !hot->desktop_indexed) return;
+
+    small_vec_remove_swap(desktop_index_bucket(s, hot->indexed_desktop), handle_to_ptr(h));
+    hot->desktop_indexed = false;
+}
+
+void wm_desktop_index_update(server_t* s, handle_t h) {
+    client_hot_t* hot = server_chot(s, h);
+    if (!hot) return;
+    // Clients join at client_finish_manage, once their desktop is final
+    if (hot->state == STATE_NEW || hot->state == STATE_READY) return;
+
+    int32_t desktop = hot->sticky ? -1 : hot->desktop;
+    if (desktop < -1) desktop = -1;
+    if (hot->desktop_indexed && hot->indexed_desktop == desktop) return;
+
+    wm_desktop_index_remove(s, h);
+    small_vec_push(desktop_index_bucket(s, desktop), handle_to_ptr(h));
+    hot->indexed_desktop = desktop;
+    hot->desktop_indexed = true;
+}
+
+const small_vec_t* wm_desktop_index_members(const server_t* s, uint32_t desktop) {
+    if (desktop >= s->desktop_members_cap) return NULL;
+    return &s->desktop_members[desktop];
+}
+
+/*
+ * Placement grid:
+ * The screen is cut into square cells of (1 << PLACE_CELL_SHIFT) pixels and
+ * every managed client is filed in each cell its frame overlaps. Refiling after
+ * a geometry change only touches the old and new cell spans. Parked frames
+ * keep their real position in hot->server, so they stay filed where they
+ * will reappear.
+ */
+#define PLACE_CELL_SHIFT 8
+
+// Caps the candidate positions per axis so crowded desktops stay cheap
+#define PLACE_MAX_CANDIDATES 128
+
+static rect_t place_frame_rect(const server_t* s, const client_hot_t* hot, const rect_t* content) {
+    rect_t r = *content;
+    if (!(hot->flags & CLIENT_FLAG_UNDECORATED) && !hot->gtk_frame_extents_set) {
+        r.w = (uint16_t)(r.w + 2 * s->config.theme.border_width);
+        r.h = (uint16_t)(r.h + s->config.theme.title_height + s->config.theme.border_width);
+    }
+    return r;
+}
+
+static bool place_cell_span(const place_grid_t* g, const rect_t* r, uint16_t span[4]) {
+    int32_t x0 = r->x > 0 ? r->x : 0;
+    int32_t y0 = r->y > 0 ? r->y : 0;
+    int32_t x1 = (int32_t)r->x + (int32_t)r->w - 1;
+    int32_t y1 = (int32_t)r->y + (int32_t)r->h - 1;
+    if (x1 >= (int32_t)g->width) x1 = (int32_t)g->width - 1;
+    if (y1 >= (int32_t)g->height) y1 = (int32_t)g->height - 1;
+
+    if (r->w == 0 || r->h == 0 || x0 > x1 || y0 > y1) {
+        // Entirely off screen: filed nowhere
+        span[0] = 1;
+        span[1] = 1;
+        span[2] = 0;
+        span[3] = 0;
+        return false;
+    }
+    span[0] = (uint16_t)(x0 >> PLACE_CELL_SHIFT);
+    span[1] = (uint16_t)(y0 >> PLACE_CELL_SHIFT);
+    span[2] = (uint16_t)(x1 >> PLACE_CELL_SHIFT);
+    span[3] = (uint16_t)(y1 >> PLACE_CELL_SHIFT);
+    return true;
+}
+
+static void place_grid_free(place_grid_t* g) {
+    for (uint32_t i = 0; i < (uint32_t)g->cols * g->rows; i++) small_vec_destroy(&g->cells[i]);
+    free(g->cells);
+    g->cells = NULL;
+    g->cols = 0;
+    g->rows = 0;
+    g->width = 0;
+    g->height = 0;
+}
+
+// Returns false when there is no screen to index against
+static bool place_grid_ensure(server_t* s) {
+    if (!s->conn) return false;
+
+    int32_t sw, sh;
+    wm_screen_size(s, &sw, &sh);
+    if (sw <= 0 || sh <= 0) return false;
+
+    place_grid_t* g = &s->place_grid;
+    if (g->cells && g->width == (uint16_t)sw && g->height == (uint16_t)sh) return true;
+
+    place_grid_free(g);
+    g->width = (uint16_t)sw;
+    g->height = (uint16_t)sh;
+    g->cols = (uint16_t)(((uint32_t)sw + (1u << PLACE_CELL_SHIFT) - 1) >> PLACE_CELL_SHIFT);
+    g->rows = (uint16_t)(((uint32_t)sh + (1u << PLACE_CELL_SHIFT) - 1) >> PLACE_CELL_SHIFT);
+    g->cells = calloc((size_t)g->cols * g->rows, sizeof(*g->cells));
+    if (!g->cells) {
+        LOG_ERROR("placement grid allocation failed");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < (uint32_t)g->cols * g->rows; i++) small_vec_init(&g->cells[i]);
+
+    // New screen size: refile everyone
+    for (size_t i = 0; i < s->active_clients.length; i++) {
+        client_hot_t* hot = server_chot(s, ptr_to_handle(s->active_clients.items[i]));
+        if (hot) hot->place_indexed = false;
+    }
+    for (size_t i = 0; i < s->active_clients.length; i++) {
+        wm_place_index_update(s, ptr_to_handle(s->active_clients.items[i]));
+    }
+    return true;
+}
+
+void wm_place_index_remove(server_t* s, handle_t h) {
+    client_hot_t* hot = server_chot(s, h);
+    if (!hot || !hot->place_indexed) return;
+
+    place_grid_t* g = &s->place_grid;
+    for (uint32_t cy = hot->place_cy0; cy <= hot->place_cy1 && g->cells; cy++) {
+        for (uint32_t cx = hot->place_cx0; cx <= hot->place_cx1; cx++) {
+            small_vec_remove_swap(&g->cells[cy * g->cols + cx], handle_to_ptr(h));
+        }
+    }
+    hot->place_indexed = false;
+}
+
+void wm_place_index_update(server_t* s, handle_t h) {
+    client_hot_t* hot = server_chot(s, h);
+    if (!hot) return;
+    // Clients join at client_finish_manage, like the desktop index
+    if (hot->state == STATE_NEW || hot->state == STATE_READY) return;
+    if (!place_grid_ensure(s)) return;
+
+    place_grid_t* g = &s->place_grid;
+    rect_t r = place_frame_rect(s, hot, &hot->server);
+    uint16_t span[4];
+    place_cell_span(g, &r, span);
+    if (hot->place_indexed && hot->place_cx0 == span[0] && hot->place_cy0 == span[1] && hot->place_cx1 == span[2] &&
+        hot->place_cy1 == span[3]) {
+        return;
+    }
+
+    wm_place_index_remove(s, h);
+    for (uint32_t cy = span[1]; cy <= span[3]; cy++) {
+        for (uint32_t cx = span[0]; cx <= span[2]; cx++) {
+            small_vec_push(&g->cells[cy * g->cols + cx], handle_to_ptr(h));
+        }
+    }
+    hot->place_cx0 = span[0];
+    hot->place_cy0 = span[1];
+    hot->place_cx1 = span[2];
+    hot->place_cy1 = span[3];
+    hot->place_indexed = true;
+}
+
+void wm_place_index_destroy(server_t* s) { place_grid_free(&s->place_grid); }
+
+static bool place_is_obstacle(const client_hot_t* o, const client_hot_t* self, uint32_t desktop) {
+    if (o == self || o->state != STATE_MAPPED) return false;
+    if (o->type == WINDOW_TYPE_DESKTOP || o->type == WINDOW_TYPE_DOCK) return false;
+    return o->sticky || o->desktop < 0 || (uint32_t)o->desktop == desktop;
+}
+
+static uint64_t place_overlap(const rect_t* a, const rect_t* b) {
+    int32_t x0 = a->x > b->x ? a->x : b->x;
+    int32_t y0 = a->y > b->y ? a->y : b->y;
+    int32_t x1 = (a->x + (int32_t)a->w) < (b->x + (int32_t)b->w) ? (a->x + (int32_t)a->w) : (b->x + (int32_t)b->w);
+    int32_t y1 = (a->y + (int32_t)a->h) < (b->y + (int32_t)b->h) ? (a->y + (int32_t)a->h) : (b->y + (int32_t)b->h);
+    if (x1 <= x0 || y1 <= y0) return 0;
+    return (uint64_t)(x1 - x0) * (uint64_t)(y1 - y0);
+}
+
+/*
+ * Visit every obstacle whose frame may overlap `r`, once each.
+ * Sums the overlap with `r`, stopping early once `limit` is reached.
+ * With `edges` set, the obstacle frames are appended there as well.
+ */
+static uint64_t place_scan(server_t* s, const client_hot_t* self, uint32_t desktop, const rect_t* r, uint64_t limit,
+                           small_vec_t* edges) {
+    place_grid_t* g = &s->place_grid;
+    uint16_t span[4];
+    if (!place_cell_span(g, r, span)) return 0;
+
+    uint32_t stamp = ++g->stamp;
+    uint64_t total = 0;
+    for (uint32_t cy = span[1]; cy <= span[3]; cy++) {
+        for (uint32_t cx = span[0]; cx <= span[2]; cx++) {
+            small_vec_t* cell = &g->cells[cy * g->cols + cx];
+            for (size_t i = 0; i < cell->length; i++) {
+                client_hot_t* o = server_chot(s, ptr_to_handle(cell->items[i]));
+                if (!o || o->place_stamp == stamp) continue;
+                o->place_stamp = stamp;
+                if (!place_is_obstacle(o, self, desktop)) continue;
+
+                rect_t of = place_frame_rect(s, o, &o->server);
+                uint64_t ov = place_overlap(r, &of);
+                if (!ov) continue;
+                if (edges) small_vec_push(edges, o);
+                total += ov;
+                if (total >= limit) return total;
             }
-            if (cold->strut.bottom > 0) {
-                xcb_screen_t* screen = xcb_setup_roots_iterator(xcb_get_setup(s->conn)).data;
-                int32_t b_edge = (int32_t)screen->height_in_pixels - (int32_t)cold->strut.bottom;
-                if (b_edge < mb && b_edge > mt) {
-                    bool overlap = true;
-                    if (cold->strut_partial_active) {
-                        overlap =
-                            (cold->strut.bottom_start_x < (uint32_t)mr && cold->strut.bottom_end_x > (uint32_t)ml);
-                    }
-                    if (overlap) {
-                        if (b_edge < (int32_t)(mon->workarea.y + mon->workarea.h)) {
-                            mon->workarea.h = (uint16_t)(b_edge - mon->workarea.y);
-                        }
-                    }
-                }
+        }
+    }
+    return total;
+}
+
+static int place_cmp_i32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a;
+    int32_t y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Sorted, deduplicated, limited to [lo, hi]; thinned evenly past PLACE_MAX_CANDIDATES
+static size_t place_axis(int32_t* v, size_t n, int32_t lo, int32_t hi) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (v[i] >= lo && v[i] <= hi) v[k++] = v[i];
+    }
+    qsort(v, k, sizeof(*v), place_cmp_i32);
+
+    size_t u = 0;
+    for (size_t i = 0; i < k; i++) {
+        if (u == 0 || v[u - 1] != v[i]) v[u++] = v[i];
+    }
+    if (u <= PLACE_MAX_CANDIDATES) return u;
+
+    for (size_t i = 0; i < PLACE_MAX_CANDIDATES; i++) v[i] = v[i * u / PLACE_MAX_CANDIDATES];
+    return PLACE_MAX_CANDIDATES;
+}
+
+static void place_target_area(server_t* s, client_hot_t* hot, rect_t* area) {
+    if (s->monitor_count <= 1) {
+        *area = s->workarea;
+        return;
+    }
+
+    // New windows open on the monitor the user is working on: the focused window's is
+    // always current, the pointer cache (last input event) is only a fallback hint
+    client_hot_t* focused = server_chot(s, s->focused_client);
+    if (focused && focused != hot && focused->state == STATE_MAPPED &&
+        (focused->sticky || focused->desktop == (int32_t)s->current_desktop)) {
+        *area = s->monitors[wm_monitor_index(s, focused)].workarea;
+        return;
+    }
+    if (s->pointer.valid) {
+        for (uint32_t i = 0; i < s->monitor_count; i++) {
+            const rect_t* g = &s->monitors[i].geom;
+            if (s->pointer.x >= g->x && s->pointer.x < g->x + (int32_t)g->w && s->pointer.y >= g->y &&
+                s->pointer.y < g->y + (int32_t)g->h) {
+                *area = s->monitors[i].workarea;
+                return;
             }
         }
     }
+    wm_get_monitor_workarea(s, hot, area);
+}
 
-    // 3. Set output workarea to the primary monitor's workarea (first monitor)
-    if (s->monitor_count > 0) {
-        *out = s->monitors[0].workarea;
-    } else {
-        *out = default_mon.workarea;
+/*
+ * Smart placement:
+ * Position the frame inside the target workarea so that the area it shares
+ * with visible windows of its desktop is minimal.
+ *
+ * Strategy:
+ * - the requested position wins if it is already free
+ * - candidates are the workarea edges plus positions flush against the edges
+ *   of the windows inside the workarea (the minimum is always at such a corner)
+ * - candidates are tried top-to-bottom, left-to-right; the first free one ends
+ *   the search, otherwise the least overlap (earliest on ties) is used
+ * - every overlap sum only reads the grid cells under the candidate and stops
+ *   as soon as it cannot beat the best so far
+ *
+ * Returns false (desired left untouched) when there is no grid or the window
+ * does not fit the workarea.
+ */
+bool wm_place_smart(server_t* s, client_hot_t* hot) {
+    if (!place_grid_ensure(s)) return false;
+
+    rect_t area;
+    place_target_area(s, hot, &area);
+
+    rect_t fp = place_frame_rect(s, hot, &hot->desired);
+    if (area.w == 0 || area.h == 0 || fp.w > area.w || fp.h > area.h) return false;
+
+    uint32_t desktop = (hot->sticky || hot->desktop < 0) ? s->current_desktop : (uint32_t)hot->desktop;
+    int32_t max_x = area.x + (int32_t)area.w - (int32_t)fp.w;
+    int32_t max_y = area.y + (int32_t)area.h - (int32_t)fp.h;
+
+    rect_t cand = fp;
+    if (cand.x < area.x) cand.x = area.x;
+    if (cand.y < area.y) cand.y = area.y;
+    if (cand.x > max_x) cand.x = (int16_t)max_x;
+    if (cand.y > max_y) cand.y = (int16_t)max_y;
+    if (place_scan(s, hot, desktop, &cand, 1, NULL) == 0) {
+        hot->desired.x = cand.x;
+        hot->desired.y = cand.y;
+        return true;
+    }
+
+    small_vec_t obstacles;
+    small_vec_init(&obstacles);
+    place_scan(s, hot, desktop, &area, UINT64_MAX, &obstacles);
+
+    size_t cap = 2 + 2 * obstacles.length;
+    int32_t* xs = malloc(cap * sizeof(*xs));
+    int32_t* ys = malloc(cap * sizeof(*ys));
+    if (!xs || !ys) {
+        LOG_ERROR("placement candidate allocation failed");
+        exit(1);
+    }
+
+    size_t nx = 0, ny = 0;
+    xs[nx++] = area.x;
+    xs[nx++] = max_x;
+    ys[ny++] = area.y;
+    ys[ny++] = max_y;
+    for (size_t i = 0; i < obstacles.length; i++) {
+        const client_hot_t* o = obstacles.items[i];
+        rect_t of = place_frame_rect(s, o, &o->server);
+        xs[nx++] = of.x + (int32_t)of.w;
+        xs[nx++] = of.x - (int32_t)fp.w;
+        ys[ny++] = of.y + (int32_t)of.h;
+        ys[ny++] = of.y - (int32_t)fp.h;
+    }
+    small_vec_destroy(&obstacles);
+
+    nx = place_axis(xs, nx, area.x, max_x);
+    ny = place_axis(ys, ny, area.y, max_y);
+
+    uint64_t best = UINT64_MAX;
+    int32_t best_x = cand.x, best_y = cand.y;
+    for (size_t iy = 0; iy < ny && best; iy++) {
+        for (size_t ix = 0; ix < nx && best; ix++) {
+            cand.x = (int16_t)xs[ix];
+            cand.y = (int16_t)ys[iy];
+            uint64_t ov = place_scan(s, hot, desktop, &cand, best, NULL);
+            if (ov < best) {
+                best = ov;
+                best_x = cand.x;
+                best_y = cand.y;
+            }
+        }
     }
+    free(xs);
+    free(ys);
+
+    TRACE_LOG("smart placement h=%lx -> %d,%d overlap=%lu", hot->self, best_x, best_y, (unsigned long)best);
+    hot->desired.x = (int16_t)best_x;
+    hot->desired.y = (int16_t)best_y;
+    return true;
+}
+
+void wm_client_visibility_changed(server_t* s, handle_t h) {
+    small_vec_push(&s->visibility_pending, handle_to_ptr(h));
+    s->root_dirty |= ROOT_DIRTY_VISIBILITY;
 }
 
 void wm_switch_workspace(server_t* s, uint32_t new_desktop) {
@@ -327,12 +834,13 @@ void wm_client_move_to_workspace(server_t* s, handle_t h, uint32_t desktop, bool
 
     c->desktop = new_desk;
     c->sticky = (new_desk == -1);
+    wm_desktop_index_update(s, h);
 
     if (follow && !c->sticky) {
         wm_switch_workspace(s, desktop);
         wm_set_focus(s, h);
     } else if (c->state == STATE_MAPPED) {
-        s->root_dirty |= ROOT_DIRTY_VISIBILITY;
+        wm_client_visibility_changed(s, h);
 
         bool visible = c->sticky || (c->desktop == (int32_t)s->current_desktop);
         if (!visible && s->focused_client == h) {
@@ -357,11 +865,12 @@ void wm_client_toggle_sticky(server_t* s, handle_t h) {
     if (!c) return;
 
     c->sticky = !c->sticky;
+    wm_desktop_index_update(s, h);
 
     LOG_INFO("Client %u sticky toggled to %d", c->xid, c->sticky);
 
     if (c->state == STATE_MAPPED) {
-        s->root_dirty |= ROOT_DIRTY_VISIBILITY;
+        wm_client_visibility_changed(s, h);
 
         bool visible = c->sticky || (c->desktop == (int32_t)s->current_desktop);
         if (!visible && s->focused_client == h) {
@@ -29,15 +29,222 @@
 #include "event.h"
 #include "frame.h"
 #include "hxm.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "wm_internal.h"
 
+// Title governor: at most one title refetch per client per interval (10Hz)
+#define TITLE_COALESCE_NS 100000000ull
+
+/*
+ * Property write cache:
+ * Remembers a hash of the last value published per (window, atom) so that
+ * republishing identical bytes is dropped before it reaches the server (and
+ * wakes every pager listening for PropertyNotify). Only properties the WM owns
+ * go through it; nothing else writes them while the window is managed.
+ */
+#define PROP_CACHE_PER_WINDOW 8
+
+typedef struct prop_cache_win {
+    uint32_t count;
+    uint32_t next_evict;
+    xcb_atom_t atoms[PROP_CACHE_PER_WINDOW];
+    uint64_t hashes[PROP_CACHE_PER_WINDOW];
+} prop_cache_win_t;
+
+static uint64_t prop_cache_hash(xcb_atom_t type, uint8_t format, uint32_t len, const void* data) {
+    // FNV-1a over type, format, length and payload
+    uint64_t h = 1469598103934665603ull;
+    const uint32_t hdr[3] = {type, format, len};
+    const uint8_t* p = (const uint8_t*)hdr;
+    for (size_t i = 0; i < sizeof(hdr); i++) h = (h ^ p[i]) * 1099511628211ull;
+
+    size_t bytes = (size_t)len * (format / 8u);
+    p = (const uint8_t*)data;
+    for (size_t i = 0; p && i < bytes; i++) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+// Returns true if (win, atom) already holds `hash`; otherwise records it and returns false
+static bool prop_cache_check(server_t* s, xcb_window_t win, xcb_atom_t atom, uint64_t hash) {
+    prop_cache_win_t* pc = hash_map_get(&s->prop_cache, win);
+    if (!pc) {
+        pc = calloc(1, sizeof(*pc));
+        if (!pc) {
+            LOG_ERROR("prop cache allocation failed");
+            exit(1);
+        }
+        hash_map_insert(&s->prop_cache, win, pc);
+    }
+
+    for (uint32_t i = 0; i < pc->count; i++) {
+        if (pc->atoms[i] != atom) continue;
+        if (pc->hashes[i] == hash) return true;
+        pc->hashes[i] = hash;
+        return false;
+    }
+
+    uint32_t slot = pc->count;
+    if (slot == PROP_CACHE_PER_WINDOW) {
+        slot = pc->next_evict;
+        pc->next_evict = (pc->next_evict + 1) % PROP_CACHE_PER_WINDOW;
+    } else {
+        pc->count++;
+    }
+    pc->atoms[slot] = atom;
+    pc->hashes[slot] = hash;
+    return false;
+}
+
+bool wm_prop_publish(server_t* s, xcb_window_t win, xcb_atom_t atom, xcb_atom_t type, uint8_t format, uint32_t len,
+                     const void* data) {
+    if (win == XCB_NONE) return false;
+    if (prop_cache_check(s, win, atom, prop_cache_hash(type, format, len, data))) {
+        counters.prop_writes_skipped++;
+        return false;
+    }
+    xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, win, atom, type, format, len, data);
+    return true;
+}
+
+bool wm_prop_delete(server_t* s, xcb_window_t win, xcb_atom_t atom) {
+    if (win == XCB_NONE) return false;
+    // A deleted property hashes like an empty value of type None
+    if (prop_cache_check(s, win, atom, prop_cache_hash(XCB_ATOM_NONE, 0, 0, NULL))) {
+        counters.prop_writes_skipped++;
+        return false;
+    }
+    xcb_delete_property(s->conn, win, atom);
+    return true;
+}
+
+void wm_prop_forget(server_t* s, xcb_window_t win) {
+    if (win == XCB_NONE) return;
+    prop_cache_win_t* pc = hash_map_get(&s->prop_cache, win);
+    if (!pc) return;
+    hash_map_remove(&s->prop_cache, win);
+    free(pc);
+}
+
+void wm_prop_cache_destroy(server_t* s) {
+    for (size_t i = 0; i < s->prop_cache.capacity; i++) {
+        hash_map_entry_t* entry = &s->prop_cache.entries[i];
+        if (entry->key) free(entry->value);
+    }
+    hash_map_destroy(&s->prop_cache);
+}
+
+void wm_frame_set_parked(server_t* s, client_hot_t* hot, bool parked) {
+    if (hot->frame_parked == parked) return;
+
+    uint32_t values[2];
+    if (parked) {
+        values[0] = (uint32_t)WM_FRAME_PARK_POS;
+        values[1] = (uint32_t)WM_FRAME_PARK_POS;
+    } else {
+        values[0] = (uint32_t)(int32_t)hot->server.x;
+        values[1] = (uint32_t)(int32_t)hot->server.y;
+    }
+    xcb_configure_window(s->conn, hot->frame, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values);
+    hot->frame_parked = parked;
+}
+
+static void wm_apply_visibility(server_t* s, client_hot_t* c) {
+    if (c->state != STATE_MAPPED) return;
+
+    bool visible = c->sticky || (c->desktop == (int32_t)s->current_desktop);
+    bool shown = c->frame_mapped && !c->frame_parked;
+    if (visible == shown) return;
+
+    if (visible) {
+        wm_frame_set_parked(s, c, false);
+        if (!c->frame_mapped) xcb_map_window(s->conn, c->frame);
+        c->frame_mapped = true;
+        uint32_t state_vals[] = {XCB_ICCCM_WM_STATE_NORMAL, XCB_NONE};
+        wm_prop_publish(s, c->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2, state_vals);
+    } else {
+        if (s->config.workspace_hide == WORKSPACE_HIDE_PARK) {
+            // Stays mapped: the client keeps its contents and skips a full repaint when shown again
+            wm_frame_set_parked(s, c, true);
+        } else {
+            uint8_t echoes = client_frame_unmap_echoes(c);
+            c->ignore_unmap = (c->ignore_unmap > UINT8_MAX - echoes) ? UINT8_MAX : (uint8_t)(c->ignore_unmap + echoes);
+            xcb_unmap_window(s->conn, c->frame);
+            c->frame_mapped = false;
+        }
+        uint32_t state_vals[] = {XCB_ICCCM_WM_STATE_ICONIC, XCB_NONE};
+        wm_prop_publish(s, c->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2, state_vals);
+    }
+
+    // _NET_WM_STATE_HIDDEN follows
+    c->dirty |= DIRTY_STATE;
+}
+
+static void wm_apply_visibility_list(server_t* s, const small_vec_t* v) {
+    if (!v) return;
+    for (size_t i = 0; i < v->length; i++) {
+        client_hot_t* c = server_chot(s, ptr_to_handle(v->items[i]));
+        if (c) wm_apply_visibility(s, c);
+    }
+}
+
 static bool wm_client_is_hidden(const server_t* s, const client_hot_t* hot) {
     if (hot->state != STATE_MAPPED) return true;
     if (!hot->sticky && hot->desktop != (int32_t)s->current_desktop) return true;
     return false;
 }
 
+/*
+ * wm_frame_is_occluded:
+ * Whether an opaque fullscreen client on screen covers the whole frame.
+ *
+ * Logic:
+ * - only frames below the fullscreen layer can be covered
+ * - the occluder must be mapped on the current desktop and not see-through
+ *   (ARGB visual or _NET_WM_WINDOW_OPACITY below opaque)
+ * - the frame rect includes title and borders; the occluder's is its client rect
+ */
+static bool wm_frame_is_occluded(const server_t* s, const client_hot_t* hot) {
+    if (hot->stacking_layer >= LAYER_FULLSCREEN) return false;
+
+    uint16_t bw = s->config.theme.border_width;
+    int32_t x0 = hot->server.x;
+    int32_t y0 = hot->server.y;
+    int32_t x1 = x0 + hot->server.w + 2 * bw;
+    int32_t y1 = y0 + hot->server.h + s->config.theme.title_height + bw;
+
+    for (const client_hot_t* fs = s->layers[LAYER_FULLSCREEN].bottom; fs; fs = fs->stack_above) {
+        if (wm_client_is_hidden(s, fs) || !fs->frame_mapped || fs->frame_parked) continue;
+        if (fs->depth == 32) continue;
+        if (fs->window_opacity_valid && fs->window_opacity != 0xFFFFFFFFu) continue;
+
+        if (fs->server.x <= x0 && fs->server.y <= y0 && fs->server.x + fs->server.w >= x1 &&
+            fs->server.y + fs->server.h >= y1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool wm_frame_needs_paint(const client_hot_t* hot) {
+    if (hot->flags & CLIENT_FLAG_UNDECORATED) return false;
+    uint32_t f_dirty = DIRTY_FRAME_ALL | DIRTY_FRAME_TITLE | DIRTY_FRAME_BUTTONS | DIRTY_FRAME_BORDER | DIRTY_FRAME_STYLE;
+    return (hot->dirty & f_dirty) || hot->frame_damage.valid;
+}
+
+/*
+ * wm_frame_is_visible:
+ * Whether painting the frame now would reach the screen.
+ *
+ * Frames that fail this keep their DIRTY_FRAME_* bits and damage; the flush
+ * after the visibility pass, a restore or a map paints them once.
+ */
+static bool wm_frame_is_visible(const server_t* s, const client_hot_t* hot) {
+    if (wm_client_is_hidden(s, hot)) return false;
+    if (!hot->frame_mapped || hot->frame_parked || hot->show_desktop_hidden) return false;
+    return !wm_frame_is_occluded(s, hot);
+}
+
 static void wm_send_sync_request(server_t* s, const client_hot_t* hot, uint64_t value, uint32_t time) {
     xcb_client_message_event_t ev;
     memset(&ev, 0, sizeof(ev));
@@ -118,18 +325,23 @@ void wm_publish_workarea(server_t* s, const rect_t* wa) {
         }
     }
 
-    if (!changed) return;
+    // The primary monitor's workarea is monitor 0's
+    uint64_t moved = s->workarea_changed_monitors | (changed ? 1ull : 0ull);
+    s->workarea_changed_monitors = 0;
+    if (!moved) return;
 
-    // Re-apply workarea-dependent geometry for maximized/fullscreen windows
+    // Re-apply workarea-dependent geometry for maximized/fullscreen windows on the monitors that moved
     for (size_t i = 0; i < s->active_clients.length; i++) {
         handle_t h = ptr_to_handle(s->active_clients.items[i]);
         client_hot_t* hot = server_chot(s, h);
         if (!hot) continue;
 
         if (hot->state == STATE_UNMANAGING || hot->state == STATE_DESTROYED) continue;
+        if (hot->layer != LAYER_FULLSCREEN && !hot->maximized_horz && !hot->maximized_vert) continue;
+        if (!wm_client_on_monitors(s, hot, moved)) continue;
 
         if (hot->layer == LAYER_FULLSCREEN && s->config.fullscreen_use_workarea) {
-            hot->desired = s->workarea;
+            wm_get_monitor_workarea(s, hot, &hot->desired);
             hot->dirty |= DIRTY_GEOM;
         } else if (hot->maximized_horz || hot->maximized_vert) {
             wm_client_set_maximize(s, hot, hot->maximized_horz, hot->maximized_vert);
@@ -137,22 +349,35 @@ void wm_publish_workarea(server_t* s, const rect_t* wa) {
     }
 }
 
+#ifndef NDEBUG
+// Duplicate check for the root lists: one bit per slotmap slot, so a rebuild stays O(n)
+static uint64_t* client_list_seen_alloc(server_t* s) {
+    size_t words = ((size_t)s->clients.cap + 63u) / 64u;
+    uint64_t* seen = arena_alloc(&s->tick_arena, words * sizeof(uint64_t));
+    memset(seen, 0, words * sizeof(uint64_t));
+    return seen;
+}
+
+static void client_list_assert_unique(uint64_t* seen, handle_t h) {
+    uint32_t i = handle_index(h);
+    assert(!(seen[i / 64u] & (1ull << (i % 64u))));
+    seen[i / 64u] |= 1ull << (i % 64u);
+}
+#endif
+
 static uint32_t wm_build_client_list_stacking(server_t* s, xcb_window_t* out, uint32_t cap) {
     if (!s || !out || !cap) return 0;
 
+#ifndef NDEBUG
+    uint64_t* seen = client_list_seen_alloc(s);
+#endif
     uint32_t idx = 0;
     for (int l = 0; l < LAYER_COUNT; l++) {
-        small_vec_t* v = &s->layers[l];
-        for (size_t i = 0; i < v->length; i++) {
-            handle_t h = ptr_to_handle(v->items[i]);
-            client_hot_t* hot = server_chot(s, h);
-            if (!hot) continue;
+        for (const client_hot_t* hot = s->layers[l].bottom; hot; hot = hot->stack_above) {
             if (hot->state == STATE_UNMANAGING || hot->state == STATE_DESTROYED) continue;
             if (idx >= cap) return idx;
 #ifndef NDEBUG
-            for (uint32_t j = 0; j < idx; j++) {
-                assert(out[j] != hot->xid);
-            }
+            client_list_assert_unique(seen, hot->self);
 #endif
             out[idx++] = hot->xid;
         }
@@ -164,6 +389,9 @@ static uint32_t wm_build_client_list_stacking(server_t* s, xcb_window_t* out, ui
 static uint32_t wm_build_client_list(server_t* s, xcb_window_t* out, uint32_t cap) {
     if (!s || !out || !cap) return 0;
 
+#ifndef NDEBUG
+    uint64_t* seen = client_list_seen_alloc(s);
+#endif
     uint32_t idx = 0;
     for (size_t i = 0; i < s->active_clients.length; i++) {
         handle_t h = ptr_to_handle(s->active_clients.items[i]);
@@ -173,22 +401,59 @@ static uint32_t wm_build_client_list(server_t* s, xcb_window_t* out, uint32_t ca
 
         if (idx >= cap) return idx;
 #ifndef NDEBUG
-        for (uint32_t j = 0; j < idx; j++) {
-            assert(out[j] != hot->xid);
-        }
+        client_list_assert_unique(seen, h);
 #endif
         out[idx++] = hot->xid;
     }
     return idx;
 }
 
+/*
+ * Publish a root window list against what was last written:
+ * - identical: no request
+ * - old list is a prefix (e.g. a newly managed window): PropModeAppend with the tail
+ * - otherwise: PropModeReplace
+ */
+static void wm_publish_window_list(server_t* s, xcb_atom_t atom, published_windows_t* pub, const xcb_window_t* wins,
+                                   uint32_t n) {
+    uint32_t prefix = 0;
+    uint32_t common = n < pub->len ? n : pub->len;
+    while (prefix < common && pub->items[prefix] == wins[prefix]) prefix++;
+
+    if (prefix == n && n == pub->len) {
+        counters.prop_writes_skipped++;
+        return;
+    }
+
+    if (prefix == pub->len) {
+        xcb_change_property(s->conn, XCB_PROP_MODE_APPEND, s->root, atom, XCB_ATOM_WINDOW, 32, n - prefix,
+                            wins + prefix);
+    } else {
+        xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, s->root, atom, XCB_ATOM_WINDOW, 32, n, wins);
+    }
+
+    if (n > pub->cap) {
+        uint32_t cap = pub->cap ? pub->cap : 16;
+        while (cap < n) cap *= 2;
+        xcb_window_t* items = realloc(pub->items, cap * sizeof(*items));
+        if (!items) {
+            LOG_ERROR("client list allocation failed");
+            exit(1);
+        }
+        pub->items = items;
+        pub->cap = cap;
+    }
+    if (n > prefix) memcpy(pub->items + prefix, wins + prefix, (n - prefix) * sizeof(*wins));
+    pub->len = n;
+}
+
 /*
  * wm_flush_dirty:
  * Commit all pending state changes to the X server.
  *
  * Phases:
  * 1. Visibility: Map/Unmap windows based on desktop state.
- * 2. Per-Client Updates: Flush geometry, title, hints, and stacking.
+ * 2. Per-Client Updates: Flush geometry, title, hints; stacking is committed once for all clients.
  * 3. Focus Commit: Apply deferred focus changes (SetInputFocus).
  * 4. Root Properties: Update _NET_CLIENT_LIST, WORKAREA, etc.
  *
@@ -196,6 +461,7 @@ static uint32_t wm_build_client_list(server_t* s, xcb_window_t* out, uint32_t ca
  */
 bool wm_flush_dirty(server_t* s, uint64_t now) {
     bool flushed = false;
+    bool restack = false;
     s->in_commit_phase = true;
 
     // 0. Handle new clients ready to be managed
@@ -215,50 +481,21 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
     }
 
     // 1. Visibility (Map/Unmap) - Must happen before focus
+    // Only the old and new desktop's members can change visibility on a switch, plus
+    // clients queued by wm_client_visibility_changed; frames already in the right map
+    // state are left alone
     if (s->root_dirty & ROOT_DIRTY_VISIBILITY) {
         flushed = true;
-        for (size_t i = 0; i < s->active_clients.length;) {
-            void* ptr = s->active_clients.items[i];
-            handle_t h = ptr_to_handle(ptr);
-            client_hot_t* c = server_chot(s, h);
-            if (!c) {
-                if (i < s->active_clients.length && s->active_clients.items[i] == ptr) i++;
-                continue;
-            }
 
-            if (c->state != STATE_MAPPED) {
-                if (i < s->active_clients.length && s->active_clients.items[i] == ptr) i++;
-                continue;
-            }
+        if (s->visible_desktop != s->current_desktop) {
+            wm_apply_visibility_list(s, wm_desktop_index_members(s, s->visible_desktop));
+            wm_apply_visibility_list(s, wm_desktop_index_members(s, s->current_desktop));
+            s->visible_desktop = s->current_desktop;
+        }
 
-            bool visible = c->sticky || (c->desktop == (int32_t)s->current_desktop);
-            if (visible) {
-                // Ensure mapped
-                // We don't track "actually mapped" bit perfectly besides state=MAPPED.
-                // But since we use deferred visibility for workspace switch, we assume
-                // if it's MAPPED state, it SHOULD be mapped if visible.
-                // Ideally we'd check if it's already mapped to avoid redundant
-                // requests, but XCB map on mapped window is no-op. However, we want to
-                // update WM_STATE property too.
-
-                // Optimization: track visibility in client or just blindly apply?
-                // Blindly applying is safer for "commit" style.
-                xcb_map_window(s->conn, c->frame);
-                uint32_t state_vals[] = {XCB_ICCCM_WM_STATE_NORMAL, XCB_NONE};
-                xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, c->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2,
-                                    state_vals);
-            } else {
-                if (c->ignore_unmap < UINT8_MAX) c->ignore_unmap++;
-                xcb_unmap_window(s->conn, c->frame);
-                uint32_t state_vals[] = {XCB_ICCCM_WM_STATE_ICONIC, XCB_NONE};
-                xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, c->xid, atoms.WM_STATE, atoms.WM_STATE, 32, 2,
-                                    state_vals);
-            }
+        wm_apply_visibility_list(s, &s->visibility_pending);
+        small_vec_clear(&s->visibility_pending);
 
-            if (i < s->active_clients.length && s->active_clients.items[i] == ptr) {
-                i++;
-            }
-        }
         s->root_dirty &= ~ROOT_DIRTY_VISIBILITY;
     }
 
@@ -288,6 +525,9 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
             continue;
         }
 
+        // Ahead of the configure, so a frame going fullscreen is never repainted at the new size
+        if (hot->dirty & (DIRTY_GEOM | DIRTY_STATE)) frame_sync_bypass(s, hot);
+
         if (hot->dirty & DIRTY_GEOM) {
             bool interactive =
                 ((s->interaction_mode == INTERACTION_RESIZE || s->interaction_mode == INTERACTION_MOVE) &&
@@ -344,8 +584,11 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
             int32_t client_h_calc = (int32_t)hot->desired.h;
 
             if (hot->gtk_frame_extents_set) {
-                frame_x -= (int32_t)hot->gtk_extents.left;
-                frame_y -= (int32_t)hot->gtk_extents.top;
+                // Fullscreen geometry is the monitor itself, not the content inside the shadow
+                if (hot->layer != LAYER_FULLSCREEN) {
+                    frame_x -= (int32_t)hot->gtk_extents.left;
+                    frame_y -= (int32_t)hot->gtk_extents.top;
+                }
 
                 client_w_calc = frame_w;
                 client_h_calc = frame_h;
@@ -374,13 +617,17 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
                 frame_values[1] = (uint32_t)frame_y;
                 frame_values[2] = frame_w;
                 frame_values[3] = frame_h;
+                if (hot->frame_parked) {
+                    // Resize in place off screen; wm_frame_set_parked restores server.x/y
+                    frame_values[0] = (uint32_t)WM_FRAME_PARK_POS;
+                    frame_values[1] = (uint32_t)WM_FRAME_PARK_POS;
+                }
 
                 xcb_configure_window(
                     s->conn, hot->frame,
                     XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
                     frame_values);
 
-                uint32_t client_values[4];
                 int32_t local_x = bw;
                 int32_t local_y = th;
 
@@ -389,15 +636,19 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
                     local_y = 0;
                 }
 
-                client_values[0] = (uint32_t)local_x;
-                client_values[1] = (uint32_t)local_y;
-                client_values[2] = client_w;
-                client_values[3] = client_h;
-
-                xcb_configure_window(
-                    s->conn, hot->xid,
-                    XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
-                    client_values);
+                // Frameless: frame and client are one window, already configured above
+                if (!client_is_frameless(hot)) {
+                    uint32_t client_values[4];
+                    client_values[0] = (uint32_t)local_x;
+                    client_values[1] = (uint32_t)local_y;
+                    client_values[2] = client_w;
+                    client_values[3] = client_h;
+
+                    xcb_configure_window(
+                        s->conn, hot->xid,
+                        XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
+                        client_values);
+                }
 
                 // Set _NET_FRAME_EXTENTS
                 uint32_t extents[4] = {bw, bw, th + bw, bw};
@@ -407,16 +658,16 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
                     extents[2] = 0;
                     extents[3] = 0;
                 }
-                xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_FRAME_EXTENTS,
-                                    XCB_ATOM_CARDINAL, 32, 4, extents);
+                wm_prop_publish(s, hot->xid, atoms._NET_FRAME_EXTENTS, XCB_ATOM_CARDINAL, 32, 4, extents);
 
                 // Update server state immediately to ensure redraw uses correct geometry
                 hot->server.x = (int16_t)frame_x;
                 hot->server.y = (int16_t)frame_y;
                 hot->server.w = (uint16_t)client_w;
                 hot->server.h = (uint16_t)client_h;
+                wm_place_index_update(s, h);
 
-                frame_redraw(s, h, FRAME_REDRAW_ALL);
+                if (!client_is_frameless(hot)) frame_redraw(s, h, FRAME_REDRAW_ALL);
 
                 LOG_DEBUG("Flushed DIRTY_GEOM for %lx: Frame Global(%d,%d) Client Local(%d,%d) %dx%d", h, frame_x,
                           frame_y, local_x, local_y, client_w, client_h);
@@ -435,79 +686,50 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
         }
     end_dirty_geom:
 
-        if (hot->dirty & DIRTY_TITLE) {
-            flushed = true;
-            uint32_t c =
-                xcb_get_property(s->conn, 0, hot->xid, atoms._NET_WM_NAME, atoms.UTF8_STRING, 0, 1024).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h, ((uint64_t)hot->xid << 32) | atoms._NET_WM_NAME,
-                            s->txn_id, wm_handle_reply);
-
-            c = xcb_get_property(s->conn, 0, hot->xid, atoms.WM_NAME, XCB_ATOM_STRING, 0, 1024).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h, ((uint64_t)hot->xid << 32) | atoms.WM_NAME,
-                            s->txn_id, wm_handle_reply);
-
-            hot->dirty &= ~DIRTY_TITLE;
-        }
-
-        if (hot->dirty & DIRTY_HINTS) {
-            flushed = true;
-            uint32_t c =
-                xcb_get_property(s->conn, 0, hot->xid, atoms.WM_NORMAL_HINTS, XCB_ATOM_WM_SIZE_HINTS, 0, 32).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h,
-                            ((uint64_t)hot->xid << 32) | atoms.WM_NORMAL_HINTS, s->txn_id, wm_handle_reply);
-
-            c = xcb_get_property(s->conn, 0, hot->xid, atoms.WM_HINTS, atoms.WM_HINTS, 0, 32).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h, ((uint64_t)hot->xid << 32) | atoms.WM_HINTS,
-                            s->txn_id, wm_handle_reply);
-
-            c = xcb_get_property(s->conn, 0, hot->xid, atoms.WM_COLORMAP_WINDOWS, XCB_ATOM_WINDOW, 0, 64).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h,
-                            ((uint64_t)hot->xid << 32) | atoms.WM_COLORMAP_WINDOWS, s->txn_id, wm_handle_reply);
-
-            c = xcb_get_property(s->conn, 0, hot->xid, atoms._MOTIF_WM_HINTS, XCB_ATOM_ANY, 0, 5).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h,
-                            ((uint64_t)hot->xid << 32) | atoms._MOTIF_WM_HINTS, s->txn_id, wm_handle_reply);
-
-            c = xcb_get_property(s->conn, 0, hot->xid, atoms._GTK_FRAME_EXTENTS, XCB_ATOM_CARDINAL, 0, 4).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h,
-                            ((uint64_t)hot->xid << 32) | atoms._GTK_FRAME_EXTENTS, s->txn_id, wm_handle_reply);
-
-            hot->dirty &= ~DIRTY_HINTS;
-        }
-
-        if (hot->dirty & DIRTY_STRUT) {
-            flushed = true;
-            uint32_t c =
-                xcb_get_property(s->conn, 0, hot->xid, atoms._NET_WM_STRUT_PARTIAL, XCB_ATOM_CARDINAL, 0, 12).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h,
-                            ((uint64_t)hot->xid << 32) | atoms._NET_WM_STRUT_PARTIAL, s->txn_id, wm_handle_reply);
-
-            c = xcb_get_property(s->conn, 0, hot->xid, atoms._NET_WM_STRUT, XCB_ATOM_CARDINAL, 0, 4).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h, ((uint64_t)hot->xid << 32) | atoms._NET_WM_STRUT,
-                            s->txn_id, wm_handle_reply);
-
-            hot->dirty &= ~DIRTY_STRUT;
-        }
-
-        if (hot->dirty & DIRTY_OPACITY) {
-            flushed = true;
-            uint32_t c =
-                xcb_get_property(s->conn, 0, hot->xid, atoms._NET_WM_WINDOW_OPACITY, XCB_ATOM_CARDINAL, 0, 1).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h,
-                            ((uint64_t)hot->xid << 32) | atoms._NET_WM_WINDOW_OPACITY, s->txn_id, wm_handle_reply);
+        // Property refetches (DIRTY_TITLE, DIRTY_HINTS, DIRTY_STRUT, DIRTY_OPACITY): only the atoms
+        // PropertyNotify recorded are fetched, deletions are applied without a request
+        if (hot->dirty & prop_schema_dirty_mask()) {
+            uint32_t groups = hot->dirty & prop_schema_dirty_mask();
+
+            // Shells and progress bars can retitle many times per second. Within the governor
+            // interval DIRTY_TITLE stays set (the changed atoms stay recorded) and is committed
+            // once on the trailing edge; the first update after a quiet period goes out at once
+            if (groups & DIRTY_TITLE) {
+                uint64_t since = now - hot->title_fetch_ns;
+                if (hot->title_fetch_ns != 0 && now >= hot->title_fetch_ns && since < TITLE_COALESCE_NS) {
+                    groups &= ~DIRTY_TITLE;
+                    counters.title_fetches_deferred++;
+                    server_schedule_timer(s, (int)((TITLE_COALESCE_NS - since) / 1000000) + 1);
+                } else {
+                    hot->title_fetch_ns = now;
+                }
+            }
 
-            hot->dirty &= ~DIRTY_OPACITY;
+            if (groups) {
+                flushed = true;
+                hot->dirty &= ~groups;
+                prop_schema_commit(s, h, hot, groups);
+            }
         }
 
         if (hot->dirty & DIRTY_DESKTOP) {
             flushed = true;
             uint32_t desktop = hot->sticky ? 0xFFFFFFFFu : (uint32_t)hot->desktop;
-            xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_WM_DESKTOP, XCB_ATOM_CARDINAL, 32,
-                                1, &desktop);
+            wm_prop_publish(s, hot->xid, atoms._NET_WM_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &desktop);
             hot->dirty &= ~DIRTY_DESKTOP;
         }
 
-        frame_flush(s, h);
+        if (client_is_frameless(hot)) {
+            // Nothing of ours to paint
+            hot->dirty &= ~(DIRTY_FRAME_ALL | DIRTY_FRAME_TITLE | DIRTY_FRAME_BUTTONS | DIRTY_FRAME_BORDER |
+                            DIRTY_FRAME_STYLE);
+            dirty_region_reset(&hot->frame_damage);
+        } else if (wm_frame_needs_paint(hot) && !wm_frame_is_visible(s, hot)) {
+            // Nobody would see the paint: the bits stay until the frame is shown
+            counters.frame_redraws_deferred++;
+        } else {
+            frame_flush(s, h);
+        }
 
         if (hot->dirty & DIRTY_STACK) {
             flushed = true;
@@ -522,7 +744,7 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
                 stack_move_to_layer(s, h);
             }
 
-            stack_sync_to_xcb(s, h);
+            restack = true;
             hot->dirty &= ~DIRTY_STACK;
         }
 
@@ -556,8 +778,7 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
             if (wm_client_is_hidden(s, hot)) state_atoms[count++] = atoms._NET_WM_STATE_HIDDEN;
             if (hot->flags & CLIENT_FLAG_FOCUSED) state_atoms[count++] = atoms._NET_WM_STATE_FOCUSED;
 
-            xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_WM_STATE, XCB_ATOM_ATOM, 32, count,
-                                state_atoms);
+            wm_prop_publish(s, hot->xid, atoms._NET_WM_STATE, XCB_ATOM_ATOM, 32, count, state_atoms);
 
             // Set _NET_WM_ALLOWED_ACTIONS
             xcb_atom_t actions[16];
@@ -580,8 +801,7 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
                 actions[num_actions++] = atoms._NET_WM_ACTION_FULLSCREEN;
             }
 
-            xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->xid, atoms._NET_WM_ALLOWED_ACTIONS, XCB_ATOM_ATOM,
-                                32, num_actions, actions);
+            wm_prop_publish(s, hot->xid, atoms._NET_WM_ALLOWED_ACTIONS, XCB_ATOM_ATOM, 32, num_actions, actions);
 
             hot->dirty &= ~DIRTY_STATE;
         }
@@ -591,6 +811,9 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
         }
     }
 
+    // Stacking: one diff against the committed order covers every DIRTY_STACK client
+    if (restack) stack_commit(s);
+
     // Commit Focus
     if (s->committed_focus != s->initial_focus) {
         // Handle initial condition where they might be different?
@@ -655,27 +878,16 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
         if (s->focused_client != HANDLE_INVALID) {
             client_hot_t* c = server_chot(s, s->focused_client);
             if (c) {
-                xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, s->root, atoms._NET_ACTIVE_WINDOW, XCB_ATOM_WINDOW,
-                                    32, 1, &c->xid);
+                wm_prop_publish(s, s->root, atoms._NET_ACTIVE_WINDOW, XCB_ATOM_WINDOW, 32, 1, &c->xid);
             }
         } else {
-            xcb_delete_property(s->conn, s->root, atoms._NET_ACTIVE_WINDOW);
+            wm_prop_delete(s, s->root, atoms._NET_ACTIVE_WINDOW);
         }
         s->root_dirty &= ~ROOT_DIRTY_ACTIVE_WINDOW;
     }
 
-    if (s->root_dirty & (ROOT_DIRTY_CLIENT_LIST | ROOT_DIRTY_CLIENT_LIST_STACKING)) {
+    if (s->root_dirty & ROOT_DIRTY_CLIENT_LIST) {
         flushed = true;
-        size_t cap = 0;
-        for (int l = 0; l < LAYER_COUNT; l++) cap += s->layers[l].length;
-
-        xcb_window_t* wins_stacking =
-            cap ? (xcb_window_t*)arena_alloc(&s->tick_arena, cap * sizeof(xcb_window_t)) : NULL;
-
-        uint32_t idx_stacking = 0;
-        if (wins_stacking) {
-            idx_stacking = wm_build_client_list_stacking(s, wins_stacking, (uint32_t)cap);
-        }
 
         // _NET_CLIENT_LIST: mapping order (slotmap order), minus docks and
         // skip-taskbar/pager clients.
@@ -687,19 +899,24 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
         if (wins_list) {
             idx_list = wm_build_client_list(s, wins_list, cap_list);
         }
+        wm_publish_window_list(s, atoms._NET_CLIENT_LIST, &s->client_list_pub, wins_list, idx_list);
+    }
 
-        if (s->root_dirty & ROOT_DIRTY_CLIENT_LIST) {
-            xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, s->root, atoms._NET_CLIENT_LIST, XCB_ATOM_WINDOW, 32,
-                                idx_list, wins_list);
-        }
+    if (s->root_dirty & ROOT_DIRTY_CLIENT_LIST_STACKING) {
+        flushed = true;
+        size_t cap = 0;
+        for (int l = 0; l < LAYER_COUNT; l++) cap += s->layers[l].length;
 
-        if (s->root_dirty & ROOT_DIRTY_CLIENT_LIST_STACKING) {
-            xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, s->root, atoms._NET_CLIENT_LIST_STACKING,
-                                XCB_ATOM_WINDOW, 32, idx_stacking, wins_stacking);
-        }
+        xcb_window_t* wins_stacking =
+            cap ? (xcb_window_t*)arena_alloc(&s->tick_arena, cap * sizeof(xcb_window_t)) : NULL;
 
-        s->root_dirty &= ~(ROOT_DIRTY_CLIENT_LIST | ROOT_DIRTY_CLIENT_LIST_STACKING);
+        uint32_t idx_stacking = 0;
+        if (wins_stacking) {
+            idx_stacking = wm_build_client_list_stacking(s, wins_stacking, (uint32_t)cap);
+        }
+        wm_publish_window_list(s, atoms._NET_CLIENT_LIST_STACKING, &s->client_stack_pub, wins_stacking, idx_stacking);
     }
+    s->root_dirty &= ~(ROOT_DIRTY_CLIENT_LIST | ROOT_DIRTY_CLIENT_LIST_STACKING);
 
     if (s->root_dirty & ROOT_DIRTY_WORKAREA) {
         flushed = true;
@@ -716,16 +933,14 @@ bool wm_flush_dirty(server_t* s, uint64_t now) {
 
     if (s->root_dirty & ROOT_DIRTY_CURRENT_DESKTOP) {
         flushed = true;
-        xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, s->root, atoms._NET_CURRENT_DESKTOP, XCB_ATOM_CARDINAL, 32,
-                            1, &s->current_desktop);
+        wm_prop_publish(s, s->root, atoms._NET_CURRENT_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &s->current_desktop);
         s->root_dirty &= ~ROOT_DIRTY_CURRENT_DESKTOP;
     }
 
     if (s->root_dirty & ROOT_DIRTY_SHOWING_DESKTOP) {
         flushed = true;
         uint32_t val = s->showing_desktop ? 1u : 0u;
-        xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, s->root, atoms._NET_SHOWING_DESKTOP, XCB_ATOM_CARDINAL, 32,
-                            1, &val);
+        wm_prop_publish(s, s->root, atoms._NET_SHOWING_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &val);
         s->root_dirty &= ~ROOT_DIRTY_SHOWING_DESKTOP;
     }
 
@@ -4,14 +4,14 @@
  * This module manages:
  * - Global key bindings (Alt-Tab, Workspace switching, etc.).
  * - Focus cycling logic (MRU traversal).
- * - Executing external commands (spawn).
+ * - Executing external commands (through the launcher).
  */
 
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
-#include <sys/wait.h>
 #include <unistd.h>
 
 #ifndef TEST_WM_INPUT_KEYS
@@ -23,6 +23,7 @@
 #include "config.h"
 #include "event.h"
 #include "hxm.h"
+#include "launcher.h"
 #include "menu.h"
 #include "wm.h"
 #include "wm_internal.h"
@@ -46,29 +47,76 @@ uint32_t wm_clean_mods(uint16_t state) {
     return state & ~(XCB_MOD_MASK_LOCK | XCB_MOD_MASK_2 | XCB_MOD_MASK_5);
 }
 
-#ifndef TEST_WM_INPUT_KEYS
-static void spawn(const char* cmd) {
-    if (!cmd) return;
-
-    // Double fork to avoid zombies if SIGCHLD isn't trapped globally
-    pid_t pid = fork();
-    if (pid == 0) {
-        if (fork() == 0) {
-            setsid();
-            char* args[] = {"/bin/sh", "-c", (char*)cmd, NULL};
-            execvp(args[0], args);
-            // Use _exit to avoid flushing parent stdio buffers
-            perror("spawn execvp failed");
-            _exit(127);
+// Modifier bits that survive wm_clean_mods and can be part of a binding:
+// Shift (0), Control (2), Mod1 (3), Mod3 (5), Mod4 (6)
+#define KEY_TABLE_MOD_BITS 0x6Du
+
+// Packs cleaned modifiers into a table column; -1 if the state carries anything else (e.g. a held button)
+static int key_table_column(uint32_t clean) {
+    if (clean & ~KEY_TABLE_MOD_BITS) return -1;
+    return (int)((clean & 0x1u) | ((clean >> 1) & 0x6u) | ((clean >> 2) & 0x18u));
+}
+
+// Inverse of key_table_column: the modifier mask a column stands for
+static uint16_t key_table_column_mods(uint32_t col) {
+    return (uint16_t)((col & 0x1u) | ((col & 0x6u) << 1) | ((col & 0x18u) << 2));
+}
+
+/*
+ * key_table_compile:
+ * Rebuild s->key_table from the configured bindings and the current keymap.
+ *
+ * Logic:
+ * - every keycode's base keysym (column 0) comes from s->keymap; presses
+ *   never call into xcb_keysyms
+ * - a binding lands on each keycode whose base keysym equals its keysym,
+ *   matching what the old per-press comparison accepted
+ * - the first binding in config order wins a slot, as the linear scan did
+ */
+static void key_table_compile(server_t* s) {
+    key_table_t* t = &s->key_table;
+    if (!t->slots) {
+        t->slots = calloc((size_t)KEY_TABLE_KEYCODES * KEY_TABLE_MODS, sizeof(*t->slots));
+        if (!t->slots) {
+            LOG_ERROR("key table allocation failed");
+            exit(1);
         }
-        _exit(0);
+    } else {
+        memset(t->slots, 0, (size_t)KEY_TABLE_KEYCODES * KEY_TABLE_MODS * sizeof(*t->slots));
     }
-    // Wait for the intermediate child
-    if (pid > 0) {
-        waitpid(pid, NULL, 0);
+    memset(t->escape, 0, sizeof(t->escape));
+
+    size_t bound = 0;
+    for (uint32_t k = 8; k < KEY_TABLE_KEYCODES; k++) {
+        xcb_keysym_t sym = s->keymap.base[k];
+        if (sym == XK_Escape) t->escape[k >> 3] |= (uint8_t)(1u << (k & 7));
+        if (sym == 0) continue;
+
+        for (size_t i = 0; i < s->config.key_bindings.length; i++) {
+            const key_binding_t* b = s->config.key_bindings.items[i];
+            if (!b || b->keysym != sym) continue;
+
+            int col = key_table_column(b->modifiers);
+            if (col < 0) continue;
+            const key_binding_t** slot = &t->slots[k * KEY_TABLE_MODS + (uint32_t)col];
+            if (!*slot) {
+                *slot = b;
+                bound++;
+            }
+        }
     }
+    LOG_DEBUG("Compiled %zu key table slots for %zu bindings", bound, (size_t)s->config.key_bindings.length);
+}
+
+static const key_binding_t* key_table_lookup(const key_table_t* t, xcb_keycode_t keycode, uint32_t clean) {
+    int col = key_table_column(clean);
+    if (!t->slots || col < 0) return NULL;
+    return t->slots[(uint32_t)keycode * KEY_TABLE_MODS + (uint32_t)col];
+}
+
+static bool key_table_is_escape(const key_table_t* t, xcb_keycode_t keycode) {
+    return (t->escape[keycode >> 3] >> (keycode & 7)) & 1u;
 }
-#endif
 
 // Helper predicate for focus cycling
 static bool is_focusable(client_hot_t* c, server_t* s) {
@@ -94,78 +142,165 @@ static bool is_focusable(client_hot_t* c, server_t* s) {
     }
 }
 
-void wm_cycle_focus(server_t* s, bool forward) {
-    if (list_empty(&s->focus_history)) return;
+/*
+ * cycle_focus_target:
+ * Find the next focusable client after `from` in the focus history (before it
+ * when walking backwards), wrapping around the list.
+ *
+ * Logic:
+ * - with no `from` client the walk starts at the list head
+ * - landing back on `from` (or finding nothing) yields HANDLE_INVALID
+ */
+static handle_t cycle_focus_target(server_t* s, handle_t from, bool forward) {
+    if (list_empty(&s->focus_history)) return HANDLE_INVALID;
 
     list_node_t* start_node = &s->focus_history;
-
-    // If we have a focused client, start searching from there
-    if (s->focused_client != HANDLE_INVALID) {
-        client_hot_t* focused = server_chot(s, s->focused_client);
-        if (focused) start_node = &focused->focus_node;
+    if (from != HANDLE_INVALID) {
+        client_hot_t* c = server_chot(s, from);
+        if (c) start_node = &c->focus_node;
     }
 
     list_node_t* node = forward ? start_node->next : start_node->prev;
-
-    // Guard against infinite loop if no windows are focusable
-    int iterations = 0;
-    int max_iterations = 1000;  // Sanity limit
-
-    while (node != start_node && iterations++ < max_iterations) {
+    while (node != start_node) {
         // Skip the list head (sentinel)
-        if (node == &s->focus_history) {
-            node = forward ? node->next : node->prev;
-            if (node == start_node) break;
-        }
-
-        client_hot_t* c = (client_hot_t*)((char*)node - offsetof(client_hot_t, focus_node));
-
-        if (is_focusable(c, s)) {
-            wm_set_focus(s, c->self);
-            stack_raise(s, c->self);
-            return;
+        if (node != &s->focus_history) {
+            client_hot_t* c = (client_hot_t*)((char*)node - offsetof(client_hot_t, focus_node));
+            if (is_focusable(c, s)) return c->self;
         }
-
         node = forward ? node->next : node->prev;
     }
+    return HANDLE_INVALID;
+}
+
+void wm_cycle_focus(server_t* s, bool forward) {
+    handle_t h = cycle_focus_target(s, s->focused_client, forward);
+    if (h == HANDLE_INVALID) return;
+
+    wm_set_focus(s, h);
+    stack_raise(s, h);
 }
 
 #ifndef TEST_WM_INPUT_KEYS
 /*
- * wm_setup_keys:
- * Grab all configured global keys on the root window.
+ * key_grabs_sync:
+ * Bring the passive key grabs on the root in line with the compiled table.
  *
  * Robustness:
  * X11 grabs are exact. If NumLock or CapsLock is on, the modifier mask changes.
- * To ensure bindings work regardless of Lock state, we grab every binding with
- * all 8 combinations of (CapsLock | NumLock | ScrollLock).
+ * To ensure bindings work regardless of Lock state, every (keycode, modifiers)
+ * pair is grabbed with all 8 combinations of (CapsLock | NumLock | ScrollLock).
+ *
+ * Only pairs added or removed since the last sync go on the wire, so a reload
+ * that leaves the bindings alone sends nothing.
  */
-void wm_setup_keys(server_t* s) {
-    if (s->keysyms) xcb_key_symbols_free(s->keysyms);
-    s->keysyms = xcb_key_symbols_alloc(s->conn);
-    if (!s->keysyms) return;
-
-    xcb_ungrab_key(s->conn, XCB_GRAB_ANY, s->root, XCB_MOD_MASK_ANY);
-
-    for (size_t i = 0; i < s->config.key_bindings.length; i++) {
-        key_binding_t* b = s->config.key_bindings.items[i];
-        if (!b) continue;
+static void key_grabs_sync(server_t* s) {
+    key_table_t* t = &s->key_table;
+    size_t grabbed = 0;
+    size_t released = 0;
+
+    for (uint32_t k = 8; k < KEY_TABLE_KEYCODES; k++) {
+        uint32_t want = 0;
+        for (uint32_t col = 0; col < KEY_TABLE_MODS; col++) {
+            if (t->slots[k * KEY_TABLE_MODS + col]) want |= 1u << col;
+        }
 
-        xcb_keycode_t* keycodes = xcb_key_symbols_get_keycode(s->keysyms, b->keysym);
-        if (!keycodes) continue;
+        uint32_t diff = want ^ t->grabbed[k];
+        for (uint32_t col = 0; diff && col < KEY_TABLE_MODS; col++) {
+            if (!(diff & (1u << col))) continue;
+            diff &= ~(1u << col);
 
-        for (xcb_keycode_t* k = keycodes; *k; k++) {
-            // Grab for all ignored modifier combinations
-            // This ensures the bind works even if CapsLock or NumLock is on
+            uint16_t mods = key_table_column_mods(col);
+            bool add = (want >> col) & 1u;
             for (size_t m = 0; m < sizeof(IGNORED_MODS) / sizeof(IGNORED_MODS[0]); m++) {
-                xcb_grab_key(s->conn, 1, s->root, b->modifiers | IGNORED_MODS[m], *k, XCB_GRAB_MODE_ASYNC,
-                             XCB_GRAB_MODE_ASYNC);
+                if (add) {
+                    xcb_grab_key(s->conn, 1, s->root, mods | IGNORED_MODS[m], (xcb_keycode_t)k, XCB_GRAB_MODE_ASYNC,
+                                 XCB_GRAB_MODE_ASYNC);
+                } else {
+                    xcb_ungrab_key(s->conn, (xcb_keycode_t)k, s->root, mods | IGNORED_MODS[m]);
+                }
+            }
+            if (add) {
+                grabbed++;
+            } else {
+                released++;
             }
         }
-        free(keycodes);
+        t->grabbed[k] = want;
     }
 
-    // xcb_flush(s->conn);
+    if (grabbed || released) LOG_DEBUG("Key grabs: %zu added, %zu released", grabbed, released);
+}
+
+static void wm_handle_keymap_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_generic_error_t* err) {
+    (void)err;
+
+    // A newer MappingNotify superseded this request
+    if ((uint32_t)(slot->data >> 8) != s->keymap.gen) return;
+
+    xcb_get_keyboard_mapping_reply_t* r = (xcb_get_keyboard_mapping_reply_t*)reply;
+    if (!r) {
+        LOG_WARN("GetKeyboardMapping failed, keeping the previous keymap");
+        return;
+    }
+
+    uint32_t first = (uint32_t)(slot->data & 0xFFu);
+    uint32_t per = r->keysyms_per_keycode;
+    int len = xcb_get_keyboard_mapping_keysyms_length(r);
+    const xcb_keysym_t* syms = xcb_get_keyboard_mapping_keysyms(r);
+
+    memset(s->keymap.base, 0, sizeof(s->keymap.base));
+    for (uint32_t i = 0; per && (int)((i + 1) * per) <= len && first + i < KEY_TABLE_KEYCODES; i++) {
+        s->keymap.base[first + i] = syms[i * per];
+    }
+    s->keymap.valid = true;
+
+    key_table_compile(s);
+    key_grabs_sync(s);
+}
+
+/*
+ * wm_refresh_keymap:
+ * Refetch the keyboard mapping without blocking.
+ *
+ * The reply lands through the cookie jar, recompiles the key table against the
+ * bindings current at that point and syncs the grabs. Bursts of mapping
+ * notifies are coalesced by the caller; a reply from an older request is
+ * dropped by generation.
+ */
+void wm_refresh_keymap(server_t* s) {
+    const xcb_setup_t* setup = xcb_get_setup(s->conn);
+    uint8_t first = setup->min_keycode < 8 ? 8 : setup->min_keycode;
+    uint8_t last = setup->max_keycode < first ? (uint8_t)(KEY_TABLE_KEYCODES - 1) : setup->max_keycode;
+
+    // The menu still resolves keysyms through xcb_keysyms; its table is loaded lazily
+    xcb_key_symbols_t* keysyms = xcb_key_symbols_alloc(s->conn);
+    if (keysyms) {
+        if (s->keysyms) xcb_key_symbols_free(s->keysyms);
+        s->keysyms = keysyms;
+    }
+
+    s->keymap.gen++;
+    xcb_get_keyboard_mapping_cookie_t ck = xcb_get_keyboard_mapping(s->conn, first, (uint8_t)(last - first + 1));
+    cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_GET_KEYBOARD_MAPPING, HANDLE_INVALID,
+                    ((uintptr_t)s->keymap.gen << 8) | first, s->txn_id, wm_handle_keymap_reply);
+}
+
+/*
+ * wm_setup_keys:
+ * Apply the configured bindings.
+ *
+ * With a keymap in hand (every reload) this is a recompile plus a grab diff
+ * and never waits on the server. Before the first keymap reply it only
+ * requests one; the reply does the rest.
+ */
+void wm_setup_keys(server_t* s) {
+    if (!s->keymap.valid) {
+        wm_refresh_keymap(s);
+        return;
+    }
+
+    key_table_compile(s);
+    key_grabs_sync(s);
 }
 #endif
 
@@ -178,50 +313,154 @@ static int safe_atoi(const char* str) {
     return (int)val;
 }
 
-void wm_handle_key_press(server_t* s, xcb_key_press_event_t* ev) {
-    if (!s->keysyms) return;
+void wm_key_actions_flush(server_t* s) {
+    key_action_queue_t q = s->key_actions;
+    s->key_actions.kind = KEY_ACTION_NONE;
+    s->key_actions.coalesced = 0;
+
+    if (q.coalesced) LOG_DEBUG("Coalesced %u repeated key actions", q.coalesced);
+
+    switch (q.kind) {
+        case KEY_ACTION_WORKSPACE:
+            if (q.workspace != s->current_desktop) wm_switch_workspace(s, q.workspace);
+            break;
+
+        case KEY_ACTION_FOCUS: {
+            // wm_set_focus moves each target to the MRU head, so repeated presses do not walk the list
+            // linearly (next toggles between the two most recent clients). Replay the presses against the
+            // history order and only focus the final target.
+            handle_t h = s->focused_client;
+            for (uint32_t i = 0; i < q.focus_presses; i++) {
+                handle_t next = cycle_focus_target(s, h, (q.focus_next >> i) & 1u);
+                if (next == HANDLE_INVALID) break;
+
+                client_hot_t* c = server_chot(s, next);
+                list_remove(&c->focus_node);
+                list_push_front(&s->focus_history, &c->focus_node);
+                h = next;
+            }
+            if (h != s->focused_client) {
+                wm_set_focus(s, h);
+                stack_raise(s, h);
+            }
+            break;
+        }
 
-    xcb_keysym_t sym = xcb_key_symbols_get_keysym(s->keysyms, ev->detail, 0);
+        case KEY_ACTION_STICKY:
+            if (q.sticky_flip) wm_client_toggle_sticky(s, q.sticky_client);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * key_action_queue:
+ * Fold a repeatable action into s->key_actions instead of running it.
+ *
+ * Coalescing:
+ * - relative and absolute workspace switches collapse into one target desktop
+ * - focus-next/prev presses are recorded in order and replayed against the
+ *   focus history, so the result matches handling them one at a time
+ * - sticky toggles on the same client cancel out in pairs
+ *
+ * Returns false for actions that run immediately.
+ */
+static bool key_action_queue(server_t* s, const key_binding_t* b) {
+    key_action_kind_t kind;
+    switch (b->action) {
+        case ACTION_WORKSPACE:
+        case ACTION_WORKSPACE_PREV:
+        case ACTION_WORKSPACE_NEXT:
+            kind = KEY_ACTION_WORKSPACE;
+            break;
+        case ACTION_FOCUS_NEXT:
+        case ACTION_FOCUS_PREV:
+            kind = KEY_ACTION_FOCUS;
+            break;
+        case ACTION_TOGGLE_STICKY:
+            if (s->focused_client == HANDLE_INVALID) return true;
+            kind = KEY_ACTION_STICKY;
+            break;
+        default:
+            return false;
+    }
+
+    key_action_queue_t* q = &s->key_actions;
+    if (q->kind != kind || (kind == KEY_ACTION_STICKY && q->sticky_client != s->focused_client) ||
+        (kind == KEY_ACTION_FOCUS && q->focus_presses == KEY_ACTION_FOCUS_MAX)) {
+        wm_key_actions_flush(s);
+        q->kind = kind;
+        q->workspace = s->current_desktop;
+        q->focus_next = 0;
+        q->focus_presses = 0;
+        q->sticky_client = s->focused_client;
+        q->sticky_flip = false;
+    } else {
+        q->coalesced++;
+    }
+
+    uint32_t count = s->desktop_count ? s->desktop_count : 1;
+    switch (b->action) {
+        case ACTION_WORKSPACE:
+            if (b->exec_cmd) {
+                // Out-of-range targets are ignored, as wm_switch_workspace would
+                uint32_t ws = (uint32_t)safe_atoi(b->exec_cmd);
+                if (ws < count) q->workspace = ws;
+            }
+            break;
+        case ACTION_WORKSPACE_PREV:
+            q->workspace = (q->workspace + count - 1) % count;
+            break;
+        case ACTION_WORKSPACE_NEXT:
+            q->workspace = (q->workspace + 1) % count;
+            break;
+        case ACTION_FOCUS_NEXT:
+            q->focus_next |= 1u << q->focus_presses++;
+            break;
+        case ACTION_FOCUS_PREV:
+            q->focus_presses++;
+            break;
+        default:
+            q->sticky_flip = !q->sticky_flip;
+            break;
+    }
+    return true;
+}
+
+void wm_handle_key_press(server_t* s, xcb_key_press_event_t* ev) {
+    if (!s->key_table.slots) return;
 
     // Menu logic takes precedence
-    if (s->menu.visible && sym == XK_Escape) {
+    if (s->menu.visible && key_table_is_escape(&s->key_table, ev->detail)) {
         menu_hide(s);
         return;
     }
 
     uint32_t clean_state = wm_clean_mods(ev->state);
 
-    LOG_DEBUG("Key press: detail=%u state=%u clean=%u sym=%x", ev->detail, ev->state, clean_state, sym);
-
-    // Linear scan of bindings
-    // Note: For large configs, a hash map lookup would be O(1)
-    for (size_t i = 0; i < s->config.key_bindings.length; i++) {
-        key_binding_t* b = s->config.key_bindings.items[i];
-        if (!b) continue;
-
-        if (b->keysym != sym || b->modifiers != clean_state) continue;
+    LOG_DEBUG("Key press: detail=%u state=%u clean=%u", ev->detail, ev->state, clean_state);
 
+    const key_binding_t* b = key_table_lookup(&s->key_table, ev->detail, clean_state);
+    if (b) {
         LOG_INFO("Matched key binding action %d", b->action);
 
+        // Repeatable actions are applied once per tick by wm_key_actions_flush
+        if (key_action_queue(s, b)) return;
+        wm_key_actions_flush(s);
+
         switch (b->action) {
             case ACTION_CLOSE:
                 if (s->focused_client != HANDLE_INVALID) client_close(s, s->focused_client);
                 break;
 
-            case ACTION_FOCUS_NEXT:
-                wm_cycle_focus(s, true);
-                break;
-
-            case ACTION_FOCUS_PREV:
-                wm_cycle_focus(s, false);
-                break;
-
             case ACTION_TERMINAL:
-                spawn("st || xterm || x-terminal-emulator");
+                launcher_spawn(s, "st || xterm || x-terminal-emulator");
                 break;
 
             case ACTION_EXEC:
-                spawn(b->exec_cmd);
+                launcher_spawn(s, b->exec_cmd);
                 break;
 
             case ACTION_RESTART:
@@ -233,18 +472,6 @@ void wm_handle_key_press(server_t* s, xcb_key_press_event_t* ev) {
                 exit(0);
                 break;
 
-            case ACTION_WORKSPACE:
-                if (b->exec_cmd) wm_switch_workspace(s, (uint32_t)safe_atoi(b->exec_cmd));
-                break;
-
-            case ACTION_WORKSPACE_PREV:
-                wm_switch_workspace_relative(s, -1);
-                break;
-
-            case ACTION_WORKSPACE_NEXT:
-                wm_switch_workspace_relative(s, 1);
-                break;
-
             case ACTION_MOVE_TO_WORKSPACE:
                 if (b->exec_cmd && s->focused_client != HANDLE_INVALID) {
                     wm_client_move_to_workspace(s, s->focused_client, (uint32_t)safe_atoi(b->exec_cmd), false);
@@ -257,10 +484,6 @@ void wm_handle_key_press(server_t* s, xcb_key_press_event_t* ev) {
                 }
                 break;
 
-            case ACTION_TOGGLE_STICKY:
-                if (s->focused_client != HANDLE_INVALID) wm_client_toggle_sticky(s, s->focused_client);
-                break;
-
             case ACTION_MOVE:
             case ACTION_RESIZE:
                 if (s->focused_client != HANDLE_INVALID) {
@@ -273,8 +496,10 @@ void wm_handle_key_press(server_t* s, xcb_key_press_event_t* ev) {
                     int16_t root_x, root_y;
 
                     if (b->action == ACTION_MOVE) {
+                        // The origin must be exact (motion deltas are taken from it), so ask rather
+                        // than trust the pointer cache; started as a keyboard move (no button held)
                         xcb_query_pointer_cookie_t ck = xcb_query_pointer(s->conn, s->root);
-                        cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_QUERY_POINTER, s->focused_client, 0x100,
+                        cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_QUERY_POINTER, s->focused_client, 0x300,
                                         s->txn_id, wm_handle_reply);
                     } else {
                         // RESIZE: Warp to bottom right
@@ -292,7 +517,5 @@ void wm_handle_key_press(server_t* s, xcb_key_press_event_t* ev) {
             default:
                 break;
         }
-        // Break after finding the first matching binding (prevent duplicate triggers)
-        return;
     }
 }
@@ -15,6 +15,9 @@
 #define MIN_FRAME_SIZE 32
 #define MAX_FRAME_SIZE 65535
 
+// Frame position of parked (hidden, still mapped) clients; server.x/y keep the real one
+#define WM_FRAME_PARK_POS (-32000)
+
 uint32_t wm_clean_mods(uint16_t state);
 
 // Exposed interaction logic
@@ -28,6 +31,11 @@ void wm_set_showing_desktop(server_t* s, bool show);
 void wm_install_client_colormap(server_t* s, client_hot_t* hot);
 void wm_update_monitors(server_t* s);
 void wm_get_monitor_geometry(server_t* s, client_hot_t* hot, rect_t* out_geom);
+uint32_t wm_monitor_index(server_t* s, const client_hot_t* hot);
+void wm_get_monitor_workarea(server_t* s, const client_hot_t* hot, rect_t* out);
+bool wm_client_on_monitors(server_t* s, const client_hot_t* hot, uint64_t mask);
 void wm_set_frame_extents_for_window(server_t* s, xcb_window_t win, bool undecorated);
+void wm_frame_set_parked(server_t* s, client_hot_t* hot, bool parked);
+bool wm_place_smart(server_t* s, client_hot_t* hot);
 
 #endif
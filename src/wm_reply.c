@@ -22,6 +22,7 @@
 #include "event.h"
 #include "frame.h"
 #include "hxm.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "wm_internal.h"
 
@@ -108,8 +109,18 @@ static bool client_apply_gtk_frame_extents(server_t* s, handle_t h, const xcb_ge
 }
 
 static bool is_valid_utf8(const char* str, size_t len) {
+    const uint64_t high_bits = 0x8080808080808080ull;
     size_t i = 0;
     while (i < len) {
+        // ASCII fast path: skip 8 bytes at a time while no byte has the high bit set
+        while (i + sizeof(uint64_t) <= len) {
+            uint64_t word;
+            memcpy(&word, str + i, sizeof(word));
+            if (word & high_bits) break;
+            i += sizeof(uint64_t);
+        }
+        if (i >= len) break;
+
         uint8_t c = (uint8_t)str[i];
         if (c <= 0x7Fu) {
             i++;
@@ -246,7 +257,8 @@ static bool client_should_be_undecorated(const client_hot_t* hot) {
 
 static bool client_apply_decoration_hints(client_hot_t* hot) {
     bool was_undecorated = (hot->flags & CLIENT_FLAG_UNDECORATED) != 0;
-    bool now_undecorated = client_should_be_undecorated(hot);
+    // A frameless client has no frame to decorate
+    bool now_undecorated = client_should_be_undecorated(hot) || client_is_frameless(hot);
 
     if (now_undecorated) {
         hot->flags |= CLIENT_FLAG_UNDECORATED;
@@ -274,7 +286,7 @@ static void abort_manage(server_t* s, handle_t h) {
         hash_map_remove(&s->window_to_client, hot->xid);
     }
 
-    arena_destroy(&cold->string_arena);
+    client_cold_strings_destroy(cold);
     render_free(&hot->render_ctx);
     if (hot->icon_surface) cairo_surface_destroy(hot->icon_surface);
 
@@ -299,24 +311,23 @@ static void parse_net_wm_name_like(server_t* s, handle_t h, client_hot_t* hot, c
             bool had_net = cold->has_net_wm_name;
             cold->has_net_wm_name = false;
             if (had_net) {
-                cold->base_title = arena_strndup(&cold->string_arena, "", 0);
+                client_cold_set_string(cold, &cold->base_title, "", 0);
                 wm_client_refresh_title(s, h);
-                hot->dirty |= DIRTY_FRAME_STYLE;
             }
 
-            if (hot->manage_phase != MANAGE_DONE) hot->pending_replies++;
-            uint32_t c = xcb_get_property(s->conn, 0, hot->xid, atoms.WM_NAME, XCB_ATOM_STRING, 0, 1024).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h, ((uint64_t)hot->xid << 32) | atoms.WM_NAME,
-                            s->txn_id, wm_handle_reply);
+            const prop_schema_t* legacy = prop_schema_lookup(atoms.WM_NAME);
+            if (legacy) {
+                if (hot->manage_phase != MANAGE_DONE) hot->pending_replies++;
+                prop_schema_fetch(s, h, hot, legacy);
+            }
             return;
         }
 
         if (!cold->has_net_wm_name || !cold->base_title || strlen(cold->base_title) != trimmed_len ||
             strncmp(cold->base_title, str, trimmed_len) != 0) {
-            cold->base_title = arena_strndup(&cold->string_arena, str, trimmed_len);
+            client_cold_set_string(cold, &cold->base_title, str, trimmed_len);
             cold->has_net_wm_name = true;
             wm_client_refresh_title(s, h);
-            hot->dirty |= DIRTY_FRAME_STYLE;
         }
         return;
     }
@@ -326,24 +337,23 @@ static void parse_net_wm_name_like(server_t* s, handle_t h, client_hot_t* hot, c
             bool had_net = cold->has_net_wm_icon_name;
             cold->has_net_wm_icon_name = false;
             if (had_net) {
-                cold->base_icon_name = arena_strndup(&cold->string_arena, "", 0);
+                client_cold_set_string(cold, &cold->base_icon_name, "", 0);
                 wm_client_refresh_title(s, h);
-                hot->dirty |= DIRTY_FRAME_STYLE;
             }
 
-            if (hot->manage_phase != MANAGE_DONE) hot->pending_replies++;
-            uint32_t c = xcb_get_property(s->conn, 0, hot->xid, atoms.WM_ICON_NAME, XCB_ATOM_STRING, 0, 1024).sequence;
-            cookie_jar_push(&s->cookie_jar, c, COOKIE_GET_PROPERTY, h, ((uint64_t)hot->xid << 32) | atoms.WM_ICON_NAME,
-                            s->txn_id, wm_handle_reply);
+            const prop_schema_t* legacy = prop_schema_lookup(atoms.WM_ICON_NAME);
+            if (legacy) {
+                if (hot->manage_phase != MANAGE_DONE) hot->pending_replies++;
+                prop_schema_fetch(s, h, hot, legacy);
+            }
             return;
         }
 
         if (!cold->has_net_wm_icon_name || !cold->base_icon_name || strlen(cold->base_icon_name) != trimmed_len ||
             strncmp(cold->base_icon_name, str, trimmed_len) != 0) {
-            cold->base_icon_name = arena_strndup(&cold->string_arena, str, trimmed_len);
+            client_cold_set_string(cold, &cold->base_icon_name, str, trimmed_len);
             cold->has_net_wm_icon_name = true;
             wm_client_refresh_title(s, h);
-            hot->dirty |= DIRTY_FRAME_STYLE;
         }
         return;
     }
@@ -366,10 +376,10 @@ static void parse_wm_class(client_cold_t* cold, const xcb_get_property_reply_t*
     size_t cls_len = nul2 ? (size_t)(nul2 - cls) : rem;
 
     if (!cold->wm_instance || strcmp(cold->wm_instance, str) != 0) {
-        cold->wm_instance = arena_strndup(&cold->string_arena, str, inst_len);
+        client_cold_set_string(cold, &cold->wm_instance, str, inst_len);
     }
     if (!cold->wm_class || strcmp(cold->wm_class, cls) != 0) {
-        cold->wm_class = arena_strndup(&cold->string_arena, cls, cls_len);
+        client_cold_set_string(cold, &cold->wm_class, cls, cls_len);
     }
 }
 
@@ -424,6 +434,910 @@ static bool check_transient_cycle(server_t* s, handle_t child, handle_t parent)
     return false;
 }
 
+static bool prop_parse_wm_class(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    parse_wm_class(ctx->cold, r);
+    return false;
+}
+
+static bool prop_parse_wm_client_machine(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_cold_t* cold = ctx->cold;
+
+    int len = 0;
+    char* str = prop_get_string(r, &len);
+    if (str) {
+        client_cold_set_string(cold, &cold->wm_client_machine, str, (size_t)len);
+    }
+    return false;
+}
+
+static bool prop_parse_wm_command(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_cold_t* cold = ctx->cold;
+
+    int len = 0;
+    char* str = prop_get_string(r, &len);
+    if (str && len > 0) {
+        size_t n = (size_t)len;
+        char* nul = memchr(str, '\0', n);
+        size_t cmd_len = nul ? (size_t)(nul - str) : n;
+        if (cmd_len > 0) {
+            client_cold_set_string(cold, &cold->wm_command, str, cmd_len);
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_wm_colormap_windows(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+    client_hot_t* hot = ctx->hot;
+    client_cold_t* cold = ctx->cold;
+
+    if (!prop_is_empty(r) && r->format == 32 && r->type == XCB_ATOM_WINDOW) {
+        int bytes = xcb_get_property_value_length(r);
+        if (bytes >= 4) {
+            uint32_t count = (uint32_t)(bytes / (int)sizeof(xcb_window_t));
+            client_set_colormap_windows(cold, (xcb_window_t*)xcb_get_property_value(r), count);
+        } else {
+            client_set_colormap_windows(cold, NULL, 0);
+        }
+    } else {
+        client_set_colormap_windows(cold, NULL, 0);
+    }
+    if (s->focused_client == h) {
+        wm_install_client_colormap(s, hot);
+    }
+    return false;
+}
+
+// Shared by _NET_WM_NAME and _NET_WM_ICON_NAME
+// Title parsers never ask for a restyle: wm_client_refresh_title queues a title-only redraw
+static bool prop_parse_net_wm_name(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    parse_net_wm_name_like(ctx->s, ctx->h, ctx->hot, ctx->cold, ctx->atom, r);
+    return false;
+}
+
+static bool prop_parse_wm_name(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+    client_cold_t* cold = ctx->cold;
+
+    if (prop_is_empty(r) && !cold->has_net_wm_name) {
+        client_cold_set_string(cold, &cold->base_title, "", 0);
+        wm_client_refresh_title(s, h);
+    } else {
+        int len = 0;
+        char* str = prop_get_string(r, &len);
+        if (str && !cold->has_net_wm_name) {
+            size_t trimmed_len = clamp_prop_len(len, MAX_TITLE_BYTES);
+            if (!cold->base_title || strlen(cold->base_title) != trimmed_len ||
+                strncmp(cold->base_title, str, trimmed_len) != 0) {
+                client_cold_set_string(cold, &cold->base_title, str, trimmed_len);
+                wm_client_refresh_title(s, h);
+            }
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_wm_icon_name(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+    client_cold_t* cold = ctx->cold;
+
+    if (prop_is_empty(r) && !cold->has_net_wm_icon_name) {
+        client_cold_set_string(cold, &cold->base_icon_name, "", 0);
+        wm_client_refresh_title(s, h);
+    } else {
+        int len = 0;
+        char* str = prop_get_string(r, &len);
+        if (str && !cold->has_net_wm_icon_name) {
+            size_t trimmed_len = clamp_prop_len(len, MAX_TITLE_BYTES);
+            if (!cold->base_icon_name || strlen(cold->base_icon_name) != trimmed_len ||
+                strncmp(cold->base_icon_name, str, trimmed_len) != 0) {
+                client_cold_set_string(cold, &cold->base_icon_name, str, trimmed_len);
+                wm_client_refresh_title(s, h);
+            }
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_motif_wm_hints(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+    client_hot_t* hot = ctx->hot;
+
+    bool changed = false;
+    if (client_apply_motif_hints(s, h, r)) {
+        if (client_apply_decoration_hints(hot)) changed = true;
+    }
+    return changed;
+}
+
+static bool prop_parse_gtk_frame_extents(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+    client_hot_t* hot = ctx->hot;
+
+    bool changed = false;
+    if (client_apply_gtk_frame_extents(s, h, r)) {
+        // Existing logic for geometry updates if not in manage phase
+        if (hot->manage_phase == MANAGE_DONE) {
+            hot->dirty |= DIRTY_GEOM;
+        }
+        if (client_apply_decoration_hints(hot)) changed = true;
+    }
+    return changed;
+}
+
+static bool prop_parse_net_wm_state(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+
+    if (prop_is_empty(r)) {
+        client_state_set_t set = {0};
+        wm_client_apply_state_set(s, h, &set);
+    } else {
+        int num_states = 0;
+        xcb_atom_t* states = (xcb_atom_t*)prop_get_u32_array(r, 1, &num_states);
+        if (states) {
+            client_state_set_t set = {0};
+            for (int i = 0; i < num_states; i++) {
+                xcb_atom_t state = states[i];
+                if (state == atoms._NET_WM_STATE_FULLSCREEN) {
+                    set.fullscreen = true;
+                } else if (state == atoms._NET_WM_STATE_ABOVE) {
+                    set.above = true;
+                } else if (state == atoms._NET_WM_STATE_BELOW) {
+                    set.below = true;
+                } else if (state == atoms._NET_WM_STATE_STICKY) {
+                    set.sticky = true;
+                } else if (state == atoms._NET_WM_STATE_DEMANDS_ATTENTION) {
+                    set.urgent = true;
+                } else if (state == atoms._NET_WM_STATE_MAXIMIZED_HORZ) {
+                    set.max_horz = true;
+                } else if (state == atoms._NET_WM_STATE_MAXIMIZED_VERT) {
+                    set.max_vert = true;
+                } else if (state == atoms._NET_WM_STATE_MODAL) {
+                    set.modal = true;
+                } else if (state == atoms._NET_WM_STATE_SHADED) {
+                    set.shaded = true;
+                } else if (state == atoms._NET_WM_STATE_SKIP_TASKBAR) {
+                    set.skip_taskbar = true;
+                } else if (state == atoms._NET_WM_STATE_SKIP_PAGER) {
+                    set.skip_pager = true;
+                }
+            }
+            wm_client_apply_state_set(s, h, &set);
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_wm_normal_hints(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    client_hot_t* hot = ctx->hot;
+
+    xcb_size_hints_t hints;
+
+    size_hints_t next_hints = {0};
+
+    uint32_t next_flags = 0;
+
+    bool valid = false;
+
+    if (prop_is_empty(r)) {
+        valid = true;
+
+    } else if (xcb_get_property_value_length(r) >= (int)sizeof(xcb_size_hints_t) &&
+
+               xcb_icccm_get_wm_size_hints_from_reply(&hints, r)) {
+        valid = true;
+
+        next_flags = hints.flags;
+
+        if (hints.flags & XCB_ICCCM_SIZE_HINT_P_MIN_SIZE) {
+            next_hints.min_w = hints.min_width;
+
+            next_hints.min_h = hints.min_height;
+        }
+
+        if (hints.flags & XCB_ICCCM_SIZE_HINT_P_MAX_SIZE) {
+            next_hints.max_w = hints.max_width;
+
+            next_hints.max_h = hints.max_height;
+        }
+
+        if (hints.flags & XCB_ICCCM_SIZE_HINT_P_RESIZE_INC) {
+            next_hints.inc_w = hints.width_inc;
+
+            next_hints.inc_h = hints.height_inc;
+        }
+
+        if (hints.flags & XCB_ICCCM_SIZE_HINT_BASE_SIZE) {
+            next_hints.base_w = hints.base_width;
+
+            next_hints.base_h = hints.base_height;
+        }
+
+        if (hints.flags & XCB_ICCCM_SIZE_HINT_P_ASPECT) {
+            next_hints.min_aspect_num = hints.min_aspect_num;
+
+            next_hints.min_aspect_den = hints.min_aspect_den;
+
+            next_hints.max_aspect_num = hints.max_aspect_num;
+
+            next_hints.max_aspect_den = hints.max_aspect_den;
+        }
+    }
+
+    if (valid) {
+        bool hints_changed =
+            (hot->hints_flags != next_flags || memcmp(&hot->hints, &next_hints, sizeof(size_hints_t)) != 0);
+
+        if (hints_changed) {
+            hot->hints = next_hints;
+
+            hot->hints_flags = next_flags;
+
+            hot->dirty |= DIRTY_STATE;  // Allowed actions might change
+
+            if (hot->state == STATE_NEW && hot->manage_phase != MANAGE_DONE) {
+                if (next_flags & (XCB_ICCCM_SIZE_HINT_US_SIZE | XCB_ICCCM_SIZE_HINT_P_SIZE)) {
+                    if (!hot->geometry_from_configure) {
+                        if (hints.width > 0) hot->desired.w = (uint16_t)hints.width;
+
+                        if (hints.height > 0) hot->desired.h = (uint16_t)hints.height;
+
+                    } else {
+                        if (hot->desired.w == 0 && hints.width > 0) hot->desired.w = (uint16_t)hints.width;
+
+                        if (hot->desired.h == 0 && hints.height > 0)
+                            hot->desired.h = (uint16_t)hints.height;
+                    }
+                }
+
+                if (next_flags & (XCB_ICCCM_SIZE_HINT_US_POSITION | XCB_ICCCM_SIZE_HINT_P_POSITION)) {
+                    if (!hot->geometry_from_configure) {
+                        hot->desired.x = (int16_t)hints.x;
+
+                        hot->desired.y = (int16_t)hints.y;
+                    }
+                }
+
+                client_constrain_size(&hot->hints, hot->hints_flags, &hot->desired.w, &hot->desired.h);
+
+            } else if (s->interaction_mode == INTERACTION_RESIZE && s->interaction_window == hot->frame) {
+                client_constrain_size(&hot->hints, hot->hints_flags, &hot->desired.w, &hot->desired.h);
+
+                hot->dirty |= DIRTY_GEOM;
+
+            } else {
+                // Even if not resizing, if hints changed, we might need to re-constrain
+
+                uint16_t w = hot->desired.w;
+
+                uint16_t h_val = hot->desired.h;
+
+                client_constrain_size(&hot->hints, hot->hints_flags, &w, &h_val);
+
+                if (w != hot->desired.w || h_val != hot->desired.h) {
+                    hot->desired.w = w;
+
+                    hot->desired.h = h_val;
+
+                    hot->dirty |= DIRTY_GEOM;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_wm_transient_for(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+    client_hot_t* hot = ctx->hot;
+    client_cold_t* cold = ctx->cold;
+
+    bool changed = false;
+    if (xcb_get_property_value_length(r) >= 4) {
+        xcb_window_t transient_for_xid = *(xcb_window_t*)xcb_get_property_value(r);
+        cold->transient_for_xid = transient_for_xid;
+        hot->transient_for = server_get_client_by_window(s, transient_for_xid);
+
+        if (hot->transient_for != HANDLE_INVALID) {
+            if (check_transient_cycle(s, h, hot->transient_for)) {
+                LOG_WARN("Ignoring transient_for cycle for client %u", hot->xid);
+                hot->transient_for = HANDLE_INVALID;
+            }
+        }
+
+        if (hot->transient_for != HANDLE_INVALID) {
+            client_hot_t* parent = server_chot(s, hot->transient_for);
+            if (parent) {
+                if (hot->transient_sibling.next && hot->transient_sibling.next != &hot->transient_sibling) {
+                    list_remove(&hot->transient_sibling);
+                }
+                list_insert(&hot->transient_sibling, parent->transients_head.prev,
+                            &parent->transients_head);
+            }
+        }
+    } else {
+        cold->transient_for_xid = XCB_NONE;
+        if (hot->transient_for != HANDLE_INVALID) {
+            if (hot->transient_sibling.next && hot->transient_sibling.next != &hot->transient_sibling) {
+                list_remove(&hot->transient_sibling);
+                list_init(&hot->transient_sibling);
+            }
+            hot->transient_for = HANDLE_INVALID;
+        }
+    }
+
+    if (client_apply_default_type(s, hot, cold)) {
+        changed = true;
+    }
+    return changed;
+}
+
+static bool prop_parse_net_wm_window_type(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    client_hot_t* hot = ctx->hot;
+
+    bool changed = false;
+    if (xcb_get_property_value_length(r) > 0) {
+        uint8_t prev_type = hot->type;
+        xcb_atom_t* types = (xcb_atom_t*)xcb_get_property_value(r);
+        int num_types = xcb_get_property_value_length(r) / (int)sizeof(xcb_atom_t);
+
+        for (int i = 0; i < num_types; i++) {
+            if (types[i] == atoms._NET_WM_WINDOW_TYPE_DOCK) {
+                hot->type = WINDOW_TYPE_DOCK;
+                hot->base_layer = LAYER_DOCK;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_NOTIFICATION) {
+                hot->type = WINDOW_TYPE_NOTIFICATION;
+                hot->base_layer = LAYER_OVERLAY;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_DIALOG) {
+                hot->type = WINDOW_TYPE_DIALOG;
+                hot->base_layer = LAYER_NORMAL;
+                hot->placement = PLACEMENT_CENTER;
+                hot->type_from_net = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_DESKTOP) {
+                hot->type = WINDOW_TYPE_DESKTOP;
+                hot->base_layer = LAYER_DESKTOP;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_SPLASH) {
+                hot->type = WINDOW_TYPE_SPLASH;
+                hot->base_layer = LAYER_ABOVE;
+                hot->type_from_net = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_TOOLBAR) {
+                hot->type = WINDOW_TYPE_TOOLBAR;
+                hot->base_layer = LAYER_NORMAL;
+                hot->placement = PLACEMENT_DEFAULT;
+                hot->type_from_net = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_UTILITY) {
+                hot->type = WINDOW_TYPE_UTILITY;
+                hot->base_layer = LAYER_NORMAL;
+                hot->placement = PLACEMENT_DEFAULT;
+                hot->type_from_net = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_MENU) {
+                hot->type = WINDOW_TYPE_MENU;
+                hot->base_layer = LAYER_OVERLAY;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_DROPDOWN_MENU) {
+                hot->type = WINDOW_TYPE_DROPDOWN_MENU;
+                hot->base_layer = LAYER_OVERLAY;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
+                    hot->manage_aborted = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_POPUP_MENU) {
+                hot->type = WINDOW_TYPE_POPUP_MENU;
+                hot->base_layer = LAYER_OVERLAY;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
+                    hot->manage_aborted = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_TOOLTIP) {
+                hot->type = WINDOW_TYPE_TOOLTIP;
+                hot->base_layer = LAYER_OVERLAY;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
+                    hot->manage_aborted = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_COMBO) {
+                hot->type = WINDOW_TYPE_COMBO;
+                hot->base_layer = LAYER_OVERLAY;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
+                    hot->manage_aborted = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_DND) {
+                hot->type = WINDOW_TYPE_DND;
+                hot->base_layer = LAYER_OVERLAY;
+                hot->flags |= CLIENT_FLAG_UNDECORATED;
+                hot->type_from_net = true;
+                if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
+                    hot->manage_aborted = true;
+                break;
+            } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_NORMAL) {
+                hot->type = WINDOW_TYPE_NORMAL;
+                hot->base_layer = LAYER_NORMAL;
+                hot->placement = PLACEMENT_DEFAULT;
+                hot->type_from_net = true;
+                break;
+            }
+        }
+
+        if (client_apply_decoration_hints(hot)) {
+            changed = true;
+        }
+
+        if (hot->layer != LAYER_FULLSCREEN) {
+            uint8_t prev_layer = hot->layer;
+            hot->layer = client_layer_from_state(hot);
+            if (hot->layer != prev_layer) {
+                hot->dirty |= DIRTY_STATE | DIRTY_STACK;
+            }
+        }
+
+        if (hot->type != prev_type) {
+            s->root_dirty |= ROOT_DIRTY_CLIENT_LIST | ROOT_DIRTY_CLIENT_LIST_STACKING;
+        }
+    }
+    return changed;
+}
+
+static bool prop_parse_wm_protocols(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_hot_t* hot = ctx->hot;
+    client_cold_t* cold = ctx->cold;
+
+    cold->protocols = 0;
+    hot->sync_enabled = false;
+    int num_protocols = 0;
+    xcb_atom_t* protocols = (xcb_atom_t*)prop_get_u32_array(r, 1, &num_protocols);
+    if (!protocols && r && r->format == 32 && r->value_len > 0) {
+        protocols = (xcb_atom_t*)xcb_get_property_value(r);
+        num_protocols = (int)r->value_len;
+    }
+    if (protocols) {
+        for (int i = 0; i < num_protocols; i++) {
+            if (protocols[i] == atoms.WM_DELETE_WINDOW) {
+                cold->protocols |= PROTOCOL_DELETE_WINDOW;
+            } else if (protocols[i] == atoms.WM_TAKE_FOCUS) {
+                cold->protocols |= PROTOCOL_TAKE_FOCUS;
+            } else if (protocols[i] == atoms._NET_WM_SYNC_REQUEST) {
+                cold->protocols |= PROTOCOL_SYNC_REQUEST;
+                hot->sync_enabled = true;
+            } else if (protocols[i] == atoms._NET_WM_PING) {
+                cold->protocols |= PROTOCOL_PING;
+            }
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_net_wm_desktop(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    client_hot_t* hot = ctx->hot;
+
+    uint32_t* val = prop_get_u32_array(r, 1, NULL);
+    if (val) {
+        if (*val == 0xFFFFFFFFu) {
+            hot->sticky = true;
+            hot->desktop = -1;
+        } else {
+            hot->sticky = false;
+            uint32_t desk = *val;
+            if (desk >= s->desktop_count) desk = s->current_desktop;
+            hot->desktop = (int32_t)desk;
+        }
+        if (hot->desktop_indexed) {
+            wm_desktop_index_update(s, ctx->h);
+            wm_client_visibility_changed(s, ctx->h);
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_net_wm_strut(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+    client_hot_t* hot = ctx->hot;
+    client_cold_t* cold = ctx->cold;
+    xcb_atom_t atom = ctx->atom;
+
+    int len = r ? xcb_get_property_value_length(r) : 0;
+    bool is_partial = (atom == atoms._NET_WM_STRUT_PARTIAL);
+    strut_t* target = is_partial ? &cold->strut_partial : &cold->strut_full;
+    bool* active = is_partial ? &cold->strut_partial_active : &cold->strut_full_active;
+
+    strut_t prev_effective = cold->strut;
+    bool prev_partial = cold->strut_partial_active;
+
+    if (r && r->type == XCB_ATOM_CARDINAL && r->format == 32 && len >= 16) {
+        uint32_t* val = (uint32_t*)xcb_get_property_value(r);
+        memset(target, 0, sizeof(*target));
+        target->left = val[0];
+        target->right = val[1];
+        target->top = val[2];
+        target->bottom = val[3];
+
+        if (is_partial && len >= 48) {
+            target->left_start_y = val[4];
+            target->left_end_y = val[5];
+            target->right_start_y = val[6];
+            target->right_end_y = val[7];
+            target->top_start_x = val[8];
+            target->top_end_x = val[9];
+            target->bottom_start_x = val[10];
+            target->bottom_end_x = val[11];
+            sanitize_strut_range(&target->left_start_y, &target->left_end_y);
+            sanitize_strut_range(&target->right_start_y, &target->right_end_y);
+            sanitize_strut_range(&target->top_start_x, &target->top_end_x);
+            sanitize_strut_range(&target->bottom_start_x, &target->bottom_end_x);
+        }
+        *active = true;
+    } else {
+        memset(target, 0, sizeof(*target));
+        *active = false;
+    }
+
+    // Waterfall: If PARTIAL failed (or empty), try legacy STRUT
+    if (is_partial && !*active) {
+        const prop_schema_t* legacy = prop_schema_lookup(atoms._NET_WM_STRUT);
+        if (legacy) prop_schema_fetch(s, h, hot, legacy);
+    }
+
+    client_update_effective_strut(cold);
+
+    if (memcmp(&prev_effective, &cold->strut, sizeof(strut_t)) != 0) {
+        static rl_t rl_strut = {0};
+        if (rl_allow(&rl_strut, monotonic_time_ns(), 1000000000)) {
+            TRACE_LOG("strut_reply xid=%u atom=%s changed active=%d top=%u", hot->xid,
+                      is_partial ? "_NET_WM_STRUT_PARTIAL" : "_NET_WM_STRUT", *active, cold->strut.top);
+        }
+        wm_strut_changed(s, h, &prev_effective, prev_partial);
+    }
+    return false;
+}
+
+static bool prop_parse_wm_hints(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_hot_t* hot = ctx->hot;
+    client_cold_t* cold = ctx->cold;
+
+    bool changed = false;
+    if (prop_is_empty(r)) {
+        bool changed_any = (cold->can_focus != true || hot->initial_state != XCB_ICCCM_WM_STATE_NORMAL);
+        cold->can_focus = true;
+        hot->initial_state = XCB_ICCCM_WM_STATE_NORMAL;
+        if (hot->flags & CLIENT_FLAG_URGENT) {
+            hot->flags &= ~CLIENT_FLAG_URGENT;
+            hot->dirty |= DIRTY_STATE;
+            changed = true;
+        } else if (changed_any) {
+            hot->dirty |= DIRTY_STATE;
+            changed = true;
+        }
+    } else {
+        xcb_icccm_wm_hints_t hints;
+        if (xcb_icccm_get_wm_hints_from_reply(&hints, r)) {
+            bool next_can_focus = true;
+            if (hints.flags & XCB_ICCCM_WM_HINT_INPUT) {
+                next_can_focus = (bool)(hints.input);
+            }
+
+            uint8_t next_initial_state = hot->initial_state;
+            if (hints.flags & XCB_ICCCM_WM_HINT_STATE) {
+                next_initial_state = (uint8_t)hints.initial_state;
+            }
+
+            bool next_urgent = (hints.flags & XCB_ICCCM_WM_HINT_X_URGENCY) != 0;
+            bool was_urgent = (hot->flags & CLIENT_FLAG_URGENT) != 0;
+
+            if (cold->can_focus != next_can_focus || hot->initial_state != next_initial_state ||
+                was_urgent != next_urgent) {
+                cold->can_focus = next_can_focus;
+                hot->initial_state = next_initial_state;
+                if (next_urgent) {
+                    hot->flags |= CLIENT_FLAG_URGENT;
+                } else {
+                    hot->flags &= ~CLIENT_FLAG_URGENT;
+                }
+                hot->dirty |= DIRTY_STATE;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+static bool prop_parse_net_wm_icon(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_hot_t* hot = ctx->hot;
+
+    bool changed = false;
+    if (!prop_is_empty(r)) {
+        const uint32_t icon_target_sizes[] = {16, 24, 32, 48, 64};
+        const uint32_t icon_dim_max = 4096;
+        const uint64_t icon_pixels_max = 1024ull * 1024ull;
+        const uint64_t icon_total_pixels_max = 4ull * 1024ull * 1024ull;
+        const uint32_t icon_count_max = 32;
+
+        int total_words = 0;
+        uint32_t* val = prop_get_u32_array(r, 2, &total_words);
+        if (!val) return false;
+
+        uint32_t best_w = 0;
+        uint32_t best_h = 0;
+        uint64_t best_area = 0;
+        uint32_t* best_data = NULL;
+        uint32_t best_diff = UINT32_MAX;
+
+        int i = 0;
+        uint32_t icons_seen = 0;
+        uint64_t total_pixels = 0;
+        while (i + 2 <= total_words) {
+            if (icons_seen >= icon_count_max) break;
+
+            uint32_t w = val[i];
+            uint32_t h = val[i + 1];
+            if (w == 0 || h == 0) break;
+
+            uint64_t pixels = (uint64_t)w * (uint64_t)h;
+            if (pixels > (uint64_t)(total_words - i - 2)) break;
+            if (pixels > icon_pixels_max) break;
+            if (total_pixels + pixels > icon_total_pixels_max) break;
+
+            if (w <= icon_dim_max && h <= icon_dim_max) {
+                uint32_t diff = UINT32_MAX;
+                for (size_t t = 0; t < sizeof(icon_target_sizes) / sizeof(icon_target_sizes[0]); t++) {
+                    int dw = abs((int)w - (int)icon_target_sizes[t]);
+                    int dh = abs((int)h - (int)icon_target_sizes[t]);
+                    uint32_t td = (uint32_t)(dw + dh);
+                    if (td < diff) diff = td;
+                }
+
+                if (diff < best_diff || (diff == best_diff && pixels > best_area)) {
+                    best_diff = diff;
+                    best_w = w;
+                    best_h = h;
+                    best_area = pixels;
+                    best_data = &val[i + 2];
+                }
+            }
+
+            i += (int)(2 + pixels);
+            icons_seen++;
+            total_pixels += pixels;
+        }
+
+        if (best_data) {
+            if (hot->icon_surface) cairo_surface_destroy(hot->icon_surface);
+            hot->icon_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)best_w, (int)best_h);
+
+            unsigned char* dest = cairo_image_surface_get_data(hot->icon_surface);
+            int stride = cairo_image_surface_get_stride(hot->icon_surface);
+            cairo_surface_flush(hot->icon_surface);
+
+            for (int y = 0; y < (int)best_h; y++) {
+                uint32_t* row = (uint32_t*)(dest + y * stride);
+                for (int x = 0; x < (int)best_w; x++) {
+                    row[x] = best_data[y * (int)best_w + x];
+                }
+            }
+
+            cairo_surface_mark_dirty(hot->icon_surface);
+            changed = true;
+        } else if (hot->icon_surface) {
+            cairo_surface_destroy(hot->icon_surface);
+            hot->icon_surface = NULL;
+            changed = true;
+        }
+    } else if (hot->icon_surface) {
+        cairo_surface_destroy(hot->icon_surface);
+        hot->icon_surface = NULL;
+        changed = true;
+    }
+    return changed;
+}
+
+static bool prop_parse_net_wm_pid(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_cold_t* cold = ctx->cold;
+
+    if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
+        uint32_t val = *(uint32_t*)xcb_get_property_value(r);
+        cold->pid = val;
+    }
+    return false;
+}
+
+static bool prop_parse_net_wm_user_time(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_hot_t* hot = ctx->hot;
+
+    if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
+        uint32_t val = *(uint32_t*)xcb_get_property_value(r);
+        hot->user_time = val;
+    }
+    return false;
+}
+
+static bool prop_parse_net_wm_user_time_window(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    client_hot_t* hot = ctx->hot;
+
+    if (r && r->type == XCB_ATOM_WINDOW && xcb_get_property_value_length(r) >= 4) {
+        xcb_window_t w = *(xcb_window_t*)xcb_get_property_value(r);
+        hot->user_time_window = w;
+
+        if (w != hot->xid) {
+            uint32_t values[] = {XCB_EVENT_MASK_PROPERTY_CHANGE};
+            xcb_change_window_attributes(s->conn, w, XCB_CW_EVENT_MASK, values);
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_net_wm_sync_request_counter(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    handle_t h = ctx->h;
+    client_hot_t* hot = ctx->hot;
+
+    if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
+        xcb_sync_counter_t counter = *(xcb_sync_counter_t*)xcb_get_property_value(r);
+        hot->sync_counter = counter;
+        hot->sync_value = 0;
+        if (counter != XCB_NONE) {
+            xcb_sync_query_counter_cookie_t ck = xcb_sync_query_counter(s->conn, counter);
+            cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_SYNC_QUERY_COUNTER, h,
+                            (uintptr_t)counter, s->txn_id, wm_handle_reply);
+        }
+    } else {
+        hot->sync_counter = 0;
+        hot->sync_value = 0;
+    }
+    return false;
+}
+
+static bool prop_parse_net_wm_window_opacity(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    server_t* s = ctx->s;
+    client_hot_t* hot = ctx->hot;
+
+    if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
+        uint32_t val = *(uint32_t*)xcb_get_property_value(r);
+        if (!hot->window_opacity_valid || hot->window_opacity != val) {
+            hot->window_opacity = val;
+            hot->window_opacity_valid = true;
+            // A frameless client's own property is the one the compositor reads
+            if (hot->frame != XCB_NONE && !client_is_frameless(hot)) {
+                xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->frame,
+                                    atoms._NET_WM_WINDOW_OPACITY, XCB_ATOM_CARDINAL, 32, 1, &val);
+            }
+        }
+    } else {
+        if (hot->window_opacity_valid) {
+            hot->window_opacity_valid = false;
+            if (hot->frame != XCB_NONE && !client_is_frameless(hot)) {
+                xcb_delete_property(s->conn, hot->frame, atoms._NET_WM_WINDOW_OPACITY);
+            }
+        }
+    }
+    return false;
+}
+
+static bool prop_parse_net_wm_bypass_compositor(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_hot_t* hot = ctx->hot;
+
+    uint8_t mode = 0;
+    if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
+        uint32_t val = *(uint32_t*)xcb_get_property_value(r);
+        // Anything other than 1 (unredirect) or 2 (keep compositing) is "no preference"
+        if (val == 1 || val == 2) mode = (uint8_t)val;
+    }
+    hot->bypass_compositor = mode;
+    frame_sync_bypass(ctx->s, hot);
+    return false;
+}
+
+static bool prop_parse_net_wm_icon_geometry(const prop_ctx_t* ctx, xcb_get_property_reply_t* r) {
+    client_hot_t* hot = ctx->hot;
+
+    if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 16) {
+        uint32_t* val = (uint32_t*)xcb_get_property_value(r);
+        rect_t next_geom = {(int16_t)val[0], (int16_t)val[1], (uint16_t)val[2], (uint16_t)val[3]};
+        if (!hot->icon_geometry_valid || memcmp(&hot->icon_geometry, &next_geom, sizeof(rect_t)) != 0) {
+            hot->icon_geometry = next_geom;
+            hot->icon_geometry_valid = true;
+        }
+    } else {
+        hot->icon_geometry_valid = false;
+    }
+    return false;
+}
+
+static const xcb_atom_t prop_type_any = XCB_ATOM_ANY;
+static const xcb_atom_t prop_type_atom = XCB_ATOM_ATOM;
+static const xcb_atom_t prop_type_cardinal = XCB_ATOM_CARDINAL;
+static const xcb_atom_t prop_type_string = XCB_ATOM_STRING;
+static const xcb_atom_t prop_type_window = XCB_ATOM_WINDOW;
+static const xcb_atom_t prop_type_size_hints = XCB_ATOM_WM_SIZE_HINTS;
+
+#define PROP_MC (PROP_F_MANAGE | PROP_F_CRITICAL)
+
+/*
+ * Client property schema (see prop_schema.h).
+ *
+ * Order is significant:
+ * - _NET_WM_NAME before WM_NAME (and the icon-name pair): the legacy reply is
+ *   ignored once the EWMH one has been seen, so refetches must land in order.
+ * - _NET_WM_STRUT_PARTIAL before _NET_WM_STRUT: the partial reply drives the
+ *   legacy waterfall.
+ *
+ * Non-critical entries are still fetched at manage time but do not hold the
+ * client in STATE_NEW; their replies are applied whenever they arrive.
+ */
+const prop_schema_t prop_schema_table[] = {
+    {&atoms.WM_CLASS, &prop_type_string, 8, 1024, prop_parse_wm_class, 0, PROP_MC},
+    {&atoms.WM_CLIENT_MACHINE, &prop_type_string, 8, 1024, prop_parse_wm_client_machine, 0, PROP_F_MANAGE},
+    {&atoms.WM_COMMAND, &prop_type_string, 8, 1024, prop_parse_wm_command, 0, PROP_F_MANAGE},
+    {&atoms.WM_COLORMAP_WINDOWS, &prop_type_window, 32, 64, prop_parse_wm_colormap_windows, DIRTY_HINTS, PROP_MC},
+    {&atoms._NET_WM_NAME, &atoms.UTF8_STRING, 8, 1024, prop_parse_net_wm_name, DIRTY_TITLE, PROP_MC},
+    {&atoms._NET_WM_ICON_NAME, &atoms.UTF8_STRING, 8, 1024, prop_parse_net_wm_name, 0, PROP_MC},
+    {&atoms.WM_NAME, &prop_type_string, 8, 1024, prop_parse_wm_name, DIRTY_TITLE, PROP_MC},
+    {&atoms.WM_ICON_NAME, &prop_type_string, 8, 1024, prop_parse_wm_icon_name, 0, PROP_MC},
+    {&atoms._MOTIF_WM_HINTS, &prop_type_any, 32, 5, prop_parse_motif_wm_hints, DIRTY_HINTS, PROP_MC},
+    {&atoms._GTK_FRAME_EXTENTS, &prop_type_cardinal, 32, 4, prop_parse_gtk_frame_extents, DIRTY_HINTS, PROP_MC},
+    {&atoms._NET_WM_STATE, &prop_type_atom, 32, 32, prop_parse_net_wm_state, 0, PROP_MC},
+    {&atoms.WM_NORMAL_HINTS, &prop_type_size_hints, 32, 32, prop_parse_wm_normal_hints, DIRTY_HINTS, PROP_MC},
+    {&atoms.WM_TRANSIENT_FOR, &prop_type_window, 32, 1, prop_parse_wm_transient_for, 0, PROP_MC},
+    {&atoms._NET_WM_WINDOW_TYPE, &prop_type_atom, 32, 32, prop_parse_net_wm_window_type, 0, PROP_MC},
+    {&atoms.WM_PROTOCOLS, &prop_type_atom, 32, 32, prop_parse_wm_protocols, 0, PROP_MC | PROP_F_NOTIFY_FETCH},
+    {&atoms._NET_WM_DESKTOP, &prop_type_cardinal, 32, 1, prop_parse_net_wm_desktop, 0, PROP_MC | PROP_F_NOTIFY_IGNORE},
+    {&atoms._NET_WM_STRUT_PARTIAL, &prop_type_cardinal, 32, 12, prop_parse_net_wm_strut, DIRTY_STRUT, PROP_MC},
+    {&atoms._NET_WM_STRUT, &prop_type_cardinal, 32, 4, prop_parse_net_wm_strut, DIRTY_STRUT, PROP_MC},
+    {&atoms.WM_HINTS, &atoms.WM_HINTS, 32, 32, prop_parse_wm_hints, DIRTY_HINTS, PROP_MC},
+    {&atoms._NET_WM_ICON, &prop_type_cardinal, 32, 1048576, prop_parse_net_wm_icon, 0, PROP_F_MANAGE},
+    {&atoms._NET_WM_PID, &prop_type_cardinal, 32, 1, prop_parse_net_wm_pid, 0, PROP_F_MANAGE},
+    {&atoms._NET_WM_USER_TIME, &prop_type_cardinal, 32, 1, prop_parse_net_wm_user_time, 0, PROP_MC},
+    {&atoms._NET_WM_USER_TIME_WINDOW, &prop_type_window, 32, 1, prop_parse_net_wm_user_time_window, 0, PROP_MC},
+    {&atoms._NET_WM_SYNC_REQUEST_COUNTER, &prop_type_cardinal, 32, 1, prop_parse_net_wm_sync_request_counter, 0,
+     PROP_MC | PROP_F_NOTIFY_FETCH},
+    {&atoms._NET_WM_WINDOW_OPACITY, &prop_type_cardinal, 32, 1, prop_parse_net_wm_window_opacity, DIRTY_OPACITY,
+     PROP_F_MANAGE},
+    {&atoms._NET_WM_ICON_GEOMETRY, &prop_type_cardinal, 32, 4, prop_parse_net_wm_icon_geometry, 0, PROP_F_MANAGE},
+    // Compositor hint like the opacity: committed with the DIRTY_OPACITY group
+    {&atoms._NET_WM_BYPASS_COMPOSITOR, &prop_type_cardinal, 32, 1, prop_parse_net_wm_bypass_compositor, DIRTY_OPACITY,
+     PROP_F_MANAGE},
+
+    // Written by the WM itself; the resulting PropertyNotify is not interesting
+    {&atoms._NET_WM_ALLOWED_ACTIONS, &prop_type_any, 0, 0, NULL, 0, PROP_F_NOTIFY_IGNORE},
+    {&atoms._NET_FRAME_EXTENTS, &prop_type_any, 0, 0, NULL, 0, PROP_F_NOTIFY_IGNORE},
+    {&atoms.WM_STATE, &prop_type_any, 0, 0, NULL, 0, PROP_F_NOTIFY_IGNORE},
+    {&atoms._NET_WM_VISIBLE_NAME, &prop_type_any, 0, 0, NULL, 0, PROP_F_NOTIFY_IGNORE},
+    {&atoms._NET_WM_VISIBLE_ICON_NAME, &prop_type_any, 0, 0, NULL, 0, PROP_F_NOTIFY_IGNORE},
+};
+
+const size_t prop_schema_count = sizeof(prop_schema_table) / sizeof(prop_schema_table[0]);
+
+#undef PROP_MC
+
 /*
  * wm_handle_reply:
  * Central callback for all async X11 replies.
@@ -441,6 +1355,14 @@ void wm_handle_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_ge
         LOG_DEBUG("Cookie %u returned error code %d", slot->sequence, err->error_code);
     }
 
+    if (slot->type == COOKIE_QUERY_POINTER && reply) {
+        // Every answer is fresher than the cache
+        xcb_query_pointer_reply_t* r = (xcb_query_pointer_reply_t*)reply;
+        s->pointer.x = r->root_x;
+        s->pointer.y = r->root_y;
+        s->pointer.valid = true;
+    }
+
     if (slot->client == HANDLE_INVALID) {
         if ((slot->type == COOKIE_GET_WINDOW_ATTRIBUTES || slot->type == COOKIE_CHECK_MANAGE_MAP_REQUEST) && reply) {
             xcb_get_window_attributes_reply_t* r = (xcb_get_window_attributes_reply_t*)reply;
@@ -516,6 +1438,13 @@ void wm_handle_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_ge
         return;
     }
 
+    // Property replies resolve their schema entry once (dispatch and manage accounting)
+    const prop_schema_t* ps = NULL;
+    if (slot->type == COOKIE_GET_PROPERTY) {
+        ps = prop_schema_lookup((xcb_atom_t)(slot->data & 0xFFFFFFFFu));
+        if (ps) prop_schema_note_reply(hot, cold, ps);
+    }
+
     if (slot->type != COOKIE_SYNC_QUERY_COUNTER) {
         if (slot->txn_id < hot->last_applied_txn_id) {
             LOG_DEBUG("Discarding stale reply for client %u (txn_id %lu < last %lu)", hot->xid, slot->txn_id,
@@ -594,700 +1523,13 @@ void wm_handle_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_ge
             xcb_atom_t atom = (xcb_atom_t)(slot->data & 0xFFFFFFFFu);
             xcb_get_property_reply_t* r = (xcb_get_property_reply_t*)reply;
 
-            if (atom == atoms.WM_CLASS) {
-                parse_wm_class(cold, r);
-            } else if (atom == atoms.WM_CLIENT_MACHINE) {
-                int len = 0;
-                char* str = prop_get_string(r, &len);
-                if (str) {
-                    cold->wm_client_machine = arena_strndup(&cold->string_arena, str, (size_t)len);
-                }
-            } else if (atom == atoms.WM_COMMAND) {
-                int len = 0;
-                char* str = prop_get_string(r, &len);
-                if (str && len > 0) {
-                    size_t n = (size_t)len;
-                    char* nul = memchr(str, '\0', n);
-                    size_t cmd_len = nul ? (size_t)(nul - str) : n;
-                    if (cmd_len > 0) {
-                        cold->wm_command = arena_strndup(&cold->string_arena, str, cmd_len);
-                    }
-                }
-            } else if (atom == atoms.WM_COLORMAP_WINDOWS) {
-                if (!prop_is_empty(r) && r->format == 32 && r->type == XCB_ATOM_WINDOW) {
-                    int bytes = xcb_get_property_value_length(r);
-                    if (bytes >= 4) {
-                        uint32_t count = (uint32_t)(bytes / (int)sizeof(xcb_window_t));
-                        client_set_colormap_windows(cold, (xcb_window_t*)xcb_get_property_value(r), count);
-                    } else {
-                        client_set_colormap_windows(cold, NULL, 0);
-                    }
-                } else {
-                    client_set_colormap_windows(cold, NULL, 0);
-                }
-                if (s->focused_client == slot->client) {
-                    wm_install_client_colormap(s, hot);
-                }
-
-            } else if (atom == atoms._NET_WM_NAME || atom == atoms._NET_WM_ICON_NAME) {
-                parse_net_wm_name_like(s, slot->client, hot, cold, atom, r);
-                break;
-
-            } else if (atom == atoms.WM_NAME) {
-                if (prop_is_empty(r) && !cold->has_net_wm_name) {
-                    cold->base_title = arena_strndup(&cold->string_arena, "", 0);
-                    wm_client_refresh_title(s, slot->client);
-                    changed = true;
-                } else {
-                    int len = 0;
-                    char* str = prop_get_string(r, &len);
-                    if (str && !cold->has_net_wm_name) {
-                        size_t trimmed_len = clamp_prop_len(len, MAX_TITLE_BYTES);
-                        if (!cold->base_title || strlen(cold->base_title) != trimmed_len ||
-                            strncmp(cold->base_title, str, trimmed_len) != 0) {
-                            cold->base_title = arena_strndup(&cold->string_arena, str, trimmed_len);
-                            wm_client_refresh_title(s, slot->client);
-                            changed = true;
-                        }
-                    }
-                }
-
-            } else if (atom == atoms.WM_ICON_NAME) {
-                if (prop_is_empty(r) && !cold->has_net_wm_icon_name) {
-                    cold->base_icon_name = arena_strndup(&cold->string_arena, "", 0);
-                    wm_client_refresh_title(s, slot->client);
-                    changed = true;
-                } else {
-                    int len = 0;
-                    char* str = prop_get_string(r, &len);
-                    if (str && !cold->has_net_wm_icon_name) {
-                        size_t trimmed_len = clamp_prop_len(len, MAX_TITLE_BYTES);
-                        if (!cold->base_icon_name || strlen(cold->base_icon_name) != trimmed_len ||
-                            strncmp(cold->base_icon_name, str, trimmed_len) != 0) {
-                            cold->base_icon_name = arena_strndup(&cold->string_arena, str, trimmed_len);
-                            wm_client_refresh_title(s, slot->client);
-                            changed = true;
-                        }
-                    }
-                }
-
-            } else if (atom == atoms._MOTIF_WM_HINTS) {
-                if (client_apply_motif_hints(s, slot->client, r)) {
-                    if (client_apply_decoration_hints(hot)) changed = true;
-                }
-
-            } else if (atom == atoms._GTK_FRAME_EXTENTS) {
-                if (client_apply_gtk_frame_extents(s, slot->client, r)) {
-                    // Existing logic for geometry updates if not in manage phase
-                    if (hot->manage_phase == MANAGE_DONE) {
-                        hot->dirty |= DIRTY_GEOM;
-                    }
-                    if (client_apply_decoration_hints(hot)) changed = true;
-                }
-
-            } else if (atom == atoms._NET_WM_STATE) {
-                if (prop_is_empty(r)) {
-                    client_state_set_t set = {0};
-                    wm_client_apply_state_set(s, slot->client, &set);
-                } else {
-                    int num_states = 0;
-                    xcb_atom_t* states = (xcb_atom_t*)prop_get_u32_array(r, 1, &num_states);
-                    if (states) {
-                        client_state_set_t set = {0};
-                        for (int i = 0; i < num_states; i++) {
-                            xcb_atom_t state = states[i];
-                            if (state == atoms._NET_WM_STATE_FULLSCREEN) {
-                                set.fullscreen = true;
-                            } else if (state == atoms._NET_WM_STATE_ABOVE) {
-                                set.above = true;
-                            } else if (state == atoms._NET_WM_STATE_BELOW) {
-                                set.below = true;
-                            } else if (state == atoms._NET_WM_STATE_STICKY) {
-                                set.sticky = true;
-                            } else if (state == atoms._NET_WM_STATE_DEMANDS_ATTENTION) {
-                                set.urgent = true;
-                            } else if (state == atoms._NET_WM_STATE_MAXIMIZED_HORZ) {
-                                set.max_horz = true;
-                            } else if (state == atoms._NET_WM_STATE_MAXIMIZED_VERT) {
-                                set.max_vert = true;
-                            } else if (state == atoms._NET_WM_STATE_MODAL) {
-                                set.modal = true;
-                            } else if (state == atoms._NET_WM_STATE_SHADED) {
-                                set.shaded = true;
-                            } else if (state == atoms._NET_WM_STATE_SKIP_TASKBAR) {
-                                set.skip_taskbar = true;
-                            } else if (state == atoms._NET_WM_STATE_SKIP_PAGER) {
-                                set.skip_pager = true;
-                            }
-                        }
-                        wm_client_apply_state_set(s, slot->client, &set);
-                    }
-                }
-
-            } else if (atom == atoms.WM_NORMAL_HINTS) {
-                xcb_size_hints_t hints;
-
-                size_hints_t next_hints = {0};
-
-                uint32_t next_flags = 0;
-
-                bool valid = false;
-
-                if (prop_is_empty(r)) {
-                    valid = true;
-
-                } else if (xcb_get_property_value_length(r) >= (int)sizeof(xcb_size_hints_t) &&
-
-                           xcb_icccm_get_wm_size_hints_from_reply(&hints, r)) {
-                    valid = true;
-
-                    next_flags = hints.flags;
-
-                    if (hints.flags & XCB_ICCCM_SIZE_HINT_P_MIN_SIZE) {
-                        next_hints.min_w = hints.min_width;
-
-                        next_hints.min_h = hints.min_height;
-                    }
-
-                    if (hints.flags & XCB_ICCCM_SIZE_HINT_P_MAX_SIZE) {
-                        next_hints.max_w = hints.max_width;
-
-                        next_hints.max_h = hints.max_height;
-                    }
-
-                    if (hints.flags & XCB_ICCCM_SIZE_HINT_P_RESIZE_INC) {
-                        next_hints.inc_w = hints.width_inc;
-
-                        next_hints.inc_h = hints.height_inc;
-                    }
-
-                    if (hints.flags & XCB_ICCCM_SIZE_HINT_BASE_SIZE) {
-                        next_hints.base_w = hints.base_width;
-
-                        next_hints.base_h = hints.base_height;
-                    }
-
-                    if (hints.flags & XCB_ICCCM_SIZE_HINT_P_ASPECT) {
-                        next_hints.min_aspect_num = hints.min_aspect_num;
-
-                        next_hints.min_aspect_den = hints.min_aspect_den;
-
-                        next_hints.max_aspect_num = hints.max_aspect_num;
-
-                        next_hints.max_aspect_den = hints.max_aspect_den;
-                    }
-                }
-
-                if (valid) {
-                    bool hints_changed =
-                        (hot->hints_flags != next_flags || memcmp(&hot->hints, &next_hints, sizeof(size_hints_t)) != 0);
-
-                    if (hints_changed) {
-                        hot->hints = next_hints;
-
-                        hot->hints_flags = next_flags;
-
-                        hot->dirty |= DIRTY_STATE;  // Allowed actions might change
-
-                        if (hot->state == STATE_NEW && hot->manage_phase != MANAGE_DONE) {
-                            if (next_flags & (XCB_ICCCM_SIZE_HINT_US_SIZE | XCB_ICCCM_SIZE_HINT_P_SIZE)) {
-                                if (!hot->geometry_from_configure) {
-                                    if (hints.width > 0) hot->desired.w = (uint16_t)hints.width;
-
-                                    if (hints.height > 0) hot->desired.h = (uint16_t)hints.height;
-
-                                } else {
-                                    if (hot->desired.w == 0 && hints.width > 0) hot->desired.w = (uint16_t)hints.width;
-
-                                    if (hot->desired.h == 0 && hints.height > 0)
-                                        hot->desired.h = (uint16_t)hints.height;
-                                }
-                            }
-
-                            if (next_flags & (XCB_ICCCM_SIZE_HINT_US_POSITION | XCB_ICCCM_SIZE_HINT_P_POSITION)) {
-                                if (!hot->geometry_from_configure) {
-                                    hot->desired.x = (int16_t)hints.x;
-
-                                    hot->desired.y = (int16_t)hints.y;
-                                }
-                            }
-
-                            client_constrain_size(&hot->hints, hot->hints_flags, &hot->desired.w, &hot->desired.h);
-
-                        } else if (s->interaction_mode == INTERACTION_RESIZE && s->interaction_window == hot->frame) {
-                            client_constrain_size(&hot->hints, hot->hints_flags, &hot->desired.w, &hot->desired.h);
-
-                            hot->dirty |= DIRTY_GEOM;
-
-                        } else {
-                            // Even if not resizing, if hints changed, we might need to re-constrain
-
-                            uint16_t w = hot->desired.w;
-
-                            uint16_t h_val = hot->desired.h;
-
-                            client_constrain_size(&hot->hints, hot->hints_flags, &w, &h_val);
-
-                            if (w != hot->desired.w || h_val != hot->desired.h) {
-                                hot->desired.w = w;
-
-                                hot->desired.h = h_val;
-
-                                hot->dirty |= DIRTY_GEOM;
-                            }
-                        }
-                    }
-                }
-
-            } else if (atom == atoms.WM_TRANSIENT_FOR) {
-                if (xcb_get_property_value_length(r) >= 4) {
-                    xcb_window_t transient_for_xid = *(xcb_window_t*)xcb_get_property_value(r);
-                    cold->transient_for_xid = transient_for_xid;
-                    hot->transient_for = server_get_client_by_window(s, transient_for_xid);
-
-                    if (hot->transient_for != HANDLE_INVALID) {
-                        if (check_transient_cycle(s, slot->client, hot->transient_for)) {
-                            LOG_WARN("Ignoring transient_for cycle for client %u", hot->xid);
-                            hot->transient_for = HANDLE_INVALID;
-                        }
-                    }
-
-                    if (hot->transient_for != HANDLE_INVALID) {
-                        client_hot_t* parent = server_chot(s, hot->transient_for);
-                        if (parent) {
-                            if (hot->transient_sibling.next && hot->transient_sibling.next != &hot->transient_sibling) {
-                                list_remove(&hot->transient_sibling);
-                            }
-                            list_insert(&hot->transient_sibling, parent->transients_head.prev,
-                                        &parent->transients_head);
-                        }
-                    }
-                } else {
-                    cold->transient_for_xid = XCB_NONE;
-                    if (hot->transient_for != HANDLE_INVALID) {
-                        if (hot->transient_sibling.next && hot->transient_sibling.next != &hot->transient_sibling) {
-                            list_remove(&hot->transient_sibling);
-                            list_init(&hot->transient_sibling);
-                        }
-                        hot->transient_for = HANDLE_INVALID;
-                    }
-                }
-
-                if (client_apply_default_type(s, hot, cold)) {
-                    changed = true;
-                }
-
-            } else if (atom == atoms._NET_WM_WINDOW_TYPE) {
-                if (xcb_get_property_value_length(r) > 0) {
-                    uint8_t prev_type = hot->type;
-                    xcb_atom_t* types = (xcb_atom_t*)xcb_get_property_value(r);
-                    int num_types = xcb_get_property_value_length(r) / (int)sizeof(xcb_atom_t);
-
-                    for (int i = 0; i < num_types; i++) {
-                        if (types[i] == atoms._NET_WM_WINDOW_TYPE_DOCK) {
-                            hot->type = WINDOW_TYPE_DOCK;
-                            hot->base_layer = LAYER_DOCK;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_NOTIFICATION) {
-                            hot->type = WINDOW_TYPE_NOTIFICATION;
-                            hot->base_layer = LAYER_OVERLAY;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_DIALOG) {
-                            hot->type = WINDOW_TYPE_DIALOG;
-                            hot->base_layer = LAYER_NORMAL;
-                            hot->placement = PLACEMENT_CENTER;
-                            hot->type_from_net = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_DESKTOP) {
-                            hot->type = WINDOW_TYPE_DESKTOP;
-                            hot->base_layer = LAYER_DESKTOP;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_SPLASH) {
-                            hot->type = WINDOW_TYPE_SPLASH;
-                            hot->base_layer = LAYER_ABOVE;
-                            hot->type_from_net = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_TOOLBAR) {
-                            hot->type = WINDOW_TYPE_TOOLBAR;
-                            hot->base_layer = LAYER_NORMAL;
-                            hot->placement = PLACEMENT_DEFAULT;
-                            hot->type_from_net = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_UTILITY) {
-                            hot->type = WINDOW_TYPE_UTILITY;
-                            hot->base_layer = LAYER_NORMAL;
-                            hot->placement = PLACEMENT_DEFAULT;
-                            hot->type_from_net = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_MENU) {
-                            hot->type = WINDOW_TYPE_MENU;
-                            hot->base_layer = LAYER_OVERLAY;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_DROPDOWN_MENU) {
-                            hot->type = WINDOW_TYPE_DROPDOWN_MENU;
-                            hot->base_layer = LAYER_OVERLAY;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
-                                hot->manage_aborted = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_POPUP_MENU) {
-                            hot->type = WINDOW_TYPE_POPUP_MENU;
-                            hot->base_layer = LAYER_OVERLAY;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
-                                hot->manage_aborted = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_TOOLTIP) {
-                            hot->type = WINDOW_TYPE_TOOLTIP;
-                            hot->base_layer = LAYER_OVERLAY;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
-                                hot->manage_aborted = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_COMBO) {
-                            hot->type = WINDOW_TYPE_COMBO;
-                            hot->base_layer = LAYER_OVERLAY;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
-                                hot->manage_aborted = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_DND) {
-                            hot->type = WINDOW_TYPE_DND;
-                            hot->base_layer = LAYER_OVERLAY;
-                            hot->flags |= CLIENT_FLAG_UNDECORATED;
-                            hot->type_from_net = true;
-                            if (hot->state == STATE_NEW && hot->manage_phase == MANAGE_PHASE1)
-                                hot->manage_aborted = true;
-                            break;
-                        } else if (types[i] == atoms._NET_WM_WINDOW_TYPE_NORMAL) {
-                            hot->type = WINDOW_TYPE_NORMAL;
-                            hot->base_layer = LAYER_NORMAL;
-                            hot->placement = PLACEMENT_DEFAULT;
-                            hot->type_from_net = true;
-                            break;
-                        }
-                    }
-
-                    if (client_apply_decoration_hints(hot)) {
-                        changed = true;
-                    }
-
-                    if (hot->layer != LAYER_FULLSCREEN) {
-                        uint8_t prev_layer = hot->layer;
-                        hot->layer = client_layer_from_state(hot);
-                        if (hot->layer != prev_layer) {
-                            hot->dirty |= DIRTY_STATE | DIRTY_STACK;
-                        }
-                    }
-
-                    if (hot->type != prev_type) {
-                        s->root_dirty |= ROOT_DIRTY_CLIENT_LIST | ROOT_DIRTY_CLIENT_LIST_STACKING;
-                    }
-                }
-
-            } else if (atom == atoms.WM_PROTOCOLS) {
-                cold->protocols = 0;
-                hot->sync_enabled = false;
-                int num_protocols = 0;
-                xcb_atom_t* protocols = (xcb_atom_t*)prop_get_u32_array(r, 1, &num_protocols);
-                if (!protocols && r && r->format == 32 && r->value_len > 0) {
-                    protocols = (xcb_atom_t*)xcb_get_property_value(r);
-                    num_protocols = (int)r->value_len;
-                }
-                if (protocols) {
-                    for (int i = 0; i < num_protocols; i++) {
-                        if (protocols[i] == atoms.WM_DELETE_WINDOW) {
-                            cold->protocols |= PROTOCOL_DELETE_WINDOW;
-                        } else if (protocols[i] == atoms.WM_TAKE_FOCUS) {
-                            cold->protocols |= PROTOCOL_TAKE_FOCUS;
-                        } else if (protocols[i] == atoms._NET_WM_SYNC_REQUEST) {
-                            cold->protocols |= PROTOCOL_SYNC_REQUEST;
-                            hot->sync_enabled = true;
-                        } else if (protocols[i] == atoms._NET_WM_PING) {
-                            cold->protocols |= PROTOCOL_PING;
-                        }
-                    }
-                }
-
-            } else if (atom == atoms._NET_WM_DESKTOP) {
-                uint32_t* val = prop_get_u32_array(r, 1, NULL);
-                if (val) {
-                    if (*val == 0xFFFFFFFFu) {
-                        hot->sticky = true;
-                        hot->desktop = -1;
-                    } else {
-                        hot->sticky = false;
-                        uint32_t desk = *val;
-                        if (desk >= s->desktop_count) desk = s->current_desktop;
-                        hot->desktop = (int32_t)desk;
-                    }
-                }
-
-            } else if (atom == atoms._NET_WM_STRUT || atom == atoms._NET_WM_STRUT_PARTIAL) {
-                int len = r ? xcb_get_property_value_length(r) : 0;
-                bool is_partial = (atom == atoms._NET_WM_STRUT_PARTIAL);
-                strut_t* target = is_partial ? &cold->strut_partial : &cold->strut_full;
-                bool* active = is_partial ? &cold->strut_partial_active : &cold->strut_full_active;
-
-                strut_t prev_effective = cold->strut;
-
-                if (r && r->type == XCB_ATOM_CARDINAL && r->format == 32 && len >= 16) {
-                    uint32_t* val = (uint32_t*)xcb_get_property_value(r);
-                    memset(target, 0, sizeof(*target));
-                    target->left = val[0];
-                    target->right = val[1];
-                    target->top = val[2];
-                    target->bottom = val[3];
-
-                    if (is_partial && len >= 48) {
-                        target->left_start_y = val[4];
-                        target->left_end_y = val[5];
-                        target->right_start_y = val[6];
-                        target->right_end_y = val[7];
-                        target->top_start_x = val[8];
-                        target->top_end_x = val[9];
-                        target->bottom_start_x = val[10];
-                        target->bottom_end_x = val[11];
-                        sanitize_strut_range(&target->left_start_y, &target->left_end_y);
-                        sanitize_strut_range(&target->right_start_y, &target->right_end_y);
-                        sanitize_strut_range(&target->top_start_x, &target->top_end_x);
-                        sanitize_strut_range(&target->bottom_start_x, &target->bottom_end_x);
-                    }
-                    *active = true;
-                } else {
-                    memset(target, 0, sizeof(*target));
-                    *active = false;
-                }
-
-                // Waterfall: If PARTIAL failed (or empty), try legacy STRUT
-                if (is_partial && !*active) {
-                    xcb_get_property_cookie_t ck =
-                        xcb_get_property(s->conn, 0, hot->xid, atoms._NET_WM_STRUT, XCB_ATOM_CARDINAL, 0, 4);
-                    cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_GET_PROPERTY, slot->client,
-                                    ((uint64_t)hot->xid << 32) | atoms._NET_WM_STRUT, s->txn_id, wm_handle_reply);
-                }
-
-                client_update_effective_strut(cold);
-
-                if (memcmp(&prev_effective, &cold->strut, sizeof(strut_t)) != 0) {
-                    static rl_t rl_strut = {0};
-                    if (rl_allow(&rl_strut, monotonic_time_ns(), 1000000000)) {
-                        TRACE_LOG("strut_reply xid=%u atom=%s changed active=%d top=%u", hot->xid,
-                                  is_partial ? "_NET_WM_STRUT_PARTIAL" : "_NET_WM_STRUT", *active, cold->strut.top);
-                    }
-                    s->workarea_dirty = true;
-                    s->root_dirty |= ROOT_DIRTY_WORKAREA;
-                }
-
-            } else if (atom == atoms.WM_HINTS) {
-                if (prop_is_empty(r)) {
-                    bool changed_any = (cold->can_focus != true || hot->initial_state != XCB_ICCCM_WM_STATE_NORMAL);
-                    cold->can_focus = true;
-                    hot->initial_state = XCB_ICCCM_WM_STATE_NORMAL;
-                    if (hot->flags & CLIENT_FLAG_URGENT) {
-                        hot->flags &= ~CLIENT_FLAG_URGENT;
-                        hot->dirty |= DIRTY_STATE;
-                        changed = true;
-                    } else if (changed_any) {
-                        hot->dirty |= DIRTY_STATE;
-                        changed = true;
-                    }
-                } else {
-                    xcb_icccm_wm_hints_t hints;
-                    if (xcb_icccm_get_wm_hints_from_reply(&hints, r)) {
-                        bool next_can_focus = true;
-                        if (hints.flags & XCB_ICCCM_WM_HINT_INPUT) {
-                            next_can_focus = (bool)(hints.input);
-                        }
-
-                        uint8_t next_initial_state = hot->initial_state;
-                        if (hints.flags & XCB_ICCCM_WM_HINT_STATE) {
-                            next_initial_state = (uint8_t)hints.initial_state;
-                        }
-
-                        bool next_urgent = (hints.flags & XCB_ICCCM_WM_HINT_X_URGENCY) != 0;
-                        bool was_urgent = (hot->flags & CLIENT_FLAG_URGENT) != 0;
-
-                        if (cold->can_focus != next_can_focus || hot->initial_state != next_initial_state ||
-                            was_urgent != next_urgent) {
-                            cold->can_focus = next_can_focus;
-                            hot->initial_state = next_initial_state;
-                            if (next_urgent) {
-                                hot->flags |= CLIENT_FLAG_URGENT;
-                            } else {
-                                hot->flags &= ~CLIENT_FLAG_URGENT;
-                            }
-                            hot->dirty |= DIRTY_STATE;
-                            changed = true;
-                        }
-                    }
-                }
-
-            } else if (atom == atoms._NET_WM_ICON) {
-                if (!prop_is_empty(r)) {
-                    const uint32_t icon_target_sizes[] = {16, 24, 32, 48, 64};
-                    const uint32_t icon_dim_max = 4096;
-                    const uint64_t icon_pixels_max = 1024ull * 1024ull;
-                    const uint64_t icon_total_pixels_max = 4ull * 1024ull * 1024ull;
-                    const uint32_t icon_count_max = 32;
-
-                    int total_words = 0;
-                    uint32_t* val = prop_get_u32_array(r, 2, &total_words);
-                    if (!val) break;
-
-                    uint32_t best_w = 0;
-                    uint32_t best_h = 0;
-                    uint64_t best_area = 0;
-                    uint32_t* best_data = NULL;
-                    uint32_t best_diff = UINT32_MAX;
-
-                    int i = 0;
-                    uint32_t icons_seen = 0;
-                    uint64_t total_pixels = 0;
-                    while (i + 2 <= total_words) {
-                        if (icons_seen >= icon_count_max) break;
-
-                        uint32_t w = val[i];
-                        uint32_t h = val[i + 1];
-                        if (w == 0 || h == 0) break;
-
-                        uint64_t pixels = (uint64_t)w * (uint64_t)h;
-                        if (pixels > (uint64_t)(total_words - i - 2)) break;
-                        if (pixels > icon_pixels_max) break;
-                        if (total_pixels + pixels > icon_total_pixels_max) break;
-
-                        if (w <= icon_dim_max && h <= icon_dim_max) {
-                            uint32_t diff = UINT32_MAX;
-                            for (size_t t = 0; t < sizeof(icon_target_sizes) / sizeof(icon_target_sizes[0]); t++) {
-                                int dw = abs((int)w - (int)icon_target_sizes[t]);
-                                int dh = abs((int)h - (int)icon_target_sizes[t]);
-                                uint32_t td = (uint32_t)(dw + dh);
-                                if (td < diff) diff = td;
-                            }
-
-                            if (diff < best_diff || (diff == best_diff && pixels > best_area)) {
-                                best_diff = diff;
-                                best_w = w;
-                                best_h = h;
-                                best_area = pixels;
-                                best_data = &val[i + 2];
-                            }
-                        }
-
-                        i += (int)(2 + pixels);
-                        icons_seen++;
-                        total_pixels += pixels;
-                    }
-
-                    if (best_data) {
-                        if (hot->icon_surface) cairo_surface_destroy(hot->icon_surface);
-                        hot->icon_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)best_w, (int)best_h);
-
-                        unsigned char* dest = cairo_image_surface_get_data(hot->icon_surface);
-                        int stride = cairo_image_surface_get_stride(hot->icon_surface);
-                        cairo_surface_flush(hot->icon_surface);
-
-                        for (int y = 0; y < (int)best_h; y++) {
-                            uint32_t* row = (uint32_t*)(dest + y * stride);
-                            for (int x = 0; x < (int)best_w; x++) {
-                                row[x] = best_data[y * (int)best_w + x];
-                            }
-                        }
-
-                        cairo_surface_mark_dirty(hot->icon_surface);
-                        changed = true;
-                    } else if (hot->icon_surface) {
-                        cairo_surface_destroy(hot->icon_surface);
-                        hot->icon_surface = NULL;
-                        changed = true;
-                    }
-                } else if (hot->icon_surface) {
-                    cairo_surface_destroy(hot->icon_surface);
-                    hot->icon_surface = NULL;
-                    changed = true;
-                }
-
-            } else if (atom == atoms._NET_WM_PID) {
-                if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
-                    uint32_t val = *(uint32_t*)xcb_get_property_value(r);
-                    cold->pid = val;
-                }
-
-            } else if (atom == atoms._NET_WM_USER_TIME) {
-                if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
-                    uint32_t val = *(uint32_t*)xcb_get_property_value(r);
-                    hot->user_time = val;
-                }
-
-            } else if (atom == atoms._NET_WM_USER_TIME_WINDOW) {
-                if (r && r->type == XCB_ATOM_WINDOW && xcb_get_property_value_length(r) >= 4) {
-                    xcb_window_t w = *(xcb_window_t*)xcb_get_property_value(r);
-                    hot->user_time_window = w;
-
-                    if (w != hot->xid) {
-                        uint32_t values[] = {XCB_EVENT_MASK_PROPERTY_CHANGE};
-                        xcb_change_window_attributes(s->conn, w, XCB_CW_EVENT_MASK, values);
-                    }
-                }
-
-            } else if (atom == atoms._NET_WM_SYNC_REQUEST_COUNTER) {
-                if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
-                    xcb_sync_counter_t counter = *(xcb_sync_counter_t*)xcb_get_property_value(r);
-                    hot->sync_counter = counter;
-                    hot->sync_value = 0;
-                    if (counter != XCB_NONE) {
-                        xcb_sync_query_counter_cookie_t ck = xcb_sync_query_counter(s->conn, counter);
-                        cookie_jar_push(&s->cookie_jar, ck.sequence, COOKIE_SYNC_QUERY_COUNTER, slot->client,
-                                        (uintptr_t)counter, s->txn_id, wm_handle_reply);
-                    }
-                } else {
-                    hot->sync_counter = 0;
-                    hot->sync_value = 0;
-                }
-
-            } else if (atom == atoms._NET_WM_WINDOW_OPACITY) {
-                if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 4) {
-                    uint32_t val = *(uint32_t*)xcb_get_property_value(r);
-                    if (!hot->window_opacity_valid || hot->window_opacity != val) {
-                        hot->window_opacity = val;
-                        hot->window_opacity_valid = true;
-                        if (hot->frame != XCB_NONE) {
-                            xcb_change_property(s->conn, XCB_PROP_MODE_REPLACE, hot->frame,
-                                                atoms._NET_WM_WINDOW_OPACITY, XCB_ATOM_CARDINAL, 32, 1, &val);
-                        }
-                    }
-                } else {
-                    if (hot->window_opacity_valid) {
-                        hot->window_opacity_valid = false;
-                        if (hot->frame != XCB_NONE) {
-                            xcb_delete_property(s->conn, hot->frame, atoms._NET_WM_WINDOW_OPACITY);
-                        }
-                    }
-                }
-
-            } else if (atom == atoms._NET_WM_ICON_GEOMETRY) {
-                if (prop_is_cardinal(r) && xcb_get_property_value_length(r) >= 16) {
-                    uint32_t* val = (uint32_t*)xcb_get_property_value(r);
-                    rect_t next_geom = {(int16_t)val[0], (int16_t)val[1], (uint16_t)val[2], (uint16_t)val[3]};
-                    if (!hot->icon_geometry_valid || memcmp(&hot->icon_geometry, &next_geom, sizeof(rect_t)) != 0) {
-                        hot->icon_geometry = next_geom;
-                        hot->icon_geometry_valid = true;
-                    }
-                } else {
-                    hot->icon_geometry_valid = false;
+            if (ps && ps->parse) {
+                if (ps->format && !prop_is_empty(r) && r->format != ps->format) {
+                    LOG_DEBUG("Property %s on %u has format %u (expected %u)", atom_name(atom), hot->xid, r->format,
+                              ps->format);
                 }
+                prop_ctx_t ctx = {s, slot->client, hot, cold, atom};
+                if (ps->parse(&ctx, r)) changed = true;
             }
 
             break;
@@ -1295,6 +1537,7 @@ void wm_handle_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_ge
 
         case COOKIE_QUERY_POINTER: {
             xcb_query_pointer_reply_t* r = (xcb_query_pointer_reply_t*)reply;
+            if (!r) break;
             int16_t root_x = r->root_x;
             int16_t root_y = r->root_y;
             bool is_move = (slot->data & 0x100) != 0;
@@ -1333,7 +1576,8 @@ void wm_handle_reply(server_t* s, const cookie_slot_t* slot, void* reply, xcb_ge
     if (changed) hot->dirty |= DIRTY_FRAME_STYLE;
 
 done_one:
-    if (hot->pending_replies > 0) hot->pending_replies--;
+    // Non-critical manage-time properties are not part of the pending_replies budget
+    if (hot->pending_replies > 0 && (!ps || (ps->flags & PROP_F_CRITICAL))) hot->pending_replies--;
 
     if (hot->state != STATE_NEW) return;
     if (hot->pending_replies != 0) return;
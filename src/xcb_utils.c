@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include "hxm.h"
+#include "prop_schema.h"
 
 struct atoms atoms;
 static xcb_connection_t* g_conn_ref = NULL;
@@ -196,6 +197,8 @@ void atoms_init(xcb_connection_t* conn) {
             atom_ptr[i] = XCB_ATOM_NONE;
         }
     }
+
+    prop_schema_index_build();
 }
 
 void atoms_print(void) {
@@ -5,6 +5,7 @@
 
 #include "client.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -25,7 +26,6 @@ static void setup_server(server_t* s) {
     list_init(&s->focus_history);
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
 
     slotmap_init(&s->clients, 16, sizeof(client_hot_t), sizeof(client_cold_t));
 }
@@ -49,7 +49,6 @@ static void cleanup_server(server_t* s) {
     slotmap_destroy(&s->clients);
     hash_map_destroy(&s->window_to_client);
     hash_map_destroy(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s->layers[i]);
     xcb_disconnect(s->conn);
 }
 
@@ -67,7 +66,6 @@ static handle_t add_client(server_t* s, xcb_window_t xid, xcb_window_t frame) {
     hot->xid = xid;
     hot->frame = frame;
     hot->state = STATE_MAPPED;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->focus_node);
     list_init(&hot->transients_head);
@@ -131,6 +129,7 @@ static void test_colormap_windows_update_on_focus(void) {
     setup_server(&s);
 
     atoms.WM_COLORMAP_WINDOWS = 500;
+    prop_schema_index_build();
     handle_t h = add_client(&s, 300, 310);
     client_hot_t* hot = server_chot(&s, h);
     hot->colormap = 30;
@@ -31,6 +31,9 @@ static void test_defaults(void) {
     assert(strcmp(c.font_name, "fixed") == 0);
     assert(c.focus_raise == true);
     assert(c.fullscreen_use_workarea == false);
+    assert(c.workspace_hide == WORKSPACE_HIDE_UNMAP);
+    assert(!c.frameless_undecorated);
+    assert(c.placement == PLACEMENT_DEFAULT);
     assert(c.key_bindings.length > 0);
 
     // Verify specific default keybinds
@@ -53,6 +56,9 @@ static void test_load_simple(void) {
         "border_width=5\n"
         "font_name=Monospace 12\n"
         "focus_raise=false\n"
+        "workspace_hide=park\n"
+        "frameless_undecorated=true\n"
+        "placement=smart\n"
         "active_bg=#FF0000\n"
         "desktop_names=Web,Code,Music\n";
 
@@ -67,6 +73,9 @@ static void test_load_simple(void) {
     assert(c.theme.border_width == 5);
     assert(strcmp(c.font_name, "Monospace 12") == 0);
     assert(!c.focus_raise);
+    assert(c.workspace_hide == WORKSPACE_HIDE_PARK);
+    assert(c.frameless_undecorated);
+    assert(c.placement == PLACEMENT_SMART);
     assert(c.theme.window_active_title.color == 0xFF0000);
 
     assert(c.desktop_names_count == 3);
@@ -121,7 +130,8 @@ static void test_rules(void) {
     const char* content =
         "rule=class:Firefox -> desktop:1\n"
         "rule=title:Error, type:dialog -> layer:above, focus:yes\n"
-        "rule=instance:term -> placement:center\n";
+        "rule=instance:term -> placement:center\n"
+        "rule=class:mpv -> bypass:true\n";
 
     char* path = write_temp_file(content);
 
@@ -130,7 +140,7 @@ static void test_rules(void) {
     bool res = config_load(&c, path);
     assert(res);
 
-    assert(c.rules.length == 3);
+    assert(c.rules.length == 4);
 
     // Rule 1
     app_rule_t* r1 = c.rules.items[0];
@@ -148,6 +158,11 @@ static void test_rules(void) {
     app_rule_t* r3 = c.rules.items[2];
     assert(strcmp(r3->instance_match, "term") == 0);
     assert(r3->placement == PLACEMENT_CENTER);
+    assert(r3->bypass_compositor == -1);
+
+    // Rule 4
+    app_rule_t* r4 = c.rules.items[3];
+    assert(r4->bypass_compositor == 1);
 
     config_destroy(&c);
     unlink(path);
@@ -155,6 +170,38 @@ static void test_rules(void) {
     printf("test_rules passed\n");
 }
 
+static void test_rule_index_follows_edits(void) {
+    char* path = write_temp_file("rule=class:Alpha -> desktop:1\nrule=class:Beta -> desktop:2\n");
+
+    config_t c;
+    config_init_defaults(&c);
+    assert(config_load(&c, path));
+
+    uint32_t* hits = NULL;
+    assert(rule_index_query(&c.rule_index, "Alpha", NULL, NULL, &hits) == 1);
+    assert(hits[0] == 0);
+
+    // Unchanged rules keep the index
+    uint32_t gen = c.rule_index.generation;
+    rule_index_sync(&c.rule_index, &c.rules, c.rules_version);
+    assert(c.rule_index.generation == gen);
+
+    // Swapping rules in place keeps the count; the version bump still forces a rebuild
+    void* tmp = c.rules.items[0];
+    c.rules.items[0] = c.rules.items[1];
+    c.rules.items[1] = tmp;
+    c.rules_version++;
+    rule_index_sync(&c.rule_index, &c.rules, c.rules_version);
+    assert(c.rule_index.generation != gen);
+    assert(rule_index_query(&c.rule_index, "Alpha", NULL, NULL, &hits) == 1);
+    assert(hits[0] == 1);
+
+    config_destroy(&c);
+    unlink(path);
+    free(path);
+    printf("test_rule_index_follows_edits passed\n");
+}
+
 static void test_theme(void) {
     const char* content =
         "window.active.title.bg: gradient vertical\n"
@@ -211,13 +258,73 @@ static void test_missing_file(void) {
     printf("test_missing_file passed\n");
 }
 
+static void load_from(config_t* c, const char* content) {
+    char* path = write_temp_file(content);
+    config_init_defaults(c);
+    bool res = config_load(c, path);
+    assert(res);
+    unlink(path);
+    free(path);
+}
+
+static void test_config_diff(void) {
+    const char* base =
+        "desktop_count=4\n"
+        "keybind=Mod4+q : close\n"
+        "rule=class:Firefox -> desktop:1\n"
+        "active_bg=#112233\n";
+
+    config_t a, b;
+    load_from(&a, base);
+    load_from(&b, base);
+    assert(config_diff(&a, &b) == 0);
+    config_destroy(&b);
+
+    // One binding changed: only keys
+    load_from(&b,
+              "desktop_count=4\n"
+              "keybind=Mod4+w : close\n"
+              "rule=class:Firefox -> desktop:1\n"
+              "active_bg=#112233\n");
+    assert(config_diff(&a, &b) == CONFIG_CHANGED_KEYS);
+    config_destroy(&b);
+
+    // Color only: repaint without reconfigure
+    load_from(&b,
+              "desktop_count=4\n"
+              "keybind=Mod4+q : close\n"
+              "rule=class:Firefox -> desktop:1\n"
+              "active_bg=#445566\n");
+    assert(config_diff(&a, &b) == CONFIG_CHANGED_FRAME_STYLE);
+    config_destroy(&b);
+
+    load_from(&b,
+              "desktop_count=5\n"
+              "border_width=7\n"
+              "keybind=Mod4+q : close\n"
+              "rule=class:Firefox -> desktop:2\n"
+              "active_bg=#112233\n");
+    assert(config_diff(&a, &b) == (CONFIG_CHANGED_DESKTOPS | CONFIG_CHANGED_FRAME_GEOM | CONFIG_CHANGED_RULES));
+    config_destroy(&b);
+
+    // Shallow copy: shares a's heap data, so it is not destroyed
+    config_t m = a;
+    m.theme.menu_items_text_color ^= 1;
+    assert(config_diff(&a, &m) == CONFIG_CHANGED_MENU);
+
+    config_destroy(&a);
+    printf("test_config_diff passed\n");
+}
+
 int main(void) {
     test_defaults();
     test_load_simple();
     test_keybinds();
     test_rules();
+    test_rule_index_follows_edits();
     test_theme();
     test_invalid();
     test_missing_file();
+    test_config_diff();
     return 0;
 }
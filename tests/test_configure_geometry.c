@@ -8,6 +8,7 @@
 #include "config.h"
 #include "event.h"
 #include "hxm.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -53,7 +54,6 @@ static void setup_server(server_t* s) {
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
     list_init(&s->focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
 
     slotmap_init(&s->clients, 16, sizeof(client_hot_t), sizeof(client_cold_t));
     small_vec_init(&s->active_clients);
@@ -76,7 +76,6 @@ static void cleanup_server(server_t* s) {
     small_vec_destroy(&s->active_clients);
     hash_map_destroy(&s->window_to_client);
     hash_map_destroy(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s->layers[i]);
     arena_destroy(&s->tick_arena);
     config_destroy(&s->config);
     xcb_disconnect(s->conn);
@@ -102,7 +101,6 @@ static handle_t add_client(server_t* s, xcb_window_t win, xcb_window_t frame) {
     hot->base_layer = LAYER_NORMAL;
     hot->desired = (rect_t){10, 20, 100, 80};
     hot->server = hot->desired;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->focus_node);
     list_init(&hot->transients_head);
@@ -121,6 +119,7 @@ static void test_configure_request_applies_and_extents(void) {
     xcb_stubs_reset();
 
     atoms._NET_FRAME_EXTENTS = 700;
+    prop_schema_index_build();
 
     handle_t h = add_client(&s, 1001, 1101);
     client_hot_t* hot = server_chot(&s, h);
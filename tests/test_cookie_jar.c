@@ -600,6 +600,135 @@ static void test_alloc_fail_grow(void) {
     }
 }
 
+// Grouped transactions: replies up to (and including) g_ready_upto are ready
+static uint32_t g_ready_upto = 0;
+static uint32_t g_txn_seen[64];
+static uintptr_t g_txn_seen_data[64];
+static uint64_t g_txn_seen_txn[64];
+static size_t g_txn_seen_len = 0;
+
+static int mock_poll_upto(xcb_connection_t* c, unsigned int request, void** reply, xcb_generic_error_t** error) {
+    (void)c;
+    if (request > g_ready_upto) return 0;
+    *reply = malloc(1);
+    *error = NULL;
+    return 1;
+}
+
+static void txn_handler(struct server* s, const struct cookie_slot* slot, void* reply, xcb_generic_error_t* err) {
+    (void)s;
+    (void)reply;
+    (void)err;
+    assert(slot->type != COOKIE_TXN);
+    if (g_txn_seen_len < HXM_ARRAY_LEN(g_txn_seen)) {
+        g_txn_seen[g_txn_seen_len] = slot->sequence;
+        g_txn_seen_data[g_txn_seen_len] = slot->data;
+        g_txn_seen_txn[g_txn_seen_len] = slot->txn_id;
+        g_txn_seen_len++;
+    }
+}
+
+static void test_txn_single_slot_and_ordered_dispatch(void) {
+    cookie_jar_t cj;
+    cookie_jar_init(&cj);
+    stub_poll_for_reply_hook = mock_poll_upto;
+    g_ready_upto = 0;
+    g_txn_seen_len = 0;
+
+    cookie_txn_t* txn = cookie_jar_txn_begin(&cj, HANDLE_INVALID, 77, txn_handler);
+    for (uint32_t i = 0; i < 28; i++) {
+        cookie_jar_txn_add(&cj, txn, 100 + i, COOKIE_GET_PROPERTY, 1000 + i);
+    }
+    cookie_jar_txn_commit(&cj, txn);
+    assert(cj.live_count == 1);
+
+    // Partial readiness dispatches only the ready prefix
+    g_ready_upto = 109;
+    cookie_jar_drain(&cj, NULL, NULL, 64);
+    assert(g_txn_seen_len == 10);
+    assert(cj.live_count == 1);
+
+    // Budget is counted per sub-reply
+    g_ready_upto = 200;
+    cookie_jar_drain(&cj, NULL, NULL, 5);
+    assert(g_txn_seen_len == 15);
+    assert(cj.live_count == 1);
+
+    cookie_jar_drain(&cj, NULL, NULL, 64);
+    assert(g_txn_seen_len == 28);
+    assert(cj.live_count == 0);
+
+    for (uint32_t i = 0; i < 28; i++) {
+        assert(g_txn_seen[i] == 100 + i);
+        assert(g_txn_seen_data[i] == 1000 + i);
+        assert(g_txn_seen_txn[i] == 77);
+    }
+
+    // Record is recycled for the next group
+    cookie_txn_t* again = cookie_jar_txn_begin(&cj, HANDLE_INVALID, 78, txn_handler);
+    assert(again == txn);
+    cookie_jar_txn_commit(&cj, again);
+    assert(cj.live_count == 0);
+
+    stub_poll_for_reply_hook = NULL;
+    cookie_jar_destroy(&cj);
+    printf("test_txn_single_slot_and_ordered_dispatch passed\n");
+}
+
+static void test_txn_gap_falls_back_to_push(void) {
+    cookie_jar_t cj;
+    cookie_jar_init(&cj);
+    stub_poll_for_reply_hook = mock_poll_upto;
+    g_ready_upto = 0;
+    g_txn_seen_len = 0;
+
+    cookie_txn_t* txn = cookie_jar_txn_begin(&cj, HANDLE_INVALID, 5, txn_handler);
+    cookie_jar_txn_add(&cj, txn, 10, COOKIE_GET_GEOMETRY, 1);
+    cookie_jar_txn_add(&cj, txn, 11, COOKIE_GET_PROPERTY, 2);
+    cookie_jar_txn_add(&cj, txn, 13, COOKIE_GET_PROPERTY, 3);  // gap: seq 12 went elsewhere
+    cookie_jar_txn_commit(&cj, txn);
+    assert(txn->count == 2);
+    assert(cj.live_count == 2);
+
+    g_ready_upto = 13;
+    cookie_jar_drain(&cj, NULL, NULL, 64);
+    assert(g_txn_seen_len == 3);
+    assert(cj.live_count == 0);
+
+    stub_poll_for_reply_hook = NULL;
+    cookie_jar_destroy(&cj);
+    printf("test_txn_gap_falls_back_to_push passed\n");
+}
+
+static void test_txn_timeout_completes_group(void) {
+    cookie_jar_t cj;
+    cookie_jar_init(&cj);
+    stub_poll_for_reply_hook = mock_poll_upto;
+    g_use_mock_time = true;
+    g_mock_time = 1000000000ULL;
+    g_ready_upto = 0;
+    g_txn_seen_len = 0;
+
+    cookie_txn_t* txn = cookie_jar_txn_begin(&cj, HANDLE_INVALID, 9, txn_handler);
+    for (uint32_t i = 0; i < 4; i++) cookie_jar_txn_add(&cj, txn, 300 + i, COOKIE_GET_PROPERTY, i);
+    cookie_jar_txn_commit(&cj, txn);
+
+    g_ready_upto = 301;
+    cookie_jar_drain(&cj, NULL, NULL, 64);
+    assert(g_txn_seen_len == 2);
+
+    // Remaining sub-requests are expired with reply=NULL
+    g_mock_time += 7000000000ULL;
+    cookie_jar_drain(&cj, NULL, NULL, 64);
+    assert(g_txn_seen_len == 4);
+    assert(cj.live_count == 0);
+
+    g_use_mock_time = false;
+    stub_poll_for_reply_hook = NULL;
+    cookie_jar_destroy(&cj);
+    printf("test_txn_timeout_completes_group passed\n");
+}
+
 int main(void) {
     test_init_destroy();
     test_push_and_drain();
@@ -616,6 +745,9 @@ int main(void) {
     test_performance_smoke();
     test_alloc_fail_init();
     test_alloc_fail_grow();
+    test_txn_single_slot_and_ordered_dispatch();
+    test_txn_gap_falls_back_to_push();
+    test_txn_timeout_completes_group();
 
     printf("All cookie_jar tests passed\n");
     return 0;
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 #include <xcb/xcb.h>
 
 #include "../src/wm_internal.h"
@@ -284,6 +286,31 @@ static void test_6_6_randr_dirty_processing(void) {
     cleanup_server(&s);
 }
 
+static void test_6_7_timer_keeps_earliest_deadline(void) {
+    server_t s;
+    setup_server(&s);
+    s.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    assert(s.timer_fd > 0);
+
+    // A 16ms interaction deadline is not pushed back by a 100ms title deadline
+    server_schedule_timer(&s, 16);
+    uint64_t first = s.timer_deadline_ns;
+    server_schedule_timer(&s, 100);
+    assert(s.timer_deadline_ns == first);
+
+    struct itimerspec its;
+    timerfd_gettime(s.timer_fd, &its);
+    assert(its.it_value.tv_sec == 0 && its.it_value.tv_nsec <= 16000000);
+
+    // A sooner one still re-arms
+    server_schedule_timer(&s, 1);
+    assert(s.timer_deadline_ns < first);
+
+    close(s.timer_fd);
+    printf("test_6_7_timer_keeps_earliest_deadline passed\n");
+    cleanup_server(&s);
+}
+
 int main(void) {
     test_6_1_key_press_dispatch();
     test_6_2_button_events_dispatch();
@@ -291,5 +318,6 @@ int main(void) {
     test_6_4_motion_notify_dispatch();
     test_6_5_configure_request_unknown_window();
     test_6_6_randr_dirty_processing();
+    test_6_7_timer_keeps_earliest_deadline();
     return 0;
 }
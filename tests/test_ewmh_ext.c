@@ -5,6 +5,7 @@
 
 #include "client.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -31,6 +32,7 @@ void test_frame_extents(void) {
 
     // Init atoms
     atoms._NET_FRAME_EXTENTS = 200;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
     small_vec_init(&s.active_clients);
@@ -44,7 +46,6 @@ void test_frame_extents(void) {
     hash_map_init(&s.window_to_client);
     hash_map_init(&s.frame_to_client);
     list_init(&s.focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
 
     void *hot_ptr = NULL, *cold_ptr = NULL;
     handle_t h = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
@@ -57,7 +58,6 @@ void test_frame_extents(void) {
     hot->desired.y = 0;
     hot->desired.w = 100;
     hot->desired.h = 100;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transient_sibling);
     list_init(&hot->transients_head);
@@ -139,6 +139,7 @@ void test_allowed_actions(void) {
     atoms._NET_WM_ACTION_MOVE = 301;
     atoms._NET_WM_ACTION_RESIZE = 302;
     atoms._NET_WM_STATE = 400;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
     small_vec_init(&s.active_clients);
@@ -228,6 +229,7 @@ void test_desktop_clamp_single(void) {
 
     atoms._NET_WM_DESKTOP = 500;
     atoms.WM_STATE = 501;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
     small_vec_init(&s.active_clients);
@@ -247,7 +249,6 @@ void test_desktop_clamp_single(void) {
 
     hash_map_init(&s.window_to_client);
     hash_map_init(&s.frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
 
     stub_last_prop_atom = 0;
     wm_client_move_to_workspace(&s, h, 2, false);
@@ -283,7 +284,6 @@ void test_desktop_clamp_single(void) {
 
     hash_map_destroy(&s.window_to_client);
     hash_map_destroy(&s.frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s.layers[i]);
     render_free(&hot->render_ctx);
     if (hot->icon_surface) cairo_surface_destroy(hot->icon_surface);
     slotmap_destroy(&s.clients);
@@ -302,7 +302,6 @@ void test_dirty_stack_relayer(void) {
     s.root = 1;
     arena_init(&s.tick_arena, 4096);
 
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
     small_vec_init(&s.active_clients);
@@ -316,7 +315,6 @@ void test_dirty_stack_relayer(void) {
     hot->frame = 456;
     hot->state = STATE_MAPPED;
     hot->layer = LAYER_NORMAL;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transient_sibling);
     list_init(&hot->transients_head);
@@ -330,7 +328,7 @@ void test_dirty_stack_relayer(void) {
 
     assert(s.layers[LAYER_NORMAL].length == 0);
     assert(s.layers[LAYER_ABOVE].length == 1);
-    assert((handle_t)(uintptr_t)s.layers[LAYER_ABOVE].items[0] == h);
+    assert(s.layers[LAYER_ABOVE].bottom == hot);
 
     printf("test_dirty_stack_relayer passed\n");
 
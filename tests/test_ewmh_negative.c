@@ -11,6 +11,7 @@
 #include "event.h"
 #include "hxm.h"
 #include "src/wm_internal.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -72,7 +73,6 @@ static void setup_server(server_t* s) {
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
     list_init(&s->focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
 }
 
 static void cleanup_server(server_t* s) {
@@ -91,7 +91,6 @@ static void cleanup_server(server_t* s) {
     slotmap_destroy(&s->clients);
     hash_map_destroy(&s->window_to_client);
     hash_map_destroy(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s->layers[i]);
     arena_destroy(&s->tick_arena);
     config_destroy(&s->config);
     xcb_disconnect(s->conn);
@@ -115,7 +114,6 @@ static handle_t add_mapped_client(server_t* s, xcb_window_t win, xcb_window_t fr
     hot->type = WINDOW_TYPE_NORMAL;
     hot->layer = LAYER_NORMAL;
     hot->base_layer = LAYER_NORMAL;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     hot->manage_phase = MANAGE_DONE;
     hot->server = (rect_t){10, 10, 200, 150};
@@ -137,6 +135,7 @@ static void test_malformed_wm_state_format_ignored(void) {
 
     atoms._NET_WM_STATE = 100;
     atoms._NET_WM_STATE_FULLSCREEN = 101;
+    prop_schema_index_build();
 
     handle_t h = add_mapped_client(&s, 1001, 1101);
     client_hot_t* hot = server_chot(&s, h);
@@ -165,6 +164,7 @@ static void test_unknown_window_type_ignored(void) {
     xcb_stubs_reset();
 
     atoms._NET_WM_WINDOW_TYPE = 200;
+    prop_schema_index_build();
 
     handle_t h = add_mapped_client(&s, 2001, 2101);
     client_hot_t* hot = server_chot(&s, h);
@@ -200,6 +200,7 @@ static void test_strut_partial_invalid_ranges_ignored(void) {
 
     atoms._NET_WORKAREA = 300;
     atoms._NET_WM_STRUT_PARTIAL = 301;
+    prop_schema_index_build();
     s.desktop_count = 1;
 
     handle_t h = add_mapped_client(&s, 3001, 3101);
@@ -243,6 +244,7 @@ static void test_property_spam_no_crash(void) {
 
     atoms._NET_WM_NAME = 400;
     atoms.UTF8_STRING = 401;
+    prop_schema_index_build();
 
     handle_t h = add_mapped_client(&s, 4001, 4101);
     client_hot_t* hot = server_chot(&s, h);
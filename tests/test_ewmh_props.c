@@ -12,6 +12,7 @@
 #include "event.h"
 #include "hxm.h"
 #include "src/wm_internal.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -19,6 +20,7 @@ extern void xcb_stubs_reset(void);
 extern xcb_atom_t stub_last_prop_atom;
 extern uint32_t stub_last_prop_len;
 extern uint8_t stub_last_prop_data[4096];
+extern uint8_t stub_last_prop_mode;
 extern int stub_prop_calls_len;
 extern struct stub_prop_call {
     xcb_window_t window;
@@ -40,6 +42,14 @@ static const struct stub_prop_call* find_prop_call(xcb_window_t win, xcb_atom_t
     return NULL;
 }
 
+static int count_prop_calls(xcb_window_t win, xcb_atom_t atom) {
+    int n = 0;
+    for (int i = 0; i < stub_prop_calls_len; i++) {
+        if (stub_prop_calls[i].window == win && stub_prop_calls[i].atom == atom) n++;
+    }
+    return n;
+}
+
 static void setup_server(server_t* s) {
     memset(s, 0, sizeof(*s));
     s->is_test = true;
@@ -63,8 +73,6 @@ static void setup_server(server_t* s) {
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
     list_init(&s->focus_history);
-
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
 }
 
 static void cleanup_server(server_t* s) {
@@ -84,7 +92,9 @@ static void cleanup_server(server_t* s) {
     small_vec_destroy(&s->active_clients);
     hash_map_destroy(&s->window_to_client);
     hash_map_destroy(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s->layers[i]);
+    wm_prop_cache_destroy(s);
+    free(s->client_list_pub.items);
+    free(s->client_stack_pub.items);
     arena_destroy(&s->tick_arena);
     config_destroy(&s->config);
     xcb_disconnect(s->conn);
@@ -108,7 +118,6 @@ static handle_t add_mapped_client(server_t* s, xcb_window_t win, xcb_window_t fr
     hot->type = WINDOW_TYPE_NORMAL;
     hot->layer = LAYER_NORMAL;
     hot->base_layer = LAYER_NORMAL;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     hot->server = (rect_t){10, 10, 200, 150};
     hot->desired = hot->server;
@@ -189,6 +198,54 @@ static void test_client_list_add_remove(void) {
     cleanup_server(&s);
 }
 
+static void test_client_list_incremental(void) {
+    server_t s;
+    setup_server(&s);
+    xcb_stubs_reset();
+
+    atoms._NET_CLIENT_LIST = 310;
+    atoms._NET_CLIENT_LIST_STACKING = 311;
+
+    handle_t h1 = add_mapped_client(&s, 3001, 3101);
+    handle_t h2 = add_mapped_client(&s, 3002, 3102);
+    stack_raise(&s, h1);
+    stack_raise(&s, h2);
+    s.root_dirty |= ROOT_DIRTY_CLIENT_LIST | ROOT_DIRTY_CLIENT_LIST_STACKING;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(s.root, atoms._NET_CLIENT_LIST) == 1);
+    assert(count_prop_calls(s.root, atoms._NET_CLIENT_LIST_STACKING) == 1);
+
+    // A new window is appended, not republished
+    handle_t h3 = add_mapped_client(&s, 3003, 3103);
+    stack_raise(&s, h3);
+    s.root_dirty |= ROOT_DIRTY_CLIENT_LIST;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    const struct stub_prop_call* list = find_prop_call(s.root, atoms._NET_CLIENT_LIST, false);
+    assert(count_prop_calls(s.root, atoms._NET_CLIENT_LIST) == 2);
+    assert(list->len == 1);
+    assert(((const uint32_t*)list->data)[0] == 3003);
+    assert(stub_last_prop_mode == XCB_PROP_MODE_APPEND);
+
+    // Unchanged lists are not written at all
+    int stacking_writes = count_prop_calls(s.root, atoms._NET_CLIENT_LIST_STACKING);
+    s.root_dirty |= ROOT_DIRTY_CLIENT_LIST | ROOT_DIRTY_CLIENT_LIST_STACKING;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(s.root, atoms._NET_CLIENT_LIST) == 2);
+    assert(count_prop_calls(s.root, atoms._NET_CLIENT_LIST_STACKING) == stacking_writes);
+
+    // A reorder replaces the stacking list
+    stack_raise(&s, h1);
+    s.root_dirty |= ROOT_DIRTY_CLIENT_LIST_STACKING;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    const struct stub_prop_call* stack = find_prop_call(s.root, atoms._NET_CLIENT_LIST_STACKING, false);
+    assert(stub_last_prop_mode == XCB_PROP_MODE_REPLACE);
+    assert(stack->len == 3);
+    assert(((const uint32_t*)stack->data)[2] == 3001);
+
+    printf("test_client_list_incremental passed\n");
+    cleanup_server(&s);
+}
+
 static void test_client_list_filters_skip_and_dock(void) {
     server_t s;
     setup_server(&s);
@@ -199,6 +256,7 @@ static void test_client_list_filters_skip_and_dock(void) {
     atoms._NET_WM_STATE = 322;
     atoms._NET_WM_STATE_SKIP_TASKBAR = 323;
     atoms._NET_WM_STATE_SKIP_PAGER = 324;
+    prop_schema_index_build();
 
     handle_t h1 = add_mapped_client(&s, 7001, 7101);
     handle_t h2 = add_mapped_client(&s, 7002, 7102);
@@ -284,6 +342,7 @@ static void test_strut_updates_workarea(void) {
 
     atoms._NET_WORKAREA = 500;
     atoms._NET_WM_STRUT_PARTIAL = 501;
+    prop_schema_index_build();
     s.desktop_count = 1;
 
     handle_t h = add_mapped_client(&s, 3001, 3101);
@@ -342,6 +401,7 @@ static void test_window_type_dock_layer(void) {
 
     atoms._NET_WM_WINDOW_TYPE = 600;
     atoms._NET_WM_WINDOW_TYPE_DOCK = 601;
+    prop_schema_index_build();
 
     handle_t h = add_mapped_client(&s, 4001, 4101);
     client_hot_t* hot = server_chot(&s, h);
@@ -415,6 +475,7 @@ static void test_urgency_hint_maps_to_ewmh_state(void) {
     atoms.WM_HINTS = 800;
     atoms._NET_WM_STATE = 801;
     atoms._NET_WM_STATE_DEMANDS_ATTENTION = 802;
+    prop_schema_index_build();
 
     handle_t h = add_mapped_client(&s, 6001, 6101);
     client_hot_t* hot = server_chot(&s, h);
@@ -454,14 +515,135 @@ static void test_urgency_hint_maps_to_ewmh_state(void) {
     cleanup_server(&s);
 }
 
+static void test_unchanged_property_writes_skipped(void) {
+    server_t s;
+    setup_server(&s);
+    xcb_stubs_reset();
+
+    atoms._NET_WM_STATE = 900;
+    atoms._NET_WM_ALLOWED_ACTIONS = 901;
+    atoms._NET_ACTIVE_WINDOW = 902;
+    atoms._NET_CURRENT_DESKTOP = 903;
+    atoms._NET_WM_STATE_FOCUSED = 904;
+    prop_schema_index_build();
+
+    handle_t h1 = add_mapped_client(&s, 7001, 7101);
+    handle_t h2 = add_mapped_client(&s, 7002, 7102);
+    client_hot_t* hot1 = server_chot(&s, h1);
+
+    hot1->dirty |= DIRTY_STATE;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(7001, atoms._NET_WM_STATE) == 1);
+    assert(count_prop_calls(7001, atoms._NET_WM_ALLOWED_ACTIONS) == 1);
+
+    // Same bytes again: nothing reaches the server
+    hot1->dirty |= DIRTY_STATE;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(7001, atoms._NET_WM_STATE) == 1);
+    assert(count_prop_calls(7001, atoms._NET_WM_ALLOWED_ACTIONS) == 1);
+
+    // A real change still goes out; the unchanged sibling property does not
+    wm_set_focus(&s, h1);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(7001, atoms._NET_WM_STATE) == 2);
+    assert(count_prop_calls(7001, atoms._NET_WM_ALLOWED_ACTIONS) == 1);
+    assert(count_prop_calls(s.root, atoms._NET_ACTIVE_WINDOW) == 1);
+
+    // Root properties go through the same cache
+    s.root_dirty |= ROOT_DIRTY_ACTIVE_WINDOW | ROOT_DIRTY_CURRENT_DESKTOP;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    s.root_dirty |= ROOT_DIRTY_CURRENT_DESKTOP;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(s.root, atoms._NET_ACTIVE_WINDOW) == 1);
+    assert(count_prop_calls(s.root, atoms._NET_CURRENT_DESKTOP) == 1);
+
+    wm_set_focus(&s, h2);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(s.root, atoms._NET_ACTIVE_WINDOW) == 2);
+
+    // Forgetting a window makes the next write unconditional
+    int before = count_prop_calls(7001, atoms._NET_WM_ALLOWED_ACTIONS);
+    wm_prop_forget(&s, 7001);
+    hot1->dirty |= DIRTY_STATE;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(7001, atoms._NET_WM_ALLOWED_ACTIONS) == before + 1);
+
+    printf("test_unchanged_property_writes_skipped passed\n");
+    cleanup_server(&s);
+}
+
+static void test_client_message_writes_use_cache(void) {
+    server_t s;
+    setup_server(&s);
+    xcb_stubs_reset();
+
+    atoms._NET_WM_DESKTOP = 910;
+    atoms._NET_NUMBER_OF_DESKTOPS = 911;
+    atoms._NET_REQUEST_FRAME_EXTENTS = 912;
+    atoms._NET_FRAME_EXTENTS = 913;
+    prop_schema_index_build();
+
+    handle_t h = add_mapped_client(&s, 7201, 7301);
+    client_hot_t* hot = server_chot(&s, h);
+    hot->desktop = 2;
+    hot->dirty |= DIRTY_DESKTOP;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(7201, atoms._NET_WM_DESKTOP) == 1);
+
+    xcb_client_message_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CLIENT_MESSAGE;
+    ev.format = 32;
+    ev.window = s.root;
+    ev.type = atoms._NET_NUMBER_OF_DESKTOPS;
+
+    // Dropping desktop 2 moves the client to desktop 0
+    ev.data.data32[0] = 2;
+    wm_handle_client_message(&s, &ev);
+    assert(hot->desktop == 0);
+    const struct stub_prop_call* call = find_prop_call(7201, atoms._NET_WM_DESKTOP, false);
+    assert(call && *(const uint32_t*)call->data == 0);
+    int before = count_prop_calls(7201, atoms._NET_WM_DESKTOP);
+
+    // Going back to desktop 2 must not be mistaken for an unchanged value
+    ev.data.data32[0] = 3;
+    wm_handle_client_message(&s, &ev);
+    hot->desktop = 2;
+    hot->dirty |= DIRTY_DESKTOP;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(count_prop_calls(7201, atoms._NET_WM_DESKTOP) == before + 1);
+    call = find_prop_call(7201, atoms._NET_WM_DESKTOP, false);
+    assert(*(const uint32_t*)call->data == 2);
+
+    // A client drawing its own frame (_GTK_FRAME_EXTENTS) is told about zero extents
+    hot->gtk_frame_extents_set = true;
+    ev.window = hot->xid;
+    ev.type = atoms._NET_REQUEST_FRAME_EXTENTS;
+    wm_handle_client_message(&s, &ev);
+    call = find_prop_call(7201, atoms._NET_FRAME_EXTENTS, false);
+    assert(call && call->len == 4);
+    static const uint32_t zeros[4] = {0};
+    assert(memcmp(call->data, zeros, sizeof(zeros)) == 0);
+
+    // ...and a repeated request is answered from the cache
+    wm_handle_client_message(&s, &ev);
+    assert(count_prop_calls(7201, atoms._NET_FRAME_EXTENTS) == 1);
+
+    printf("test_client_message_writes_use_cache passed\n");
+    cleanup_server(&s);
+}
+
 int main(void) {
     test_active_window_updates();
     test_client_list_add_remove();
+    test_client_list_incremental();
     test_client_list_filters_skip_and_dock();
     test_desktop_props_publish_and_switch();
     test_strut_updates_workarea();
     test_window_type_dock_layer();
     test_state_idempotent_and_unknown();
     test_urgency_hint_maps_to_ewmh_state();
+    test_unchanged_property_writes_skipped();
+    test_client_message_writes_use_cache();
     return 0;
 }
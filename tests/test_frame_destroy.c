@@ -58,9 +58,6 @@ static void server_init_for_test(server_t* s) {
 
     // Init list heads
     list_init(&s->focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) {
-        small_vec_init(&s->layers[i]);
-    }
 
     // Init slotmap
     if (!slotmap_init(&s->clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) {
@@ -109,7 +106,6 @@ static handle_t test_create_managed_client(server_t* s, xcb_window_t client_xid,
     hot->server.h = 200;
 
     // Init list nodes
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transient_sibling);
     list_init(&hot->transients_head);
@@ -235,11 +235,60 @@ static void test_frame_buttons_present(void) {
     printf("PASS: Buttons present\n");
 }
 
+static void test_frame_title_redraw_skipped_when_unchanged(void) {
+    printf("Testing title-only redraw skip...\n");
+    setup();
+
+    cold->title = "Terminal";
+    hot->dirty = DIRTY_FRAME_ALL;
+    s.in_commit_phase = true;
+    frame_flush(&s, h);
+    assert(stub_last_image_w > 0);
+
+    // Same visible text: nothing is painted
+    stub_last_image_w = 0;
+    hot->dirty = DIRTY_FRAME_TITLE;
+    frame_flush(&s, h);
+    assert(stub_last_image_w == 0);
+    assert(!(hot->dirty & DIRTY_FRAME_TITLE));
+
+    // Different text is painted
+    cold->title = "Terminal 2";
+    hot->dirty = DIRTY_FRAME_TITLE;
+    frame_flush(&s, h);
+    assert(stub_last_image_w > 0);
+
+    // A wider frame changes the text box, so the title is painted again
+    stub_last_image_w = 0;
+    hot->server.w = 300;
+    hot->dirty = DIRTY_FRAME_TITLE;
+    frame_flush(&s, h);
+    assert(stub_last_image_w > 0);
+
+    // Long titles that differ only past the ellipsis look the same on screen
+    hot->server.w = 120;
+    cold->title = "progress: building the project, step 0001 of 9999 (please wait)";
+    hot->dirty = DIRTY_FRAME_ALL;
+    frame_flush(&s, h);
+    if (pango_layout_is_ellipsized(hot->render_ctx.layout)) {
+        stub_last_image_w = 0;
+        cold->title = "progress: building the project, step 0001 of 9999 (please wait!)";
+        hot->dirty = DIRTY_FRAME_TITLE;
+        frame_flush(&s, h);
+        assert(stub_last_image_w == 0);
+    }
+
+    s.in_commit_phase = false;
+    teardown();
+    printf("PASS: Title-only redraw skip\n");
+}
+
 int main(void) {
     test_frame_render_no_icon();
     test_frame_render_active_color();
     test_frame_controls_position();
     test_frame_title_background_color();
     test_frame_buttons_present();
+    test_frame_title_redraw_skipped_when_unchanged();
     return 0;
 }
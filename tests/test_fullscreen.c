@@ -8,6 +8,7 @@
 #include "config.h"
 #include "event.h"
 #include "hxm.h"
+#include "prop_schema.h"
 #include "slotmap.h"
 #include "wm.h"
 #include "xcb_utils.h"
@@ -17,6 +18,7 @@ extern int stub_unmap_window_count;
 extern xcb_atom_t stub_last_prop_atom;
 extern uint32_t stub_last_prop_len;
 extern uint8_t stub_last_prop_data[1024];
+extern xcb_window_t stub_last_prop_window;
 
 static void setup_server(server_t* s) {
     memset(s, 0, sizeof(*s));
@@ -31,7 +33,6 @@ static void setup_server(server_t* s) {
     s->config.fullscreen_use_workarea = false;
     s->workarea = (rect_t){0, 0, 800, 600};
     list_init(&s->focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
     slotmap_init(&s->clients, 16, sizeof(client_hot_t), sizeof(client_cold_t));
@@ -52,7 +53,6 @@ static void cleanup_server(server_t* s) {
     slotmap_destroy(&s->clients);
     hash_map_destroy(&s->window_to_client);
     hash_map_destroy(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s->layers[i]);
     config_destroy(&s->config);
     free(s->conn);
 }
@@ -181,6 +181,7 @@ void test_hidden_state_iconify_restore(void) {
 
     atoms._NET_WM_STATE_HIDDEN = 120;
     atoms.WM_STATE = 121;
+    prop_schema_index_build();
 
     handle_t h = add_client(&s);
     client_hot_t* hot = server_chot(&s, h);
@@ -210,10 +211,68 @@ void test_hidden_state_iconify_restore(void) {
     cleanup_server(&s);
 }
 
+void test_fullscreen_bypass_compositor(void) {
+    server_t s;
+    setup_server(&s);
+
+    atoms._NET_WM_STATE_FULLSCREEN = 102;
+    atoms._NET_WM_BYPASS_COMPOSITOR = 103;
+    prop_schema_index_build();
+
+    handle_t h = add_client(&s);
+    client_hot_t* hot = server_chot(&s, h);
+
+    // The client's hint is mirrored onto the frame, which compositors see as the toplevel
+    hot->bypass_compositor = 1;
+    stub_last_prop_atom = 0;
+    frame_sync_bypass(&s, hot);
+    assert(stub_last_prop_atom == atoms._NET_WM_BYPASS_COMPOSITOR);
+    assert(stub_last_prop_window == hot->frame);
+    assert(stub_last_prop_len == 1 && ((uint32_t*)stub_last_prop_data)[0] == 1);
+    assert(!hot->frame_bare);
+
+    // Unchanged: nothing is sent
+    stub_last_prop_atom = 0;
+    frame_sync_bypass(&s, hot);
+    assert(stub_last_prop_atom == 0);
+
+    wm_client_update_state(&s, h, 1, atoms._NET_WM_STATE_FULLSCREEN);
+    frame_sync_bypass(&s, hot);
+    assert(hot->frame_bare);
+
+    // A rule override wins over the client
+    hot->bypass_rule = 2;
+    frame_sync_bypass(&s, hot);
+    assert(stub_last_prop_atom == atoms._NET_WM_BYPASS_COMPOSITOR);
+    assert(((uint32_t*)stub_last_prop_data)[0] == 2);
+
+    wm_client_update_state(&s, h, 0, atoms._NET_WM_STATE_FULLSCREEN);
+    frame_sync_bypass(&s, hot);
+    assert(!hot->frame_bare);
+
+    // A frameless client's toplevel is its own window: its property is never touched
+    handle_t h2 = add_client(&s);
+    client_hot_t* bare = server_chot(&s, h2);
+    bare->flags |= CLIENT_FLAG_FRAMELESS;
+    bare->frame = bare->xid;
+    bare->bypass_rule = 1;
+    stub_last_prop_atom = 0;
+    frame_sync_bypass(&s, bare);
+    bare->bypass_rule = 0;
+    frame_sync_bypass(&s, bare);
+    assert(stub_last_prop_atom == 0);
+    assert(bare->bypass_published == 0);
+
+    printf("test_fullscreen_bypass_compositor passed\n");
+
+    cleanup_server(&s);
+}
+
 int main(void) {
     test_fullscreen_decorations();
     test_fullscreen_restores_flags_and_layer();
     test_above_below_state_layers();
     test_hidden_state_iconify_restore();
+    test_fullscreen_bypass_compositor();
     return 0;
 }
@@ -6,6 +6,7 @@
 #include "client.h"
 #include "cookie_jar.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -31,6 +32,7 @@ static void cleanup_server(server_t* s) {
 void test_gtk_extents_toggle_decorations(void) {
     atoms._GTK_FRAME_EXTENTS = 100;
     atoms._NET_FRAME_EXTENTS = 200;
+    prop_schema_index_build();
 
     server_t s;
     memset(&s, 0, sizeof(s));
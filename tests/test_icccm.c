@@ -10,6 +10,7 @@
 #include "config.h"
 #include "cookie_jar.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -54,6 +55,7 @@ void test_icccm_protocols(void) {
     atoms.WM_PROTOCOLS = 10;
     atoms.WM_DELETE_WINDOW = 11;
     atoms.WM_TAKE_FOCUS = 12;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -113,6 +115,7 @@ void test_client_close(void) {
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_PROTOCOLS = 10;
     atoms.WM_DELETE_WINDOW = 11;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -176,6 +179,7 @@ void test_wm_take_focus_on_focus(void) {
 
     atoms.WM_PROTOCOLS = 20;
     atoms.WM_TAKE_FOCUS = 21;
+    prop_schema_index_build();
 
     list_init(&s.focus_history);
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
@@ -244,11 +248,11 @@ void test_wm_state_manage_unmanage(void) {
     s.conn = (xcb_connection_t*)malloc(1);
     config_init_defaults(&s.config);
     list_init(&s.focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
     hash_map_init(&s.window_to_client);
     hash_map_init(&s.frame_to_client);
 
     atoms.WM_STATE = 30;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -293,7 +297,6 @@ void test_wm_state_manage_unmanage(void) {
 
     printf("test_wm_state_manage_unmanage passed\n");
     config_destroy(&s.config);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s.layers[i]);
     hash_map_destroy(&s.window_to_client);
     hash_map_destroy(&s.frame_to_client);
     slotmap_destroy(&s.clients);
@@ -310,6 +313,7 @@ void test_name_fallback(void) {
     atoms.WM_NAME = 1;
     atoms._NET_WM_NAME = 2;
     atoms.UTF8_STRING = 3;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -8,6 +8,7 @@
 #include "config.h"
 #include "cookie_jar.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -39,7 +40,6 @@ static void setup_server(server_t* s) {
     config_init_defaults(&s->config);
 
     list_init(&s->focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
 
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
@@ -113,6 +113,7 @@ static void test_wm_normal_hints_malformed_short(void) {
     xcb_stubs_reset();
 
     atoms.WM_NORMAL_HINTS = 10;
+    prop_schema_index_build();
 
     void *hot_ptr = NULL, *cold_ptr = NULL;
     handle_t h = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
@@ -159,6 +160,7 @@ static void test_wm_normal_hints_malformed_long(void) {
     xcb_stubs_reset();
 
     atoms.WM_NORMAL_HINTS = 11;
+    prop_schema_index_build();
 
     void *hot_ptr = NULL, *cold_ptr = NULL;
     handle_t h = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
@@ -208,6 +210,7 @@ static void test_wm_name_huge_bounded(void) {
     xcb_stubs_reset();
 
     atoms.WM_NAME = 12;
+    prop_schema_index_build();
 
     void *hot_ptr = NULL, *cold_ptr = NULL;
     handle_t h = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
@@ -287,6 +290,7 @@ static void test_map_unmap_property_race(void) {
     atoms.WM_STATE = 21;
     atoms._NET_WM_STATE = 22;
     atoms._NET_WM_DESKTOP = 23;
+    prop_schema_index_build();
 
     void *hot_ptr = NULL, *cold_ptr = NULL;
     handle_t h = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
@@ -7,6 +7,7 @@
 #include "client.h"
 #include "cookie_jar.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -73,6 +74,7 @@ static void test_wm_icon_name_fallback(void) {
     atoms._NET_WM_ICON_NAME = 10;
     atoms.WM_ICON_NAME = 11;
     atoms.UTF8_STRING = 12;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -129,6 +131,7 @@ static void test_wm_class_invalid_no_nul(void) {
     s.root_visual_type = xcb_get_visualtype(NULL, 0);
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_CLASS = 3;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -173,6 +176,7 @@ static void test_wm_client_machine_large(void) {
     s.root_visual_type = xcb_get_visualtype(NULL, 0);
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_CLIENT_MACHINE = 4;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -217,6 +221,7 @@ static void test_wm_command_first_token(void) {
     s.root_visual_type = xcb_get_visualtype(NULL, 0);
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_COMMAND = 5;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -255,6 +260,7 @@ static void test_wm_hints_input_affects_focus(void) {
     s.root_visual_type = xcb_get_visualtype(NULL, 0);
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_HINTS = 6;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
     list_init(&s.focus_history);
@@ -327,6 +333,7 @@ static void test_wm_hints_icon_safe(void) {
     s.root_visual_type = xcb_get_visualtype(NULL, 0);
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_HINTS = 7;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -381,6 +388,7 @@ static void test_property_deletions_reset_defaults(void) {
     atoms.WM_TAKE_FOCUS = 12;
     atoms.WM_TRANSIENT_FOR = 13;
     atoms.WM_NAME = 14;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
     hash_map_init(&s.window_to_client);
@@ -38,7 +38,6 @@ static void setup_server(server_t* s) {
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
     list_init(&s->focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
 
     s->desktop_count = 2;
     s->current_desktop = 0;
@@ -63,10 +62,16 @@ static void cleanup_server(server_t* s) {
     slotmap_destroy(&s->clients);
     hash_map_destroy(&s->window_to_client);
     hash_map_destroy(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s->layers[i]);
+    free(s->key_table.slots);
     xcb_disconnect(s->conn);
 }
 
+// Keycode 9 is Escape, as on a stock keymap
+static void seed_keymap(server_t* s) {
+    s->keymap.base[9] = XK_Escape;
+    s->keymap.valid = true;
+}
+
 static void reset_keybindings(config_t* config) {
     for (size_t i = 0; i < config->key_bindings.length; i++) {
         key_binding_t* b = config->key_bindings.items[i];
@@ -306,7 +311,8 @@ static void test_keybinding_clean_mods(void) {
     ev.detail = 9;
     ev.state = XCB_MOD_MASK_1 | XCB_MOD_MASK_LOCK | XCB_MOD_MASK_2;
 
-    s.keysyms = xcb_key_symbols_alloc(s.conn);
+    seed_keymap(&s);
+    wm_setup_keys(&s);
     wm_handle_key_press(&s, &ev);
 
     assert(g_restart_pending == 1);
@@ -342,7 +348,8 @@ static void test_keybinding_conflict_deterministic(void) {
     ev.detail = 9;
     ev.state = 0;
 
-    s.keysyms = xcb_key_symbols_alloc(s.conn);
+    seed_keymap(&s);
+    wm_setup_keys(&s);
     wm_handle_key_press(&s, &ev);
 
     assert(g_restart_pending == 1);
@@ -365,12 +372,26 @@ static void test_key_grabs_from_config(void) {
     reset_keybindings(&s.config);
     small_vec_push(&s.config.key_bindings, b);
 
+    seed_keymap(&s);
     wm_setup_keys(&s);
 
-    assert(stub_ungrab_key_count >= 1);
-    assert(stub_grab_key_count >= 1);
+    // One (keycode, mods) pair, grabbed under all 8 lock combinations
+    assert(stub_ungrab_key_count == 0);
+    assert(stub_grab_key_count == 8);
     assert(wm_clean_mods(stub_last_grab_key_mods) == XCB_MOD_MASK_1);
-    assert(stub_last_grab_keycode != 0);
+    assert(stub_last_grab_keycode == 9);
+
+    // Reload with the same bindings: nothing goes on the wire
+    wm_setup_keys(&s);
+    assert(stub_ungrab_key_count == 0);
+    assert(stub_grab_key_count == 8);
+
+    // Rebinding only swaps the changed pair
+    b->modifiers = XCB_MOD_MASK_4;
+    wm_setup_keys(&s);
+    assert(stub_ungrab_key_count == 8);
+    assert(stub_grab_key_count == 16);
+    assert(wm_clean_mods(stub_last_grab_key_mods) == XCB_MOD_MASK_4);
 
     printf("test_key_grabs_from_config passed\n");
     if (s.keysyms) {
@@ -380,6 +401,110 @@ static void test_key_grabs_from_config(void) {
     cleanup_server(&s);
 }
 
+extern int (*stub_poll_for_reply_hook)(xcb_connection_t* c, unsigned int request, void** reply,
+                                       xcb_generic_error_t** error);
+
+// GetKeyboardMapping for keycodes 8..255, two keysyms each; keycode 9 is Escape
+static int keymap_poll(xcb_connection_t* c, unsigned int request, void** reply, xcb_generic_error_t** error) {
+    (void)c;
+    (void)request;
+    (void)error;
+    size_t count = 248;
+    xcb_get_keyboard_mapping_reply_t* r = calloc(1, sizeof(*r) + count * 2 * sizeof(xcb_keysym_t));
+    r->keysyms_per_keycode = 2;
+    r->length = (uint32_t)(count * 2);
+    xcb_keysym_t* syms = (xcb_keysym_t*)(r + 1);
+    syms[(9 - 8) * 2] = XK_Escape;
+    syms[(9 - 8) * 2 + 1] = XK_Tab;
+    *reply = r;
+    return 1;
+}
+
+static void test_keymap_refresh_async(void) {
+    server_t s;
+    setup_server(&s);
+    xcb_stubs_reset();
+    cookie_jar_init(&s.cookie_jar);
+
+    key_binding_t* b = calloc(1, sizeof(*b));
+    b->keysym = XK_Escape;
+    b->modifiers = XCB_MOD_MASK_1;
+    b->action = ACTION_RESTART;
+    reset_keybindings(&s.config);
+    small_vec_push(&s.config.key_bindings, b);
+
+    // No keymap yet: the request is queued and nothing is grabbed until it lands
+    wm_setup_keys(&s);
+    assert(!s.keymap.valid);
+    assert(stub_grab_key_count == 0);
+
+    // A MappingNotify burst before the reply supersedes the first request
+    wm_refresh_keymap(&s);
+    assert(s.cookie_jar.live_count == 2);
+
+    stub_poll_for_reply_hook = keymap_poll;
+    cookie_jar_drain(&s.cookie_jar, s.conn, &s, 16);
+    stub_poll_for_reply_hook = NULL;
+
+    assert(s.cookie_jar.live_count == 0);
+    assert(s.keymap.valid);
+    assert(s.keymap.base[9] == XK_Escape);
+    assert(stub_grab_key_count == 8);
+    assert(stub_last_grab_keycode == 9);
+
+    g_restart_pending = 0;
+    xcb_key_press_event_t ev = {0};
+    ev.detail = 9;
+    ev.state = XCB_MOD_MASK_1;
+    wm_handle_key_press(&s, &ev);
+    assert(g_restart_pending == 1);
+
+    printf("test_keymap_refresh_async passed\n");
+    xcb_key_symbols_free(s.keysyms);
+    cookie_jar_destroy(&s.cookie_jar);
+    cleanup_server(&s);
+}
+
+static void test_keyboard_move_queries_pointer(void) {
+    server_t s;
+    setup_server(&s);
+    xcb_stubs_reset();
+    cookie_jar_init(&s.cookie_jar);
+
+    key_binding_t* b = calloc(1, sizeof(*b));
+    b->keysym = XK_Escape;
+    b->modifiers = XCB_MOD_MASK_1;
+    b->action = ACTION_MOVE;
+    reset_keybindings(&s.config);
+    small_vec_push(&s.config.key_bindings, b);
+    seed_keymap(&s);
+    wm_setup_keys(&s);
+
+    handle_t h = add_mapped_client(&s, 100, 200);
+    s.focused_client = h;
+
+    // The cache lags behind motion inside clients: the move origin is asked for instead
+    s.pointer = (pointer_cache_t){.x = 5, .y = 5, .valid = true};
+    xcb_key_press_event_t ev = {0};
+    ev.detail = 9;
+    ev.state = XCB_MOD_MASK_1;
+    wm_handle_key_press(&s, &ev);
+
+    assert(s.interaction_mode == INTERACTION_NONE);
+    assert(s.cookie_jar.live_count == 1);
+    bool queried = false;
+    for (size_t i = 0; i < s.cookie_jar.cap; i++) {
+        const cookie_slot_t* slot = &s.cookie_jar.slots[i];
+        if (slot->live && slot->type == COOKIE_QUERY_POINTER && slot->client == h) queried = true;
+    }
+    assert(queried);
+
+    printf("test_keyboard_move_queries_pointer passed\n");
+    xcb_key_symbols_free(s.keysyms);
+    cookie_jar_destroy(&s.cookie_jar);
+    cleanup_server(&s);
+}
+
 int main(void) {
     test_click_to_focus();
     test_move_interaction();
@@ -390,5 +515,7 @@ int main(void) {
     test_keybinding_clean_mods();
     test_keybinding_conflict_deterministic();
     test_key_grabs_from_config();
+    test_keymap_refresh_async();
+    test_keyboard_move_queries_pointer();
     return 0;
 }
@@ -0,0 +1,98 @@
+#include <assert.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "event.h"
+#include "hxm.h"
+#include "launcher.h"
+
+static bool wait_for_file(const char* path) {
+    for (int i = 0; i < 200; i++) {
+        struct stat st;
+        if (stat(path, &st) == 0) return true;
+        usleep(10000);
+    }
+    return false;
+}
+
+static void wait_for_replies(server_t* s) {
+    for (int i = 0; i < 200 && s->launcher.fd > 0 && s->launcher.inflight > 0; i++) {
+        struct pollfd pfd = {s->launcher.fd, POLLIN, 0};
+        if (poll(&pfd, 1, 10) > 0) launcher_handle_replies(s);
+    }
+}
+
+static void test_spawn_through_launcher(void) {
+    server_t s;
+    memset(&s, 0, sizeof(s));
+    counters_init();
+
+    launcher_start(&s.launcher);
+    assert(s.launcher.fd > 0);
+    assert(s.launcher.pid > 0);
+
+    char path[] = "/tmp/hxm_test_launcher_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    unlink(path);
+
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "touch %s", path);
+    launcher_spawn(&s, cmd);
+    assert(s.launcher.inflight == 1);
+    assert(counters.spawn_fallbacks == 0);
+
+    wait_for_replies(&s);
+    assert(s.launcher.inflight == 0);
+    assert(counters.spawn_requests == 1);
+    assert(counters.spawn_latency_count == 1);
+    assert(counters.spawn_failures == 0);
+    assert(wait_for_file(path));
+    unlink(path);
+
+    // Direct exec of a missing program is reported back as a failure
+    launcher_run(&s, LAUNCH_EXEC, "/nonexistent/hxm-autostart");
+    wait_for_replies(&s);
+    assert(counters.spawn_failures == 1);
+
+    // The helper exits once the WM end closes
+    pid_t helper = s.launcher.pid;
+    launcher_stop(&s.launcher);
+    assert(waitpid(helper, NULL, 0) == helper);
+
+    printf("test_spawn_through_launcher passed\n");
+}
+
+static void test_fallback_without_launcher(void) {
+    server_t s;
+    memset(&s, 0, sizeof(s));
+    counters_init();
+
+    char path[] = "/tmp/hxm_test_launcher_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    unlink(path);
+
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "touch %s", path);
+    launcher_spawn(&s, cmd);
+    assert(counters.spawn_fallbacks == 1);
+    assert(counters.spawn_latency_count == 1);
+    assert(wait_for_file(path));
+    unlink(path);
+
+    printf("test_fallback_without_launcher passed\n");
+}
+
+int main(void) {
+    test_spawn_through_launcher();
+    test_fallback_without_launcher();
+    return 0;
+}
@@ -22,6 +22,7 @@ extern xcb_window_t stub_mapped_windows[256];
 extern bool xcb_stubs_enqueue_event(xcb_generic_event_t* ev);
 extern int stub_destroy_window_count;
 extern xcb_window_t stub_last_destroyed_window;
+extern int stub_unmap_window_count;
 
 static void setup_server(server_t* s) {
     memset(s, 0, sizeof(*s));
@@ -45,10 +46,6 @@ static void setup_server(server_t* s) {
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
     list_init(&s->focus_history);
-
-    for (int i = 0; i < LAYER_COUNT; i++) {
-        small_vec_init(&s->layers[i]);
-    }
 }
 
 static void cleanup_server(server_t* s) {
@@ -350,6 +347,162 @@ static void test_destroy_notify_unmanages_and_destroys_frame(void) {
     cleanup_server(&s);
 }
 
+static void test_frameless_manage_skips_frame(void) {
+    server_t s;
+    setup_server(&s);
+    s.config.frameless_undecorated = true;
+
+    void *hot_ptr = NULL, *cold_ptr = NULL;
+    handle_t h = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
+    client_hot_t* hot = (client_hot_t*)hot_ptr;
+    client_cold_t* cold = (client_cold_t*)cold_ptr;
+
+    render_init(&hot->render_ctx);
+    arena_init(&cold->string_arena, 512);
+
+    hot->self = h;
+    hot->xid = 7001;
+    hot->state = STATE_NEW;
+    hot->type = WINDOW_TYPE_SPLASH;
+    hot->flags = CLIENT_FLAG_UNDECORATED;
+    hot->focus_override = -1;
+    hot->transient_for = HANDLE_INVALID;
+    hot->desired = (rect_t){10, 20, 100, 80};
+    hot->visual_id = s.root_visual;
+    hot->depth = s.root_depth;
+    hot->layer = LAYER_NORMAL;
+    hot->base_layer = LAYER_NORMAL;
+    list_init(&hot->focus_node);
+    list_init(&hot->transients_head);
+    list_init(&hot->transient_sibling);
+
+    hash_map_insert(&s.window_to_client, hot->xid, handle_to_ptr(h));
+
+    stub_mapped_windows_len = 0;
+    client_finish_manage(&s, h);
+
+    // The client window is its own frame: mapped once, never registered as a frame
+    assert(client_is_frameless(hot));
+    assert(hot->frame == hot->xid);
+    assert(hot->ignore_unmap == 0);
+    assert(stub_mapped_windows_len == 1);
+    assert(stub_mapped_windows[0] == hot->xid);
+    assert(server_get_client_by_frame(&s, hot->xid) == HANDLE_INVALID);
+
+    // Hiding it expects both the client's and the root's UnmapNotify
+    wm_client_iconify(&s, h);
+    assert(hot->state == STATE_UNMAPPED);
+    assert(hot->ignore_unmap == 2);
+
+    xcb_unmap_notify_event_t unmap;
+    memset(&unmap, 0, sizeof(unmap));
+    unmap.window = hot->xid;
+    unmap.event = hot->xid;
+    wm_handle_unmap_notify(&s, &unmap);
+    unmap.event = s.root;
+    wm_handle_unmap_notify(&s, &unmap);
+    assert(server_get_client_by_window(&s, 7001) == h);
+
+    stub_destroy_window_count = 0;
+    xcb_destroy_notify_event_t destroy;
+    memset(&destroy, 0, sizeof(destroy));
+    destroy.window = 7001;
+    destroy.event = s.root;
+    wm_handle_destroy_notify(&s, &destroy);
+
+    assert(server_get_client_by_window(&s, 7001) == HANDLE_INVALID);
+    assert(stub_destroy_window_count == 0);
+
+    printf("test_frameless_manage_skips_frame passed\n");
+    cleanup_server(&s);
+}
+
+static int frame_pool_sync_poll_for_reply(xcb_connection_t* c, unsigned int request, void** reply,
+                                          xcb_generic_error_t** error) {
+    (void)c;
+    (void)request;
+    if (error) *error = NULL;
+    if (reply) *reply = calloc(1, sizeof(xcb_get_input_focus_reply_t));
+    return 1;
+}
+
+static void test_unmanage_recycles_frame_after_sync(void) {
+    server_t s;
+    setup_server(&s);
+    frame_pool_init(&s);
+    assert(s.frame_pool.len == FRAME_POOL_PREFILL);
+    s.txn_id = 1;
+
+    void *hot_ptr = NULL, *cold_ptr = NULL;
+    handle_t h = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
+    client_hot_t* hot = (client_hot_t*)hot_ptr;
+    client_cold_t* cold = (client_cold_t*)cold_ptr;
+
+    render_init(&hot->render_ctx);
+    arena_init(&cold->string_arena, 512);
+
+    hot->self = h;
+    hot->xid = 6001;
+    hot->state = STATE_NEW;
+    hot->type = WINDOW_TYPE_NORMAL;
+    hot->focus_override = -1;
+    hot->transient_for = HANDLE_INVALID;
+    hot->desired = (rect_t){0, 0, 100, 80};
+    hot->visual_id = s.root_visual;
+    hot->depth = s.root_depth;
+    hot->layer = LAYER_NORMAL;
+    hot->base_layer = LAYER_NORMAL;
+    list_init(&hot->focus_node);
+    list_init(&hot->transients_head);
+    list_init(&hot->transient_sibling);
+
+    hash_map_insert(&s.window_to_client, hot->xid, handle_to_ptr(h));
+
+    // Prefilled frames are handed out without creating a window
+    uint64_t created = counters.frames_created;
+    client_finish_manage(&s, h);
+    xcb_window_t frame = hot->frame;
+    assert(frame != XCB_NONE);
+    assert(counters.frames_created == created);
+    assert(s.frame_pool.len == FRAME_POOL_PREFILL - 1);
+
+    stub_destroy_window_count = 0;
+    stub_unmap_window_count = 0;
+
+    xcb_destroy_notify_event_t destroy;
+    memset(&destroy, 0, sizeof(destroy));
+    destroy.window = hot->xid;
+    destroy.event = s.root;
+    wm_handle_destroy_notify(&s, &destroy);
+
+    assert(server_get_client_by_window(&s, 6001) == HANDLE_INVALID);
+    assert(stub_destroy_window_count == 0);
+    assert(stub_unmap_window_count == 1);
+    assert(s.frame_pool.len == FRAME_POOL_PREFILL);
+
+    // Quarantined until the round trip returns and another tick has passed
+    render_context_t ctx;
+    render_init(&ctx);
+    xcb_window_t other = frame_acquire(&s, &ctx, 0, 0, 10, 10);
+    assert(other != frame);
+    render_free(&ctx);
+
+    stub_poll_for_reply_hook = frame_pool_sync_poll_for_reply;
+    cookie_jar_drain(&s.cookie_jar, s.conn, &s, 16);
+    render_init(&ctx);
+    assert(frame_acquire(&s, &ctx, 0, 0, 10, 10) != frame);
+    render_free(&ctx);
+
+    s.txn_id += 2;
+    render_init(&ctx);
+    assert(frame_acquire(&s, &ctx, 0, 0, 10, 10) == frame);
+    render_free(&ctx);
+
+    printf("test_unmanage_recycles_frame_after_sync passed\n");
+    frame_pool_destroy(&s);
+    cleanup_server(&s);
+}
+
 static void test_iconify_ignores_unmap_notify_send_event(void) {
     server_t s;
     setup_server(&s);
@@ -371,7 +524,6 @@ static void test_iconify_ignores_unmap_notify_send_event(void) {
     hot->layer = LAYER_NORMAL;
     hot->base_layer = LAYER_NORMAL;
     hot->stacking_layer = -1;
-    hot->stacking_index = -1;
     list_init(&hot->focus_node);
     list_init(&hot->transients_head);
     list_init(&hot->transient_sibling);
@@ -508,6 +660,8 @@ int main(void) {
     test_finish_manage_maps_client_then_frame();
     test_unmap_destroy_unmanages();
     test_destroy_notify_unmanages_and_destroys_frame();
+    test_unmanage_recycles_frame_after_sync();
+    test_frameless_manage_skips_frame();
     test_iconify_ignores_unmap_notify_send_event();
     test_reparent_notify_ignored();
 
@@ -1,3 +1,4 @@
+#include <X11/keysym.h>
 #include <assert.h>
 #include <fontconfig/fontconfig.h>
 #include <pango/pangocairo.h>
@@ -79,6 +80,7 @@ void test_menu_basics(void) {
     }
     slotmap_destroy(&s.clients);
     xcb_key_symbols_free(s.keysyms);
+    free(s.key_table.slots);
     xcb_disconnect(s.conn);
 
     pango_cairo_font_map_set_default(NULL);
@@ -102,6 +104,10 @@ void test_menu_esc(void) {
 
     // Let's check xcb_stubs.c's xcb_key_symbols_get_keysym.
 
+    // Presses resolve through the compiled key table
+    s.keymap.base[9] = XK_Escape;
+    s.keymap.valid = true;
+    wm_setup_keys(&s);
     wm_handle_key_press(&s, &ev);
     assert(s.menu.visible == false);
 
@@ -120,6 +126,7 @@ void test_menu_esc(void) {
     }
     slotmap_destroy(&s.clients);
     xcb_key_symbols_free(s.keysyms);
+    free(s.key_table.slots);
     xcb_disconnect(s.conn);
 
     pango_cairo_font_map_set_default(NULL);
@@ -5,6 +5,7 @@
 
 #include "client.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -27,6 +28,7 @@ void test_net_close_window(void) {
     atoms._NET_CLOSE_WINDOW = 100;
     atoms.WM_PROTOCOLS = 10;
     atoms.WM_DELETE_WINDOW = 11;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -103,9 +103,104 @@ static void test_position_clamped_without_hint(void) {
     cleanup_server(&s);
 }
 
+static void test_mouse_placement_uses_pointer_cache(void) {
+    server_t s;
+    setup_server(&s);
+    s.pointer = (pointer_cache_t){.x = 400, .y = 300, .valid = true};
+
+    handle_t h = add_client(&s, 0, 0, 120, 80);
+    client_hot_t* hot = server_chot(&s, h);
+    hot->placement = PLACEMENT_MOUSE;
+
+    // Centered on the cached pointer (the QueryPointer stub would return nothing)
+    wm_place_window(&s, h);
+    assert(hot->desired.x == 340);
+    assert(hot->desired.y == 260);
+
+    printf("test_mouse_placement_uses_pointer_cache passed\n");
+    cleanup_server(&s);
+}
+
+static void test_smart_placement_avoids_overlap(void) {
+    server_t s;
+    setup_server(&s);
+    s.screen_w = 800;
+    s.screen_h = 600;
+    s.config.placement = PLACEMENT_SMART;
+
+    handle_t a = add_client(&s, 0, 0, 400, 300);
+    server_chot(&s, a)->state = STATE_MAPPED;
+    wm_place_index_update(&s, a);
+
+    // Requested spot is taken: first free spot scanning top-left to bottom-right
+    handle_t h = add_client(&s, 0, 0, 400, 300);
+    client_hot_t* hot = server_chot(&s, h);
+    wm_place_window(&s, h);
+    assert(hot->desired.x == 400 && hot->desired.y == 0);
+
+    hot->server = hot->desired;
+    hot->state = STATE_MAPPED;
+    wm_place_index_update(&s, h);
+
+    handle_t h2 = add_client(&s, 0, 0, 400, 300);
+    client_hot_t* hot2 = server_chot(&s, h2);
+    wm_place_window(&s, h2);
+    assert(hot2->desired.x == 0 && hot2->desired.y == 300);
+
+    // A free requested position is kept
+    handle_t h3 = add_client(&s, 400, 300, 200, 200);
+    client_hot_t* hot3 = server_chot(&s, h3);
+    wm_place_window(&s, h3);
+    assert(hot3->desired.x == 400 && hot3->desired.y == 300);
+
+    // Windows on other desktops do not count
+    server_chot(&s, a)->desktop = 1;
+    handle_t h4 = add_client(&s, 0, 0, 400, 300);
+    client_hot_t* hot4 = server_chot(&s, h4);
+    wm_place_window(&s, h4);
+    assert(hot4->desired.x == 0 && hot4->desired.y == 0);
+
+    printf("test_smart_placement_avoids_overlap passed\n");
+    wm_place_index_destroy(&s);
+    cleanup_server(&s);
+}
+
+static void test_smart_placement_follows_focused_monitor(void) {
+    server_t s;
+    setup_server(&s);
+    s.screen_w = 1600;
+    s.screen_h = 600;
+    s.config.placement = PLACEMENT_SMART;
+    s.monitor_count = 2;
+    s.monitors = calloc(2, sizeof(monitor_t));
+    s.monitors[0].geom = s.monitors[0].workarea = (rect_t){0, 0, 800, 600};
+    s.monitors[1].geom = s.monitors[1].workarea = (rect_t){800, 0, 800, 600};
+
+    handle_t f = add_client(&s, 1200, 300, 300, 200);
+    server_chot(&s, f)->state = STATE_MAPPED;
+    wm_place_index_update(&s, f);
+    s.focused_client = f;
+
+    // The pointer cache still points at the left monitor (motion inside clients is not seen)
+    s.pointer = (pointer_cache_t){.x = 10, .y = 10, .valid = true};
+
+    handle_t h = add_client(&s, 0, 0, 200, 200);
+    client_hot_t* hot = server_chot(&s, h);
+    wm_place_window(&s, h);
+    assert(hot->desired.x == 800 && hot->desired.y == 0);
+
+    printf("test_smart_placement_follows_focused_monitor passed\n");
+    free(s.monitors);
+    wm_place_index_destroy(&s);
+    cleanup_server(&s);
+}
+
 int main(void) {
     test_us_position_preserved();
     test_p_position_preserved();
     test_position_clamped_without_hint();
+    test_mouse_placement_uses_pointer_cache();
+    test_smart_placement_avoids_overlap();
+    test_smart_placement_follows_focused_monitor();
     return 0;
 }
@@ -0,0 +1,360 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "client.h"
+#include "cookie_jar.h"
+#include "event.h"
+#include "prop_schema.h"
+#include "wm.h"
+#include "xcb_utils.h"
+
+extern void xcb_stubs_reset(void);
+
+static void setup_server(server_t* s) {
+    memset(s, 0, sizeof(*s));
+    s->is_test = true;
+
+    xcb_stubs_reset();
+    s->conn = xcb_connect(NULL, NULL);
+    atoms_init(s->conn);
+
+    s->root = 1;
+    cookie_jar_init(&s->cookie_jar);
+    slotmap_init(&s->clients, 16, sizeof(client_hot_t), sizeof(client_cold_t));
+    small_vec_init(&s->active_clients);
+    hash_map_init(&s->window_to_client);
+    hash_map_init(&s->frame_to_client);
+    list_init(&s->focus_history);
+}
+
+static void cleanup_server(server_t* s) {
+    for (uint32_t i = 1; i < s->clients.cap; i++) {
+        if (!s->clients.hdr[i].live) continue;
+        handle_t h = handle_make(i, s->clients.hdr[i].gen);
+        client_cold_t* cold = server_ccold(s, h);
+        if (cold) arena_destroy(&cold->string_arena);
+    }
+    cookie_jar_destroy(&s->cookie_jar);
+    slotmap_destroy(&s->clients);
+    small_vec_destroy(&s->active_clients);
+    hash_map_destroy(&s->window_to_client);
+    hash_map_destroy(&s->frame_to_client);
+    xcb_disconnect(s->conn);
+}
+
+static handle_t add_client(server_t* s, xcb_window_t xid) {
+    void *hot_ptr = NULL, *cold_ptr = NULL;
+    handle_t h = slotmap_alloc(&s->clients, &hot_ptr, &cold_ptr);
+    assert(h != HANDLE_INVALID);
+    client_hot_t* hot = (client_hot_t*)hot_ptr;
+    client_cold_t* cold = (client_cold_t*)cold_ptr;
+    hot->xid = xid;
+    hot->state = STATE_MAPPED;
+    arena_init(&cold->string_arena, 128);
+    hash_map_insert(&s->window_to_client, xid, handle_to_ptr(h));
+    return h;
+}
+
+static const cookie_slot_t* find_property_cookie(const server_t* s, xcb_atom_t atom) {
+    for (size_t i = 0; i < s->cookie_jar.cap; i++) {
+        const cookie_slot_t* slot = &s->cookie_jar.slots[i];
+        if (!slot->live || slot->type != COOKIE_GET_PROPERTY) continue;
+        if ((xcb_atom_t)(slot->data & 0xFFFFFFFFu) == atom) return slot;
+    }
+    return NULL;
+}
+
+static void test_lookup_after_atoms_init(void) {
+    server_t s;
+    setup_server(&s);
+
+    for (size_t i = 0; i < prop_schema_count; i++) {
+        const prop_schema_t* ps = &prop_schema_table[i];
+        assert(*ps->atom != XCB_ATOM_NONE);
+        assert(prop_schema_lookup(*ps->atom) == ps);
+    }
+
+    assert(prop_schema_lookup(XCB_ATOM_NONE) == NULL);
+    assert(prop_schema_lookup(atoms._NET_SUPPORTED) == NULL);
+
+    const prop_schema_t* ps = prop_schema_lookup(atoms.WM_NORMAL_HINTS);
+    assert(ps->dirty == DIRTY_HINTS);
+    assert(ps->flags & PROP_F_CRITICAL);
+    assert(prop_schema_lookup(atoms._NET_WM_ICON)->max_len == 1048576);
+    assert(!(prop_schema_lookup(atoms._NET_WM_ICON)->flags & PROP_F_CRITICAL));
+
+    printf("test_lookup_after_atoms_init passed\n");
+    cleanup_server(&s);
+}
+
+static void test_lookup_follows_reassigned_atom(void) {
+    server_t s;
+    setup_server(&s);
+
+    // Tests (and nothing else) poke atom values after atoms_init; the index only
+    // follows once it is rebuilt, and a stale hit is never returned
+    xcb_atom_t old = atoms.WM_COLORMAP_WINDOWS;
+    atoms.WM_COLORMAP_WINDOWS = 5000;
+    assert(prop_schema_lookup(5000) == NULL);
+    assert(prop_schema_lookup(old) == NULL);
+    prop_schema_index_build();
+
+    const prop_schema_t* ps = prop_schema_lookup(5000);
+    assert(ps && ps->atom == &atoms.WM_COLORMAP_WINDOWS);
+    assert(prop_schema_lookup(old) == NULL);
+
+    printf("test_lookup_follows_reassigned_atom passed\n");
+    cleanup_server(&s);
+}
+
+static void test_refetch_title_in_table_order(void) {
+    server_t s;
+    setup_server(&s);
+    handle_t h = add_client(&s, 100);
+
+    prop_schema_refetch(&s, h, server_chot(&s, h), DIRTY_TITLE);
+    assert(s.cookie_jar.live_count == 2);
+
+    const cookie_slot_t* net = find_property_cookie(&s, atoms._NET_WM_NAME);
+    const cookie_slot_t* legacy = find_property_cookie(&s, atoms.WM_NAME);
+    assert(net && legacy);
+    assert(net->sequence < legacy->sequence);
+    assert((xcb_window_t)(net->data >> 32) == 100);
+
+    printf("test_refetch_title_in_table_order passed\n");
+    cleanup_server(&s);
+}
+
+static void test_property_notify_uses_schema(void) {
+    server_t s;
+    setup_server(&s);
+    handle_t h = add_client(&s, 200);
+    client_hot_t* hot = server_chot(&s, h);
+
+    xcb_property_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.window = 200;
+
+    ev.atom = atoms.WM_STATE;
+    wm_handle_property_notify(&s, h, &ev);
+    assert(hot->dirty == DIRTY_NONE);
+    assert(s.cookie_jar.live_count == 0);
+
+    ev.atom = atoms._NET_WM_STRUT;
+    wm_handle_property_notify(&s, h, &ev);
+    assert(hot->dirty == DIRTY_STRUT);
+    assert(s.cookie_jar.live_count == 0);
+
+    ev.atom = atoms.WM_PROTOCOLS;
+    wm_handle_property_notify(&s, h, &ev);
+    assert(hot->dirty == DIRTY_STRUT);
+    assert(find_property_cookie(&s, atoms.WM_PROTOCOLS) != NULL);
+
+    printf("test_property_notify_uses_schema passed\n");
+    cleanup_server(&s);
+}
+
+static void test_commit_fetches_only_notified_atoms(void) {
+    server_t s;
+    setup_server(&s);
+    handle_t h = add_client(&s, 400);
+    client_hot_t* hot = server_chot(&s, h);
+
+    xcb_property_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.window = 400;
+    ev.state = XCB_PROPERTY_NEW_VALUE;
+
+    // Repeated title updates within a tick coalesce into one fetch of that atom
+    ev.atom = atoms._NET_WM_NAME;
+    wm_handle_property_notify(&s, h, &ev);
+    wm_handle_property_notify(&s, h, &ev);
+    ev.atom = atoms._GTK_FRAME_EXTENTS;
+    wm_handle_property_notify(&s, h, &ev);
+    assert(hot->dirty == (DIRTY_TITLE | DIRTY_HINTS));
+
+    prop_schema_commit(&s, h, hot, DIRTY_TITLE | DIRTY_HINTS);
+    assert(s.cookie_jar.live_count == 2);
+    assert(find_property_cookie(&s, atoms._NET_WM_NAME) != NULL);
+    assert(find_property_cookie(&s, atoms._GTK_FRAME_EXTENTS) != NULL);
+    assert(find_property_cookie(&s, atoms.WM_NAME) == NULL);
+    assert(find_property_cookie(&s, atoms.WM_NORMAL_HINTS) == NULL);
+    assert(hot->prop_refetch == 0);
+
+    printf("test_commit_fetches_only_notified_atoms passed\n");
+    cleanup_server(&s);
+}
+
+static void test_commit_applies_delete_without_request(void) {
+    server_t s;
+    setup_server(&s);
+    handle_t h = add_client(&s, 500);
+    client_hot_t* hot = server_chot(&s, h);
+
+    hot->window_opacity = 0x80000000u;
+    hot->window_opacity_valid = true;
+
+    xcb_property_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.window = 500;
+    ev.atom = atoms._NET_WM_WINDOW_OPACITY;
+
+    // NewValue then Delete in the same tick: the delete wins
+    ev.state = XCB_PROPERTY_NEW_VALUE;
+    wm_handle_property_notify(&s, h, &ev);
+    ev.state = XCB_PROPERTY_DELETE;
+    wm_handle_property_notify(&s, h, &ev);
+
+    prop_schema_commit(&s, h, hot, DIRTY_OPACITY);
+    assert(s.cookie_jar.live_count == 0);
+    assert(!hot->window_opacity_valid);
+
+    // With a fetch still in flight, a delete must not race it: refetch instead
+    const prop_schema_t* ps = prop_schema_lookup(atoms._NET_WM_WINDOW_OPACITY);
+    hot->prop_inflight |= prop_schema_bit(ps);
+    wm_handle_property_notify(&s, h, &ev);
+    prop_schema_commit(&s, h, hot, DIRTY_OPACITY);
+    assert(find_property_cookie(&s, atoms._NET_WM_WINDOW_OPACITY) != NULL);
+
+    printf("test_commit_applies_delete_without_request passed\n");
+    cleanup_server(&s);
+}
+
+static void test_overlapping_fetches_keep_inflight(void) {
+    server_t s;
+    setup_server(&s);
+    handle_t h = add_client(&s, 700);
+    client_hot_t* hot = server_chot(&s, h);
+    const prop_schema_t* ps = prop_schema_lookup(atoms._NET_WM_WINDOW_OPACITY);
+    uint64_t bit = prop_schema_bit(ps);
+
+    prop_schema_fetch(&s, h, hot, ps);
+    prop_schema_fetch(&s, h, hot, ps);
+
+    xcb_get_property_reply_t* empty = calloc(1, sizeof(*empty));
+    cookie_slot_t slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.type = COOKIE_GET_PROPERTY;
+    slot.client = h;
+    slot.txn_id = s.txn_id;
+    slot.data = prop_schema_cookie_data(700, atoms._NET_WM_WINDOW_OPACITY);
+
+    // The first reply leaves the second fetch outstanding
+    wm_handle_reply(&s, &slot, empty, NULL);
+    assert(hot->prop_inflight & bit);
+
+    // A delete seen now must wait for a fetch ordered after the older one
+    xcb_property_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.window = 700;
+    ev.atom = atoms._NET_WM_WINDOW_OPACITY;
+    ev.state = XCB_PROPERTY_DELETE;
+    wm_handle_property_notify(&s, h, &ev);
+    size_t live = s.cookie_jar.live_count;
+    prop_schema_commit(&s, h, hot, DIRTY_OPACITY);
+    assert(s.cookie_jar.live_count == live + 1);
+
+    wm_handle_reply(&s, &slot, empty, NULL);
+    assert(hot->prop_inflight & bit);
+    wm_handle_reply(&s, &slot, empty, NULL);
+    assert(!(hot->prop_inflight & bit));
+
+    free(empty);
+    printf("test_overlapping_fetches_keep_inflight passed\n");
+    cleanup_server(&s);
+}
+
+static void test_title_governor_commits_on_trailing_edge(void) {
+    server_t s;
+    setup_server(&s);
+    handle_t h = add_client(&s, 600);
+    small_vec_push(&s.active_clients, handle_to_ptr(h));
+    client_hot_t* hot = server_chot(&s, h);
+    hot->flags |= CLIENT_FLAG_UNDECORATED;
+
+    xcb_property_notify_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.window = 600;
+    ev.atom = atoms._NET_WM_NAME;
+    ev.state = XCB_PROPERTY_NEW_VALUE;
+
+    const uint64_t ms = 1000000ull;
+    const uint64_t t0 = 5000 * ms;
+
+    // Leading edge: the first update after a quiet period is fetched at once
+    wm_handle_property_notify(&s, h, &ev);
+    wm_flush_dirty(&s, t0);
+    assert(s.cookie_jar.live_count == 1);
+    assert(!(hot->dirty & DIRTY_TITLE));
+
+    // A burst inside the interval is held back across ticks
+    wm_handle_property_notify(&s, h, &ev);
+    wm_flush_dirty(&s, t0 + 10 * ms);
+    wm_handle_property_notify(&s, h, &ev);
+    wm_flush_dirty(&s, t0 + 60 * ms);
+    assert(s.cookie_jar.live_count == 1);
+    assert(hot->dirty & DIRTY_TITLE);
+    assert(hot->prop_refetch & prop_schema_bit(prop_schema_lookup(atoms._NET_WM_NAME)));
+
+    // Trailing edge: one fetch for the whole burst
+    wm_flush_dirty(&s, t0 + 100 * ms);
+    assert(s.cookie_jar.live_count == 2);
+    assert(!(hot->dirty & DIRTY_TITLE));
+    assert(hot->prop_refetch == 0);
+
+    printf("test_title_governor_commits_on_trailing_edge passed\n");
+    cleanup_server(&s);
+}
+
+static void test_manage_waits_only_for_critical(void) {
+    server_t s;
+    setup_server(&s);
+
+    client_manage_start(&s, 300);
+    handle_t h = server_get_client_by_window(&s, 300);
+    assert(h != HANDLE_INVALID);
+    client_hot_t* hot = server_chot(&s, h);
+
+    uint32_t critical = 0;
+    for (size_t i = 0; i < prop_schema_count; i++) {
+        uint32_t f = prop_schema_table[i].flags;
+        if ((f & PROP_F_MANAGE) && (f & PROP_F_CRITICAL)) critical++;
+    }
+    assert(hot->pending_replies == 2 + critical);
+    uint8_t before = hot->pending_replies;
+
+    xcb_get_property_reply_t* empty = calloc(1, sizeof(*empty));
+    cookie_slot_t slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.type = COOKIE_GET_PROPERTY;
+    slot.client = h;
+    slot.txn_id = s.txn_id;
+
+    slot.data = prop_schema_cookie_data(300, atoms._NET_WM_PID);
+    wm_handle_reply(&s, &slot, empty, NULL);
+    assert(hot->pending_replies == before);
+
+    slot.data = prop_schema_cookie_data(300, atoms.WM_CLASS);
+    wm_handle_reply(&s, &slot, empty, NULL);
+    assert(hot->pending_replies == before - 1);
+    assert(hot->state == STATE_NEW);
+
+    free(empty);
+    printf("test_manage_waits_only_for_critical passed\n");
+    cleanup_server(&s);
+}
+
+int main(void) {
+    test_lookup_after_atoms_init();
+    test_lookup_follows_reassigned_atom();
+    test_refetch_title_in_table_order();
+    test_property_notify_uses_schema();
+    test_commit_fetches_only_notified_atoms();
+    test_commit_applies_delete_without_request();
+    test_overlapping_fetches_keep_inflight();
+    test_title_governor_commits_on_trailing_edge();
+    test_manage_waits_only_for_critical();
+    return 0;
+}
@@ -28,7 +28,6 @@ static void setup_server(server_t* s) {
     list_init(&s->focus_history);
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
     small_vec_init(&s->active_clients);
     cookie_jar_init(&s->cookie_jar);
     slotmap_init(&s->clients, 16, sizeof(client_hot_t), sizeof(client_cold_t));
@@ -172,7 +171,6 @@ static void test_out_of_order_reply_ignored(void) {
     hot->state = STATE_NEW;
     hot->layer = LAYER_NORMAL;
     hot->base_layer = LAYER_NORMAL;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->focus_node);
     list_init(&hot->transients_head);
@@ -27,9 +27,6 @@ void test_resize_logic(void) {
 
     // Init list heads
     list_init(&s.focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) {
-        small_vec_init(&s.layers[i]);
-    }
 
     // Init slotmap
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) {
@@ -62,7 +59,6 @@ void test_resize_logic(void) {
     hot->hints_flags = XCB_ICCCM_SIZE_HINT_P_MIN_SIZE | XCB_ICCCM_SIZE_HINT_P_MAX_SIZE;
 
     // Init list nodes
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transient_sibling);
     list_init(&hot->transients_head);
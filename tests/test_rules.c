@@ -20,7 +20,6 @@ void setup_server(server_t* s) {
     s->desktop_count = 4;
     s->current_desktop = 0;
     list_init(&s->focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
     config_init_defaults(&s->config);
@@ -48,6 +47,7 @@ void test_rules_matching(void) {
     r->focus = 0;
     r->placement = PLACEMENT_CENTER;
     small_vec_push(&s.config.rules, r);
+    s.config.rules_version++;
 
     // Mock client
     void *hot_ptr = NULL, *cold_ptr = NULL;
@@ -64,7 +64,6 @@ void test_rules_matching(void) {
     hot->desired.w = 400;
     hot->desired.h = 300;
     list_init(&hot->focus_node);
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transients_head);
     list_init(&hot->transient_sibling);
@@ -104,7 +103,112 @@ void test_rules_matching(void) {
     xcb_disconnect(s.conn);
 }
 
+static app_rule_t* make_rule(const char* class_match, const char* title_match) {
+    app_rule_t* r = calloc(1, sizeof(*r));
+    if (class_match) r->class_match = strdup(class_match);
+    if (title_match) r->title_match = strdup(title_match);
+    r->type_match = -1;
+    r->transient_match = -1;
+    r->desktop = -2;
+    r->layer = -1;
+    r->focus = -1;
+    r->placement = PLACEMENT_DEFAULT;
+    return r;
+}
+
+void test_rules_index_and_title_change(void) {
+    server_t s;
+    setup_server(&s);
+    config_load(&s.config, "/non/existent");
+
+    // Many class rules; only App042 should ever be applied
+    for (int i = 0; i < 200; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "App%03d", i);
+        app_rule_t* r = make_rule(name, NULL);
+        r->desktop = (i == 42) ? 1 : 2;
+        r->layer = (i == 42) ? -1 : LAYER_BELOW;
+        small_vec_push(&s.config.rules, r);
+    }
+    // Overlapping title patterns exercise the automaton's fail links
+    app_rule_t* inbox = make_rule(NULL, "Inbox");
+    inbox->desktop = 3;
+    small_vec_push(&s.config.rules, inbox);
+    app_rule_t* box = make_rule(NULL, "box -");
+    box->layer = LAYER_ABOVE;
+    small_vec_push(&s.config.rules, box);
+    app_rule_t* other = make_rule("Other", "Inbox");
+    other->focus = 0;
+    small_vec_push(&s.config.rules, other);
+    s.config.rules_version++;
+
+    void *hot_ptr = NULL, *cold_ptr = NULL;
+    handle_t h = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
+    client_hot_t* hot = (client_hot_t*)hot_ptr;
+    client_cold_t* cold = (client_cold_t*)cold_ptr;
+    hot->self = h;
+    hot->xid = 102;
+    hot->type = WINDOW_TYPE_NORMAL;
+    hot->layer = LAYER_NORMAL;
+    hot->base_layer = LAYER_NORMAL;
+    hot->focus_override = -1;
+    hot->placement = PLACEMENT_DEFAULT;
+    hot->transient_for = HANDLE_INVALID;
+    hot->desired.w = 400;
+    hot->desired.h = 300;
+    list_init(&hot->focus_node);
+    hot->stacking_layer = -1;
+    list_init(&hot->transients_head);
+    list_init(&hot->transient_sibling);
+
+    client_cold_set_string(cold, &cold->wm_class, "App042", 6);
+    client_cold_set_string(cold, &cold->wm_instance, "app", 3);
+    client_cold_set_string(cold, &cold->base_title, "Editor", 6);
+    cold->title = cold->base_title;
+
+    client_finish_manage(&s, h);
+    assert(hot->state == STATE_MAPPED || hot->state == STATE_UNMAPPED);
+    assert(hot->desktop == 1);
+    assert(hot->layer == LAYER_NORMAL);
+    assert(cold->title_rules_len == 0);
+
+    // Title now matches both title-only rules; the class-qualified one stays out
+    client_cold_set_string(cold, &cold->base_title, "Inbox - Mail", 12);
+    wm_client_refresh_title(&s, h);
+    assert(hot->desktop == 3);
+    assert(hot->base_layer == LAYER_ABOVE);
+    assert(hot->layer == LAYER_ABOVE);
+    assert(hot->focus_override == -1);
+    assert(cold->title_rules_len == 2);
+
+    // Rules that keep matching are not re-applied over user changes
+    wm_client_move_to_workspace(&s, h, 0, false);
+    client_cold_set_string(cold, &cold->base_title, "Inbox - Mail (2)", 16);
+    wm_client_refresh_title(&s, h);
+    assert(hot->desktop == 0);
+
+    // Dropping out of a rule and matching it again applies it anew
+    client_cold_set_string(cold, &cold->base_title, "Mail", 4);
+    wm_client_refresh_title(&s, h);
+    assert(cold->title_rules_len == 0);
+    client_cold_set_string(cold, &cold->base_title, "Inbox", 5);
+    wm_client_refresh_title(&s, h);
+    assert(hot->desktop == 3);
+    assert(cold->title_rules_len == 1);
+
+    printf("test_rules_index_and_title_change passed\n");
+
+    client_unmanage(&s, h);
+    config_destroy(&s.config);
+    slotmap_destroy(&s.clients);
+    hash_map_destroy(&s.window_to_client);
+    hash_map_destroy(&s.frame_to_client);
+    xcb_key_symbols_free(s.keysyms);
+    xcb_disconnect(s.conn);
+}
+
 int main(void) {
     test_rules_matching();
+    test_rules_index_and_title_change();
     return 0;
 }
@@ -26,7 +26,6 @@ static void setup_server(server_t* s) {
     list_init(&s->focus_history);
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
     slotmap_init(&s->clients, 16, sizeof(client_hot_t), sizeof(client_cold_t));
 }
 
@@ -46,7 +45,6 @@ static void cleanup_server(server_t* s) {
     slotmap_destroy(&s->clients);
     hash_map_destroy(&s->window_to_client);
     hash_map_destroy(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_destroy(&s->layers[i]);
     xcb_disconnect(s->conn);
 }
 
@@ -70,7 +68,6 @@ static handle_t add_client(server_t* s, xcb_window_t xid, xcb_window_t frame) {
     hot->desired = (rect_t){0, 0, 100, 80};
     hot->visual_id = s->root_visual;
     hot->depth = s->root_depth;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->focus_node);
     list_init(&hot->transients_head);
@@ -25,7 +25,6 @@ static bool init_server(server_t* s) {
     s->is_test = true;
     s->conn = (xcb_connection_t*)malloc(1);
     config_init_defaults(&s->config);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
     arena_init(&s->tick_arena, 4096);
     list_init(&s->focus_history);
     small_vec_init(&s->active_clients);
@@ -43,11 +42,9 @@ static void cleanup_server(server_t* s) {
         render_free(&hot->render_ctx);
         if (hot->icon_surface) cairo_surface_destroy(hot->icon_surface);
     }
+    free(s->committed_stack.items);
     slotmap_destroy(&s->clients);
     small_vec_destroy(&s->active_clients);
-    for (int i = 0; i < LAYER_COUNT; i++) {
-        small_vec_destroy(&s->layers[i]);
-    }
     arena_destroy(&s->tick_arena);
     config_destroy(&s->config);
     free(s->conn);
@@ -62,7 +59,6 @@ static handle_t add_client(server_t* s, xcb_window_t xid, xcb_window_t frame, in
     hot->frame = frame;
     hot->layer = layer;
     hot->state = STATE_MAPPED;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transients_head);
     list_init(&hot->transient_sibling);
@@ -72,11 +68,15 @@ static handle_t add_client(server_t* s, xcb_window_t xid, xcb_window_t frame, in
 }
 
 static void assert_layer_order(const server_t* s, int layer, const handle_t* handles, size_t count) {
-    const small_vec_t* v = &s->layers[layer];
+    const stack_layer_t* v = &s->layers[layer];
     assert(v->length == count);
+    const client_hot_t* c = v->bottom;
     for (size_t i = 0; i < count; i++) {
-        assert((handle_t)(uintptr_t)v->items[i] == handles[i]);
+        assert(c && c->self == handles[i]);
+        if (i > 0) assert(stack_is_above(c, c->stack_below));
+        c = c->stack_above;
     }
+    assert(c == NULL);
 }
 
 void test_stack_restack_single_and_sibling(void) {
@@ -185,6 +185,108 @@ void test_stack_raise_transients_restack_count(void) {
     cleanup_server(&s);
 }
 
+void test_stack_commit_minimal_restacks(void) {
+    server_t s;
+    if (!init_server(&s)) return;
+
+    handle_t hp = add_client(&s, 10, 110, LAYER_NORMAL);
+    handle_t ht1 = add_client(&s, 20, 120, LAYER_NORMAL);
+    handle_t ht2 = add_client(&s, 30, 130, LAYER_NORMAL);
+    handle_t hx = add_client(&s, 40, 140, LAYER_NORMAL);
+    handle_t hy = add_client(&s, 50, 150, LAYER_NORMAL);
+
+    client_hot_t* p = server_chot(&s, hp);
+    client_hot_t* t1 = server_chot(&s, ht1);
+    client_hot_t* t2 = server_chot(&s, ht2);
+    client_hot_t* y = server_chot(&s, hy);
+
+    stack_raise(&s, hp);
+    stack_raise(&s, ht1);
+    stack_raise(&s, ht2);
+    stack_raise(&s, hx);
+    stack_raise(&s, hy);
+    wm_flush_dirty(&s, monotonic_time_ns());
+
+    // Nothing moved: no requests
+    stub_configure_window_count = 0;
+    stack_raise(&s, hy);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(stub_configure_window_count == 0);
+
+    // Bottom window to the top: a single restack above the old top
+    stub_configure_window_count = 0;
+    stack_raise(&s, hp);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    {
+        handle_t order[] = {ht1, ht2, hx, hy, hp};
+        assert_layer_order(&s, LAYER_NORMAL, order, 5);
+    }
+    assert(stub_configure_window_count == 1);
+    assert(stub_last_config_window == p->frame);
+    assert(stub_last_config_sibling == y->frame);
+    assert(stub_last_config_stack_mode == XCB_STACK_MODE_ABOVE);
+
+    // Parent already on top: raising it with its transients only moves the two transients
+    t1->transient_for = hp;
+    list_insert(&t1->transient_sibling, p->transients_head.prev, &p->transients_head);
+    t2->transient_for = hp;
+    list_insert(&t2->transient_sibling, p->transients_head.prev, &p->transients_head);
+
+    stub_configure_window_count = 0;
+    stack_raise(&s, hp);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    {
+        handle_t order[] = {hx, hy, hp, ht1, ht2};
+        assert_layer_order(&s, LAYER_NORMAL, order, 5);
+    }
+    assert(stub_configure_window_count == 2);
+    assert(stub_last_config_window == t2->frame);
+    assert(stub_last_config_sibling == t1->frame);
+    assert(stub_last_config_stack_mode == XCB_STACK_MODE_ABOVE);
+
+    printf("test_stack_commit_minimal_restacks passed\n");
+
+    cleanup_server(&s);
+}
+
+void test_stack_labels_survive_gap_exhaustion(void) {
+    server_t s;
+    if (!init_server(&s)) return;
+
+    handle_t ha = add_client(&s, 10, 110, LAYER_NORMAL);
+    handle_t hb = add_client(&s, 20, 120, LAYER_NORMAL);
+    handle_t hc = add_client(&s, 30, 130, LAYER_NORMAL);
+    stack_raise(&s, ha);
+    stack_raise(&s, hb);
+    stack_raise(&s, hc);
+
+    // Bouncing between two places keeps bisecting the same gap until the layer is relabelled
+    uint64_t relabels = counters.stack_relabels;
+    for (int i = 0; i < 80; i++) {
+        stack_place_above(&s, hc, ha);
+        stack_place_below(&s, hb, hc);
+    }
+    assert(counters.stack_relabels > relabels);
+
+    {
+        handle_t order[] = {ha, hb, hc};
+        assert_layer_order(&s, LAYER_NORMAL, order, 3);
+    }
+    assert(stack_is_above(server_chot(&s, hc), server_chot(&s, ha)));
+    assert(!stack_is_above(server_chot(&s, ha), server_chot(&s, hc)));
+
+    stack_remove(&s, hb);
+    {
+        handle_t order[] = {ha, hc};
+        assert_layer_order(&s, LAYER_NORMAL, order, 2);
+    }
+    assert(!stack_is_above(server_chot(&s, hb), server_chot(&s, ha)));
+
+    printf("test_stack_labels_survive_gap_exhaustion passed\n");
+
+    cleanup_server(&s);
+}
+
 void test_root_stacking_property_order(void) {
     server_t s;
     if (!init_server(&s)) return;
@@ -244,6 +346,8 @@ int main(void) {
     test_stack_restack_single_and_sibling();
     test_stack_cross_layer_sibling();
     test_stack_raise_transients_restack_count();
+    test_stack_commit_minimal_restacks();
+    test_stack_labels_survive_gap_exhaustion();
     test_root_stacking_property_order();
     test_focus_raise_on_focus();
     return 0;
@@ -7,6 +7,7 @@
 #include "cookie_jar.h"
 #include "event.h"
 #include "hxm.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -16,6 +17,7 @@ void test_transient_cycle_prevention(void) {
     s.is_test = true;
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_TRANSIENT_FOR = 100;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -145,6 +147,7 @@ void test_transient_orphan_handled(void) {
     s.is_test = true;
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_TRANSIENT_FOR = 100;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -18,7 +18,6 @@ void test_idempotent_unmanage(void) {
     s.conn = (xcb_connection_t*)malloc(1);
 
     list_init(&s.focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -31,7 +30,6 @@ void test_idempotent_unmanage(void) {
     client_cold_t* cold = (client_cold_t*)cold_ptr;
     hot->xid = 123;
     hot->state = STATE_MAPPED;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transient_sibling);
     list_init(&hot->transients_head);
@@ -61,7 +59,6 @@ void test_destroy_unmanage_race(void) {
     s.conn = (xcb_connection_t*)malloc(1);
 
     list_init(&s.focus_history);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -74,7 +71,6 @@ void test_destroy_unmanage_race(void) {
     client_cold_t* cold = (client_cold_t*)cold_ptr;
     hot->xid = 123;
     hot->state = STATE_MAPPED;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transient_sibling);
     list_init(&hot->transients_head);
@@ -9,6 +9,7 @@
 #include "cookie_jar.h"
 #include "event.h"
 #include "hxm.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -42,6 +43,7 @@ static void setup(void) {
     atoms._NET_WM_NAME = 1;
     atoms.WM_NAME = 2;
     atoms.UTF8_STRING = 3;
+    prop_schema_index_build();
     // STRING is 31 (XCB_ATOM_STRING)
 }
 
@@ -154,9 +156,73 @@ static void test_title_truncation(void) {
     printf("PASS: Title truncation\n");
 }
 
+static size_t arena_bytes(const arena_t* a) {
+    size_t total = 0;
+    for (const arena_block_t* b = a->first; b; b = b->next) total += b->size;
+    return total;
+}
+
+static void test_title_churn_memory_bounded(void) {
+    printf("Testing title churn keeps string memory bounded...\n");
+    setup();
+
+    cookie_slot_t slot = {0};
+    slot.type = COOKIE_GET_PROPERTY;
+    slot.client = h;
+    slot.data = ((uint64_t)hot->xid << 32) | atoms._NET_WM_NAME;
+
+    char title[256];
+    for (int i = 0; i < 20000; i++) {
+        // Lengths vary so that in-place reuse alone can't absorb the churn
+        int pad = (i * 37) % 200;
+        int len = snprintf(title, sizeof(title), "step %d ", i);
+        memset(title + len, 'x', (size_t)pad);
+        len += pad;
+        title[len] = '\0';
+
+        xcb_get_property_reply_t* rep = make_string_reply(atoms.UTF8_STRING, title, len);
+        wm_handle_reply(&s, &slot, rep, NULL);
+        free(rep);
+
+        assert(cold->string_dead <= 4096 || cold->string_dead <= cold->string_live);
+    }
+
+    assert(strcmp(cold->title, title) == 0);
+    assert(cold->title == cold->base_title);
+    assert(arena_bytes(&cold->string_arena) < 64 * 1024);
+
+    teardown();
+    printf("PASS: Title churn memory bounded\n");
+}
+
+static void test_cold_string_reuse_in_place(void) {
+    printf("Testing cold string in-place reuse...\n");
+    setup();
+
+    client_cold_set_string(cold, &cold->wm_class, "XTerm", 5);
+    char* first = cold->wm_class;
+    assert(cold->string_live == 8 && cold->string_dead == 0);
+
+    // Same slot size: overwritten in place
+    client_cold_set_string(cold, &cold->wm_class, "UXTerm", 6);
+    assert(cold->wm_class == first);
+    assert(strcmp(cold->wm_class, "UXTerm") == 0);
+    assert(cold->string_live == 8 && cold->string_dead == 0);
+
+    // Longer: a new slot, the old one is dead
+    client_cold_set_string(cold, &cold->wm_class, "Alacritty", 9);
+    assert(strcmp(cold->wm_class, "Alacritty") == 0);
+    assert(cold->string_live == 16 && cold->string_dead == 8);
+
+    teardown();
+    printf("PASS: Cold string in-place reuse\n");
+}
+
 int main(void) {
     test_net_wm_name_update();
     test_wm_name_fallback();
     test_title_truncation();
+    test_title_churn_memory_bounded();
+    test_cold_string_reuse_in_place();
     return 0;
 }
\ No newline at end of file
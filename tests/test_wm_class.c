@@ -6,6 +6,7 @@
 #include "client.h"
 #include "cookie_jar.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -17,6 +18,7 @@ void test_wm_class_split(void) {
     s.root_visual_type = xcb_get_visualtype(NULL, 0);
     s.conn = (xcb_connection_t*)malloc(1);
     atoms.WM_CLASS = 1;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
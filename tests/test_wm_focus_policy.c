@@ -8,6 +8,7 @@
 #include "client.h"
 #include "cookie_jar.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -41,7 +42,6 @@ static void setup_server_for_manage(server_t* s) {
     list_init(&s->focus_history);
     hash_map_init(&s->window_to_client);
     hash_map_init(&s->frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s->layers[i]);
 
     s->config.theme.border_width = 1;
     s->config.theme.title_height = 10;
@@ -69,7 +69,6 @@ static handle_t alloc_test_client(server_t* s, xcb_window_t xid, int32_t desktop
     hot->desired = (rect_t){0, 0, 200, 150};
     hot->visual_id = s->root_visual;
     hot->depth = s->root_depth;
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->focus_node);
     list_init(&hot->transients_head);
@@ -99,7 +98,6 @@ void test_focus_on_finish_manage(void) {
     s.focused_client = HANDLE_INVALID;
     hash_map_init(&s.window_to_client);
     hash_map_init(&s.frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -118,7 +116,6 @@ void test_focus_on_finish_manage(void) {
     h1_hot->transient_for = HANDLE_INVALID;
     h1_hot->desktop = 0;
     list_init(&h1_hot->focus_node);
-    h1_hot->stacking_index = -1;
     h1_hot->stacking_layer = -1;
     list_init(&h1_hot->transients_head);
     list_init(&h1_hot->transient_sibling);
@@ -144,7 +141,6 @@ void test_focus_on_finish_manage(void) {
     h2_hot->transient_for = HANDLE_INVALID;
     h2_hot->desktop = 0;
     list_init(&h2_hot->focus_node);
-    h2_hot->stacking_index = -1;
     h2_hot->stacking_layer = -1;
     list_init(&h2_hot->transients_head);
     list_init(&h2_hot->transient_sibling);
@@ -166,7 +162,6 @@ void test_focus_on_finish_manage(void) {
     h3_hot->transient_for = HANDLE_INVALID;
     h3_hot->desktop = 0;
     list_init(&h3_hot->focus_node);
-    h3_hot->stacking_index = -1;
     h3_hot->stacking_layer = -1;
     list_init(&h3_hot->transients_head);
     list_init(&h3_hot->transient_sibling);
@@ -202,7 +197,6 @@ void test_mru_cycling(void) {
     s.focused_client = HANDLE_INVALID;
     hash_map_init(&s.window_to_client);
     hash_map_init(&s.frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
@@ -221,7 +215,6 @@ void test_mru_cycling(void) {
         hot->focus_override = -1;
         hot->desktop = 0;
         list_init(&hot->focus_node);
-        hot->stacking_index = -1;
         hot->stacking_layer = -1;
         list_init(&hot->transients_head);
         list_init(&hot->transient_sibling);
@@ -293,7 +286,6 @@ void test_move_interaction(void) {
     s.focused_client = HANDLE_INVALID;
     hash_map_init(&s.window_to_client);
     hash_map_init(&s.frame_to_client);
-    for (int i = 0; i < LAYER_COUNT; i++) small_vec_init(&s.layers[i]);
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
     void *hot_ptr = NULL, *cold_ptr = NULL;
@@ -310,7 +302,6 @@ void test_move_interaction(void) {
     hot->server.h = 100;
     hot->desired = hot->server;
     list_init(&hot->focus_node);
-    hot->stacking_index = -1;
     hot->stacking_layer = -1;
     list_init(&hot->transients_head);
     list_init(&hot->transient_sibling);
@@ -387,6 +378,7 @@ void test_title_update(void) {
     atoms._NET_WM_NAME = 10;
     atoms.UTF8_STRING = 11;
     atoms.WM_NAME = 12;
+    prop_schema_index_build();
 
     cookie_slot_t slot = {0};
     slot.client = h;
@@ -408,7 +400,7 @@ void test_title_update(void) {
 
     assert(cold->title != NULL);
     assert(strcmp(cold->title, "Hello") == 0);
-    assert(hot->dirty & DIRTY_FRAME_STYLE);
+    assert(hot->dirty & DIRTY_FRAME_TITLE);
 
     printf("test_title_update passed\n");
     for (uint32_t i = 1; i < s.clients.cap; i++) {
@@ -7,6 +7,7 @@
 #include "client.h"
 #include "cookie_jar.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -19,6 +20,7 @@ void test_wm_icon(void) {
     s.conn = (xcb_connection_t*)malloc(1);
 
     atoms._NET_WM_ICON = 99;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
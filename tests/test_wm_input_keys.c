@@ -90,6 +90,20 @@ static inline void list_push_back(list_node_t* head, list_node_t* node) {
     head->prev = node;
 }
 
+static inline void list_push_front(list_node_t* head, list_node_t* node) {
+    node->prev = head;
+    node->next = head->next;
+    head->next->prev = node;
+    head->next = node;
+}
+
+static inline void list_remove(list_node_t* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node;
+    node->next = node;
+}
+
 // Key binding structure used by module
 typedef struct key_binding {
     uint32_t keysym;
@@ -107,10 +121,45 @@ typedef struct {
     key_bindings_vec_t key_bindings;
 } config_t;
 
+// Compiled binding table (mirrors include/event.h)
+#define KEY_TABLE_KEYCODES 256
+#define KEY_TABLE_MODS 32
+
+typedef struct {
+    const key_binding_t** slots;
+    uint8_t escape[KEY_TABLE_KEYCODES / 8];
+    uint32_t grabbed[KEY_TABLE_KEYCODES];
+} key_table_t;
+
 // Minimal xcb structs used by wm_handle_key_press
 typedef uint32_t xcb_keysym_t;
 typedef uint8_t xcb_keycode_t;
 
+typedef struct {
+    xcb_keysym_t base[KEY_TABLE_KEYCODES];
+    uint32_t gen;
+    bool valid;
+} keymap_t;
+
+typedef enum {
+    KEY_ACTION_NONE = 0,
+    KEY_ACTION_WORKSPACE,
+    KEY_ACTION_FOCUS,
+    KEY_ACTION_STICKY,
+} key_action_kind_t;
+
+#define KEY_ACTION_FOCUS_MAX 32
+
+typedef struct {
+    key_action_kind_t kind;
+    uint32_t workspace;
+    uint32_t focus_next;
+    uint8_t focus_presses;
+    handle_t sticky_client;
+    bool sticky_flip;
+    uint32_t coalesced;
+} key_action_queue_t;
+
 typedef struct {
     uint8_t detail;
     uint16_t state;
@@ -154,12 +203,16 @@ typedef struct server {
     void* conn;
     uint32_t root;
     void* keysyms;
+    keymap_t keymap;
+    key_table_t key_table;
+    key_action_queue_t key_actions;
 
     config_t config;
 
     list_node_t focus_history;
     handle_t focused_client;
     uint32_t current_desktop;
+    uint32_t desktop_count;
 
     cookie_jar_t cookie_jar;
     uint64_t txn_id;
@@ -179,6 +232,10 @@ int g_restart_pending = 0;
     do {              \
         (void)0;      \
     } while (0)
+#define LOG_ERROR(...) \
+    do {               \
+        (void)0;       \
+    } while (0)
 
 // -----------------------------
 // Stubs/spies for external WM functions called by module
@@ -267,12 +324,6 @@ void client_close(server_t* s, handle_t h) {
     spy_client_close_last = h;
 }
 
-void wm_set_focus(server_t* s, handle_t h) {
-    (void)s;
-    spy_wm_set_focus_calls++;
-    spy_wm_set_focus_last = h;
-}
-
 void stack_raise(server_t* s, handle_t h) {
     (void)s;
     spy_stack_raise_calls++;
@@ -316,6 +367,19 @@ client_hot_t* server_chot(server_t* s, handle_t h) {
     return NULL;
 }
 
+// Mirrors the MRU bookkeeping of the real wm_set_focus
+void wm_set_focus(server_t* s, handle_t h) {
+    spy_wm_set_focus_calls++;
+    spy_wm_set_focus_last = h;
+
+    client_hot_t* c = server_chot(s, h);
+    if (c && c->focus_node.next) {
+        list_remove(&c->focus_node);
+        list_push_front(&s->focus_history, &c->focus_node);
+    }
+    s->focused_client = h;
+}
+
 // These are referenced by MOVE/RESIZE branches; tests avoid those actions
 bool client_can_move(client_hot_t* hot) {
     (void)hot;
@@ -374,16 +438,13 @@ void wm_start_interaction(server_t* s, handle_t h, client_hot_t* hot, bool start
 }
 
 // -----------------------------
-// XCB keysyms stub
+// Keymap stub
 // -----------------------------
 
-static xcb_keysym_t g_fake_keysym;
-
-xcb_keysym_t xcb_key_symbols_get_keysym(void* keysyms, xcb_keycode_t detail, int col) {
-    (void)keysyms;
-    (void)detail;
-    (void)col;
-    return g_fake_keysym;
+// Every keycode maps to the same base keysym
+static void fake_keymap(server_t* s, xcb_keysym_t sym) {
+    for (size_t k = 0; k < KEY_TABLE_KEYCODES; k++) s->keymap.base[k] = sym;
+    s->keymap.valid = true;
 }
 
 // X11 KeySym constants used by module logic
@@ -391,12 +452,13 @@ xcb_keysym_t xcb_key_symbols_get_keysym(void* keysyms, xcb_keycode_t detail, int
 #define XK_Escape 0xff1b
 
 // -----------------------------
-// Override spawn() + exit() inside included module
+// Override launcher_spawn() + exit() inside included module
 // -----------------------------
 
 static jmp_buf exit_jmp_buf;
 
-static void test_spawn(const char* cmd) {
+static void test_spawn(server_t* s, const char* cmd) {
+    (void)s;
     spy_spawn_calls++;
     if (!cmd) {
         spy_spawn_last_cmd[0] = 0;
@@ -415,7 +477,7 @@ static void test_exit(int code) {
 #define static /* expose statics */
 
 // Redirect spawn/exit to spies
-#define spawn test_spawn
+#define launcher_spawn test_spawn
 #define exit test_exit
 
 // Include the module under test
@@ -423,7 +485,7 @@ static void test_exit(int code) {
 
 // Undo macros to avoid leaking to other includes
 #undef static
-#undef spawn
+#undef launcher_spawn
 #undef exit
 
 // -----------------------------
@@ -436,6 +498,7 @@ static server_t make_server(key_binding_t** bindings, size_t nbindings, client_h
 
     s.keysyms = (void*)0x1;  // non-null to allow wm_handle_key_press
     s.current_desktop = 0;
+    s.desktop_count = 10;
     s.focused_client = HANDLE_INVALID;
 
     // abuse conn as our client registry pointer for server_chot()
@@ -586,7 +649,8 @@ static void test_key_press_menu_escape_hides_menu_and_returns(void) {
     ev.detail = 9;
     ev.state = 0;
 
-    g_fake_keysym = XK_Escape;
+    fake_keymap(&s, XK_Escape);
+    key_table_compile(&s);
 
     wm_handle_key_press(&s, &ev);
 
@@ -612,7 +676,8 @@ static void test_key_press_matches_binding_with_ignored_mods(void) {
     ev.detail = 10;
     ev.state = (uint16_t)((1u << 0) | XCB_MOD_MASK_LOCK | XCB_MOD_MASK_2 | XCB_MOD_MASK_5);
 
-    g_fake_keysym = 0x1234;
+    fake_keymap(&s, 0x1234);
+    key_table_compile(&s);
 
     wm_handle_key_press(&s, &ev);
 
@@ -632,7 +697,8 @@ static void test_key_press_action_close_calls_client_close(void) {
     ev.detail = 11;
     ev.state = 0;
 
-    g_fake_keysym = 0x2222;
+    fake_keymap(&s, 0x2222);
+    key_table_compile(&s);
 
     wm_handle_key_press(&s, &ev);
 
@@ -657,14 +723,17 @@ static void test_key_press_action_focus_next_prev_dispatch(void) {
     key_binding_t* binds[] = {&bind_next};
 
     server_t s = make_server(binds, 1, registry);
+    list_init(&s.focus_history);  // make_server returned a copy of the head
     list_push_back(&s.focus_history, &a.focus_node);
     list_push_back(&s.focus_history, &b.focus_node);
     s.focused_client = a.self;
 
     xcb_key_press_event_t ev = {.detail = 12, .state = 0};
-    g_fake_keysym = 0x3333;
+    fake_keymap(&s, 0x3333);
+    key_table_compile(&s);
 
     wm_handle_key_press(&s, &ev);
+    wm_key_actions_flush(&s);
 
     assert(spy_wm_set_focus_calls == 1);
     assert(spy_wm_set_focus_last == b.self);
@@ -679,9 +748,11 @@ static void test_key_press_action_workspace_uses_safe_atoi(void) {
     server_t s = make_server(binds, 1, NULL);
 
     xcb_key_press_event_t ev = {.detail = 13, .state = 0};
-    g_fake_keysym = 0x4444;
+    fake_keymap(&s, 0x4444);
+    key_table_compile(&s);
 
     wm_handle_key_press(&s, &ev);
+    wm_key_actions_flush(&s);
 
     assert(spy_switch_workspace_calls == 1);
     assert(spy_switch_workspace_last == 2u);
@@ -697,7 +768,8 @@ static void test_key_press_action_move_to_workspace_follow(void) {
     s.focused_client = 0xCAFE;
 
     xcb_key_press_event_t ev = {.detail = 14, .state = 0};
-    g_fake_keysym = 0x5555;
+    fake_keymap(&s, 0x5555);
+    key_table_compile(&s);
 
     wm_handle_key_press(&s, &ev);
 
@@ -717,9 +789,11 @@ static void test_key_press_action_toggle_sticky(void) {
     s.focused_client = 0x123;
 
     xcb_key_press_event_t ev = {.detail = 15, .state = 0};
-    g_fake_keysym = 0x6666;
+    fake_keymap(&s, 0x6666);
+    key_table_compile(&s);
 
     wm_handle_key_press(&s, &ev);
+    wm_key_actions_flush(&s);
 
     assert(spy_toggle_sticky_calls == 1);
     assert(spy_toggle_sticky_last == 0x123);
@@ -735,7 +809,8 @@ static void test_key_press_action_exec_and_terminal_spawn(void) {
     server_t s1 = make_server(binds1, 1, NULL);
 
     xcb_key_press_event_t ev1 = {.detail = 16, .state = 0};
-    g_fake_keysym = 0x7777;
+    fake_keymap(&s1, 0x7777);
+    key_table_compile(&s1);
     wm_handle_key_press(&s1, &ev1);
 
     assert(spy_spawn_calls == 1);
@@ -747,7 +822,8 @@ static void test_key_press_action_exec_and_terminal_spawn(void) {
     server_t s2 = make_server(binds2, 1, NULL);
 
     xcb_key_press_event_t ev2 = {.detail = 17, .state = 0};
-    g_fake_keysym = 0x8888;
+    fake_keymap(&s2, 0x8888);
+    key_table_compile(&s2);
     wm_handle_key_press(&s2, &ev2);
 
     assert(spy_spawn_calls == 1);
@@ -762,7 +838,8 @@ static void test_key_press_action_exit_intercepted(void) {
     server_t s = make_server(binds, 1, NULL);
 
     xcb_key_press_event_t ev = {.detail = 18, .state = 0};
-    g_fake_keysym = 0x9999;
+    fake_keymap(&s, 0x9999);
+    key_table_compile(&s);
 
     if (setjmp(exit_jmp_buf) == 0) {
         wm_handle_key_press(&s, &ev);
@@ -772,6 +849,179 @@ static void test_key_press_action_exit_intercepted(void) {
     assert(spy_exit_last_code == 0);
 }
 
+static void test_key_table_first_binding_wins_and_exact_mods(void) {
+    reset_spies();
+
+    key_binding_t first = {.keysym = 0xAAAA, .modifiers = (1u << 3), .action = ACTION_WORKSPACE, .exec_cmd = "1"};
+    key_binding_t shadowed = {.keysym = 0xAAAA, .modifiers = (1u << 3), .action = ACTION_WORKSPACE, .exec_cmd = "5"};
+    key_binding_t* binds[] = {&first, &shadowed};
+    server_t s = make_server(binds, 2, NULL);
+
+    fake_keymap(&s, 0xAAAA);
+    key_table_compile(&s);
+
+    // Extra modifier (Shift) or a held button: no binding
+    xcb_key_press_event_t ev = {.detail = 40, .state = (uint16_t)((1u << 3) | (1u << 0))};
+    wm_handle_key_press(&s, &ev);
+    ev.state = (uint16_t)((1u << 3) | (1u << 8));
+    wm_handle_key_press(&s, &ev);
+    assert(spy_switch_workspace_calls == 0);
+
+    // Exact modifiers (NumLock ignored): the first binding in config order
+    ev.state = (uint16_t)((1u << 3) | XCB_MOD_MASK_2);
+    wm_handle_key_press(&s, &ev);
+    wm_key_actions_flush(&s);
+    assert(spy_switch_workspace_calls == 1);
+    assert(spy_switch_workspace_last == 1u);
+
+    free(s.key_table.slots);
+}
+
+static void test_key_actions_coalesce_per_tick(void) {
+    reset_spies();
+
+    client_hot_t a = make_client(10, 0, false, STATE_MAPPED, WINDOW_TYPE_NORMAL);
+    client_hot_t b = make_client(20, 0, false, STATE_MAPPED, WINDOW_TYPE_NORMAL);
+    client_hot_t c = make_client(30, 0, false, STATE_MAPPED, WINDOW_TYPE_NORMAL);
+    client_hot_t* registry[] = {&a, &b, &c, NULL};
+
+    key_binding_t next = {.keysym = 0xB001, .modifiers = 0, .action = ACTION_WORKSPACE_NEXT, .exec_cmd = NULL};
+    key_binding_t prev = {.keysym = 0xB001, .modifiers = 1u, .action = ACTION_WORKSPACE_PREV, .exec_cmd = NULL};
+    key_binding_t focus = {.keysym = 0xB001, .modifiers = (1u << 2), .action = ACTION_FOCUS_NEXT, .exec_cmd = NULL};
+    key_binding_t sticky = {.keysym = 0xB001, .modifiers = (1u << 3), .action = ACTION_TOGGLE_STICKY, .exec_cmd = NULL};
+    key_binding_t* binds[] = {&next, &prev, &focus, &sticky};
+    server_t s = make_server(binds, 4, registry);
+    list_init(&s.focus_history);  // make_server returned a copy of the head
+    list_push_back(&s.focus_history, &a.focus_node);
+    list_push_back(&s.focus_history, &b.focus_node);
+    list_push_back(&s.focus_history, &c.focus_node);
+    s.focused_client = a.self;
+
+    fake_keymap(&s, 0xB001);
+    key_table_compile(&s);
+
+    // Held workspace-next: one transition to the net target, wrapping at desktop_count
+    xcb_key_press_event_t ev = {.detail = 50, .state = 0};
+    for (int i = 0; i < 12; i++) wm_handle_key_press(&s, &ev);
+    assert(spy_switch_workspace_calls == 0);
+    wm_key_actions_flush(&s);
+    assert(spy_switch_workspace_calls == 1);
+    assert(spy_switch_workspace_last == 2u);
+
+    // Steps that cancel out switch nothing
+    reset_spies();
+    wm_handle_key_press(&s, &ev);
+    ev.state = 1u;
+    wm_handle_key_press(&s, &ev);
+    wm_key_actions_flush(&s);
+    assert(spy_switch_workspace_calls == 0);
+
+    // Focus-next toggles between the two most recent clients, so four presses end where they started
+    ev.state = (1u << 2);
+    for (int i = 0; i < 4; i++) wm_handle_key_press(&s, &ev);
+    wm_key_actions_flush(&s);
+    assert(spy_wm_set_focus_calls == 0);
+    for (int i = 0; i < 3; i++) wm_handle_key_press(&s, &ev);
+    wm_key_actions_flush(&s);
+    assert(spy_wm_set_focus_calls == 1);
+    assert(spy_wm_set_focus_last == b.self);
+
+    // Sticky toggles cancel in pairs
+    ev.state = (1u << 3);
+    wm_handle_key_press(&s, &ev);
+    wm_handle_key_press(&s, &ev);
+    wm_key_actions_flush(&s);
+    assert(spy_toggle_sticky_calls == 0);
+
+    // A different action flushes the pending one first
+    reset_spies();
+    wm_handle_key_press(&s, &ev);
+    ev.state = 0;
+    wm_handle_key_press(&s, &ev);
+    assert(spy_toggle_sticky_calls == 1);
+    assert(spy_switch_workspace_calls == 0);
+    wm_key_actions_flush(&s);
+    assert(spy_switch_workspace_calls == 1);
+
+    free(s.key_table.slots);
+}
+
+static void focus_history_order(server_t* s, handle_t* out, size_t n) {
+    size_t i = 0;
+    for (list_node_t* node = s->focus_history.next; node != &s->focus_history && i < n; node = node->next) {
+        out[i++] = ((client_hot_t*)((char*)node - offsetof(client_hot_t, focus_node)))->self;
+    }
+}
+
+static void test_key_actions_focus_matches_sequential(void) {
+    // Presses as focus-next (1) / focus-prev (0)
+    static const char* seqs[] = {"1", "11", "111", "0", "00", "000", "10", "01", "1101", "0010", "1001101", "0110100"};
+
+    for (size_t k = 0; k < sizeof(seqs) / sizeof(seqs[0]); k++) {
+        const char* seq = seqs[k];
+        handle_t want[4];
+        handle_t got[4];
+        handle_t want_focus;
+
+        // Sequential: one wm_cycle_focus per press
+        {
+            client_hot_t c[4];
+            client_hot_t* registry[5];
+            server_t s = make_server(NULL, 0, NULL);
+            list_init(&s.focus_history);
+            for (int i = 0; i < 4; i++) {
+                c[i] = make_client((handle_t)(10 * (i + 1)), 0, false, STATE_MAPPED, WINDOW_TYPE_NORMAL);
+                registry[i] = &c[i];
+                list_push_back(&s.focus_history, &c[i].focus_node);
+            }
+            registry[4] = NULL;
+            s.conn = registry;
+            s.focused_client = c[0].self;
+
+            for (const char* p = seq; *p; p++) wm_cycle_focus(&s, *p == '1');
+            want_focus = s.focused_client;
+            focus_history_order(&s, want, 4);
+        }
+
+        // Coalesced: the same presses within one tick
+        {
+            client_hot_t c[4];
+            client_hot_t* registry[5];
+            key_binding_t next = {.keysym = 0xC001, .modifiers = 0, .action = ACTION_FOCUS_NEXT, .exec_cmd = NULL};
+            key_binding_t prev = {.keysym = 0xC001, .modifiers = 1u, .action = ACTION_FOCUS_PREV, .exec_cmd = NULL};
+            key_binding_t* binds[] = {&next, &prev};
+            for (int i = 0; i < 4; i++) {
+                c[i] = make_client((handle_t)(10 * (i + 1)), 0, false, STATE_MAPPED, WINDOW_TYPE_NORMAL);
+                registry[i] = &c[i];
+            }
+            registry[4] = NULL;
+            server_t s = make_server(binds, 2, registry);
+            list_init(&s.focus_history);
+            for (int i = 0; i < 4; i++) list_push_back(&s.focus_history, &c[i].focus_node);
+            s.focused_client = c[0].self;
+
+            fake_keymap(&s, 0xC001);
+            key_table_compile(&s);
+
+            reset_spies();
+            xcb_key_press_event_t ev = {.detail = 60, .state = 0};
+            for (const char* p = seq; *p; p++) {
+                ev.state = *p == '1' ? 0u : 1u;
+                wm_handle_key_press(&s, &ev);
+            }
+            assert(spy_wm_set_focus_calls == 0);
+            wm_key_actions_flush(&s);
+            assert(spy_wm_set_focus_calls <= 1);
+
+            assert(s.focused_client == want_focus);
+            focus_history_order(&s, got, 4);
+            assert(memcmp(got, want, sizeof(want)) == 0);
+
+            free(s.key_table.slots);
+        }
+    }
+}
+
 int main(void) {
     test_wm_clean_mods_masks_lock_num_scroll();
     test_safe_atoi_cases();
@@ -787,6 +1037,9 @@ int main(void) {
     test_key_press_action_toggle_sticky();
     test_key_press_action_exec_and_terminal_spawn();
     test_key_press_action_exit_intercepted();
+    test_key_table_first_binding_wins_and_exact_mods();
+    test_key_actions_coalesce_per_tick();
+    test_key_actions_focus_matches_sequential();
 
     puts("test_wm_input_keys: OK");
     return 0;
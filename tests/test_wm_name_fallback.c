@@ -7,6 +7,7 @@
 #include "client.h"
 #include "cookie_jar.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 #include "xcb_utils.h"
 
@@ -32,6 +33,7 @@ void test_net_wm_name_fallback(void) {
     atoms._NET_WM_NAME = 10;
     atoms.WM_NAME = 11;
     atoms.UTF8_STRING = 12;
+    prop_schema_index_build();
 
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
 
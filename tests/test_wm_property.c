@@ -4,6 +4,7 @@
 
 #include "client.h"
 #include "event.h"
+#include "prop_schema.h"
 #include "wm.h"
 
 void test_property_dirty_bits(void) {
@@ -14,6 +15,7 @@ void test_property_dirty_bits(void) {
     atoms.WM_NAME = 1;
     atoms._NET_WM_NAME = 2;
     atoms.WM_NORMAL_HINTS = 3;
+    prop_schema_index_build();
 
     // Minimal init for slotmap and maps
     if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) {
@@ -1,11 +1,15 @@
 #include <assert.h>
 #include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <xcb/randr.h>
 
 #include "client.h"
+#include "cookie_jar.h"
 #include "event.h"
 #include "wm.h"
+#include "wm_internal.h"
 
 void test_workarea_compute(void) {
     server_t s;
@@ -28,7 +32,10 @@ void test_workarea_compute(void) {
     client_cold_t* cold1 = (client_cold_t*)cold_ptr;
     c1->state = STATE_MAPPED;
     cold1->strut.top = 30;
+    cold1->strut_partial_active = false;
+    cold1->strut_registered = false;
     small_vec_push(&s.active_clients, handle_to_ptr(h1));
+    wm_strut_changed(&s, h1, &(strut_t){0}, false);
 
     handle_t h2 = slotmap_alloc(&s.clients, &hot_ptr, &cold_ptr);
     assert(h2 != HANDLE_INVALID);
@@ -39,7 +46,10 @@ void test_workarea_compute(void) {
     client_cold_t* cold2 = (client_cold_t*)cold_ptr;
     c2->state = STATE_MAPPED;
     cold2->strut.left = 50;
+    cold2->strut_partial_active = false;
+    cold2->strut_registered = false;
     small_vec_push(&s.active_clients, handle_to_ptr(h2));
+    wm_strut_changed(&s, h2, &(strut_t){0}, false);
 
     rect_t wa;
     wm_compute_workarea(&s, &wa);
@@ -52,12 +62,181 @@ void test_workarea_compute(void) {
 
     printf("test_workarea_compute passed\n");
 
+    small_vec_destroy(&s.strut_clients);
     small_vec_destroy(&s.active_clients);
     slotmap_destroy(&s.clients);
     xcb_disconnect(s.conn);
 }
 
+static handle_t add_max_client(server_t* s, rect_t server) {
+    void *hot_ptr = NULL, *cold_ptr = NULL;
+    handle_t h = slotmap_alloc(&s->clients, &hot_ptr, &cold_ptr);
+    client_hot_t* hot = (client_hot_t*)hot_ptr;
+    client_cold_t* cold = (client_cold_t*)cold_ptr;
+    memset(hot, 0, sizeof(*hot));
+    memset(cold, 0, sizeof(*cold));
+    hot->self = h;
+    hot->state = STATE_MAPPED;
+    hot->layer = LAYER_NORMAL;
+    hot->server = server;
+    hot->desired = server;
+    hot->maximized_horz = true;
+    hot->maximized_vert = true;
+    small_vec_push(&s->active_clients, handle_to_ptr(h));
+    return h;
+}
+
+static handle_t add_top_dock(server_t* s, uint32_t top, uint32_t start_x, uint32_t end_x) {
+    void *hot_ptr = NULL, *cold_ptr = NULL;
+    handle_t h = slotmap_alloc(&s->clients, &hot_ptr, &cold_ptr);
+    client_hot_t* hot = (client_hot_t*)hot_ptr;
+    client_cold_t* cold = (client_cold_t*)cold_ptr;
+    memset(hot, 0, sizeof(*hot));
+    memset(cold, 0, sizeof(*cold));
+    hot->self = h;
+    hot->state = STATE_MAPPED;
+    small_vec_push(&s->active_clients, handle_to_ptr(h));
+
+    strut_t prev = cold->strut;
+    bool prev_partial = cold->strut_partial_active;
+    cold->strut_partial_active = true;
+    cold->strut.top = top;
+    cold->strut.top_start_x = start_x;
+    cold->strut.top_end_x = end_x;
+    wm_strut_changed(s, h, &prev, prev_partial);
+    return h;
+}
+
+void test_workarea_per_monitor_incremental(void) {
+    server_t s;
+    memset(&s, 0, sizeof(s));
+    if (!slotmap_init(&s.clients, 16, sizeof(client_hot_t), sizeof(client_cold_t))) return;
+    small_vec_init(&s.active_clients);
+    small_vec_init(&s.strut_clients);
+    s.conn = xcb_connect(NULL, NULL);
+
+    // Two 1920x1080 monitors side by side
+    s.screen_w = 3840;
+    s.screen_h = 1080;
+    monitor_t mons[2];
+    memset(mons, 0, sizeof(mons));
+    mons[0].geom = (rect_t){0, 0, 1920, 1080};
+    mons[1].geom = (rect_t){1920, 0, 1920, 1080};
+    mons[0].workarea = mons[0].geom;
+    mons[1].workarea = mons[1].geom;
+    s.monitors = mons;
+    s.monitor_count = 2;
+
+    handle_t hmax0 = add_max_client(&s, (rect_t){100, 100, 400, 300});
+    handle_t hmax1 = add_max_client(&s, (rect_t){2000, 100, 400, 300});
+    client_hot_t* max0 = server_chot(&s, hmax0);
+    client_hot_t* max1 = server_chot(&s, hmax1);
+
+    // Panel on the left monitor only
+    handle_t dock0 = add_top_dock(&s, 30, 0, 1919);
+    assert(s.strut_clients.length == 1);
+    assert(s.workarea_dirty_monitors == 1ull);
+
+    rect_t wa;
+    wm_compute_workarea(&s, &wa);
+    assert(wa.y == 30 && wa.h == 1050);
+    assert(mons[1].workarea.y == 0 && mons[1].workarea.h == 1080);
+    wm_publish_workarea(&s, &wa);
+    assert(max0->desired.y == 30 && max0->desired.h == 1050);
+    assert(max1->desired.y == 100 && max1->desired.h == 300);
+
+    // Panel on the right monitor: the left one is neither rebuilt nor relaid out
+    rect_t left = mons[0].workarea;
+    mons[0].workarea = (rect_t){1, 2, 3, 4};
+    max0->desired = (rect_t){5, 6, 7, 8};
+    add_top_dock(&s, 40, 1920, 3839);
+    assert(s.workarea_dirty_monitors == 2ull);
+
+    wm_compute_workarea(&s, &wa);
+    assert(mons[0].workarea.x == 1 && mons[0].workarea.h == 4);
+    assert(mons[1].workarea.y == 40 && mons[1].workarea.h == 1040);
+    assert(s.workarea_changed_monitors == 2ull);
+    mons[0].workarea = left;
+    wa = left;
+    wm_publish_workarea(&s, &wa);
+    assert(max0->desired.x == 5 && max0->desired.h == 8);
+    assert(max1->desired.x == 1920 && max1->desired.y == 40 && max1->desired.h == 1040);
+
+    // Dropping a strut dirties only the monitor it touched
+    wm_strut_remove(&s, dock0);
+    assert(s.strut_clients.length == 1);
+    assert(s.workarea_dirty_monitors == 1ull);
+    wm_compute_workarea(&s, &wa);
+    assert(wa.y == 0 && wa.h == 1080);
+
+    printf("test_workarea_per_monitor_incremental passed\n");
+
+    small_vec_destroy(&s.strut_clients);
+    small_vec_destroy(&s.active_clients);
+    slotmap_destroy(&s.clients);
+    xcb_disconnect(s.conn);
+}
+
+extern int (*stub_poll_for_reply_hook)(xcb_connection_t* c, unsigned int request, void** reply,
+                                       xcb_generic_error_t** error);
+
+// Every GetMonitors reply: left 1920x1080, right 2560x1440 (primary)
+static int monitors_poll(xcb_connection_t* c, unsigned int request, void** reply, xcb_generic_error_t** error) {
+    (void)c;
+    (void)request;
+    (void)error;
+    size_t len = sizeof(xcb_randr_get_monitors_reply_t) + 2 * sizeof(xcb_randr_monitor_info_t);
+    xcb_randr_get_monitors_reply_t* r = calloc(1, len);
+    r->nMonitors = 2;
+    xcb_randr_monitor_info_t* info = (xcb_randr_monitor_info_t*)(r + 1);
+    info[0] = (xcb_randr_monitor_info_t){.x = 0, .y = 0, .width = 1920, .height = 1080};
+    info[1] = (xcb_randr_monitor_info_t){.primary = 1, .x = 1920, .y = 0, .width = 2560, .height = 1440};
+    *reply = r;
+    return 1;
+}
+
+void test_monitor_query_async(void) {
+    server_t s;
+    memset(&s, 0, sizeof(s));
+    cookie_jar_init(&s.cookie_jar);
+    small_vec_init(&s.active_clients);
+    s.conn = xcb_connect(NULL, NULL);
+    s.randr_supported = true;
+    s.randr_monitors = true;
+
+    // Nothing is read back synchronously; the second query supersedes the first
+    wm_update_monitors(&s);
+    wm_update_monitors(&s);
+    assert(s.monitor_count == 0);
+    assert(s.cookie_jar.live_count == 2);
+
+    stub_poll_for_reply_hook = monitors_poll;
+    cookie_jar_drain(&s.cookie_jar, s.conn, &s, 16);
+    stub_poll_for_reply_hook = NULL;
+
+    assert(s.cookie_jar.live_count == 0);
+    assert(s.monitor_count == 2);
+    assert(s.monitors[0].geom.x == 1920 && s.monitors[0].geom.w == 2560);
+    assert(s.monitors[1].geom.x == 0 && s.monitors[1].geom.w == 1920);
+    assert(s.root_dirty & ROOT_DIRTY_WORKAREA);
+
+    // Without struts the rebuilt workareas equal the preset ones; both monitors still get relaid out
+    rect_t wa;
+    wm_compute_workarea(&s, &wa);
+    assert(wa.x == 1920 && wa.w == 2560);
+    assert((s.workarea_changed_monitors & 3ull) == 3ull);
+
+    printf("test_monitor_query_async passed\n");
+
+    free(s.monitors);
+    small_vec_destroy(&s.active_clients);
+    cookie_jar_destroy(&s.cookie_jar);
+    xcb_disconnect(s.conn);
+}
+
 int main(void) {
     test_workarea_compute();
+    test_workarea_per_monitor_incremental();
+    test_monitor_query_async();
     return 0;
 }
@@ -9,6 +9,7 @@
 #include "event.h"
 #include "hxm.h"
 #include "wm.h"
+#include "wm_internal.h"
 
 // Externs from xcb_stubs.c
 extern void xcb_stubs_reset(void);
@@ -16,6 +17,10 @@ extern int stub_map_window_count;
 extern int stub_unmap_window_count;
 extern xcb_window_t stub_last_mapped_window;
 extern xcb_window_t stub_last_unmapped_window;
+extern int stub_configure_window_count;
+extern xcb_window_t stub_last_config_window;
+extern int32_t stub_last_config_x;
+extern int32_t stub_last_config_y;
 
 void setup_server(server_t* s) {
     memset(s, 0, sizeof(server_t));
@@ -37,6 +42,20 @@ void setup_server(server_t* s) {
     list_init(&s->focus_history);
 }
 
+static void teardown_desktop_index(server_t* s) {
+    for (uint32_t i = 0; i < s->desktop_members_cap; i++) small_vec_destroy(&s->desktop_members[i]);
+    free(s->desktop_members);
+    small_vec_destroy(&s->sticky_members);
+    small_vec_destroy(&s->visibility_pending);
+}
+
+// Managed clients are indexed and have their frame mapped iff visible (as client_finish_manage leaves them)
+static void index_client(server_t* s, handle_t h) {
+    client_hot_t* hot = server_chot(s, h);
+    hot->frame_mapped = hot->state == STATE_MAPPED && (hot->sticky || hot->desktop == (int32_t)s->current_desktop);
+    wm_desktop_index_update(s, h);
+}
+
 void test_workspace_switch_basics(void) {
     server_t s;
     setup_server(&s);
@@ -76,6 +95,11 @@ void test_workspace_switch_basics(void) {
     c4->sticky = true;
     c4->frame = 1004;
 
+    index_client(&s, h1);
+    index_client(&s, h2);
+    index_client(&s, h3);
+    index_client(&s, h4);
+
     // Reset counters
     stub_map_window_count = 0;
     stub_unmap_window_count = 0;
@@ -128,17 +152,16 @@ void test_workspace_switch_basics(void) {
     // C1 (Desk 0) -> Unmap
     // C2 (Desk 1) -> Map
     // C3 (Desk 0, Unmapped) -> Ignore
-    // C4 (Sticky) -> Map (redundant but correct for visibility)
+    // C4 (Sticky) -> Ignore (its frame is already mapped)
 
     printf("Map count: %d, Unmap count: %d\n", stub_map_window_count, stub_unmap_window_count);
 
     assert(stub_unmap_window_count == 1);  // C1
-    assert(stub_map_window_count == 2);    // C2, C4
+    assert(stub_map_window_count == 1);    // C2
 
     assert(stub_last_unmapped_window == 1001);  // C1's frame
-    // Last mapped could be C2 or C4 depending on iteration order (likely index order).
-    // C2 is index 2, C4 is index 4. So C4 is last.
-    assert(stub_last_mapped_window == 1004);
+    assert(stub_last_mapped_window == 1002);    // C2's frame
+    assert(!c1->frame_mapped && c2->frame_mapped && !c3->frame_mapped && c4->frame_mapped);
 
     printf("Test finished successfully.\n");
 
@@ -152,6 +175,7 @@ void test_workspace_switch_basics(void) {
             }
         }
     }
+    teardown_desktop_index(&s);
     slotmap_destroy(&s.clients);
     small_vec_destroy(&s.active_clients);
     xcb_disconnect(s.conn);
@@ -169,6 +193,7 @@ void test_client_move_to_workspace(void) {
     c1->frame = 1001;
     c1->xid = 2001;
     c1->self = h1;
+    index_client(&s, h1);
 
     stub_map_window_count = 0;
     stub_unmap_window_count = 0;
@@ -228,6 +253,7 @@ void test_client_move_to_workspace(void) {
         }
     }
     arena_destroy(&s.tick_arena);
+    teardown_desktop_index(&s);
     slotmap_destroy(&s.clients);
     small_vec_destroy(&s.active_clients);
     xcb_disconnect(s.conn);
@@ -244,6 +270,7 @@ void test_client_toggle_sticky(void) {
     c1->desktop = 1;  // On hidden desktop
     c1->frame = 1001;
     c1->self = h1;
+    index_client(&s, h1);
 
     stub_map_window_count = 0;
     stub_unmap_window_count = 0;
@@ -275,6 +302,7 @@ void test_client_toggle_sticky(void) {
             }
         }
     }
+    teardown_desktop_index(&s);
     slotmap_destroy(&s.clients);
     small_vec_destroy(&s.active_clients);
     xcb_disconnect(s.conn);
@@ -314,6 +342,226 @@ void test_workspace_relative(void) {
             }
         }
     }
+    teardown_desktop_index(&s);
+    slotmap_destroy(&s.clients);
+    small_vec_destroy(&s.active_clients);
+    xcb_disconnect(s.conn);
+}
+
+void test_workspace_switch_touches_only_changed(void) {
+    server_t s;
+    setup_server(&s);
+
+    // 8 clients on each desktop, one sticky; only desktops 0 and 2 take part in the switch
+    handle_t hs[4][8];
+    for (uint32_t d = 0; d < 4; d++) {
+        for (uint32_t i = 0; i < 8; i++) {
+            handle_t h = slotmap_alloc(&s.clients, NULL, NULL);
+            small_vec_push(&s.active_clients, handle_to_ptr(h));
+            client_hot_t* c = server_chot(&s, h);
+            c->state = STATE_MAPPED;
+            c->desktop = (int32_t)d;
+            c->frame = 1000 + d * 100 + i;
+            c->self = h;
+            index_client(&s, h);
+            hs[d][i] = h;
+        }
+    }
+    handle_t hsticky = slotmap_alloc(&s.clients, NULL, NULL);
+    small_vec_push(&s.active_clients, handle_to_ptr(hsticky));
+    client_hot_t* cs = server_chot(&s, hsticky);
+    cs->state = STATE_MAPPED;
+    cs->sticky = true;
+    cs->desktop = -1;
+    cs->frame = 1999;
+    cs->self = hsticky;
+    index_client(&s, hsticky);
+
+    assert(wm_desktop_index_members(&s, 1)->length == 8);
+
+    stub_map_window_count = 0;
+    stub_unmap_window_count = 0;
+
+    wm_switch_workspace(&s, 2);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(stub_unmap_window_count == 8);
+    assert(stub_map_window_count == 8);
+    for (uint32_t i = 0; i < 8; i++) {
+        assert(!server_chot(&s, hs[0][i])->frame_mapped);
+        assert(!server_chot(&s, hs[1][i])->frame_mapped);
+        assert(server_chot(&s, hs[2][i])->frame_mapped);
+    }
+    assert(cs->frame_mapped);
+
+    // Switching back and forth repeatedly never touches other desktops or the sticky client
+    stub_map_window_count = 0;
+    stub_unmap_window_count = 0;
+    wm_switch_workspace(&s, 0);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    wm_switch_workspace(&s, 2);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(stub_unmap_window_count == 16);
+    assert(stub_map_window_count == 16);
+
+    // Moving a client re-files it; the next switch sees it under its new desktop
+    wm_client_move_to_workspace(&s, hs[3][0], 0, false);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(wm_desktop_index_members(&s, 3)->length == 7);
+    assert(wm_desktop_index_members(&s, 0)->length == 9);
+
+    stub_map_window_count = 0;
+    wm_switch_workspace(&s, 0);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(stub_map_window_count == 9);
+    assert(server_chot(&s, hs[3][0])->frame_mapped);
+
+    printf("test_workspace_switch_touches_only_changed passed.\n");
+    for (uint32_t i = 1; i < s.clients.cap; i++) {
+        if (s.clients.hdr[i].live) {
+            handle_t h = handle_make(i, s.clients.hdr[i].gen);
+            client_hot_t* hot = server_chot(&s, h);
+            if (hot) {
+                render_free(&hot->render_ctx);
+                if (hot->icon_surface) cairo_surface_destroy(hot->icon_surface);
+            }
+        }
+    }
+    teardown_desktop_index(&s);
+    slotmap_destroy(&s.clients);
+    small_vec_destroy(&s.active_clients);
+    xcb_disconnect(s.conn);
+}
+
+void test_workspace_switch_park_mode(void) {
+    server_t s;
+    setup_server(&s);
+    s.config.workspace_hide = WORKSPACE_HIDE_PARK;
+
+    handle_t h1 = slotmap_alloc(&s.clients, NULL, NULL);
+    small_vec_push(&s.active_clients, handle_to_ptr(h1));
+    client_hot_t* c1 = server_chot(&s, h1);
+    c1->state = STATE_MAPPED;
+    c1->desktop = 0;
+    c1->frame = 1001;
+    c1->xid = 2001;
+    c1->self = h1;
+    c1->server.x = 40;
+    c1->server.y = 50;
+    index_client(&s, h1);
+
+    stub_map_window_count = 0;
+    stub_unmap_window_count = 0;
+    stub_configure_window_count = 0;
+
+    // Hiding moves the frame off screen and keeps it mapped
+    wm_switch_workspace(&s, 1);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(stub_unmap_window_count == 0);
+    assert(stub_configure_window_count == 1);
+    assert(stub_last_config_window == 1001);
+    assert(stub_last_config_x == WM_FRAME_PARK_POS && stub_last_config_y == WM_FRAME_PARK_POS);
+    assert(c1->frame_mapped && c1->frame_parked);
+    assert(c1->server.x == 40 && c1->server.y == 50);
+
+    // A ConfigureNotify for the parked position does not clobber the real one
+    xcb_configure_notify_event_t ev = {0};
+    ev.window = 1001;
+    ev.x = WM_FRAME_PARK_POS;
+    ev.y = WM_FRAME_PARK_POS;
+    wm_handle_configure_notify(&s, h1, &ev);
+    assert(c1->server.x == 40 && c1->server.y == 50);
+
+    // Showing it again moves it back without a map request
+    stub_configure_window_count = 0;
+    wm_switch_workspace(&s, 0);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(stub_map_window_count == 0);
+    assert(stub_configure_window_count == 1);
+    assert(stub_last_config_x == 40 && stub_last_config_y == 50);
+    assert(c1->frame_mapped && !c1->frame_parked);
+
+    printf("test_workspace_switch_park_mode passed.\n");
+    for (uint32_t i = 1; i < s.clients.cap; i++) {
+        if (s.clients.hdr[i].live) {
+            handle_t h = handle_make(i, s.clients.hdr[i].gen);
+            client_hot_t* hot = server_chot(&s, h);
+            if (hot) {
+                render_free(&hot->render_ctx);
+                if (hot->icon_surface) cairo_surface_destroy(hot->icon_surface);
+            }
+        }
+    }
+    teardown_desktop_index(&s);
+    slotmap_destroy(&s.clients);
+    small_vec_destroy(&s.active_clients);
+    xcb_disconnect(s.conn);
+}
+
+void test_hidden_frames_defer_redraw(void) {
+    server_t s;
+    setup_server(&s);
+    s.config.theme.border_width = 2;
+    s.config.theme.title_height = 20;
+
+    handle_t hs[3];
+    for (int i = 0; i < 3; i++) {
+        hs[i] = slotmap_alloc(&s.clients, NULL, NULL);
+        small_vec_push(&s.active_clients, handle_to_ptr(hs[i]));
+        client_hot_t* c = server_chot(&s, hs[i]);
+        c->state = STATE_MAPPED;
+        c->desktop = i == 1 ? 1 : 0;
+        c->frame = 1001 + (xcb_window_t)i;
+        c->xid = 2001 + (xcb_window_t)i;
+        c->self = hs[i];
+        c->server = (rect_t){10, 10, 200, 100};
+        c->layer = c->stacking_layer = LAYER_NORMAL;
+        render_init(&c->render_ctx);
+        index_client(&s, hs[i]);
+    }
+    client_hot_t* shown = server_chot(&s, hs[0]);
+    client_hot_t* away = server_chot(&s, hs[1]);
+    client_hot_t* iconic = server_chot(&s, hs[2]);
+    iconic->state = STATE_UNMAPPED;
+    iconic->frame_mapped = false;
+
+    // A style change (theme reload) only paints the frame on screen
+    uint64_t deferred = counters.frame_redraws_deferred;
+    for (int i = 0; i < 3; i++) server_chot(&s, hs[i])->dirty |= DIRTY_FRAME_STYLE;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(!(shown->dirty & DIRTY_FRAME_STYLE));
+    assert(away->dirty & DIRTY_FRAME_STYLE);
+    assert(iconic->dirty & DIRTY_FRAME_STYLE);
+    assert(counters.frame_redraws_deferred == deferred + 2);
+
+    // Becoming visible paints it once
+    wm_switch_workspace(&s, 1);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(away->frame_mapped);
+    assert(!(away->dirty & DIRTY_FRAME_STYLE));
+    assert(shown->dirty == DIRTY_NONE);
+
+    // A frame fully under an opaque fullscreen client waits until it leaves
+    wm_switch_workspace(&s, 0);
+    wm_flush_dirty(&s, monotonic_time_ns());
+    away->desktop = 0;
+    away->layer = away->stacking_layer = LAYER_FULLSCREEN;
+    away->frame_mapped = true;
+    away->server = (rect_t){0, 0, 1024, 768};
+    s.layers[LAYER_FULLSCREEN].bottom = s.layers[LAYER_FULLSCREEN].top = away;
+    s.layers[LAYER_FULLSCREEN].length = 1;
+
+    shown->dirty |= DIRTY_FRAME_TITLE;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(shown->dirty & DIRTY_FRAME_TITLE);
+
+    away->window_opacity_valid = true;
+    away->window_opacity = 0x80000000u;
+    wm_flush_dirty(&s, monotonic_time_ns());
+    assert(!(shown->dirty & DIRTY_FRAME_TITLE));
+
+    printf("test_hidden_frames_defer_redraw passed.\n");
+    for (int i = 0; i < 3; i++) render_free(&server_chot(&s, hs[i])->render_ctx);
+    teardown_desktop_index(&s);
     slotmap_destroy(&s.clients);
     small_vec_destroy(&s.active_clients);
     xcb_disconnect(s.conn);
@@ -321,6 +569,9 @@ void test_workspace_relative(void) {
 
 int main(void) {
     test_workspace_switch_basics();
+    test_workspace_switch_touches_only_changed();
+    test_workspace_switch_park_mode();
+    test_hidden_frames_defer_redraw();
     test_client_move_to_workspace();
     test_client_toggle_sticky();
     test_workspace_relative();
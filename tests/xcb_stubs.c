@@ -7,6 +7,7 @@
 #include <unistd.h>
 #include <xcb/randr.h>
 #include <xcb/sync.h>
+#include <xcb/xkb.h>
 #include <xcb/xcb.h>
 #include <xcb/xproto.h>
 
@@ -67,6 +68,7 @@ uint8_t stub_last_image_data[200 * 1024];
 xcb_window_t stub_last_prop_window = 0;
 xcb_atom_t stub_last_prop_atom = 0;
 xcb_atom_t stub_last_prop_type = 0;
+uint8_t stub_last_prop_mode = 0;
 uint32_t stub_last_prop_len = 0;
 uint8_t stub_last_prop_data[STUB_MAX_PROP_BYTES];
 
@@ -190,6 +192,7 @@ void xcb_stubs_reset(void) {
     stub_last_prop_window = 0;
     stub_last_prop_atom = 0;
     stub_last_prop_type = 0;
+    stub_last_prop_mode = 0;
     stub_last_prop_len = 0;
     memset(stub_last_prop_data, 0, sizeof(stub_last_prop_data));
     stub_prop_calls_len = 0;
@@ -520,8 +523,8 @@ const stub_config_call_t* stub_config_call_at(int idx) {
 xcb_void_cookie_t xcb_change_property(xcb_connection_t* c, uint8_t mode, xcb_window_t window, xcb_atom_t property,
                                       xcb_atom_t type, uint8_t format, uint32_t data_len, const void* data) {
     (void)c;
-    (void)mode;
 
+    stub_last_prop_mode = mode;
     stub_last_prop_window = window;
     stub_last_prop_atom = property;
     stub_last_prop_type = type;
@@ -756,6 +759,20 @@ xcb_grab_pointer_reply_t* xcb_grab_pointer_reply(xcb_connection_t* c, xcb_grab_p
     return r;
 }
 
+xcb_query_pointer_cookie_t xcb_query_pointer(xcb_connection_t* c, xcb_window_t window) {
+    (void)c;
+    (void)window;
+    return (xcb_query_pointer_cookie_t){stub_cookie_seq++};
+}
+
+xcb_query_pointer_reply_t* xcb_query_pointer_reply(xcb_connection_t* c, xcb_query_pointer_cookie_t cookie,
+                                                   xcb_generic_error_t** e) {
+    (void)c;
+    (void)cookie;
+    (void)e;
+    return NULL;
+}
+
 xcb_void_cookie_t xcb_ungrab_pointer(xcb_connection_t* c, xcb_timestamp_t time) {
     (void)c;
     (void)time;
@@ -1126,6 +1143,46 @@ xcb_keysym_t xcb_key_symbols_get_keysym(xcb_key_symbols_t* syms, xcb_keycode_t k
     return 0;
 }
 
+xcb_get_keyboard_mapping_cookie_t xcb_get_keyboard_mapping(xcb_connection_t* c, xcb_keycode_t first_keycode,
+                                                           uint8_t count) {
+    (void)c;
+    (void)first_keycode;
+    (void)count;
+    return (xcb_get_keyboard_mapping_cookie_t){stub_cookie_seq++};
+}
+
+xcb_get_input_focus_cookie_t xcb_get_input_focus(xcb_connection_t* c) {
+    (void)c;
+    return (xcb_get_input_focus_cookie_t){stub_cookie_seq++};
+}
+
+void xcb_discard_reply(xcb_connection_t* c, unsigned int sequence) {
+    (void)c;
+    (void)sequence;
+}
+
+// XKB stubs
+xcb_xkb_use_extension_cookie_t xcb_xkb_use_extension(xcb_connection_t* c, uint16_t wantedMajor, uint16_t wantedMinor) {
+    (void)c;
+    (void)wantedMajor;
+    (void)wantedMinor;
+    return (xcb_xkb_use_extension_cookie_t){stub_cookie_seq++};
+}
+
+xcb_void_cookie_t xcb_xkb_select_events(xcb_connection_t* c, xcb_xkb_device_spec_t deviceSpec, uint16_t affectWhich,
+                                        uint16_t clear, uint16_t selectAll, uint16_t affectMap, uint16_t map,
+                                        const void* details) {
+    (void)c;
+    (void)deviceSpec;
+    (void)affectWhich;
+    (void)clear;
+    (void)selectAll;
+    (void)affectMap;
+    (void)map;
+    (void)details;
+    return (xcb_void_cookie_t){0};
+}
+
 // Colormap stubs
 xcb_void_cookie_t xcb_install_colormap(xcb_connection_t* c, xcb_colormap_t cmap) {
     (void)c;
@@ -1209,6 +1266,22 @@ xcb_randr_get_crtc_info_reply_t* xcb_randr_get_crtc_info_reply(xcb_connection_t*
     return NULL;
 }
 
+xcb_randr_get_monitors_cookie_t xcb_randr_get_monitors(xcb_connection_t* c, xcb_window_t window, uint8_t get_active) {
+    (void)c;
+    (void)window;
+    (void)get_active;
+    return (xcb_randr_get_monitors_cookie_t){stub_cookie_seq++};
+}
+
+xcb_randr_get_monitors_reply_t* xcb_randr_get_monitors_reply(xcb_connection_t* c,
+                                                             xcb_randr_get_monitors_cookie_t cookie,
+                                                             xcb_generic_error_t** e) {
+    (void)c;
+    (void)cookie;
+    (void)e;
+    return NULL;
+}
+
 xcb_void_cookie_t xcb_randr_select_input(xcb_connection_t* c, xcb_window_t window, uint16_t enable) {
     (void)c;
     (void)window;